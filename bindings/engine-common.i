@@ -44,6 +44,90 @@ AccountList * gnc_account_get_descendants_sorted (const Account *account);
 %ignore gnc_account_get_children_sorted;
 %ignore gnc_account_get_descendants;
 %ignore gnc_account_get_descendants_sorted;
+
+/* xaccAccountGetBalancesAtDates takes a list of dates and returns the
+ * list of balances at them. */
+#if defined(SWIGGUILE)
+%typemap(in) (const time64 *dates, guint n_dates, gnc_numeric *balances) {
+    long len = scm_ilength ($input);
+    SCM node = $input;
+    time64 *dates;
+
+    if (len < 0)
+        scm_wrong_type_arg ("xaccAccountGetBalancesAtDates", $argnum, $input);
+    dates = g_new (time64, len);
+    for (long i = 0; i < len; i++, node = SCM_CDR (node))
+        dates[i] = scm_to_int64 (SCM_CAR (node));
+    $1 = dates;
+    $2 = len;
+    $3 = g_new (gnc_numeric, len);
+}
+/* Dates without a split on or before them get #f instead of zero. */
+%typemap(argout) (const time64 *dates, guint n_dates, gnc_numeric *balances) {
+    SCM list = SCM_EOL;
+    for (guint i = $2; i > result; i--)
+        list = scm_cons (gnc_numeric_to_scm ($3[i - 1]), list);
+    for (guint i = result; i > 0; i--)
+        list = scm_cons (SCM_BOOL_F, list);
+    $result = list;
+}
+#elif defined(SWIGPYTHON)
+%typemap(in) (const time64 *dates, guint n_dates, gnc_numeric *balances) {
+    PyObject *seq = PySequence_Fast ($input, "a sequence of dates is expected");
+    Py_ssize_t len;
+    time64 *dates;
+
+    if (!seq)
+        return NULL;
+    PyDateTime_IMPORT;
+    len = PySequence_Fast_GET_SIZE (seq);
+    dates = g_new (time64, len);
+    for (Py_ssize_t i = 0; i < len; i++)
+    {
+        PyObject *date = PySequence_Fast_GET_ITEM (seq, i);
+        if (PyDate_Check (date))
+        {
+            struct tm time = {PyDateTime_DATE_GET_SECOND(date),
+                              PyDateTime_DATE_GET_MINUTE(date),
+                              PyDateTime_DATE_GET_HOUR(date),
+                              PyDateTime_GET_DAY(date),
+                              PyDateTime_GET_MONTH(date) - 1,
+                              PyDateTime_GET_YEAR(date) - 1900};
+            dates[i] = gnc_mktime (&time);
+        }
+        else if (PyLong_Check (date))
+            dates[i] = PyLong_AsLongLong (date);
+        else
+        {
+            PyErr_SetString (PyExc_ValueError, "date, datetime or integer expected");
+            g_free (dates);
+            Py_DECREF (seq);
+            return NULL;
+        }
+    }
+    Py_DECREF (seq);
+    $1 = dates;
+    $2 = len;
+    $3 = g_new (gnc_numeric, len);
+}
+%typemap(argout) (const time64 *dates, guint n_dates, gnc_numeric *balances) {
+    PyObject *list = PyList_New ($2);
+    for (guint i = 0; i < $2; i++)
+    {
+        gnc_numeric *balance = (gnc_numeric *) malloc (sizeof (gnc_numeric));
+        *balance = $3[i];
+        PyList_SET_ITEM (list, i, SWIG_NewPointerObj (balance, $descriptor(gnc_numeric *),
+                                                      SWIG_POINTER_OWN));
+    }
+    Py_DECREF ($result);
+    $result = list;
+}
+#endif
+%typemap(freearg) (const time64 *dates, guint n_dates, gnc_numeric *balances) {
+    g_free ((time64 *) $1);
+    g_free ($3);
+}
+
 %include <Account.h>
 
 %include <Transaction.h>
@@ -172,6 +172,15 @@ functions. */
 }
 
 %include <engine-helpers.h>
+/* Only the enums, scheme uses the gnc_split_selection_scm functions. */
+%ignore gnc_split_selection_new;
+%ignore gnc_split_selection_destroy;
+%ignore gnc_split_selection_set_matcher;
+%ignore gnc_split_selection_set_other_accounts;
+%ignore gnc_split_selection_set_sort;
+%ignore gnc_split_selection_run;
+%ignore gnc_split_selection_get_break;
+%include <gnc-split-selection.h>
 %include <gnc-engine-guile.h>
 %typemap(in) Transaction *trans;
 %typemap(in) Split *split;
@@ -318,6 +327,46 @@ void qof_book_set_string_option(QofBook* book, const char* opt_name, const char*
     SET_ENUM("ACCT-TYPE-MONEYMRKT");
     SET_ENUM("ACCT-TYPE-CREDITLINE");
 
+    SET_ENUM("ACCOUNT-BALANCE-TOTAL");
+    SET_ENUM("ACCOUNT-BALANCE-NOCLOSING");
+    SET_ENUM("ACCOUNT-BALANCE-CLEARED");
+    SET_ENUM("ACCOUNT-BALANCE-RECONCILED");
+
+    SET_ENUM("GNC-ACCOUNT-ITER-SPLITS");
+    SET_ENUM("GNC-ACCOUNT-ITER-CHILDREN");
+    SET_ENUM("GNC-ACCOUNT-ITER-DESCENDANTS");
+
+    SET_ENUM("GNC-SPLIT-SORT-NONE");
+    SET_ENUM("GNC-SPLIT-SORT-ACCOUNT-NAME");
+    SET_ENUM("GNC-SPLIT-SORT-ACCOUNT-CODE");
+    SET_ENUM("GNC-SPLIT-SORT-DATE");
+    SET_ENUM("GNC-SPLIT-SORT-RECONCILED-DATE");
+    SET_ENUM("GNC-SPLIT-SORT-RECONCILED-STATUS");
+    SET_ENUM("GNC-SPLIT-SORT-REGISTER-ORDER");
+    SET_ENUM("GNC-SPLIT-SORT-CORR-ACCOUNT-NAME");
+    SET_ENUM("GNC-SPLIT-SORT-CORR-ACCOUNT-CODE");
+    SET_ENUM("GNC-SPLIT-SORT-AMOUNT");
+    SET_ENUM("GNC-SPLIT-SORT-DESCRIPTION");
+    SET_ENUM("GNC-SPLIT-SORT-NUMBER");
+    SET_ENUM("GNC-SPLIT-SORT-ACTION");
+    SET_ENUM("GNC-SPLIT-SORT-MEMO");
+    SET_ENUM("GNC-SPLIT-SORT-NOTES");
+
+    SET_ENUM("GNC-SPLIT-DATE-GROUP-NONE");
+    SET_ENUM("GNC-SPLIT-DATE-GROUP-DAY");
+    SET_ENUM("GNC-SPLIT-DATE-GROUP-WEEK");
+    SET_ENUM("GNC-SPLIT-DATE-GROUP-MONTH");
+    SET_ENUM("GNC-SPLIT-DATE-GROUP-QUARTER");
+    SET_ENUM("GNC-SPLIT-DATE-GROUP-YEAR");
+
+    SET_ENUM("GNC-SPLIT-OTHER-ACCOUNTS-ANY");
+    SET_ENUM("GNC-SPLIT-OTHER-ACCOUNTS-INCLUDE");
+    SET_ENUM("GNC-SPLIT-OTHER-ACCOUNTS-EXCLUDE");
+
+    SET_ENUM("GNC-SPLIT-BREAK-NONE");
+    SET_ENUM("GNC-SPLIT-BREAK-SECONDARY");
+    SET_ENUM("GNC-SPLIT-BREAK-PRIMARY");
+
     SET_ENUM("QOF-QUERY-AND");
     SET_ENUM("QOF-QUERY-OR");
 
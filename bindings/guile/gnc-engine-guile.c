@@ -1916,3 +1916,230 @@ gnc_parse_time_to_time64 (const gchar *s, const gchar *format)
     return gnc_mktime(&tm);
 }
 
+
+static GncCommodityCollector *
+gnc_scm_to_commodity_collector (SCM coll_scm)
+{
+    return scm_to_pointer (coll_scm);
+}
+
+SCM
+gnc_commodity_collector_scm_new (void)
+{
+    return scm_from_pointer (gnc_commodity_collector_new (),
+                             (scm_t_pointer_finalizer) gnc_commodity_collector_destroy);
+}
+
+SCM
+gnc_commodity_collector_scm_add (SCM coll_scm, SCM commodity_scm, SCM amount_scm)
+{
+    GncCommodityCollector *coll = gnc_scm_to_commodity_collector (coll_scm);
+    gnc_commodity *commodity = gnc_scm_to_commodity (commodity_scm);
+
+    if (!commodity)
+        return SCM_BOOL_F;
+
+    /* Anything that isn't a number only lists the commodity, just as the
+     * scheme value collectors ignored it. */
+    if (gnc_commodity_collector_add (coll, commodity,
+                                     gnc_scm_to_numeric (amount_scm)))
+        return SCM_BOOL_T;
+    return scm_from_bool (!scm_is_number (amount_scm));
+}
+
+SCM
+gnc_commodity_collector_scm_merge (SCM coll_scm, SCM other_scm, SCM negate_scm)
+{
+    return scm_from_bool (gnc_commodity_collector_merge
+                          (gnc_scm_to_commodity_collector (coll_scm),
+                           gnc_scm_to_commodity_collector (other_scm),
+                           scm_is_true (negate_scm)));
+}
+
+void
+gnc_commodity_collector_scm_reset (SCM coll_scm)
+{
+    gnc_commodity_collector_reset (gnc_scm_to_commodity_collector (coll_scm));
+}
+
+SCM
+gnc_commodity_collector_scm_amount (SCM coll_scm, SCM commodity_scm)
+{
+    gnc_commodity *commodity = gnc_scm_to_commodity (commodity_scm);
+
+    if (!commodity)
+        return scm_from_int (0);
+    return gnc_numeric_to_scm (gnc_commodity_collector_get_amount
+                               (gnc_scm_to_commodity_collector (coll_scm),
+                                commodity));
+}
+
+SCM
+gnc_commodity_collector_scm_list (SCM coll_scm)
+{
+    GncCommodityCollector *coll = gnc_scm_to_commodity_collector (coll_scm);
+    SCM list = SCM_EOL;
+
+    for (guint n = gnc_commodity_collector_get_length (coll); n > 0; n--)
+        list = scm_cons (scm_cons (gnc_commodity_to_scm
+                                   (gnc_commodity_collector_nth_commodity (coll, n - 1)),
+                                   gnc_numeric_to_scm
+                                   (gnc_commodity_collector_nth_amount (coll, n - 1))),
+                         list);
+    return list;
+}
+
+SCM
+gnc_account_iter_scm_new (const Account *account, GncAccountIterKind kind,
+                          gboolean snapshot)
+{
+    GncAccountIter *iter = gnc_account_iter_new (account, kind, snapshot);
+
+    if (!iter)
+        return SCM_BOOL_F;
+    return scm_from_pointer (iter, (scm_t_pointer_finalizer) gnc_account_iter_free);
+}
+
+SCM
+gnc_account_iter_scm_next (SCM iter_scm)
+{
+    GncAccountIter *iter = scm_to_pointer (iter_scm);
+    gpointer item = gnc_account_iter_next (iter);
+
+    if (item)
+        return gnc_generic_to_scm (item,
+                                   gnc_account_iter_get_kind (iter) == GNC_ACCOUNT_ITER_SPLITS ?
+                                   "_p_Split" : "_p_Account");
+    if (gnc_account_iter_is_stale (iter))
+        scm_misc_error ("gnc-account-iter-scm-next",
+                        "The book was changed during iteration, use a snapshot iterator instead.",
+                        SCM_EOL);
+    return SCM_BOOL_F;
+}
+
+static GncSplitSelection *
+gnc_scm_to_split_selection (SCM sel_scm)
+{
+    return scm_to_pointer (sel_scm);
+}
+
+SCM
+gnc_split_selection_scm_new (void)
+{
+    return scm_from_pointer (gnc_split_selection_new (),
+                             (scm_t_pointer_finalizer) gnc_split_selection_destroy);
+}
+
+SCM
+gnc_split_selection_scm_set_matcher (SCM sel_scm, const char *pattern,
+                                     gboolean regex, gboolean case_insensitive,
+                                     gboolean exclude)
+{
+    return scm_from_bool (gnc_split_selection_set_matcher
+                          (gnc_scm_to_split_selection (sel_scm), pattern,
+                           regex, case_insensitive, exclude));
+}
+
+void
+gnc_split_selection_scm_set_other_accounts (SCM sel_scm, AccountList *accounts,
+                                            GncSplitOtherAccounts mode)
+{
+    gnc_split_selection_set_other_accounts (gnc_scm_to_split_selection (sel_scm),
+                                            accounts, mode);
+}
+
+void
+gnc_split_selection_scm_set_sort (SCM sel_scm, guint level, GncSplitSortKey key,
+                                  GncSplitDateGroup date_group,
+                                  gboolean ascending, gboolean subtotal)
+{
+    gnc_split_selection_set_sort (gnc_scm_to_split_selection (sel_scm), level,
+                                  key, date_group, ascending, subtotal);
+}
+
+SCM
+gnc_split_selection_scm_run (SCM sel_scm, QofQuery *query, gboolean unique_trans)
+{
+    SplitList *splits = gnc_split_selection_run (gnc_scm_to_split_selection (sel_scm),
+                                                 query, unique_trans);
+    SCM list = SCM_EOL;
+
+    for (GList *node = g_list_last (splits); node; node = node->prev)
+        list = scm_cons (gnc_generic_to_scm (node->data, "_p_Split"), list);
+    g_list_free (splits);
+    return list;
+}
+
+SCM
+gnc_split_selection_scm_breaks (SCM sel_scm, SCM splits)
+{
+    GncSplitSelection *sel = gnc_scm_to_split_selection (sel_scm);
+    SCM breaks = SCM_EOL;
+
+    for (; !scm_is_null (splits); splits = scm_cdr (splits))
+    {
+        Split *split = gnc_scm_to_generic (scm_car (splits), "_p_Split");
+        Split *next = scm_is_null (scm_cdr (splits)) ? NULL :
+            gnc_scm_to_generic (scm_cadr (splits), "_p_Split");
+        breaks = scm_cons (scm_from_int (gnc_split_selection_get_break (sel, split, next)),
+                           breaks);
+    }
+    return scm_reverse_x (breaks, SCM_EOL);
+}
+
+SCM
+gnc_owner_aging_scm (AccountList *accounts, time64 date, guint num_buckets,
+                     gboolean due_date, gboolean receivable)
+{
+    GncOwnerAging *aging = gnc_owner_aging_new (accounts, date, num_buckets,
+                                                due_date, receivable);
+    SCM accounts_aging = SCM_EOL;
+    SCM owners = SCM_EOL;
+    SCM invalid = SCM_EOL;
+    Account *account = NULL;
+
+    if (!aging)
+        return scm_cons (SCM_EOL, SCM_EOL);
+
+    for (guint row = 0; row < gnc_owner_aging_get_num_rows (aging); row++)
+    {
+        GncOwner *owner = gncOwnerNew ();
+        SCM buckets = SCM_EOL;
+
+        /* The rows of each account follow each other. */
+        if (account && account != gnc_owner_aging_get_account (aging, row))
+        {
+            accounts_aging = scm_cons (scm_list_2 (gnc_generic_to_scm (account, "_p_Account"),
+                                                   scm_reverse_x (owners, SCM_EOL)),
+                                       accounts_aging);
+            owners = SCM_EOL;
+        }
+        account = gnc_owner_aging_get_account (aging, row);
+
+        gncOwnerCopy (gnc_owner_aging_get_owner (aging, row), owner);
+        for (guint bucket = num_buckets; bucket > 0; bucket--)
+            buckets = scm_cons (gnc_numeric_to_scm (gnc_owner_aging_get_bucket (aging, row,
+                                                                                bucket - 1)),
+                                buckets);
+        owners = scm_cons (scm_cons (gnc_generic_to_scm (owner, "_p__gncOwner"), buckets),
+                           owners);
+    }
+    if (account)
+        accounts_aging = scm_cons (scm_list_2 (gnc_generic_to_scm (account, "_p_Account"),
+                                               scm_reverse_x (owners, SCM_EOL)),
+                                   accounts_aging);
+
+    for (guint n = gnc_owner_aging_get_num_invalid (aging); n > 0; n--)
+    {
+        Split *split = gnc_owner_aging_get_invalid_split (aging, n - 1);
+        const char *reason =
+            gnc_owner_aging_get_invalid_reason (aging, n - 1) == GNC_OWNER_AGING_INVALID_NO_OWNER ?
+            "no-owner" : "txn-type";
+        invalid = scm_cons (scm_cons (gnc_generic_to_scm (split, "_p_Split"),
+                                      scm_from_utf8_symbol (reason)),
+                            invalid);
+    }
+
+    gnc_owner_aging_destroy (aging);
+    return scm_cons (scm_reverse_x (accounts_aging, SCM_EOL), invalid);
+}
@@ -29,6 +29,10 @@
 #include <libguile.h>
 
 #include "gnc-engine.h"
+#include "Account.h"
+#include "gnc-commodity-collector.h"
+#include "gnc-split-selection.h"
+#include "gnc-owner-aging.h"
 #include <gncTaxTable.h>	/* for GncAccountValue */
 #include "gnc-hooks.h"
 
@@ -59,6 +63,56 @@ SCM gnc_book_to_scm (const QofBook *book);
 GncAccountValue * gnc_scm_to_account_value_ptr (SCM valuearg);
 SCM gnc_account_value_ptr_to_scm (GncAccountValue *);
 
+/* The native side of gnc:make-commodity-collector, see
+ * gnc-commodity-collector.h. The collector is freed once the scheme
+ * object holding it is garbage collected.
+ *
+ * gnc_commodity_collector_scm_add and gnc_commodity_collector_scm_merge
+ * return #f when the collector can't hold the amounts exactly; the
+ * caller is expected to keep those itself. The list holds
+ * (commodity . amount) pairs, most recently added commodity first. */
+SCM gnc_commodity_collector_scm_new (void);
+SCM gnc_commodity_collector_scm_add (SCM coll, SCM commodity, SCM amount);
+SCM gnc_commodity_collector_scm_merge (SCM coll, SCM other, SCM negate);
+void gnc_commodity_collector_scm_reset (SCM coll);
+SCM gnc_commodity_collector_scm_amount (SCM coll, SCM commodity);
+SCM gnc_commodity_collector_scm_list (SCM coll);
+
+/* Iterators over an account's splits, children or descendants, see
+ * gnc_account_iter_new(). The iterator is freed once the scheme object
+ * holding it is garbage collected. gnc_account_iter_scm_next returns #f
+ * when there are no more, and throws a misc-error if the book was
+ * changed under a live iterator. */
+SCM gnc_account_iter_scm_new (const Account *account, GncAccountIterKind kind,
+                              gboolean snapshot);
+SCM gnc_account_iter_scm_next (SCM iter);
+
+/* The transaction report's split selection, see gnc-split-selection.h.
+ * The selection is freed once the scheme object holding it is garbage
+ * collected. gnc_split_selection_scm_set_matcher returns #f if the
+ * pattern isn't a valid regular expression. gnc_split_selection_scm_breaks
+ * returns the GncSplitBreak after each of the splits in the list. */
+SCM gnc_split_selection_scm_new (void);
+SCM gnc_split_selection_scm_set_matcher (SCM sel, const char *pattern,
+                                         gboolean regex, gboolean case_insensitive,
+                                         gboolean exclude);
+void gnc_split_selection_scm_set_other_accounts (SCM sel, AccountList *accounts,
+                                                 GncSplitOtherAccounts mode);
+void gnc_split_selection_scm_set_sort (SCM sel, guint level, GncSplitSortKey key,
+                                       GncSplitDateGroup date_group,
+                                       gboolean ascending, gboolean subtotal);
+SCM gnc_split_selection_scm_run (SCM sel, QofQuery *query, gboolean unique_trans);
+SCM gnc_split_selection_scm_breaks (SCM sel, SCM splits);
+
+/* The aging of the accounts' owners, see gnc_owner_aging_new(). Returns
+ * a pair of the aging and the splits that couldn't be aged. The aging is
+ * a list of each account with owners and the list of its owners, each
+ * consed onto its list of bucket amounts. The splits are each consed
+ * onto their reason, 'txn-type or 'no-owner. The owners are new, free
+ * them with gncOwnerFree. */
+SCM gnc_owner_aging_scm (AccountList *accounts, time64 date, guint num_buckets,
+                         gboolean due_date, gboolean receivable);
+
 /**
  * add Scheme-style danglers from a hook
  */
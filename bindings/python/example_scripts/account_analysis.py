@@ -194,7 +194,7 @@ def main():
         period_starts = [e[0] for e in period_list ]
 
         # insert and add all splits in the periods of interest
-        for split in account_of_interest.GetSplitList():
+        for split in account_of_interest.IterSplits():
             trans = split.parent
             trans_date = date.fromtimestamp(trans.GetDate())
 
@@ -20,7 +20,8 @@ def mark_account_with_code_as_tax_related(account, target_code):
         account.SetTaxRelated(True)
         return True
     else:
-        for child in account.get_children():
+        # the loop changes the book, so it needs a snapshot
+        for child in account.IterChildren(snapshot=True):
             if mark_account_with_code_as_tax_related(child, target_code):
                 return True
         return False
@@ -15,7 +15,7 @@ import gnucash
 def get_transaction_list(account):
     """Returns all transactions in account.
 
-    Splits are derived from account.GetSplitList().
+    Splits are derived from account.IterSplits().
    
     options:
 
@@ -23,11 +23,8 @@ def get_transaction_list(account):
     
     """
     
-    split_list=account.GetSplitList()
     transaction_list=[]
-    for split in split_list:
-        if type(split) != Split:
-              split = Split(instance=split)
+    for split in account.IterSplits():
         transaction=split.GetParent()
         if not (transaction in transaction_list):       # this check may not be necessary.
           transaction_list.append(transaction)
@@ -49,7 +46,7 @@ def get_splits_without_lot(account=None,split_list=None):
       if account==None:
           return []
       else:
-          split_list=account.GetSplitList()
+          split_list=account.IterSplits()
   
   rlist=[]
   for split in split_list:
@@ -77,9 +74,7 @@ def find_account(account,name,account_list=None):
   if not account_list:
     account_list=[]
 
-  for child in account.get_children():
-    if type(child) != Account:
-      child=Account(instance=child)
+  for child in account.IterChildren():
     account_list=find_account(child,name,account_list)
   
   account_name=account.GetName()
@@ -152,9 +147,7 @@ def find_split_recursive(account, search_string):
   child_account_splits = []
   
   # Get all splits in descendants
-  for child in account.get_children():
-      if type(child) != Account:
-          child = Account(instance=child)
+  for child in account.IterChildren():
       childsplits = find_split_recursive(child, search_string)
       for split in childsplits:
           if type(split) != Split:
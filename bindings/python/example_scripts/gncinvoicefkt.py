@@ -29,10 +29,7 @@ except ImportError as import_error:
 def get_all_lots(account):
   """Return all lots in account and descendants"""
   ltotal=[]
-  descs = account.get_descendants()
-  for desc in descs:
-    if type(desc).__name__ == 'SwigPyObject':
-        desc = gnucash.Account(instance=desc)
+  for desc in account.IterDescendants():
     ll=desc.GetLotList()
     ltotal+=ll
   return ltotal
@@ -173,21 +173,50 @@ class Invoice(GnuCashCoreClass):
 class Bill(Invoice):
     pass
 
+def owner_instance(owner_type, instance):
+    """Returns the Customer, Job, Employee or Vendor of an owner tuple."""
+    if owner_type == GNC_OWNER_CUSTOMER:
+        return Customer(instance=instance)
+    elif owner_type == GNC_OWNER_JOB:
+        return Job(instance=instance)
+    elif owner_type == GNC_OWNER_EMPLOYEE:
+        return Employee(instance=instance)
+    elif owner_type == GNC_OWNER_VENDOR:
+        return Vendor(instance=instance)
+    else:
+        return None
+
 def decorate_to_return_instance_instead_of_owner(dec_function):
     def new_get_owner_function(self):
         (owner_type, instance) = dec_function(self)
-        if owner_type == GNC_OWNER_CUSTOMER:
-            return Customer(instance=instance)
-        elif owner_type == GNC_OWNER_JOB:
-            return Job(instance=instance)
-        elif owner_type == GNC_OWNER_EMPLOYEE:
-            return Employee(instance=instance)
-        elif owner_type == GNC_OWNER_VENDOR:
-            return Vendor(instance=instance)
-        else:
-            return None
+        return owner_instance(owner_type, instance)
     return new_get_owner_function
 
+def get_owner_aging(accounts, date, num_buckets=6, due_date=True,
+                    receivable=True):
+    """Ages the owners of A/Receivable or A/Payable accounts as of date,
+    the way the aging reports do, and returns a tuple of the rows and of
+    the splits that couldn't be aged.
+
+    Each row is an (account, owner, buckets) tuple. The owner is a
+    Customer, Job, Employee or Vendor, and buckets is a list of
+    num_buckets GncNumeric amounts, oldest first: the invoices due more
+    than (num_buckets - 3) * 30 days before date, those due in each 30 day
+    period after that, those not yet due, and the prepayments. Set
+    due_date to False to age invoices by their posted date instead, and
+    receivable to False for payable accounts.
+
+    Each split is a (split, reason) tuple, where reason is 'txn-type' or
+    'no-owner'.
+    """
+    rows, invalid = gnucash_core_c.gnc_owner_aging_rows(
+        [account.get_instance() for account in accounts], date,
+        num_buckets, due_date, receivable)
+    return ([(Account(instance=account), owner_instance(*owner),
+              [GncNumeric(instance=amount) for amount in buckets])
+             for account, owner, buckets in rows],
+            [(Split(instance=split), reason) for split, reason in invalid])
+
 class Entry(GnuCashCoreClass):
     def __init__(self, book=None, invoice=None, date=None, instance=None):
         """Invoice Entry constructor
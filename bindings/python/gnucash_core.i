@@ -61,6 +61,7 @@
 #include "Split.h"
 #include "Account.h"
 #include "gnc-commodity.h"
+#include "gnc-commodity-collector.h"
 #include "gnc-environment.h"
 #include "gnc-lot.h"
 #include "gnc-numeric.h"
@@ -82,6 +83,24 @@
 #include "gnc-prefs-utils.h"
 #include "cap-gains.h"
 #include "Scrub3.h"
+#include "gnc-split-columns.h"
+#include "gnc-owner-aging.h"
+
+/* Adds a bytearray of size bytes to dict and returns its contents, or
+ * NULL if it can't be created. */
+static char *
+split_columns_add (PyObject *dict, const char *name, Py_ssize_t size)
+{
+    PyObject *column = PyByteArray_FromStringAndSize (NULL, size);
+    char *data;
+
+    if (!column)
+        return NULL;
+    PyDict_SetItemString (dict, name, column);
+    data = PyByteArray_AS_STRING (column);
+    Py_DECREF (column);
+    return data;
+}
 %}
 
 %include <time64.i>
@@ -119,6 +138,94 @@
 
 %include <gnc-commodity.h>
 
+%include <gnc-commodity-collector.h>
+
+/* The columns of gnc_split_columns_fill() as a dict of bytearrays, which
+ * the columns are filled in directly, along with the 'accounts' and
+ * 'strings' they refer to and their 'length'. Wrapped by
+ * gnucash_core.SplitColumns. */
+%inline %{
+static PyObject *
+gnc_split_columns_snapshot (Account *root)
+{
+    guint n = gnc_split_columns_count (root);
+    GncSplitColumns columns;
+    GPtrArray *accounts, *strings;
+    PyObject *dict = PyDict_New ();
+    PyObject *list;
+
+    if (!dict)
+        return NULL;
+
+#define ADD_COLUMN(field, size)                                         \
+    if (!(columns.field = (void *) split_columns_add (dict, #field, (size)))) \
+    {                                                                   \
+        Py_DECREF (dict);                                               \
+        return NULL;                                                    \
+    }
+    ADD_COLUMN (split_guid, n * GUID_DATA_SIZE);
+    ADD_COLUMN (trans_guid, n * GUID_DATA_SIZE);
+    ADD_COLUMN (account, n * sizeof (guint32));
+    ADD_COLUMN (posted, n * sizeof (time64));
+    ADD_COLUMN (amount_num, n * sizeof (gint64));
+    ADD_COLUMN (amount_denom, n * sizeof (gint64));
+    ADD_COLUMN (value_num, n * sizeof (gint64));
+    ADD_COLUMN (value_denom, n * sizeof (gint64));
+    ADD_COLUMN (reconcile, n);
+    ADD_COLUMN (memo, n * sizeof (guint32));
+    ADD_COLUMN (description, n * sizeof (guint32));
+#undef ADD_COLUMN
+
+    accounts = g_ptr_array_new ();
+    strings = g_ptr_array_new ();
+    gnc_split_columns_fill (root, &columns, accounts, strings);
+
+    list = PyList_New (accounts->len);
+    for (guint i = 0; i < accounts->len; i++)
+        PyList_SET_ITEM (list, i, SWIG_NewPointerObj (g_ptr_array_index (accounts, i),
+                                                      SWIGTYPE_p_Account, 0));
+    PyDict_SetItemString (dict, "accounts", list);
+    Py_DECREF (list);
+
+    list = PyList_New (strings->len);
+    for (guint i = 0; i < strings->len; i++)
+        PyList_SET_ITEM (list, i, PyUnicode_FromString (g_ptr_array_index (strings, i)));
+    PyDict_SetItemString (dict, "strings", list);
+    Py_DECREF (list);
+
+    list = PyLong_FromUnsignedLong (n);
+    PyDict_SetItemString (dict, "length", list);
+    Py_DECREF (list);
+
+    g_ptr_array_free (accounts, TRUE);
+    g_ptr_array_free (strings, TRUE);
+    return dict;
+}
+%}
+
+/* The next Split or Account of a GncAccountIter, None when there are no
+ * more. Raises RuntimeError if the book was changed under a live
+ * iterator. Wrapped by gnucash_core.AccountIterator. */
+%inline %{
+static PyObject *
+gnc_account_iter_next_object (GncAccountIter *iter)
+{
+    gpointer item = gnc_account_iter_next (iter);
+
+    if (item)
+        return SWIG_NewPointerObj (item,
+                                   gnc_account_iter_get_kind (iter) == GNC_ACCOUNT_ITER_SPLITS ?
+                                   SWIGTYPE_p_Split : SWIGTYPE_p_Account, 0);
+    if (gnc_account_iter_is_stale (iter))
+    {
+        PyErr_SetString (PyExc_RuntimeError,
+                         "book changed during iteration, use a snapshot iterator");
+        return NULL;
+    }
+    Py_RETURN_NONE;
+}
+%}
+
 %typemap(out) GncOwner * {
     GncOwnerType owner_type = gncOwnerGetType($1);
     PyObject * owner_tuple = PyTuple_New(2);
@@ -209,6 +316,113 @@ static const GncGUID * gncEntryGetGUID(GncEntry *x);
 %include <gncTaxTable.h>
 %include <gncIDSearch.h>
 
+%{
+/* The owner as the GncOwner * out typemap returns it. */
+static PyObject *
+gnc_owner_aging_owner_tuple (const GncOwner *owner)
+{
+    gpointer instance = gncOwnerGetUndefined (owner);
+    swig_type_info *type;
+
+    switch (gncOwnerGetType (owner))
+    {
+    case GNC_OWNER_CUSTOMER:
+        type = SWIGTYPE_p__gncCustomer;
+        break;
+    case GNC_OWNER_JOB:
+        type = SWIGTYPE_p__gncJob;
+        break;
+    case GNC_OWNER_VENDOR:
+        type = SWIGTYPE_p__gncVendor;
+        break;
+    case GNC_OWNER_EMPLOYEE:
+        type = SWIGTYPE_p__gncEmployee;
+        break;
+    default:
+        return Py_BuildValue ("(lO)", (long) gncOwnerGetType (owner), Py_None);
+    }
+    return Py_BuildValue ("(lN)", (long) gncOwnerGetType (owner),
+                          SWIG_NewPointerObj (instance, type, 0));
+}
+%}
+
+/* The aging of gnc_owner_aging_new() as a tuple of its rows and of the
+ * splits that couldn't be aged. Each row is a tuple of the account, the
+ * owner as a (type, instance) tuple and the list of bucket amounts; each
+ * split is a tuple of the split and its reason. Wrapped by
+ * gnucash_business.get_owner_aging. */
+%inline %{
+static PyObject *
+gnc_owner_aging_rows (PyObject *accounts, time64 date, guint num_buckets,
+                      gboolean due_date, gboolean receivable)
+{
+    PyObject *seq = PySequence_Fast (accounts, "a sequence of accounts is expected");
+    GList *account_list = NULL;
+    GncOwnerAging *aging;
+    PyObject *rows, *invalid;
+
+    if (!seq)
+        return NULL;
+    for (Py_ssize_t i = PySequence_Fast_GET_SIZE (seq); i > 0; i--)
+    {
+        void *account;
+        if (!SWIG_IsOK (SWIG_ConvertPtr (PySequence_Fast_GET_ITEM (seq, i - 1),
+                                         &account, SWIGTYPE_p_Account, 0)))
+        {
+            PyErr_SetString (PyExc_TypeError, "a sequence of accounts is expected");
+            g_list_free (account_list);
+            Py_DECREF (seq);
+            return NULL;
+        }
+        account_list = g_list_prepend (account_list, account);
+    }
+    Py_DECREF (seq);
+
+    if (num_buckets < 3)
+    {
+        PyErr_SetString (PyExc_ValueError, "at least 3 buckets are needed");
+        g_list_free (account_list);
+        return NULL;
+    }
+    aging = gnc_owner_aging_new (account_list, date, num_buckets, due_date,
+                                 receivable);
+    g_list_free (account_list);
+
+    rows = PyList_New (gnc_owner_aging_get_num_rows (aging));
+    for (guint row = 0; row < gnc_owner_aging_get_num_rows (aging); row++)
+    {
+        PyObject *buckets = PyList_New (num_buckets);
+        for (guint bucket = 0; bucket < num_buckets; bucket++)
+        {
+            gnc_numeric *amount = (gnc_numeric *) malloc (sizeof (gnc_numeric));
+            *amount = gnc_owner_aging_get_bucket (aging, row, bucket);
+            PyList_SET_ITEM (buckets, bucket,
+                             SWIG_NewPointerObj (amount, SWIGTYPE_p__gnc_numeric,
+                                                 SWIG_POINTER_OWN));
+        }
+        PyList_SET_ITEM (rows, row,
+                         Py_BuildValue ("(NNN)",
+                                        SWIG_NewPointerObj (gnc_owner_aging_get_account (aging, row),
+                                                            SWIGTYPE_p_Account, 0),
+                                        gnc_owner_aging_owner_tuple (gnc_owner_aging_get_owner (aging, row)),
+                                        buckets));
+    }
+
+    invalid = PyList_New (gnc_owner_aging_get_num_invalid (aging));
+    for (guint n = 0; n < gnc_owner_aging_get_num_invalid (aging); n++)
+        PyList_SET_ITEM (invalid, n,
+                         Py_BuildValue ("(Ns)",
+                                        SWIG_NewPointerObj (gnc_owner_aging_get_invalid_split (aging, n),
+                                                            SWIGTYPE_p_Split, 0),
+                                        gnc_owner_aging_get_invalid_reason (aging, n) ==
+                                        GNC_OWNER_AGING_INVALID_NO_OWNER ?
+                                        "no-owner" : "txn-type"));
+
+    gnc_owner_aging_destroy (aging);
+    return Py_BuildValue ("(NN)", rows, invalid);
+}
+%}
+
 // Commodity prices includes and stuff
 %include <gnc-pricedb.h>
 
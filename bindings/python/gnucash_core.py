@@ -543,6 +543,64 @@ class GncCommodityTable(GnuCashCoreClass):
 class GncCommodityNamespace(GnuCashCoreClass):
     pass
 
+class CommodityCollector(GnuCashCoreClass):
+    """Keeps an exact total for each commodity added to it.
+
+    Besides its methods it can be called with the actions of the report
+    system's commodity collectors, e.g. coll('add', commodity, amount),
+    coll('merge', other_coll, None) or
+    coll('format', lambda commodity, amount: ..., None). Amounts are
+    GncNumeric or int; totals are returned as GncNumeric. 'getmonetary'
+    returns a (commodity, amount) tuple.
+    """
+    _new_instance = 'gnc_commodity_collector_new'
+
+    def __del__(self):
+        gnucash_core_c.gnc_commodity_collector_destroy(self.instance)
+
+    def add(self, commodity, amount):
+        if not isinstance(amount, GncNumeric):
+            amount = GncNumeric(amount)
+        if not gnucash_core_c.gnc_commodity_collector_add(
+                self.instance, commodity.instance, amount.instance):
+            raise OverflowError("Total of %s can't be represented"
+                                % commodity.get_mnemonic())
+
+    def merge(self, other, negate=False):
+        if not gnucash_core_c.gnc_commodity_collector_merge(
+                self.instance, other.instance, negate):
+            raise OverflowError("Merged totals can't be represented")
+
+    def get_totals(self):
+        """Returns a list of (commodity, amount) tuples, the most recently
+        added commodity first."""
+        return [(GncCommodity(instance=gnucash_core_c.
+                              gnc_commodity_collector_nth_commodity(self.instance, n)),
+                 GncNumeric(instance=gnucash_core_c.
+                            gnc_commodity_collector_nth_amount(self.instance, n)))
+                for n in range(len(self))]
+
+    def __len__(self):
+        return gnucash_core_c.gnc_commodity_collector_get_length(self.instance)
+
+    def __call__(self, action, commodity, amount):
+        if action == 'add':
+            self.add(commodity, amount)
+        elif action in ('merge', 'minusmerge'):
+            self.merge(commodity, action == 'minusmerge')
+        elif action == 'format':
+            return [commodity(comm, amt) for comm, amt in self.get_totals()]
+        elif action == 'reset':
+            self.reset()
+        elif action in ('getpair', 'getmonetary'):
+            total = self.get_amount(commodity)
+            if amount:
+                total = total.neg()
+            return [commodity, total] if action == 'getpair' \
+                else (commodity, total)
+        else:
+            raise ValueError("bad commodity-collector action: %s" % action)
+
 class GncLot(GnuCashCoreClass):
     def GetInvoiceFromLot(self):
         from gnucash.gnucash_business import Invoice
@@ -626,6 +684,96 @@ class Account(GnuCashCoreClass):
     """
     _new_instance = 'xaccMallocAccount'
 
+    def GetSplitColumns(self):
+        """Returns a SplitColumns snapshot of the splits of this account
+        and all its descendants."""
+        return SplitColumns(self)
+
+    def IterSplits(self, snapshot=False):
+        """Returns an AccountIterator over the splits of this account, in
+        the order of GetSplitList()."""
+        return AccountIterator(self, gnucash_core_c.GNC_ACCOUNT_ITER_SPLITS,
+                               snapshot)
+
+    def IterChildren(self, snapshot=False):
+        """Returns an AccountIterator over the children of this account."""
+        return AccountIterator(self, gnucash_core_c.GNC_ACCOUNT_ITER_CHILDREN,
+                               snapshot)
+
+    def IterDescendants(self, snapshot=False):
+        """Returns an AccountIterator over all the descendants of this
+        account, in the order of get_descendants()."""
+        return AccountIterator(self, gnucash_core_c.GNC_ACCOUNT_ITER_DESCENDANTS,
+                               snapshot)
+
+class AccountIterator(object):
+    """Iterates over the splits, children or descendants of an account
+    without building a list of all of them first.
+
+    By default the iterator walks the account's own lists, and raises
+    RuntimeError if anything in the book is changed before it is done.
+    Iterators created with snapshot=True copy the list first, so the loop
+    may change the book; they still return splits and accounts destroyed
+    in the meantime, just like the lists returned by GetSplitList().
+    """
+    _iter = None
+
+    def __init__(self, account, kind, snapshot):
+        self._iter = gnucash_core_c.gnc_account_iter_new(
+            account.get_instance(), kind, snapshot)
+        if kind == gnucash_core_c.GNC_ACCOUNT_ITER_SPLITS:
+            self._class = Split
+        else:
+            self._class = Account
+
+    def __del__(self):
+        gnucash_core_c.gnc_account_iter_free(self._iter)
+
+    def __iter__(self):
+        return self
+
+    def __next__(self):
+        instance = gnucash_core_c.gnc_account_iter_next_object(self._iter)
+        if instance is None:
+            raise StopIteration
+        return self._class(instance=instance)
+
+class SplitColumns(object):
+    """A columnar snapshot of the splits of an account and its descendants.
+
+    Each column is a memoryview with one entry per split, which NumPy and
+    pandas can use without copying, e.g. numpy.asarray(columns.value_num).
+    The columns are:
+
+    split_guid, trans_guid -- 16 bytes per split
+    account -- index into the accounts list
+    posted -- the transaction's posted date, in seconds since the epoch
+    amount_num, amount_denom, value_num, value_denom
+    reconcile -- the reconcile flag, as a single byte
+    memo, description -- index into the strings list
+
+    The snapshot doesn't change when the book does.
+    """
+    _columns = (('split_guid', 'B'), ('trans_guid', 'B'), ('account', 'I'),
+                ('posted', 'q'), ('amount_num', 'q'), ('amount_denom', 'q'),
+                ('value_num', 'q'), ('value_denom', 'q'), ('reconcile', 'c'),
+                ('memo', 'I'), ('description', 'I'))
+
+    def __init__(self, root):
+        data = gnucash_core_c.gnc_split_columns_snapshot(root.get_instance())
+        self.accounts = [Account(instance=account)
+                         for account in data['accounts']]
+        self.strings = data['strings']
+        self._length = data['length']
+        for name, fmt in self._columns:
+            column = memoryview(data[name]).cast(fmt)
+            if fmt == 'B' and self._length:
+                column = column.cast('B', [self._length, 16])
+            setattr(self, name, column)
+
+    def __len__(self):
+        return self._length
+
 class GUID(GnuCashCoreClass):
     _new_instance = 'guid_new_return'
 
@@ -682,6 +830,11 @@ from gnucash.gnucash_core_c import \
     ACCT_TYPE_LIABILITY, ACCT_TYPE_MUTUAL, ACCT_TYPE_PAYABLE, \
     ACCT_TYPE_RECEIVABLE, ACCT_TYPE_STOCK, ACCT_TYPE_ROOT, ACCT_TYPE_TRADING
 
+# import the balance kinds used by Account.GetBalancesAtDates
+from gnucash.gnucash_core_c import \
+    ACCOUNT_BALANCE_TOTAL, ACCOUNT_BALANCE_NOCLOSING, \
+    ACCOUNT_BALANCE_CLEARED, ACCOUNT_BALANCE_RECONCILED
+
 #Book
 Book.add_constructor_and_methods_with_prefix('qof_book_', 'new')
 Book.add_method('gnc_book_get_root_account', 'get_root_account')
@@ -750,6 +903,17 @@ GncCommodityNamespace.get_commodity_list = \
     method_function_returns_instance_list(
     GncCommodityNamespace.get_commodity_list, GncCommodity )
 
+# CommodityCollector
+CommodityCollector.add_methods_with_prefix('gnc_commodity_collector_',
+                                           exclude=['gnc_commodity_collector_new',
+                                                    'gnc_commodity_collector_destroy',
+                                                    'gnc_commodity_collector_add',
+                                                    'gnc_commodity_collector_merge'])
+methods_return_instance(CommodityCollector,
+                        { 'get_amount': GncNumeric,
+                          'nth_commodity': GncCommodity,
+                          'nth_amount': GncNumeric })
+
 # GncLot
 GncLot.add_constructor_and_methods_with_prefix('gnc_lot_', 'new')
 
@@ -823,7 +987,13 @@ Split.parent = property( Split.GetParent, Split.SetParent )
 
 # Account
 Account.add_methods_with_prefix('xaccAccount')
-Account.add_methods_with_prefix('gnc_account_')
+Account.add_methods_with_prefix('gnc_account_',
+                               exclude=['gnc_account_iter_new',
+                                        'gnc_account_iter_get_kind',
+                                        'gnc_account_iter_next',
+                                        'gnc_account_iter_next_object',
+                                        'gnc_account_iter_is_stale',
+                                        'gnc_account_iter_free'])
 Account.add_method('gncAccountGetGUID', 'GetGUID')
 Account.add_method('xaccAccountGetPlaceholder', 'GetPlaceholder')
 
@@ -859,6 +1029,7 @@ account_dict =  {
 methods_return_instance(Account, account_dict)
 methods_return_instance_lists(
     Account, { 'GetSplitList': Split,
+               'GetBalancesAtDates': GncNumeric,
                'get_children': Account,
                'get_children_sorted': Account,
                'get_descendants': Account,
@@ -66,5 +66,87 @@ class TestAccount(AccountSession):
         self.account.ScrubLots()
         self.assertEqual(len(self.account.GetLotList()),1)
 
+    def test_split_columns(self):
+        root = self.book.get_root_account()
+        self.account.SetName("Cash")
+        self.account.SetCommodity(self.currency)
+        root.append_child(self.account)
+        other = Account(self.book)
+        other.SetName("Food")
+        other.SetCommodity(self.currency)
+        root.append_child(other)
+
+        tx = Transaction(self.book)
+        tx.BeginEdit()
+        tx.SetCurrency(self.currency)
+        tx.SetDatePostedSecs(datetime(2020, 1, 2))
+        tx.SetDescription("Groceries")
+        s1 = Split(self.book)
+        s1.SetParent(tx)
+        s1.SetAccount(self.account)
+        s1.SetAmount(GncNumeric(-1250, 100))
+        s1.SetValue(GncNumeric(-1250, 100))
+        s1.SetMemo("Milk")
+        s2 = Split(self.book)
+        s2.SetParent(tx)
+        s2.SetAccount(other)
+        s2.SetAmount(GncNumeric(1250, 100))
+        s2.SetValue(GncNumeric(1250, 100))
+        tx.CommitEdit()
+
+        columns = root.GetSplitColumns()
+        self.assertEqual(2, len(columns))
+        self.assertEqual(["Root Account", "Cash", "Food"],
+                         [account.GetName() for account in columns.accounts])
+        self.assertEqual([1, 2], columns.account.tolist())
+        self.assertEqual([-1250, 1250], columns.amount_num.tolist())
+        self.assertEqual([100, 100], columns.value_denom.tolist())
+        self.assertEqual([b'n', b'n'], columns.reconcile.tolist())
+        self.assertEqual(columns.posted[0], columns.posted[1])
+        self.assertEqual(["Milk", ""],
+                         [columns.strings[i] for i in columns.memo.tolist()])
+        self.assertEqual(["Groceries", "Groceries"],
+                         [columns.strings[i] for i in columns.description.tolist()])
+        self.assertEqual(s1.GetGUID().to_string(),
+                         bytes(columns.split_guid[0]).hex())
+
+    def test_iterators(self):
+        root = self.book.get_root_account()
+        self.account.SetName("Cash")
+        root.append_child(self.account)
+        other = Account(self.book)
+        other.SetName("Other")
+        root.append_child(other)
+        child = Account(self.book)
+        child.SetName("Child")
+        other.append_child(child)
+        tx = Transaction(self.book)
+        tx.BeginEdit()
+        tx.SetCurrency(self.currency)
+        for amount in (100, -100):
+            split = Split(self.book)
+            split.SetParent(tx)
+            split.SetAccount(self.account)
+            split.SetValue(GncNumeric(amount))
+        tx.CommitEdit()
+
+        def names(accounts):
+            return [account.GetName() for account in accounts]
+
+        self.assertEqual(self.account.GetSplitList(),
+                         list(self.account.IterSplits()))
+        self.assertEqual(["Cash", "Other"], names(root.IterChildren()))
+        self.assertEqual(["Cash", "Other", "Child"],
+                         names(root.IterDescendants()))
+        self.assertEqual([], names(child.IterDescendants()))
+
+        live = root.IterDescendants()
+        snapshot = root.IterDescendants(snapshot=True)
+        self.assertEqual("Cash", next(live).GetName())
+        self.assertEqual("Cash", next(snapshot).GetName())
+        other.SetName("Renamed")
+        self.assertRaises(RuntimeError, next, live)
+        self.assertEqual(["Renamed", "Child"], names(snapshot))
+
 if __name__ == '__main__':
     main()
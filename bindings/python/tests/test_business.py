@@ -5,7 +5,8 @@ from datetime import datetime, timezone, timedelta
 from gnucash import Account, \
     ACCT_TYPE_RECEIVABLE, ACCT_TYPE_INCOME, ACCT_TYPE_BANK, \
     GncNumeric
-from gnucash.gnucash_business import Vendor, Employee, Customer, Job, Invoice, Entry
+from gnucash.gnucash_business import Vendor, Employee, Customer, Job, Invoice, Entry, \
+    get_owner_aging
 
 from test_book import BookSession
 
@@ -74,5 +75,24 @@ class TestBusiness(BusinessSession):
     def test_commodities(self):
         self.assertTrue( self.currency.equal( self.customer.GetCommoditiesList()[0] ) )
 
+    def test_owner_aging(self):
+        rows, invalid = get_owner_aging([self.receivable],
+                                        self.today + timedelta(days=1))
+        self.assertEqual([], invalid)
+        self.assertEqual(1, len(rows))
+        account, owner, buckets = rows[0]
+        self.assertEqual(self.receivable.GetGUID().to_string(),
+                         account.GetGUID().to_string())
+        self.assertTrue( self.customer.Equal( owner ) )
+        self.assertEqual(6, len(buckets))
+        # Due today, so in the 0-30 days bucket
+        self.assertTrue(GncNumeric(100).equal(buckets[3]))
+        for n in (0, 1, 2, 4, 5):
+            self.assertTrue(buckets[n].zero_p())
+
+        rows, invalid = get_owner_aging([self.receivable],
+                                        self.today - timedelta(days=2))
+        self.assertEqual(([], []), (rows, invalid))
+
 if __name__ == '__main__':
     main()
@@ -1460,7 +1460,10 @@ gnc_tree_model_account_event_handler (QofInstance *entity,
 
     /* clear the cached model values for account */
     if (event_type != QOF_EVENT_ADD)
+    {
+        gnc_ui_account_balance_cache_invalidate (account);
         gnc_tree_model_account_clear_cached_values (model, account);
+    }
 
     /* What to do, that to do. */
     switch (event_type)
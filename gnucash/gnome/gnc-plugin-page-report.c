@@ -45,6 +45,7 @@
 #include <libguile.h>
 #include <sys/stat.h>
 #include <errno.h>
+#include <fcntl.h>
 
 #include <gnc-glib-utils.h>
 #include "gfec.h"
@@ -1724,36 +1725,71 @@ gnc_plugin_page_report_export_cb( GtkAction *action, GncPluginPageReport *report
         SCM type = scm_cdr (choice);
         SCM document = scm_call_3 (export_thunk, priv->cur_report, type, SCM_BOOL_F);
         SCM query_result = scm_c_eval_string ("gnc:html-document?");
-        SCM get_export_string = scm_c_eval_string ("gnc:html-document-export-string");
         SCM get_export_error = scm_c_eval_string ("gnc:html-document-export-error");
+        SCM write_export = scm_c_eval_string ("gnc:html-document-write-export");
+        SCM apply_with_error_handling = scm_c_eval_string ("gnc:apply-with-error-handling");
 
         if (scm_is_false (scm_call_1 (query_result, document)))
             gnc_error_dialog (parent, _("This report must be upgraded to \
 return a document object with export-string or export-error."));
         else
         {
-            SCM export_string = scm_call_1 (get_export_string, document);
             SCM export_error = scm_call_1 (get_export_error, document);
 
-            if (scm_is_string (export_string))
-            {
-                GError *err = NULL;
-                gchar *exported = scm_to_utf8_string (export_string);
-                if (!g_file_set_contents (filepath, exported, -1, &err))
-                    gnc_error_dialog (parent, "Error during export: %s", err->message);
-                g_free (exported);
-                if (err)
-                    g_error_free (err);
-            }
-            else if (scm_is_string (export_error))
+            if (scm_is_string (export_error))
             {
                 gchar *str = scm_to_utf8_string (export_error);
                 gnc_error_dialog (parent, "error during export: %s", str);
                 g_free (str);
             }
             else
-                gnc_error_dialog (parent, _("This report must be upgraded to \
+            {
+                /* Written to a temporary file as it's produced, so large
+                 * exports aren't held in memory, and renamed once it's
+                 * complete so a failed export leaves an existing file
+                 * alone. */
+                gchar *tmp = g_strconcat (filepath, ".XXXXXX", NULL);
+                gint flags = O_WRONLY;
+                int fd;
+#ifdef G_OS_WIN32
+                flags |= O_BINARY;
+#endif
+                fd = g_mkstemp_full (tmp, flags, 0666);
+                if (fd < 0)
+                    gnc_error_dialog (parent, "Error during export: %s",
+                                      g_strerror (errno));
+                else
+                {
+                    SCM port = scm_fdes_to_port (fd, "w",
+                                                 scm_from_utf8_string (filepath));
+                    SCM written;
+                    scm_set_port_encoding_x (port, scm_from_utf8_string ("UTF-8"));
+                    written = scm_call_2 (apply_with_error_handling, write_export,
+                                          scm_list_2 (document, port));
+                    scm_close_port (port);
+
+                    if (scm_is_string (scm_cadr (written)))
+                    {
+                        gchar *str = scm_to_utf8_string (scm_cadr (written));
+                        gnc_error_dialog (parent, "error during export: %s", str);
+                        g_free (str);
+                        g_unlink (tmp);
+                    }
+                    else if (scm_is_false (scm_car (written)))
+                    {
+                        gnc_error_dialog (parent, _("This report must be upgraded to \
 return a document object with export-string or export-error."));
+                        g_unlink (tmp);
+                    }
+                    else if (g_rename (tmp, filepath))
+                    {
+                        gnc_error_dialog (parent, "Error during export: %s",
+                                          g_strerror (errno));
+                        g_unlink (tmp);
+                    }
+                }
+                g_free (tmp);
+            }
         }
         result = TRUE;
     }
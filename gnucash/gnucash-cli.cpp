@@ -66,6 +66,10 @@ namespace Gnucash {
         boost::optional <std::string> m_report_name;
         boost::optional <std::string> m_export_type;
         boost::optional <std::string> m_output_file;
+        boost::optional <std::string> m_socket;
+        boost::optional <std::string> m_cache_dir;
+        bool m_watch = false;
+        unsigned m_jobs = 0;
     };
 
 }
@@ -108,13 +112,25 @@ Gnucash::GnucashCli::configure_program_options (void)
      "  list: \tLists available reports.\n"
      "  show: \tDescribe the options modified in the named report. A datafile \
 may be specified to describe some saved options.\n"
-     "  run: \tRun the named report in the given GnuCash datafile.\n"))
+     "  run: \tRun the named report in the given GnuCash datafile.\n"
+     "  serve: \tLoad the given GnuCash datafile once and run the reports \
+requested as JSON lines on standard input or on --socket.\n"
+     "  batch: \tLoad the given GnuCash datafile once and run all the reports \
+requested as JSON lines on standard input in --jobs worker processes.\n"))
     ("name", bpo::value (&m_report_name),
      _("Name of the report to run\n"))
     ("export-type", bpo::value (&m_export_type),
      _("Specify export type\n"))
     ("output-file", bpo::value (&m_output_file),
-     _("Output file for report\n"));
+     _("Output file for report\n"))
+    ("socket", bpo::value (&m_socket),
+     _("UNIX socket on which the report server accepts requests\n"))
+    ("watch", bpo::bool_switch (&m_watch),
+     _("Reload the datafile when it changes while serving reports\n"))
+    ("cache-dir", bpo::value (&m_cache_dir),
+     _("Directory in which to keep rendered reports, which are reused while the datafile is unchanged\n"))
+    ("jobs", bpo::value (&m_jobs),
+     _("Number of worker processes running a batch of reports, by default one per processor. Reports on a database are run one at a time.\n"));
     m_opt_desc_display->add (report_options);
     m_opt_desc_all.add (report_options);
 
@@ -156,7 +172,33 @@ Gnucash::GnucashCli::start ([[maybe_unused]] int argc, [[maybe_unused]] char **a
             }
             else
                 return Gnucash::run_report(m_file_to_load, m_report_name,
-                                           m_export_type, m_output_file);
+                                           m_export_type, m_output_file,
+                                           m_cache_dir);
+        }
+
+        else if (*m_report_cmd == "serve")
+        {
+            if (!m_file_to_load || m_file_to_load->empty())
+            {
+                std::cerr << bl::translate("Missing data file parameter") << "\n\n"
+                          << *m_opt_desc_display.get();
+                return 1;
+            }
+            else
+                return Gnucash::report_serve (m_file_to_load, m_socket, m_cache_dir,
+                                              m_watch);
+        }
+
+        else if (*m_report_cmd == "batch")
+        {
+            if (!m_file_to_load || m_file_to_load->empty())
+            {
+                std::cerr << bl::translate("Missing data file parameter") << "\n\n"
+                          << *m_opt_desc_display.get();
+                return 1;
+            }
+            else
+                return Gnucash::report_batch (m_file_to_load, m_cache_dir, m_jobs);
         }
 
         // The command "list" does *not* test&pass the m_file_to_load
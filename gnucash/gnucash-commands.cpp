@@ -24,28 +24,50 @@
 
 #include <libguile.h>
 #include <guile-mappings.h>
+#include <fcntl.h>
 #ifdef __MINGW32__
 #include <Windows.h>
-#include <fcntl.h>
+#else
+#include <cerrno>
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
 #endif
 
 #include "gnucash-commands.hpp"
+#include "gnucash-report-workers.hpp"
 
 extern "C" {
+#include <glib/gstdio.h>
 #include <gnc-engine-guile.h>
+#include <gnc-filepath-utils.h>
 #include <gnc-prefs.h>
 #include <gnc-prefs-utils.h>
 #include <gnc-gnome-utils.h>
 #include <gnc-report.h>
 #include <gnc-session.h>
+#include <gnc-uri-utils.h>
 #include <qoflog.h>
 }
 
 #include <boost/locale.hpp>
+#include <boost/property_tree/json_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <algorithm>
+#include <clocale>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
+#include <functional>
 #include <iostream>
+#include <sstream>
+#include <vector>
 
 namespace bl = boost::locale;
+using Gnucash::error_response;
+using Gnucash::json_string;
 
 static std::string empty_string{};
 
@@ -145,20 +167,424 @@ struct run_report_args {
     const std::string& run_report;
     const std::string& export_type;
     const std::string& output_file;
+    const std::string& cache_dir;
 };
 
-static inline void
-write_report_file (const char *html, const char* file)
+/* Identifies the contents of a datafile by its path, size and
+ * modification time. Empty if it isn't a file. */
+static std::string
+datafile_stamp (const std::string& datafile)
+{
+    if (!gnc_uri_is_file_uri (datafile.c_str()))
+        return std::string{};
+
+    auto path = gnc_uri_get_path (datafile.c_str());
+    GStatBuf statbuf;
+    std::string stamp;
+    if (!g_stat (path, &statbuf))
+        stamp = std::string{path} + "\n" + std::to_string (statbuf.st_size) +
+            "\n" + std::to_string (statbuf.st_mtime);
+    g_free (path);
+    return stamp;
+}
+
+/* Identifies what besides the datafile a report's output depends on:
+ * the saved report and style sheet definitions, the preferences the
+ * reports read and the locale. */
+static std::string
+report_settings_stamp ()
 {
-    if (!file || !html || !*html) return;
-    std::ofstream ofs{file};
-    if (!ofs)
+    static const char* user_files[] =
+    {
+        SAVED_REPORTS_FILE, SAVED_REPORTS_FILE_OLD_REV, "stylesheets-2.0"
+    };
+    static const std::pair<const char*, const char*> prefs[] =
+    {
+        {GNC_PREFS_GROUP_GENERAL, GNC_PREF_DATE_FORMAT},
+        {GNC_PREFS_GROUP_GENERAL, GNC_PREF_ACCOUNT_SEPARATOR},
+        {GNC_PREFS_GROUP_GENERAL, GNC_PREF_ACCOUNTING_LABELS},
+        {GNC_PREFS_GROUP_GENERAL, GNC_PREF_NEGATIVE_IN_RED},
+        {GNC_PREFS_GROUP_GENERAL, "reversed-accounts-none"},
+        {GNC_PREFS_GROUP_GENERAL, "reversed-accounts-credit"},
+        {GNC_PREFS_GROUP_GENERAL, "reversed-accounts-incomeexpense"},
+        {GNC_PREFS_GROUP_GENERAL, GNC_PREF_CURRENCY_CHOICE_LOCALE},
+        {GNC_PREFS_GROUP_GENERAL, GNC_PREF_CURRENCY_CHOICE_OTHER},
+        {GNC_PREFS_GROUP_GENERAL, GNC_PREF_CURRENCY_OTHER},
+        {GNC_PREFS_GROUP_GENERAL_REPORT, GNC_PREF_CURRENCY_CHOICE_LOCALE},
+        {GNC_PREFS_GROUP_GENERAL_REPORT, GNC_PREF_CURRENCY_CHOICE_OTHER},
+        {GNC_PREFS_GROUP_GENERAL_REPORT, GNC_PREF_CURRENCY_OTHER},
+    };
+
+    std::string stamp{setlocale (LC_ALL, nullptr)};
+    for (auto file : user_files)
+    {
+        auto path = gnc_build_userdata_path (file);
+        GStatBuf statbuf;
+        stamp += "\n";
+        if (!g_stat (path, &statbuf))
+            stamp += std::to_string (statbuf.st_size) + " " +
+                std::to_string (statbuf.st_mtime);
+        g_free (path);
+    }
+    for (const auto& [group, pref] : prefs)
     {
-        std::cerr << "Failed to open file " << file << " for writing\n";
+        stamp += "\n";
+        auto value = gnc_prefs_get_value (group, pref);
+        if (!value)
+            continue;
+        auto text = g_variant_print (value, FALSE);
+        stamp += text;
+        g_free (text);
+        g_variant_unref (value);
+    }
+    return stamp;
+}
+
+/* Reports rendered by gnucash-cli are saved in the directory given with
+ * --cache-dir, so that running the same report on an unchanged datafile
+ * doesn't even load it. The least recently used ones are removed once the
+ * directory holds more than max_size bytes of them; files whose names
+ * aren't keys are left alone. */
+class ReportDiskCache
+{
+public:
+    ReportDiskCache (const std::string& dir) : m_dir{dir} {}
+    /* The key of request's output for the datafile with stamp, or an
+     * empty string if it can't be cached. Relative dates make the output
+     * depend on the day too, and it depends on the saved reports and
+     * the preferences, see report_settings_stamp. */
+    std::string key (const std::string& stamp, const std::string& request) const;
+    bool lookup (const std::string& key, std::string& output) const;
+    void store (const std::string& key, const std::string& output) const;
+    bool contains (const std::string& key) const;
+    /* Like lookup, but copies the output to out without holding all of
+     * it in memory. */
+    bool copy (const std::string& key, std::ostream& out) const;
+    /* Like store, but for output that write puts in the file whose path
+     * it's given. Returns false if write fails or the output can't be
+     * saved, write's error message is left for it to report. */
+    bool store (const std::string& key,
+                const std::function<bool(const std::string&)>& write) const;
+private:
+    std::string path (const std::string& key) const;
+    /* Marks the report as just used, for trim. */
+    void touch (const std::string& key) const;
+    void trim () const;
+
+    static constexpr goffset max_size = 64 * 1024 * 1024;
+    const std::string& m_dir;
+};
+
+std::string
+ReportDiskCache::key (const std::string& stamp, const std::string& request) const
+{
+    if (m_dir.empty() || stamp.empty())
+        return std::string{};
+
+    auto today = gnc_print_time64 (gnc_time (nullptr), "%Y-%m-%d");
+    if (!today)
+        return std::string{};
+    auto data = std::string{PROJECT_VERSION} + "\n" + today + "\n" + stamp +
+        "\n" + report_settings_stamp () + "\n" + request;
+    free (today);
+    auto checksum = g_compute_checksum_for_string (G_CHECKSUM_SHA256,
+                                                   data.c_str(), data.size());
+    std::string key{checksum};
+    g_free (checksum);
+    return key;
+}
+
+std::string
+ReportDiskCache::path (const std::string& key) const
+{
+    auto path = g_build_filename (m_dir.c_str(), key.c_str(), nullptr);
+    std::string result{path};
+    g_free (path);
+    return result;
+}
+
+/* Whether name is a key, the hex digits of a SHA-256 checksum. */
+static bool
+is_cache_key (const char *name)
+{
+    auto length = strlen (name);
+    return length == 2 * g_checksum_type_get_length (G_CHECKSUM_SHA256) &&
+        std::all_of (name, name + length,
+                     [](char c) { return g_ascii_isxdigit (c); });
+}
+
+void
+ReportDiskCache::touch (const std::string& key) const
+{
+    if (g_utime (path (key).c_str(), nullptr))
+        PWARN ("Can't update the time of the cached report %s",
+               path (key).c_str());
+}
+
+bool
+ReportDiskCache::lookup (const std::string& key, std::string& output) const
+{
+    if (key.empty())
+        return false;
+
+    auto path = g_build_filename (m_dir.c_str(), key.c_str(), nullptr);
+    gchar *contents;
+    gsize length;
+    auto found = g_file_get_contents (path, &contents, &length, nullptr);
+    if (found)
+    {
+        output.assign (contents, length);
+        g_free (contents);
+        PINFO ("Using the cached report in %s", path);
+        touch (key);
+    }
+    g_free (path);
+    return found;
+}
+
+bool
+ReportDiskCache::contains (const std::string& key) const
+{
+    return !key.empty() &&
+        g_file_test (path (key).c_str(), G_FILE_TEST_IS_REGULAR);
+}
+
+bool
+ReportDiskCache::copy (const std::string& key, std::ostream& out) const
+{
+    if (key.empty())
+        return false;
+
+    std::ifstream ifs{path (key), std::ios::binary};
+    if (!ifs)
+        return false;
+    PINFO ("Using the cached report in %s", path (key).c_str());
+    touch (key);
+    /* An empty report would leave out's failbit set */
+    if (ifs.peek() != std::ifstream::traits_type::eof())
+        out << ifs.rdbuf();
+    return static_cast<bool>(out);
+}
+
+void
+ReportDiskCache::store (const std::string& key, const std::string& output) const
+{
+    if (key.empty())
+        return;
+
+    if (g_mkdir_with_parents (m_dir.c_str(), 0700))
+    {
+        PWARN ("Can't create the report cache %s", m_dir.c_str());
         return;
     }
-    ofs << html << std::endl;
-    // ofs destructor will close the file
+
+    /* g_file_set_contents writes a temporary file and renames it, so
+     * concurrent readers never see a partial report. */
+    auto path = g_build_filename (m_dir.c_str(), key.c_str(), nullptr);
+    if (!g_file_set_contents (path, output.c_str(), output.size(), nullptr))
+        PWARN ("Can't write the cached report %s", path);
+    g_free (path);
+    trim ();
+}
+
+bool
+ReportDiskCache::store (const std::string& key,
+                        const std::function<bool(const std::string&)>& write) const
+{
+    if (key.empty() || g_mkdir_with_parents (m_dir.c_str(), 0700))
+        return false;
+
+    /* Written next to its final name and renamed, for the same reason as
+     * above. */
+    auto tmp = path (key) + ".XXXXXX";
+    auto fd = g_mkstemp (&tmp[0]);
+    if (fd < 0)
+        return false;
+    g_close (fd, nullptr);
+
+    auto stored = write (tmp) && !g_rename (tmp.c_str(), path (key).c_str());
+    if (stored)
+        trim ();
+    else
+        g_unlink (tmp.c_str());
+    return stored;
+}
+
+void
+ReportDiskCache::trim () const
+{
+    auto dir = g_dir_open (m_dir.c_str(), 0, nullptr);
+    if (!dir)
+        return;
+
+    struct CachedReport
+    {
+        std::string path;
+        goffset size;
+        time64 mtime;
+    };
+    std::vector<CachedReport> reports;
+    goffset total = 0;
+    while (auto name = g_dir_read_name (dir))
+    {
+        if (!is_cache_key (name))
+            continue;
+        auto path = g_build_filename (m_dir.c_str(), name, nullptr);
+        GStatBuf statbuf;
+        if (!g_stat (path, &statbuf) && S_ISREG (statbuf.st_mode))
+        {
+            reports.push_back ({path, statbuf.st_size, statbuf.st_mtime});
+            total += statbuf.st_size;
+        }
+        g_free (path);
+    }
+    g_dir_close (dir);
+
+    if (total <= max_size)
+        return;
+
+    /* Oldest first: lookup and copy bring a report's time up to date */
+    std::sort (reports.begin(), reports.end(),
+               [](const CachedReport& a, const CachedReport& b)
+               { return a.mtime < b.mtime; });
+    for (const auto& report : reports)
+    {
+        if (total <= max_size)
+            break;
+        g_unlink (report.path.c_str());
+        total -= report.size;
+    }
+}
+
+/* Runs the report with gnc:cmdline-run-report, which writes its output to
+ * the file at path as it's produced. The output is followed by a newline if
+ * newline is set. Returns the error message, empty if the report was
+ * written. */
+static std::string
+stream_report (SCM run_report, SCM report, SCM type, SCM settings,
+               const std::string& path, bool newline)
+{
+    auto flags = O_WRONLY | O_CREAT | O_TRUNC;
+#ifdef G_OS_WIN32
+    flags |= O_BINARY;
+#endif
+    auto fd = g_open (path.c_str(), flags, 0666);
+    if (fd < 0)
+        return "Failed to open file " + path + " for writing";
+    auto port = scm_fdes_to_port (fd, const_cast<char*>("w"),
+                                  scm_from_utf8_string (path.c_str()));
+    scm_set_port_encoding_x (port, scm_from_utf8_string ("UTF-8"));
+
+    auto result = scm_call_4 (run_report, report, type, settings, port);
+    auto written = scm_is_true (scm_car (result));
+    if (written && newline)
+        scm_newline (port);
+    scm_close_port (port);
+
+    if (written)
+        return std::string{};
+    auto error = scm_cadr (result);
+    if (!scm_is_string (error))
+        return "Report produced no output";
+    auto message = gnc_scm_to_utf8_string (error);
+    std::string err{message};
+    g_free (message);
+    return err;
+}
+
+/* Calls write with the name of a temporary file and, if it succeeds,
+ * renames that to path, or copies it to stdout if path is empty. An
+ * existing file at path is left alone and nothing is written to stdout if
+ * write fails, the temporary file is removed either way. */
+static bool
+write_through_temp (const std::string& path,
+                    const std::function<bool(const std::string&)>& write)
+{
+    if (path.empty())
+    {
+        gchar *name = nullptr;
+        auto fd = g_file_open_tmp ("gnucash-report-XXXXXX", &name, nullptr);
+        if (fd < 0)
+            return false;
+        g_close (fd, nullptr);
+        std::string tmp{name};
+        g_free (name);
+
+        auto written = write (tmp);
+        if (written)
+        {
+            std::ifstream ifs{tmp, std::ios::binary};
+            written = static_cast<bool>(ifs);
+            /* An empty report would leave cout's failbit set */
+            if (written && ifs.peek() != std::ifstream::traits_type::eof())
+                written = static_cast<bool>(std::cout << ifs.rdbuf());
+            std::cout.flush();
+        }
+        g_unlink (tmp.c_str());
+        return written;
+    }
+
+    /* Next to path so that the rename doesn't cross file systems, and with
+     * the mode a new file at path would have had. */
+    auto tmp = path + ".XXXXXX";
+    auto fd = g_mkstemp_full (&tmp[0], O_WRONLY, 0666);
+    if (fd < 0)
+        return false;
+    g_close (fd, nullptr);
+
+    if (write (tmp) && !g_rename (tmp.c_str(), path.c_str()))
+        return true;
+    g_unlink (tmp.c_str());
+    return false;
+}
+
+/* Copies the cached report for key, followed by a newline, to the file
+ * at path or to stdout if path is empty. */
+static bool
+copy_cached_report (const ReportDiskCache& cache, const std::string& key,
+                    const std::string& path)
+{
+    if (!cache.contains (key))
+        return false;
+    if (path.empty())
+        return cache.copy (key, std::cout) && std::cout << std::endl;
+
+    return write_through_temp (path, [&](const std::string& tmp)
+    {
+        std::ofstream ofs{tmp, std::ios::binary};
+        return ofs && cache.copy (key, ofs) && ofs << std::endl;
+    });
+}
+
+/* Writes the report, followed by a newline, to the file at path or to
+ * stdout if path is empty, keeping the output in the cache under key as
+ * well. Cache entries don't have the newline. */
+static std::string
+write_report (SCM run_report, SCM report, SCM type, SCM settings,
+              const ReportDiskCache& cache, const std::string& key,
+              const std::string& path)
+{
+    std::string error;
+    auto stored = cache.store (key, [&](const std::string& tmp)
+    {
+        error = stream_report (run_report, report, type, settings, tmp, false);
+        return error.empty();
+    });
+    if (!error.empty())
+        return error;
+    /* Without a usable cache the report is still rendered to a temporary
+     * file first, so a failed run doesn't leave a truncated file at path. */
+    auto written = stored ? copy_cached_report (cache, key, path) :
+        write_through_temp (path, [&](const std::string& tmp)
+        {
+            error = stream_report (run_report, report, type, settings, tmp, true);
+            return error.empty();
+        });
+    if (!error.empty())
+        return error;
+    if (!written)
+        return "Failed to write " + (path.empty() ? "the report" : path);
+    return std::string{};
 }
 
 static void
@@ -180,8 +606,6 @@ scm_run_report (void *data,
 
     auto datafile = args->file_to_load.c_str();
     auto check_report_cmd = scm_c_eval_string ("gnc:cmdline-check-report");
-    auto get_report_cmd = scm_c_eval_string ("gnc:cmdline-get-report-id");
-    auto run_export_cmd = scm_c_eval_string ("gnc:cmdline-template-export");
     /* We generally insist on using scm_from_utf8_string() throughout GnuCash
      * because all GUI-sourced strings and all file-sourced strings are encoded
      * that way. In this case, though, the input is coming from a shell window
@@ -196,6 +620,16 @@ scm_run_report (void *data,
     if (scm_is_false (scm_call_2 (check_report_cmd, report, type)))
         scm_cleanup_and_exit_with_failure (nullptr);
 
+    ReportDiskCache cache{args->cache_dir};
+    auto cache_key = cache.key (datafile_stamp (args->file_to_load),
+                                args->run_report + "\n" + args->export_type);
+    if (copy_cached_report (cache, cache_key, args->output_file))
+    {
+        qof_event_resume ();
+        gnc_shutdown (0);
+        return;
+    }
+
     PINFO ("Loading datafile %s...\n", datafile);
 
     auto session = gnc_get_current_session ();
@@ -210,79 +644,407 @@ scm_run_report (void *data,
     if (qof_session_get_error (session) != ERR_BACKEND_NO_ERR)
         scm_cleanup_and_exit_with_failure (session);
 
-    char *output;
+    auto run_report = scm_c_eval_string ("gnc:cmdline-run-report");
+    auto error = write_report (run_report, report, type, SCM_EOL,
+                               cache, cache_key, args->output_file);
+    if (!error.empty())
+    {
+        std::cerr << error << std::endl;
+        if (!args->export_type.empty())
+            scm_cleanup_and_exit_with_failure (nullptr);
+    }
+
+    qof_session_destroy (session);
+
+    qof_event_resume ();
+    gnc_shutdown (0);
+    return;
+}
 
-    if (!args->export_type.empty())
+
+/* The report server keeps the datafile loaded and renders one report for
+ * each request it reads. A request is a line holding a JSON object:
+ *
+ *   {"report": "<name or guid>", "export-type": "<type>",
+ *    "output-file": "<path>",
+ *    "options": {"<section>": {"<name>": "<value as scheme datum>"}}}
+ *
+ * Only "report" is required. Each request is answered by a line holding
+ * {"status": "ok"} plus "output" or "output-file", or
+ * {"status": "error", "message": "..."}. {"command": "quit"} stops the
+ * server.
+ */
+struct serve_report_args {
+    const std::string& file_to_load;
+    const std::string& socket_path;
+    const std::string& cache_dir;
+    bool watch;
+};
+
+struct batch_report_args {
+    const std::string& file_to_load;
+    const std::string& cache_dir;
+    unsigned jobs;
+};
+
+class ReportServer
+{
+public:
+    ReportServer (const std::string& datafile, const std::string& cache_dir,
+                  bool watch);
+    ~ReportServer ();
+    bool load ();
+    /* Returns the response line, or an empty string to stop serving. */
+    std::string handle_request (const std::string& request);
+private:
+    bool reload_if_changed ();
+    gint64 datafile_mtime () const;
+
+    const std::string& m_datafile;
+    /* Set if the datafile is watched for changes */
+    std::string m_path;
+    gint64 m_mtime = 0;
+    /* The datafile_stamp() of the loaded datafile */
+    std::string m_stamp;
+    ReportDiskCache m_cache;
+    QofSession *m_session = nullptr;
+    SCM m_run_report;
+};
+
+ReportServer::ReportServer (const std::string& datafile,
+                            const std::string& cache_dir, bool watch) :
+    m_datafile{datafile},
+    m_cache{cache_dir},
+    m_run_report{scm_c_eval_string ("gnc:cmdline-run-report")}
+{
+    if (!watch)
+        return;
+    if (gnc_uri_is_file_uri (datafile.c_str()))
     {
-        SCM retval = scm_call_2 (run_export_cmd, report, type);
-        SCM query_result = scm_c_eval_string ("gnc:html-document?");
-        SCM get_export_string = scm_c_eval_string ("gnc:html-document-export-string");
-        SCM get_export_error = scm_c_eval_string ("gnc:html-document-export-error");
+        auto path = gnc_uri_get_path (datafile.c_str());
+        m_path = path;
+        g_free (path);
+    }
+    else
+        PWARN ("Only files can be watched for changes, %s won't be reloaded.",
+               datafile.c_str());
+}
 
-        if (scm_is_false (scm_call_1 (query_result, retval)))
-        {
-            std::cerr << _("This report must be upgraded to \
-return a document object with export-string or export-error.") << std::endl;
-            scm_cleanup_and_exit_with_failure (nullptr);
-        }
+ReportServer::~ReportServer ()
+{
+    if (m_session)
+        gnc_clear_current_session ();
+}
+
+gint64
+ReportServer::datafile_mtime () const
+{
+    GStatBuf statbuf;
+    if (m_path.empty() || g_stat (m_path.c_str(), &statbuf))
+        return 0;
+    return statbuf.st_mtime;
+}
 
-        SCM export_string = scm_call_1 (get_export_string, retval);
-        SCM export_error = scm_call_1 (get_export_error, retval);
+bool
+ReportServer::load ()
+{
+    PINFO ("Loading datafile %s...\n", m_datafile.c_str());
 
-        if (scm_is_string (export_string))
-        {
-            output = scm_to_utf8_string (export_string);
-            if (!args->output_file.empty())
-            {
-                write_report_file(output, args->output_file.c_str());
-            }
-            else
+    m_mtime = datafile_mtime ();
+    m_stamp = datafile_stamp (m_datafile);
+    m_session = gnc_get_current_session ();
+    if (!m_session)
+        return false;
+
+    qof_session_begin (m_session, m_datafile.c_str(), SESSION_READ_ONLY);
+    if (qof_session_get_error (m_session) == ERR_BACKEND_NO_ERR)
+        qof_session_load (m_session, report_session_percentage);
+    if (qof_session_get_error (m_session) == ERR_BACKEND_NO_ERR)
+        return true;
+
+    PERR ("Session Error: %s\n", qof_session_get_error_message (m_session));
+    gnc_clear_current_session ();
+    m_session = nullptr;
+    return false;
+}
+
+/* The backends can only load a whole book, so a changed file is
+ * reloaded before the next request rather than while it's being
+ * written. */
+bool
+ReportServer::reload_if_changed ()
+{
+    if (m_session && (m_path.empty() || datafile_mtime () == m_mtime))
+        return true;
+
+    if (m_session)
+    {
+        gnc_clear_current_session ();
+        m_session = nullptr;
+    }
+    return load ();
+}
+
+std::string
+ReportServer::handle_request (const std::string& request)
+{
+    namespace pt = boost::property_tree;
+    pt::ptree tree;
+
+    try
+    {
+        std::istringstream stream{request};
+        pt::read_json (stream, tree);
+    }
+    catch (const pt::json_parser_error& err)
+    {
+        return error_response (err.what());
+    }
+
+    if (tree.get<std::string>("command", "") == "quit")
+        return std::string{};
+
+    auto report = tree.get<std::string>("report", "");
+    if (report.empty())
+        return error_response ("Missing report");
+
+    if (!reload_if_changed ())
+        return error_response ("Failed to load " + m_datafile);
+
+    auto export_type = tree.get<std::string>("export-type", "");
+    auto cache_request = report + "\n" + export_type;
+    auto settings = SCM_EOL;
+    if (auto options = tree.get_child_optional ("options"))
+        for (const auto& section : *options)
+            for (const auto& option : section.second)
             {
-                std::cout << output << std::endl;
+                settings = scm_cons (scm_cons2 (scm_from_utf8_string (section.first.c_str()),
+                                                scm_from_utf8_string (option.first.c_str()),
+                                                scm_from_utf8_string (option.second.data().c_str())),
+                                     settings);
+                cache_request += "\n" + section.first + "\t" + option.first +
+                    "\t" + option.second.data();
             }
+
+    auto cache_key = m_cache.key (m_stamp, cache_request);
+    auto output_file = tree.get<std::string>("output-file", "");
+    if (!output_file.empty())
+    {
+        /* Large reports are written out as they're rendered rather than
+         * built up in memory first. */
+        if (!copy_cached_report (m_cache, cache_key, output_file))
+        {
+            auto error = write_report (m_run_report,
+                                       scm_from_utf8_string (report.c_str()),
+                                       export_type.empty() ? SCM_BOOL_F :
+                                       scm_from_utf8_string (export_type.c_str()),
+                                       scm_reverse (settings), m_cache,
+                                       cache_key, output_file);
+            if (!error.empty())
+                return error_response (error);
         }
-        else if (scm_is_string (export_error))
+        return "{\"status\": \"ok\", \"output-file\": " +
+            json_string (output_file) + "}";
+    }
+
+    std::string text;
+    if (!m_cache.lookup (cache_key, text))
+    {
+        auto result = scm_call_3 (m_run_report, scm_from_utf8_string (report.c_str()),
+                                  export_type.empty() ? SCM_BOOL_F :
+                                  scm_from_utf8_string (export_type.c_str()),
+                                  scm_reverse (settings));
+        auto output = scm_car (result);
+        auto error = scm_cadr (result);
+
+        if (!scm_is_string (output))
         {
-            auto err = scm_to_utf8_string (export_error);
-            std::cerr << err << std::endl;
-            scm_cleanup_and_exit_with_failure (nullptr);
+            if (!scm_is_string (error))
+                return error_response ("Report produced no output");
+            auto message = gnc_scm_to_utf8_string (error);
+            auto response = error_response (message);
+            g_free (message);
+            return response;
         }
-        else
+
+        auto output_str = gnc_scm_to_utf8_string (output);
+        text = output_str;
+        g_free (output_str);
+        m_cache.store (cache_key, text);
+    }
+
+    return "{\"status\": \"ok\", \"output\": " + json_string (text) + "}";
+}
+
+#ifndef __MINGW32__
+/* Serves the requests of each connection in turn until one asks to
+ * quit. */
+static bool
+serve_report_socket (const std::string& socket_path, ReportServer& server)
+{
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof addr.sun_path)
+    {
+        std::cerr << "Socket path " << socket_path << " is too long\n";
+        return false;
+    }
+    socket_path.copy (addr.sun_path, socket_path.size());
+
+    /* Replace the socket a previous server left behind, but nothing else */
+    struct stat statbuf;
+    if (!lstat (socket_path.c_str(), &statbuf))
+    {
+        if (!S_ISSOCK (statbuf.st_mode))
         {
-            std::cerr << _("This report must be upgraded to \
-return a document object with export-string or export-error.") << std::endl;
-            scm_cleanup_and_exit_with_failure (nullptr);
+            std::cerr << socket_path << " exists and isn't a socket\n";
+            return false;
         }
+        unlink (socket_path.c_str());
     }
-    else
+    else if (errno != ENOENT)
     {
-        SCM id = scm_call_1(get_report_cmd, report);
+        std::cerr << "Can't use " << socket_path << ": "
+                  << g_strerror (errno) << "\n";
+        return false;
+    }
 
-        if (scm_is_false (id))
-            scm_cleanup_and_exit_with_failure (nullptr);
-        char *html, *errmsg;
+    auto sock = socket (AF_UNIX, SOCK_STREAM, 0);
+    /* Whoever can connect can have reports written to any file the user
+     * can write, so create the socket for the user alone. */
+    auto old_mask = umask (S_IRWXG | S_IRWXO);
+    auto bound = sock >= 0 &&
+        !bind (sock, reinterpret_cast<sockaddr*>(&addr), sizeof addr);
+    umask (old_mask);
+    if (!bound ||
+        chmod (socket_path.c_str(), S_IRUSR | S_IWUSR) ||
+        listen (sock, SOMAXCONN))
+    {
+        std::cerr << "Failed to listen on " << socket_path << ": "
+                  << g_strerror (errno) << "\n";
+        if (sock >= 0)
+            close (sock);
+        return false;
+    }
+    /* A client going away mid-response mustn't stop the server */
+    signal (SIGPIPE, SIG_IGN);
+
+    auto handler = [&server](const std::string& request)
+        { return server.handle_request (request); };
+    auto serving = true;
+    while (serving)
+    {
+        auto conn = accept (sock, nullptr, nullptr);
+        if (conn < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        serving = Gnucash::serve_report_fd (conn, conn, handler);
+        close (conn);
+    }
+
+    close (sock);
+    unlink (socket_path.c_str());
+    return true;
+}
+#endif
+
+static void
+scm_report_serve (void *data,
+                  [[maybe_unused]] int argc, [[maybe_unused]] char **argv)
+{
+    auto args = static_cast<serve_report_args*>(data);
+
+    scm_c_eval_string("(debug-set! stack 200000)");
+    scm_c_use_module ("gnucash utilities");
+    scm_c_use_module ("gnucash app-utils");
+    scm_c_use_module ("gnucash reports");
 
-        if (gnc_run_report_with_error_handling (scm_to_int(id), &html, &errmsg))
+    gnc_report_init ();
+    gnc_prefs_init ();
+    qof_event_suspend ();
+
+    auto ok = false;
+    {
+        ReportServer server{args->file_to_load, args->cache_dir, args->watch};
+        if (server.load ())
         {
-            if (!args->output_file.empty())
+            if (!args->socket_path.empty())
             {
-                write_report_file(html, args->output_file.c_str());
+#ifndef __MINGW32__
+                ok = serve_report_socket (args->socket_path, server);
+#else
+                std::cerr << "Serving reports on a socket isn't supported on this platform\n";
+#endif
             }
             else
             {
-                std::cout << html << std::endl;
+                std::string request;
+                while (std::getline (std::cin, request))
+                {
+                    if (request.empty())
+                        continue;
+                    auto response = server.handle_request (request);
+                    if (response.empty())
+                        break;
+                    std::cout << response << std::endl;
+                }
+                ok = true;
             }
         }
-        else
+    }
+
+    qof_event_resume ();
+    gnc_shutdown (ok ? 0 : 1);
+    return;
+}
+
+/* Runs the requests read from standard input, writing their responses
+ * in the same order once all are done. */
+static void
+scm_report_batch (void *data,
+                  [[maybe_unused]] int argc, [[maybe_unused]] char **argv)
+{
+    auto args = static_cast<batch_report_args*>(data);
+
+    scm_c_eval_string("(debug-set! stack 200000)");
+    scm_c_use_module ("gnucash utilities");
+    scm_c_use_module ("gnucash app-utils");
+    scm_c_use_module ("gnucash reports");
+
+    gnc_report_init ();
+    gnc_prefs_init ();
+    qof_event_suspend ();
+
+    std::vector<std::string> requests;
+    std::string request;
+    while (std::getline (std::cin, request))
+        if (!request.empty())
+            requests.push_back (request);
+
+    auto ok = false;
+    {
+        ReportServer server{args->file_to_load, args->cache_dir, false};
+        if (server.load ())
         {
-            std::cerr << errmsg << std::endl;
+            /* Guile's fork stops its own helper threads around the fork */
+            auto fork_proc = scm_c_eval_string ("primitive-fork");
+            auto responses = Gnucash::run_report_batch (
+                requests, args->file_to_load, args->jobs,
+                [&server](const std::string& request)
+                { return server.handle_request (request); },
+                [fork_proc]() { return scm_to_int (scm_call_0 (fork_proc)); });
+            for (const auto& response : responses)
+                std::cout << response << "\n";
+            std::cout.flush();
+            ok = true;
         }
     }
 
-    qof_session_destroy (session);
-
     qof_event_resume ();
-    gnc_shutdown (0);
+    gnc_shutdown (ok ? 0 : 1);
     return;
 }
 
@@ -354,12 +1116,14 @@ int
 Gnucash::run_report (const bo_str& file_to_load,
                      const bo_str& run_report,
                      const bo_str& export_type,
-                     const bo_str& output_file)
+                     const bo_str& output_file,
+                     const bo_str& cache_dir)
 {
     auto args = run_report_args { file_to_load ? *file_to_load : empty_string,
                                   run_report ? *run_report : empty_string,
                                   export_type ? *export_type : empty_string,
-                                  output_file ? *output_file : empty_string };
+                                  output_file ? *output_file : empty_string,
+                                  cache_dir ? *cache_dir : empty_string };
     if (run_report && !run_report->empty())
         scm_boot_guile (0, nullptr, scm_run_report, &args);
 
@@ -384,3 +1148,28 @@ Gnucash::report_list (void)
     scm_boot_guile (0, nullptr, scm_report_list, NULL);
     return 0;
 }
+
+int
+Gnucash::report_serve (const bo_str& file_to_load,
+                       const bo_str& socket_path,
+                       const bo_str& cache_dir,
+                       bool watch)
+{
+    auto args = serve_report_args { file_to_load ? *file_to_load : empty_string,
+                                    socket_path ? *socket_path : empty_string,
+                                    cache_dir ? *cache_dir : empty_string,
+                                    watch };
+    scm_boot_guile (0, nullptr, scm_report_serve, &args);
+    return 0;
+}
+
+int
+Gnucash::report_batch (const bo_str& file_to_load,
+                       const bo_str& cache_dir, unsigned jobs)
+{
+    auto args = batch_report_args { file_to_load ? *file_to_load : empty_string,
+                                    cache_dir ? *cache_dir : empty_string,
+                                    jobs ? jobs : g_get_num_processors () };
+    scm_boot_guile (0, nullptr, scm_report_batch, &args);
+    return 0;
+}
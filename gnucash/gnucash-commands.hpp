@@ -36,9 +36,16 @@ namespace Gnucash {
     int run_report (const bo_str& file_to_load,
                     const bo_str& run_report,
                     const bo_str& export_type,
-                    const bo_str& output_file);
+                    const bo_str& output_file,
+                    const bo_str& cache_dir);
     int report_list (void);
     int report_show (const bo_str& file_to_load,
                      const bo_str& run_report);
+    int report_serve (const bo_str& file_to_load,
+                      const bo_str& socket_path,
+                      const bo_str& cache_dir,
+                      bool watch);
+    int report_batch (const bo_str& file_to_load,
+                      const bo_str& cache_dir, unsigned jobs);
 }
 #endif
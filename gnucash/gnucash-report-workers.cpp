@@ -0,0 +1,349 @@
+/*
+ * gnucash-report-workers.cpp -- Answering report requests, one at a time
+ *                               or in forked worker processes
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, contact:
+ *
+ * Free Software Foundation           Voice:  +1-617-542-5942
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org
+ */
+#include <config.h>
+
+#include <fcntl.h>
+#ifndef __MINGW32__
+#include <cerrno>
+#include <csignal>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "gnucash-report-workers.hpp"
+
+extern "C" {
+#include <glib/gstdio.h>
+#include <gnc-uri-utils.h>
+#include <qoflog.h>
+}
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+/* This static indicates the debugging module that this .o belongs to.  */
+static QofLogModule log_module = GNC_MOD_GUI;
+
+std::string
+Gnucash::json_string (const std::string& str)
+{
+    std::string result{"\""};
+    for (auto c : str)
+    {
+        switch (c)
+        {
+        case '"': result += "\\\""; break;
+        case '\\': result += "\\\\"; break;
+        case '\n': result += "\\n"; break;
+        case '\r': result += "\\r"; break;
+        case '\t': result += "\\t"; break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20)
+            {
+                char escape[7];
+                snprintf (escape, sizeof escape, "\\u%04x", c);
+                result += escape;
+            }
+            else
+                result += c;
+        }
+    }
+    return result + "\"";
+}
+
+std::string
+Gnucash::error_response (const std::string& message)
+{
+    return "{\"status\": \"error\", \"message\": " + json_string (message) + "}";
+}
+
+#ifndef __MINGW32__
+/* Whether the datafile is a database, which the session keeps a
+ * connection to, rather than an XML file. file: and xml: URIs may name
+ * an SQLite file too, so those are told apart by the file's header. */
+bool
+Gnucash::datafile_is_database (const std::string& datafile)
+{
+    auto scheme = gnc_uri_get_scheme (datafile.c_str());
+    auto file = !scheme || gnc_uri_is_file_scheme (scheme);
+    auto sqlite = scheme && !g_ascii_strcasecmp (scheme, "sqlite3");
+    g_free (scheme);
+    if (!file || sqlite)
+        return true;
+
+    auto path = gnc_uri_get_path (datafile.c_str());
+    static const char sqlite_header[] = "SQLite format 3";
+    char header[sizeof sqlite_header] = "";
+    auto fd = g_open (path ? path : datafile.c_str(), O_RDONLY, 0);
+    g_free (path);
+    if (fd < 0)
+        return false;
+    auto len = read (fd, header, sizeof header);
+    g_close (fd, nullptr);
+    return len == static_cast<ssize_t>(sizeof header) &&
+        !memcmp (header, sqlite_header, sizeof header);
+}
+
+bool
+Gnucash::write_all (int fd, const std::string& data)
+{
+    for (size_t done = 0; done < data.size();)
+    {
+        auto written = write (fd, data.data() + done, data.size() - done);
+        if (written < 0 && errno == EINTR)
+            continue;
+        if (written <= 0)
+            return false;
+        done += written;
+    }
+    return true;
+}
+
+/* Answers the request lines read from in_fd on out_fd until in_fd is
+ * closed. Returns false if a request asked to quit. */
+bool
+Gnucash::serve_report_fd (int in_fd, int out_fd, const ReportHandler& handler)
+{
+    std::string pending;
+    char buf[4096];
+    ssize_t len;
+
+    while ((len = read (in_fd, buf, sizeof buf)) != 0)
+    {
+        if (len < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+        pending.append (buf, len);
+        size_t eol;
+        while ((eol = pending.find ('\n')) != std::string::npos)
+        {
+            auto response = handler (pending.substr (0, eol));
+            pending.erase (0, eol + 1);
+            if (response.empty())
+                return false;
+            write_all (out_fd, response + '\n');
+        }
+    }
+    return true;
+}
+
+struct ReportWorker
+{
+    pid_t pid;
+    int requests;
+    int responses;
+    std::string pending;
+    /* The request being worked on, -1 if none */
+    ssize_t job;
+};
+
+/* Forks up to n_workers processes that share the loaded book and hands
+ * each of them the next request as soon as it answers the previous one.
+ * Whatever no worker was left to run is handled in this process.
+ * Returns the responses in the order of the requests. */
+std::vector<std::string>
+Gnucash::run_report_workers (const std::vector<std::string>& requests,
+                             unsigned n_workers, const ReportHandler& handler,
+                             const ReportFork& fork_worker)
+{
+    std::vector<std::string> responses(requests.size());
+    std::vector<ReportWorker> workers;
+
+    signal (SIGPIPE, SIG_IGN);
+    std::cout.flush();
+    std::cerr.flush();
+
+    for (unsigned i = 0; i < n_workers; i++)
+    {
+        int to_worker[2], from_worker[2];
+        if (pipe (to_worker))
+            break;
+        if (pipe (from_worker))
+        {
+            close (to_worker[0]);
+            close (to_worker[1]);
+            break;
+        }
+
+        auto pid = fork_worker ();
+        if (pid == 0)
+        {
+            close (to_worker[1]);
+            close (from_worker[0]);
+            for (const auto& worker : workers)
+            {
+                close (worker.requests);
+                close (worker.responses);
+            }
+            serve_report_fd (to_worker[0], from_worker[1], handler);
+            _exit (0);
+        }
+
+        if (pid < 0)
+        {
+            PWARN ("Failed to fork a report worker: %s", g_strerror (errno));
+            for (auto fd : {to_worker[0], to_worker[1], from_worker[0], from_worker[1]})
+                close (fd);
+            break;
+        }
+
+        close (to_worker[0]);
+        close (from_worker[1]);
+        workers.push_back ({pid, to_worker[1], from_worker[0], {}, -1});
+    }
+
+    size_t next = 0, done = 0;
+    auto dispatch = [&requests, &next](ReportWorker& worker)
+    {
+        worker.job = -1;
+        if (worker.requests < 0)
+            return;
+        if (next < requests.size() &&
+            write_all (worker.requests, requests[next] + '\n'))
+        {
+            worker.job = next++;
+            return;
+        }
+        close (worker.requests);
+        worker.requests = -1;
+    };
+
+    for (auto& worker : workers)
+        dispatch (worker);
+
+    while (done < requests.size())
+    {
+        std::vector<pollfd> fds;
+        std::vector<ReportWorker*> polled;
+        for (auto& worker : workers)
+            if (worker.responses >= 0)
+            {
+                fds.push_back ({worker.responses, POLLIN, 0});
+                polled.push_back (&worker);
+            }
+        if (fds.empty())
+            break;
+        if (poll (fds.data(), fds.size(), -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break;
+        }
+
+        for (size_t i = 0; i < fds.size(); i++)
+        {
+            if (!fds[i].revents)
+                continue;
+            auto& worker = *polled[i];
+            char buf[4096];
+            auto len = read (worker.responses, buf, sizeof buf);
+            if (len < 0 && errno == EINTR)
+                continue;
+            if (len <= 0)
+            {
+                if (worker.job >= 0)
+                {
+                    responses[worker.job] = error_response ("Report worker exited");
+                    done++;
+                }
+                close (worker.responses);
+                worker.responses = -1;
+                if (worker.requests >= 0)
+                    close (worker.requests);
+                worker.requests = -1;
+                continue;
+            }
+
+            worker.pending.append (buf, len);
+            size_t eol;
+            while (worker.job >= 0 &&
+                   (eol = worker.pending.find ('\n')) != std::string::npos)
+            {
+                responses[worker.job] = worker.pending.substr (0, eol);
+                worker.pending.erase (0, eol + 1);
+                done++;
+                dispatch (worker);
+            }
+        }
+    }
+
+    for (auto& worker : workers)
+    {
+        if (worker.requests >= 0)
+            close (worker.requests);
+        if (worker.responses >= 0)
+            close (worker.responses);
+        waitpid (worker.pid, nullptr, 0);
+    }
+
+    /* Whatever no worker was left to run is run here */
+    for (size_t i = 0; i < requests.size(); i++)
+        if (responses[i].empty())
+        {
+            responses[i] = handler (requests[i]);
+            if (responses[i].empty())
+                responses[i] = error_response ("Can't quit a batch of reports");
+        }
+    return responses;
+}
+#endif
+
+/* Answers the requests in jobs worker processes, or one after the other
+ * in this process if there's no more than one job or the datafile is a
+ * database. Returns the responses in the order of the requests. */
+std::vector<std::string>
+Gnucash::run_report_batch (const std::vector<std::string>& requests,
+                           [[maybe_unused]] const std::string& datafile,
+                           [[maybe_unused]] unsigned jobs,
+                           const ReportHandler& handler,
+                           [[maybe_unused]] const ReportFork& fork_worker)
+{
+#ifndef __MINGW32__
+    auto n_workers = std::min<size_t> (jobs, requests.size());
+    /* Workers forked from a database session would all talk to
+     * the database over its one connection at once. */
+    if (n_workers > 1 && datafile_is_database (datafile))
+    {
+        PWARN ("%s is a database, running its reports one at a time.",
+               datafile.c_str());
+        n_workers = 1;
+    }
+    if (n_workers > 1)
+        return run_report_workers (requests, n_workers, handler, fork_worker);
+#endif
+
+    std::vector<std::string> responses;
+    for (const auto& request : requests)
+    {
+        auto response = handler (request);
+        responses.push_back (response.empty() ?
+                             error_response ("Can't quit a batch of reports") :
+                             response);
+    }
+    return responses;
+}
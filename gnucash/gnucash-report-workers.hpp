@@ -0,0 +1,57 @@
+/*
+ * gnucash-report-workers.hpp -- Answering report requests, one at a time
+ *                               or in forked worker processes
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, contact:
+ *
+ * Free Software Foundation           Voice:  +1-617-542-5942
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org
+ */
+
+#ifndef GNUCASH_REPORT_WORKERS_HPP
+#define GNUCASH_REPORT_WORKERS_HPP
+
+#include <functional>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+namespace Gnucash {
+
+    /* Answers a request line with a response line, or with an empty
+     * string if the request asked to quit. */
+    using ReportHandler = std::function<std::string (const std::string&)>;
+    /* Forks a worker process, returning as fork() does. */
+    using ReportFork = std::function<pid_t ()>;
+
+    std::string json_string (const std::string& str);
+    std::string error_response (const std::string& message);
+
+#ifndef __MINGW32__
+    bool datafile_is_database (const std::string& datafile);
+    bool write_all (int fd, const std::string& data);
+    bool serve_report_fd (int in_fd, int out_fd, const ReportHandler& handler);
+    std::vector<std::string> run_report_workers (const std::vector<std::string>& requests,
+                                                 unsigned n_workers,
+                                                 const ReportHandler& handler,
+                                                 const ReportFork& fork_worker);
+#endif
+    std::vector<std::string> run_report_batch (const std::vector<std::string>& requests,
+                                               const std::string& datafile,
+                                               unsigned jobs,
+                                               const ReportHandler& handler,
+                                               const ReportFork& fork_worker);
+}
+#endif
@@ -118,11 +118,12 @@ GncNumeric parse_amount (const std::string &str, int currency_format)
         return GncNumeric{};
 
     /* Strings otherwise containing not digits will be considered invalid */
-    if(!boost::regex_search(str, boost::regex("[0-9]")))
+    static const boost::regex digit_expr ("[0-9]");
+    if(!boost::regex_search(str, digit_expr))
         throw std::invalid_argument (_("Value doesn't appear to contain a valid number."));
 
-    auto expr = boost::make_u32regex("[[:Sc:]]");
-    std::string str_no_symbols = boost::u32regex_replace(str, expr, "");
+    static const auto symbol_expr = boost::make_u32regex("[[:Sc:]]");
+    std::string str_no_symbols = boost::u32regex_replace(str, symbol_expr, "");
 
     /* Convert based on user chosen currency format */
     gnc_numeric val = gnc_numeric_zero();
@@ -30,13 +30,17 @@ extern "C" {
 #endif
 
 #include <glib/gi18n.h>
+#include <gnc-locale-utils.h>
 }
 
 #include <algorithm>
+#include <atomic>
 #include <exception>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <utility>
 #include <vector>
@@ -193,7 +197,7 @@ void GncTxImport::base_account (Account* base_account)
                             GncTransPropType::NONE);
 
         /* Set default account for each line's split properties */
-        for (auto line : m_parsed_lines)
+        for (auto& line : m_parsed_lines)
             std::get<PL_PRESPLIT>(line)->set_account (m_settings.m_base_account);
 
 
@@ -399,7 +403,8 @@ void GncTxImport::tokenize (bool guessColTypes)
     uint32_t max_cols = 0;
     m_tokenizer->tokenize();
     m_parsed_lines.clear();
-    for (auto tokenized_line : m_tokenizer->get_tokens())
+    m_parsed_lines.reserve (m_tokenizer->get_tokens().size());
+    for (const auto& tokenized_line : m_tokenizer->get_tokens())
     {
         auto length = tokenized_line.size();
         if (length > 0)
@@ -425,7 +430,7 @@ void GncTxImport::tokenize (bool guessColTypes)
         set_column_type (i, m_settings.m_column_types[i], true);
     if (m_settings.m_base_account)
     {
-        for (auto line : m_parsed_lines)
+        for (auto& line : m_parsed_lines)
             std::get<PL_PRESPLIT>(line)->set_account (m_settings.m_base_account);
     }
 
@@ -538,7 +543,7 @@ std::string GncTxImport::verify ()
     update_skipped_lines (boost::none, boost::none, boost::none, boost::none);
 
     auto have_line_errors = false;
-    for (auto line : m_parsed_lines)
+    for (const auto& line : m_parsed_lines)
     {
         if (!std::get<PL_SKIP>(line) && !std::get<PL_ERROR>(line).empty())
         {
@@ -839,6 +844,81 @@ void GncTxImport::update_pre_split_props (uint32_t row, uint32_t col, GncTransPr
 }
 
 
+/* Lines are handed to worker threads in chunks of this many. */
+static constexpr uint32_t parse_chunk_lines = 1024;
+
+/* Whether the lines can be updated independently of each other for a
+ * column type change. In multi-split mode a transaction property decides
+ * which lines belong together, which can only be found line by line.
+ * Accounts and commodities are looked up in the engine and prices go
+ * through the expression parser, neither of which may be used from
+ * several threads at once.
+ */
+static bool
+can_update_in_parallel (GncTransPropType old_type, GncTransPropType type, bool multi_split)
+{
+    auto is_trans_prop = [](GncTransPropType prop)
+        { return (prop > GncTransPropType::NONE) && (prop <= GncTransPropType::TRANS_PROPS); };
+    if (multi_split && (is_trans_prop (old_type) || is_trans_prop (type)))
+        return false;
+    return (type != GncTransPropType::ACCOUNT) &&
+           (type != GncTransPropType::TACCOUNT) &&
+           (type != GncTransPropType::COMMODITY) &&
+           (type != GncTransPropType::PRICE);
+}
+
+/* Calls func for each line number below num_lines, spreading chunks of
+ * lines over parse_threads threads, or as many as there are processors if
+ * that is 0. func may only change the line it's given. The first exception
+ * thrown by func is passed on once all threads have finished.
+ */
+template <typename Func> static void
+for_each_line_in_parallel (uint32_t num_lines, uint32_t parse_threads, Func func)
+{
+    uint32_t num_chunks = (num_lines + parse_chunk_lines - 1) / parse_chunk_lines;
+    if (parse_threads == 0)
+        parse_threads = std::max (std::thread::hardware_concurrency(), 1u);
+    auto num_threads = std::min (parse_threads, num_chunks);
+    if (num_threads < 2)
+    {
+        for (uint32_t row = 0; row < num_lines; row++)
+            func (row);
+        return;
+    }
+
+    std::atomic<uint32_t> next_chunk {0};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+    auto worker = [&]()
+    {
+        try
+        {
+            for (auto chunk = next_chunk++; chunk < num_chunks; chunk = next_chunk++)
+            {
+                auto end = std::min (num_lines, (chunk + 1) * parse_chunk_lines);
+                for (auto row = chunk * parse_chunk_lines; row < end; row++)
+                    func (row);
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock (error_mutex);
+            if (!error)
+                error = std::current_exception();
+            next_chunk = num_chunks;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (uint32_t i = 1; i < num_threads; i++)
+        threads.emplace_back (worker);
+    worker ();
+    for (auto& thread : threads)
+        thread.join();
+    if (error)
+        std::rethrow_exception (error);
+}
+
 void
 GncTxImport::set_column_type (uint32_t position, GncTransPropType type, bool force)
 {
@@ -862,52 +942,68 @@ GncTxImport::set_column_type (uint32_t position, GncTransPropType type, bool for
     if (type == GncTransPropType::ACCOUNT)
         base_account (nullptr);
 
+    /* Reset date and currency formats for each trans/split props object
+     * to ensure column updates use the most recent one. This is done up
+     * front because the lines of a multi-split transaction share a single
+     * trans props object.
+     */
+    for (auto& parsed_line : m_parsed_lines)
+    {
+        std::get<PL_PRETRANS>(parsed_line)->set_date_format (m_settings.m_date_format);
+        std::get<PL_PRESPLIT>(parsed_line)->set_date_format (m_settings.m_date_format);
+        std::get<PL_PRESPLIT>(parsed_line)->set_currency_format (m_settings.m_currency_format);
+    }
+
     /* Update the preparsed data */
     m_parent = nullptr;
-    for (auto parsed_lines_it = m_parsed_lines.begin();
-            parsed_lines_it != m_parsed_lines.end();
-            ++parsed_lines_it)
+    uint32_t num_lines = m_parsed_lines.size();
+    if (can_update_in_parallel (old_type, type, m_settings.m_multi_split))
     {
-        /* Reset date and currency formats for each trans/split props object
-         * to ensure column updates use the most recent one
-         */
-        std::get<PL_PRETRANS>(*parsed_lines_it)->set_date_format (m_settings.m_date_format);
-        std::get<PL_PRESPLIT>(*parsed_lines_it)->set_date_format (m_settings.m_date_format);
-        std::get<PL_PRESPLIT>(*parsed_lines_it)->set_currency_format (m_settings.m_currency_format);
-
-        uint32_t row = parsed_lines_it - m_parsed_lines.begin();
-
-        /* If the column type actually changed, first reset the property
-         * represented by the old column type
-         */
-        if (old_type != type)
-        {
-            auto old_col = std::get<PL_INPUT>(*parsed_lines_it).size(); // Deliberately out of bounds to trigger a reset!
-            if ((old_type > GncTransPropType::NONE)
-                    && (old_type <= GncTransPropType::TRANS_PROPS))
-                update_pre_trans_props (row, old_col, old_type);
-            else if ((old_type > GncTransPropType::TRANS_PROPS)
-                    && (old_type <= GncTransPropType::SPLIT_PROPS))
-                update_pre_split_props (row, old_col, old_type);
-        }
-
-        /* Then set the property represented by the new column type */
-        if ((type > GncTransPropType::NONE)
-                && (type <= GncTransPropType::TRANS_PROPS))
-            update_pre_trans_props (row, position, type);
-        else if ((type > GncTransPropType::TRANS_PROPS)
-                && (type <= GncTransPropType::SPLIT_PROPS))
-            update_pre_split_props (row, position, type);
+        // Amount parsing caches the locale's conventions on first use
+        gnc_localeconv ();
+        for_each_line_in_parallel (num_lines, m_parse_threads, [this, position, old_type, type] (uint32_t row)
+            { update_line_props (row, position, old_type, type); });
+    }
+    else
+        for (uint32_t row = 0; row < num_lines; row++)
+            update_line_props (row, position, old_type, type);
+}
 
-        /* Report errors if there are any */
-        auto trans_errors = std::get<PL_PRETRANS>(*parsed_lines_it)->errors();
-        auto split_errors = std::get<PL_PRESPLIT>(*parsed_lines_it)->errors(m_req_mapped_accts);
-        std::get<PL_ERROR>(*parsed_lines_it) =
-                trans_errors +
-                (trans_errors.empty() && split_errors.empty() ? std::string() : "\n") +
-                split_errors;
+/* A helper function intended to be called only from set_column_type */
+void GncTxImport::update_line_props (uint32_t row, uint32_t position,
+                                     GncTransPropType old_type, GncTransPropType type)
+{
+    auto& parsed_line = m_parsed_lines[row];
 
+    /* If the column type actually changed, first reset the property
+     * represented by the old column type
+     */
+    if (old_type != type)
+    {
+        auto old_col = std::get<PL_INPUT>(parsed_line).size(); // Deliberately out of bounds to trigger a reset!
+        if ((old_type > GncTransPropType::NONE)
+                && (old_type <= GncTransPropType::TRANS_PROPS))
+            update_pre_trans_props (row, old_col, old_type);
+        else if ((old_type > GncTransPropType::TRANS_PROPS)
+                && (old_type <= GncTransPropType::SPLIT_PROPS))
+            update_pre_split_props (row, old_col, old_type);
     }
+
+    /* Then set the property represented by the new column type */
+    if ((type > GncTransPropType::NONE)
+            && (type <= GncTransPropType::TRANS_PROPS))
+        update_pre_trans_props (row, position, type);
+    else if ((type > GncTransPropType::TRANS_PROPS)
+            && (type <= GncTransPropType::SPLIT_PROPS))
+        update_pre_split_props (row, position, type);
+
+    /* Report errors if there are any */
+    auto trans_errors = std::get<PL_PRETRANS>(parsed_line)->errors();
+    auto split_errors = std::get<PL_PRESPLIT>(parsed_line)->errors(m_req_mapped_accts);
+    std::get<PL_ERROR>(parsed_line) =
+            trans_errors +
+            (trans_errors.empty() && split_errors.empty() ? std::string() : "\n") +
+            split_errors;
 }
 
 std::vector<GncTransPropType> GncTxImport::column_types ()
@@ -927,13 +1023,13 @@ GncTxImport::accounts ()
     uint32_t tacct_col = tacct_col_it - m_settings.m_column_types.begin();
 
     /* Iterate over all parsed lines */
-    for (auto parsed_line : m_parsed_lines)
+    for (const auto& parsed_line : m_parsed_lines)
     {
         /* Skip current line if the user specified so */
         if ((std::get<PL_SKIP>(parsed_line)))
             continue;
 
-        auto col_strs = std::get<PL_INPUT>(parsed_line);
+        const auto& col_strs = std::get<PL_INPUT>(parsed_line);
         if ((acct_col_it != m_settings.m_column_types.end()) &&
             (acct_col < col_strs.size()) &&
             !col_strs[acct_col].empty())
@@ -133,6 +133,10 @@ public:
 
     void req_mapped_accts (bool val) {m_req_mapped_accts = val; }
 
+    /** Sets the number of threads used to reparse a column after its type
+     *  changed. 0, the default, uses one thread per processor. */
+    void parse_threads (uint32_t threads) {m_parse_threads = threads; }
+
     void separators (std::string separators);
     std::string separators ();
 
@@ -188,11 +192,14 @@ private:
      */
     void update_pre_trans_props (uint32_t row, uint32_t col, GncTransPropType prop_type);
     void update_pre_split_props (uint32_t row, uint32_t col, GncTransPropType prop_type);
+    void update_line_props (uint32_t row, uint32_t position,
+                            GncTransPropType old_type, GncTransPropType type);
 
     struct CsvTranImpSettings; //FIXME do we need this line
     CsvTransImpSettings m_settings;
     bool m_skip_errors;
     bool m_req_mapped_accts;
+    uint32_t m_parse_threads = 0;
 
     /* The parameters below are only used while creating
      * transactions. They keep state information while processing multi-split
@@ -4,12 +4,10 @@
 #include <fstream>      // fstream
 #include <vector>
 #include <string>
+#include <string_view>
 #include <algorithm>    // copy
 #include <iterator>     // ostream_operator
-
-#include <boost/tokenizer.hpp>
-#include <boost/locale.hpp>
-#include <boost/algorithm/string.hpp>
+#include <stdexcept>
 
 extern "C" {
     #include <glib/gi18n.h>
@@ -21,92 +19,162 @@ GncCsvTokenizer::set_separators(const std::string& separators)
     m_sep_str = separators;
 }
 
+static inline bool
+is_space (char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' ||
+        c == '\f' || c == '\r';
+}
 
-int GncCsvTokenizer::tokenize()
+/* Splits one logical line into fields. The rules are those of
+ * boost::escaped_list_separator with \ as escape and " as quote character:
+ * a quote toggles quoted mode, a separator ends the field unless quoted
+ * and \n, \", \\ or an escaped separator stand for the escaped character.
+ */
+static void
+split_line (std::string_view line, const bool is_sep[256], StrVec& fields)
 {
-    using Tokenizer = boost::tokenizer< boost::escaped_list_separator<char>>;
+    if (line.empty())
+        return;
+
+    std::string field;
+    bool inside_quotes = false;
+    for (size_t pos = 0; pos < line.size(); ++pos)
+    {
+        auto c = line[pos];
+        if (c == '\\')
+        {
+            if (++pos == line.size())
+                throw std::range_error N_("There was an error parsing the file.");
+            c = line[pos];
+            if (c == 'n')
+                field.push_back ('\n');
+            else if (c == '"' || c == '\\' || is_sep[static_cast<unsigned char>(c)])
+                field.push_back (c);
+            else
+                throw std::range_error N_("There was an error parsing the file.");
+        }
+        else if (is_sep[static_cast<unsigned char>(c)])
+        {
+            if (inside_quotes)
+                field.push_back (c);
+            else
+            {
+                fields.push_back (std::move (field));
+                field.clear();
+            }
+        }
+        else if (c == '"')
+            inside_quotes = !inside_quotes;
+        else
+            field.push_back (c);
+    }
+    fields.push_back (std::move (field));
+}
+
+/* Rewrites line into escaped so split_line can cope with two conventions
+ * found in the wild: a backslash that doesn't start one of the escapes \\,
+ * \" or \n is taken literally, and a doubled quote inside a field stands
+ * for a quote.
+ */
+static void
+escape_line (std::string_view line, const bool is_sep[256], std::string& escaped)
+{
+    escaped.clear();
+    for (size_t pos = 0; pos < line.size(); ++pos)
+    {
+        auto c = line[pos];
+        escaped.push_back (c);
+        if (c != '\\')
+            continue;
+        if (pos + 1 < line.size() &&
+            (line[pos + 1] == '"' || line[pos + 1] == '\\' || line[pos + 1] == 'n'))
+            escaped.push_back (line[++pos]);
+        else
+            escaped.push_back ('\\');
+    }
 
-    boost::escaped_list_separator<char> sep("\\", m_sep_str, "\"");
+    // Only "" that isn't a whole (empty) field is an escaped quote.
+    for (auto pos = escaped.find ("\"\""); pos != std::string::npos;
+         pos = escaped.find ("\"\"", pos + 2))
+    {
+        if (!((pos == 0 || is_sep[static_cast<unsigned char>(escaped[pos - 1])]) &&
+              (pos + 2 >= escaped.size() || is_sep[static_cast<unsigned char>(escaped[pos + 2])])))
+            escaped[pos] = '\\';
+    }
+}
 
-    StrVec vec;
-    std::string line;
-    std::string buffer;
+/* A single pass over the contents: each physical line is trimmed and
+ * scanned for quotes to find where a logical line ends, physical lines
+ * inside quotes being joined with a space. Logical lines without quotes or
+ * backslashes, by far the most common, are split straight from the
+ * contents.
+ */
+int GncCsvTokenizer::tokenize()
+{
+    bool is_sep[256] = {};
+    for (auto c : m_sep_str)
+        is_sep[static_cast<unsigned char>(c)] = true;
 
-    bool inside_quotes(false);
-    size_t last_quote(0);
+    std::string_view contents {m_utf8_contents};
+    std::string joined;     // a logical line spanning physical lines
+    std::string escaped;
+    bool inside_quotes = false;
 
     m_tokenized_contents.clear();
-    std::istringstream in_stream(m_utf8_contents);
+    m_tokenized_contents.reserve (std::count (contents.begin(), contents.end(), '\n') + 1);
 
-    try
+    size_t pos = 0;
+    while (pos < contents.size())
     {
-        while (std::getline (in_stream, buffer))
+        auto eol = contents.find ('\n', pos);
+        if (eol == std::string_view::npos)
+            eol = contents.size();
+        auto begin = pos, end = eol;
+        pos = eol + 1;
+        while (begin < end && is_space (contents[begin]))
+            ++begin;
+        while (end > begin && is_space (contents[end - 1]))
+            --end;
+        auto physical = contents.substr (begin, end - begin);
+
+        // --- deal with line breaks in quoted strings
+        bool special = false;
+        for (size_t i = 0; i < physical.size(); ++i)
         {
-            // --- deal with line breaks in quoted strings
-            buffer = boost::trim_copy (buffer); // Removes trailing newline and spaces
-            last_quote = buffer.find_first_of('"');
-            while (last_quote != std::string::npos)
+            if (physical[i] == '\\')
+                special = true;
+            else if (physical[i] == '"')
             {
-                if (last_quote == 0) // Test separately because last_quote - 1 would be out of range
+                special = true;
+                if (i == 0 || physical[i - 1] != '\\')
                     inside_quotes = !inside_quotes;
-                else if (buffer[ last_quote - 1 ] != '\\')
-                    inside_quotes = !inside_quotes;
-
-                last_quote = buffer.find_first_of('"',last_quote+1);
             }
+        }
 
-            line.append(buffer);
+        std::string_view line = physical;
+        if (inside_quotes || !joined.empty())
+        {
+            joined.append (physical.data(), physical.size());
             if (inside_quotes)
             {
-                line.append(" ");
+                joined.push_back (' ');
                 continue;
             }
-            // ---
-
-            // Deal with backslashes that are not meant to be escapes
-            // The boost::tokenizer with escaped_list_separator as we use
-            // it would choke on this.
-            auto bs_pos = line.find ('\\');
-            while (bs_pos != std::string::npos)
-            {
-                if ((bs_pos == line.size()) ||                                 // got trailing single backslash
-                    (line.find_first_of ("\"\\n", bs_pos + 1) != bs_pos + 1))  // backslash is not part of known escapes \\, \" or \n
-                    line = line.substr(0, bs_pos) + "\\\\" + line.substr(bs_pos + 1);
-                bs_pos += 2;
-                bs_pos = line.find ('\\', bs_pos);
-            }
-
-            // Deal with repeated " ("") in strings.
-            // This is commonly used as escape mechanism for double quotes in csv files.
-            // However boost just eats them.
-            bs_pos = line.find ("\"\"");
-            while (bs_pos != std::string::npos)
-            {
-                // Only make changes in case the double quotes are part of a larger field
-                // In other words a field which only contains two double quotes represent an
-                // empty field. We don't need to touch those.
-                // The way to determine whether the double quotes represent an empty string
-                // is by checking whether the character in front or after are either
-                // a field separator or the beginning or end of of the string.
-                if (!(((bs_pos == 0) ||                                          // quotes are at start of line
-                       (m_sep_str.find (line[bs_pos-1]) != std::string::npos))    // quotes preceded by field separator
-                      &&
-                      ((bs_pos + 2 >= line.length()) ||                          // quotes are at end of line
-                       (m_sep_str.find (line[bs_pos+2]) != std::string::npos))))   // quotes followed by field separator
-                    // Only make changes in case the double quotes are not an empty field
-                    line.replace (bs_pos, 2, "\\\"");
-                bs_pos = line.find ("\"\"", bs_pos + 2);
-            }
+            line = joined;
+            special = line.find_first_of ("\\\"") != std::string_view::npos;
+        }
+        // ---
 
-            Tokenizer tok(line, sep);
-            vec.assign(tok.begin(),tok.end());
-            m_tokenized_contents.push_back(vec);
-            line.clear();
+        m_tokenized_contents.emplace_back();
+        if (special)
+        {
+            escape_line (line, is_sep, escaped);
+            split_line (escaped, is_sep, m_tokenized_contents.back());
         }
-    }
-    catch (boost::escaped_list_error &e)
-    {
-        throw (std::range_error N_("There was an error parsing the file."));
+        else
+            split_line (line, is_sep, m_tokenized_contents.back());
+        joined.clear();
     }
 
     return 0;
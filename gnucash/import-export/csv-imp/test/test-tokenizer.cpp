@@ -200,6 +200,22 @@ TEST_F (GncTokenizerTest, tokenize_semicolon_sep)
 
 
 
+TEST_F (GncTokenizerTest, tokenize_csv_multiline)
+{
+    set_utf8_contents (csv_tok, "Date,Description,Amount\n"
+                                "05/01/15,\"Multi\n  line\",\"1,100.00\"\n"
+                                ",Next,2\n");
+    csv_tok->tokenize();
+    auto tokens = csv_tok->get_tokens();
+    ASSERT_EQ(3ul, tokens.size());
+    EXPECT_EQ((StrVec{"Date", "Description", "Amount"}), tokens[0]);
+    // A quoted line break is replaced by a single space
+    EXPECT_EQ((StrVec{"05/01/15", "Multi line", "1,100.00"}), tokens[1]);
+    EXPECT_EQ((StrVec{"", "Next", "2"}), tokens[2]);
+}
+
+
+
 void
 GncTokenizerTest::test_gnc_tokenize_helper (tokenize_fw_test_data* test_data)
 {
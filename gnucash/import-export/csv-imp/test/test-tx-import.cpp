@@ -35,6 +35,12 @@
 
 /* Add specific headers for this class */
 #include "../gnc-import-tx.hpp"
+extern "C"
+{
+#include <gnc-session.h>
+}
+#include <glib/gstdio.h>
+#include <cstdio>
 
 //typedef struct
 //{
@@ -62,3 +68,244 @@ public:
 protected:
     std::unique_ptr<GncTxImport> tx_importer;
 };
+
+/* Parsing splits the lines into chunks of this many for its threads. */
+static const uint32_t chunk_lines = 1024;
+static const uint32_t num_lines = 3000;
+enum { COL_DATE, COL_NUM, COL_DESC, COL_ACCOUNT, COL_AMOUNT, COL_MEMO };
+
+/* Loads the same file of a few thousand lines into an importer that
+ * reparses columns on several threads and one that reparses them on just
+ * one, so a column type change can be checked to come out the same. */
+class GncTxImportParallelTest : public ::testing::Test
+{
+public:
+    GncTxImportParallelTest() :
+        m_book{gnc_get_current_book()}, m_root{gnc_account_create_root(m_book)},
+        m_usd{gnc_commodity_new(m_book, "US Dollar", "CURRENCY", "USD", "840",
+                                100)},
+        m_parallel{GncImpFileFormat::CSV}, m_serial{GncImpFileFormat::CSV}
+    {
+        for (auto name : {"Bank", "Groceries", "Rent"})
+            add_account(name);
+
+        auto fd = g_file_open_tmp("test-tx-import-XXXXXX.csv", &m_filename,
+                                  nullptr);
+        g_close(fd, nullptr);
+        auto contents = csv_contents();
+        g_file_set_contents(m_filename, contents.c_str(), contents.size(),
+                            nullptr);
+
+        m_parallel.parse_threads(4);
+        m_serial.parse_threads(1);
+        for (auto importer : {&m_parallel, &m_serial})
+        {
+            importer->currency_format(1); // Period: 123,456.78
+            importer->load_file(m_filename);
+            importer->tokenize(true);
+            importer->update_skipped_lines(1, 0, false, false);
+        }
+    }
+    ~GncTxImportParallelTest()
+    {
+        g_remove(m_filename);
+        g_free(m_filename);
+        xaccAccountBeginEdit(m_root);
+        xaccAccountDestroy(m_root); //It does the commit
+        gnc_clear_current_session();
+    }
+
+protected:
+    /* An account the importer maps its own name to. */
+    void add_account(const char* name)
+    {
+        auto account = xaccMallocAccount(m_book);
+        xaccAccountBeginEdit(account);
+        xaccAccountSetType(account, ACCT_TYPE_BANK);
+        xaccAccountSetName(account, name);
+        xaccAccountSetCommodity(account, m_usd);
+        gnc_account_append_child(m_root, account);
+        auto imap = gnc_account_imap_create_imap(account);
+        gnc_account_imap_add_account(imap, "csv-account-map", name, account);
+        g_free(imap);
+        xaccAccountCommitEdit(account);
+    }
+
+    /* Multi-split transactions of one to three splits, whose later splits
+     * leave the transaction's columns empty. One of four splits starts
+     * two lines before the second chunk. Now and then a date, an account or
+     * an amount can't be parsed. */
+    static std::string csv_contents()
+    {
+        std::string contents = "Date,Num,Description,Account,Amount,Memo\n";
+        uint32_t line = 1;
+        for (uint32_t trans = 0; line < num_lines; trans++)
+        {
+            auto boundary_trans = chunk_lines - 2;
+            auto splits = 1 + trans % 3;
+            if (line == boundary_trans)
+                splits = 4;
+            else if (line < boundary_trans && line + splits > boundary_trans)
+                splits = boundary_trans - line;
+
+            for (uint32_t split = 0; split < splits; split++, line++)
+            {
+                char buf[200];
+                if (split > 0)
+                    contents += ",,,";
+                else if (trans % 101 == 50)
+                    contents += "2021-13-45,,Bad date,";
+                else
+                {
+                    snprintf(buf, sizeof(buf), "2021-%02u-%02u,%u,Payee %u,",
+                             1 + trans % 12, 1 + trans % 28, trans, trans % 50);
+                    contents += buf;
+                }
+
+                if (trans % 113 == 7 && split + 1 == splits)
+                    contents += "Nowhere,";
+                else
+                    contents += split == 0 ? "Bank," :
+                        split % 2 ? "Groceries," : "Rent,";
+
+                if (trans % 97 == 20 && split == 0)
+                    contents += "12.3x,";
+                else
+                {
+                    snprintf(buf, sizeof(buf), "%s%u.%02u,",
+                             split ? "-" : "", 1 + trans % 400, split * 7 % 100);
+                    contents += buf;
+                }
+
+                if ((trans + split) % 5)
+                {
+                    snprintf(buf, sizeof(buf), "Memo %u/%u", trans, split);
+                    contents += buf;
+                }
+                contents += "\n";
+            }
+        }
+        return contents;
+    }
+
+    /* Sets the same column types in both importers, in order. */
+    void set_column_types(std::vector<std::pair<uint32_t, GncTransPropType>> types)
+    {
+        for (auto importer : {&m_parallel, &m_serial})
+            for (auto type : types)
+                importer->set_column_type(type.first, type.second);
+    }
+
+    /* Both importers found the same errors on each line and grouped the
+     * lines into the same transactions. */
+    void expect_same_lines()
+    {
+        auto& parallel = m_parallel.m_parsed_lines;
+        auto& serial = m_serial.m_parsed_lines;
+        ASSERT_EQ(num_lines, serial.size());
+        ASSERT_EQ(serial.size(), parallel.size());
+        auto num_errors = 0;
+        for (uint32_t i = 0; i < serial.size(); i++)
+        {
+            EXPECT_EQ(std::get<PL_ERROR>(serial[i]), std::get<PL_ERROR>(parallel[i]))
+                << "line " << i;
+            if (i > 0)
+                EXPECT_EQ(std::get<PL_PRETRANS>(serial[i]) == std::get<PL_PRETRANS>(serial[i - 1]),
+                          std::get<PL_PRETRANS>(parallel[i]) == std::get<PL_PRETRANS>(parallel[i - 1]))
+                    << "line " << i;
+            num_errors += !std::get<PL_ERROR>(serial[i]).empty();
+        }
+        EXPECT_LT(0, num_errors);
+    }
+
+    /* Skipping the lines with errors, both importers create the same
+     * transactions. */
+    void expect_same_transactions()
+    {
+        for (auto importer : {&m_parallel, &m_serial})
+        {
+            importer->update_skipped_lines(boost::none, boost::none,
+                                           boost::none, true);
+            ASSERT_NO_THROW(importer->create_transactions());
+        }
+
+        auto& parallel = m_parallel.m_transactions;
+        auto& serial = m_serial.m_transactions;
+        ASSERT_LT(0u, serial.size());
+        ASSERT_EQ(serial.size(), parallel.size());
+        for (auto s_it = serial.begin(), p_it = parallel.begin();
+             s_it != serial.end(); ++s_it, ++p_it)
+        {
+            auto s_trans = s_it->second->trans;
+            auto p_trans = p_it->second->trans;
+            EXPECT_EQ(xaccTransGetDate(s_trans), xaccTransGetDate(p_trans));
+            EXPECT_STREQ(xaccTransGetNum(s_trans), xaccTransGetNum(p_trans));
+            EXPECT_STREQ(xaccTransGetDescription(s_trans),
+                         xaccTransGetDescription(p_trans));
+            ASSERT_EQ(xaccTransCountSplits(s_trans),
+                      xaccTransCountSplits(p_trans));
+            for (auto i = 0; i < xaccTransCountSplits(s_trans); i++)
+            {
+                auto s_split = xaccTransGetSplit(s_trans, i);
+                auto p_split = xaccTransGetSplit(p_trans, i);
+                EXPECT_EQ(xaccSplitGetAccount(s_split),
+                          xaccSplitGetAccount(p_split));
+                EXPECT_STREQ(xaccSplitGetMemo(s_split),
+                             xaccSplitGetMemo(p_split));
+                EXPECT_TRUE(gnc_numeric_equal(xaccSplitGetAmount(s_split),
+                                              xaccSplitGetAmount(p_split)));
+            }
+        }
+    }
+
+    QofBook* m_book;
+    Account* m_root;
+    gnc_commodity* m_usd;
+    gchar* m_filename = nullptr;
+    GncTxImport m_parallel;
+    GncTxImport m_serial;
+};
+
+/* The split columns of multi-split transactions are reparsed in parallel,
+ * including those of the transaction crossing into the second chunk. */
+TEST_F(GncTxImportParallelTest, multi_split_column_change)
+{
+    for (auto importer : {&m_parallel, &m_serial})
+        importer->multi_split(true);
+    set_column_types({{COL_DATE, GncTransPropType::DATE},
+                      {COL_NUM, GncTransPropType::NUM},
+                      {COL_DESC, GncTransPropType::DESCRIPTION},
+                      {COL_ACCOUNT, GncTransPropType::ACCOUNT},
+                      {COL_AMOUNT, GncTransPropType::DEPOSIT},
+                      {COL_MEMO, GncTransPropType::MEMO}});
+    expect_same_lines();
+
+    auto& lines = m_parallel.m_parsed_lines;
+    EXPECT_EQ(std::get<PL_PRETRANS>(lines[chunk_lines - 2]),
+              std::get<PL_PRETRANS>(lines[chunk_lines + 1]));
+
+    set_column_types({{COL_AMOUNT, GncTransPropType::WITHDRAWAL},
+                      {COL_MEMO, GncTransPropType::NONE},
+                      {COL_MEMO, GncTransPropType::MEMO}});
+    expect_same_lines();
+    expect_same_transactions();
+}
+
+/* Without multi-split transactions the transaction columns are reparsed
+ * in parallel as well. */
+TEST_F(GncTxImportParallelTest, single_split_column_change)
+{
+    set_column_types({{COL_ACCOUNT, GncTransPropType::ACCOUNT},
+                      {COL_DATE, GncTransPropType::DATE},
+                      {COL_NUM, GncTransPropType::NUM},
+                      {COL_MEMO, GncTransPropType::DESCRIPTION},
+                      {COL_AMOUNT, GncTransPropType::DEPOSIT}});
+    expect_same_lines();
+
+    set_column_types({{COL_DESC, GncTransPropType::DESCRIPTION},
+                      {COL_MEMO, GncTransPropType::MEMO},
+                      {COL_DATE, GncTransPropType::NONE},
+                      {COL_DATE, GncTransPropType::DATE}});
+    expect_same_lines();
+    expect_same_transactions();
+}
@@ -824,6 +824,285 @@ void split_find_match (GNCImportTransInfo * trans_info,
     }
 }/* end split_find_match */
 
+/* Matching runs on worker threads once there are at least this many
+ * imported transactions.
+ */
+#define MATCH_THREAD_MIN_TRANS 200
+
+/* The candidate splits of one account, sorted by amount and by date so that
+ * each imported transaction only needs to score the candidates that can
+ * reach the display threshold. The order is the split's position in the
+ * account's candidate list, which is the order split_find_match always
+ * saw them in.
+ */
+typedef struct _match_candidate
+{
+    Split* split;
+    double amount;
+    time64 date;
+    guint order;
+} match_candidate;
+
+typedef struct _account_candidates
+{
+    GArray* by_amount;
+    GArray* by_date;
+} account_candidates;
+
+typedef struct _match_struct
+{
+    GHashTable* candidates;
+    gint display_threshold;
+    gint date_threshold;
+    gint date_not_threshold;
+    double fuzzy_amount;
+} match_struct;
+
+static gint
+compare_candidate_amount (gconstpointer a, gconstpointer b)
+{
+    double amount_a = ((const match_candidate*)a)->amount;
+    double amount_b = ((const match_candidate*)b)->amount;
+    return amount_a < amount_b ? -1 : amount_a > amount_b ? 1 : 0;
+}
+
+static gint
+compare_candidate_date (gconstpointer a, gconstpointer b)
+{
+    time64 date_a = ((const match_candidate*)a)->date;
+    time64 date_b = ((const match_candidate*)b)->date;
+    return date_a < date_b ? -1 : date_a > date_b ? 1 : 0;
+}
+
+static gint
+compare_candidate_order (gconstpointer a, gconstpointer b)
+{
+    guint order_a = ((const match_candidate*)a)->order;
+    guint order_b = ((const match_candidate*)b)->order;
+    return order_a < order_b ? -1 : order_a > order_b ? 1 : 0;
+}
+
+static account_candidates*
+account_candidates_new (GSList* splits)
+{
+    account_candidates* candidates = g_new0 (account_candidates, 1);
+    guint order = 0;
+    candidates->by_amount = g_array_new (FALSE, FALSE, sizeof (match_candidate));
+    for (GSList* node = splits; node != NULL; node = g_slist_next (node))
+    {
+        match_candidate candidate;
+        candidate.split = node->data;
+        candidate.amount =
+            gnc_numeric_to_double (xaccSplitGetAmount (candidate.split));
+        candidate.date = xaccTransGetDate (xaccSplitGetParent (candidate.split));
+        candidate.order = order++;
+        g_array_append_val (candidates->by_amount, candidate);
+    }
+    candidates->by_date = g_array_sized_new (FALSE, FALSE, sizeof (match_candidate),
+                                             candidates->by_amount->len);
+    g_array_append_vals (candidates->by_date, candidates->by_amount->data,
+                         candidates->by_amount->len);
+    g_array_sort (candidates->by_amount, compare_candidate_amount);
+    g_array_sort (candidates->by_date, compare_candidate_date);
+    return candidates;
+}
+
+static void
+account_candidates_free (account_candidates* candidates)
+{
+    g_array_free (candidates->by_amount, TRUE);
+    g_array_free (candidates->by_date, TRUE);
+    g_free (candidates);
+}
+
+/* The same test split_find_match uses to award points for the amount. */
+static inline gboolean
+amount_is_close (double a, double b, double fuzzy_amount)
+{
+    double difference = fabs (a - b);
+    return difference < 1e-6 || difference <= fuzzy_amount;
+}
+
+static guint
+first_amount_at_least (GArray* array, double amount)
+{
+    guint lo = 0, hi = array->len;
+    while (lo < hi)
+    {
+        guint mid = lo + (hi - lo) / 2;
+        if (g_array_index (array, match_candidate, mid).amount < amount)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+static guint
+first_date_at_least (GArray* array, time64 date)
+{
+    guint lo = 0, hi = array->len;
+    while (lo < hi)
+    {
+        guint mid = lo + (hi - lo) / 2;
+        if (g_array_index (array, match_candidate, mid).date < date)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+static inline gboolean
+string_is_set (const char* str)
+{
+    return str && *str;
+}
+
+/* Score the candidates that could reach the display threshold against one
+ * imported transaction. split_find_match awards at most 3 points each for
+ * amount and date, and at most 8 more for the number, memo and
+ * description, while a candidate whose amount isn't close loses 5. So
+ * unless the threshold is very low, only the candidates with a close amount
+ * and those with another amount but a close date need to be scored.
+ */
+static void
+match_trans_info (gpointer data, gpointer user_data)
+{
+    GNCImportTransInfo* txn_info = data;
+    match_struct* s = user_data;
+    Transaction* trans = gnc_import_TransInfo_get_trans (txn_info);
+    Split* fsplit = gnc_import_TransInfo_get_fsplit (txn_info);
+    account_candidates* candidates =
+        g_hash_table_lookup (s->candidates, xaccSplitGetAccount (fsplit));
+    GArray* picked;
+    double amount, slack;
+    time64 date;
+    gint needed, far_date_points;
+
+    if (!candidates)
+        return;
+
+    amount = gnc_numeric_to_double (xaccSplitGetAmount (fsplit));
+    date = xaccTransGetDate (trans);
+    /* The points the amount and date must make up between them. */
+    needed = s->display_threshold -
+        (string_is_set (gnc_get_num_action (trans, fsplit)) ? 4 : 0) -
+        (string_is_set (xaccSplitGetMemo (fsplit)) ? 2 : 0) -
+        (string_is_set (xaccTransGetDescription (trans)) ? 2 : 0);
+    if (needed > 6)
+        return;
+
+    picked = g_array_new (FALSE, FALSE, sizeof (match_candidate));
+
+    /* Candidates with a close amount, whatever their date. */
+    slack = MAX (s->fuzzy_amount, 1e-6) + 1e-9 * (1.0 + fabs (amount));
+    for (guint i = first_amount_at_least (candidates->by_amount, amount - slack);
+         i < candidates->by_amount->len; ++i)
+    {
+        match_candidate* candidate =
+            &g_array_index (candidates->by_amount, match_candidate, i);
+        if (candidate->amount > amount + slack)
+            break;
+        if (amount_is_close (amount, candidate->amount, s->fuzzy_amount))
+            g_array_append_val (picked, *candidate);
+    }
+
+    /* Candidates with another amount, which need this many points for the
+     * date. */
+    far_date_points = needed + 5;
+    if (far_date_points <= -5)
+    {
+        for (guint i = 0; i < candidates->by_amount->len; ++i)
+        {
+            match_candidate* candidate =
+                &g_array_index (candidates->by_amount, match_candidate, i);
+            if (!amount_is_close (amount, candidate->amount, s->fuzzy_amount))
+                g_array_append_val (picked, *candidate);
+        }
+    }
+    else if (far_date_points <= 3)
+    {
+        static const time64 secs_per_day = 86400;
+        gint days = far_date_points > 2 ? 0 :
+            far_date_points > 0 ? MAX (s->date_threshold, 0) :
+            MAX (MAX (s->date_threshold, s->date_not_threshold), 0);
+        time64 window = (days + 1) * secs_per_day;
+        for (guint i = first_date_at_least (candidates->by_date, date - window);
+             i < candidates->by_date->len; ++i)
+        {
+            match_candidate* candidate =
+                &g_array_index (candidates->by_date, match_candidate, i);
+            if (candidate->date > date + window)
+                break;
+            if (!amount_is_close (amount, candidate->amount, s->fuzzy_amount))
+                g_array_append_val (picked, *candidate);
+        }
+    }
+
+    /* Score them in the original order so that matches with equal
+     * probabilities come out the same way they always did. */
+    g_array_sort (picked, compare_candidate_order);
+    for (guint i = 0; i < picked->len; ++i)
+        split_find_match (txn_info,
+                          g_array_index (picked, match_candidate, i).split,
+                          s->display_threshold,
+                          s->date_threshold,
+                          s->date_not_threshold,
+                          s->fuzzy_amount);
+    g_array_free (picked, TRUE);
+}
+
+/* Iterate through the imported transactions finding the matches for each of
+ * them among its account's candidates, on worker threads if there are many.
+ */
+void
+gnc_import_find_matches (GSList *trans_list, GHashTable *account_hash,
+                         gint display_threshold,
+                         gint date_threshold,
+                         gint date_not_threshold,
+                         double fuzzy_amount_difference)
+{
+    GHashTableIter hash_iter;
+    gpointer account, splits;
+    guint n_trans = g_slist_length (trans_list);
+    GThreadPool* pool = NULL;
+    match_struct s;
+
+    s.candidates =
+        g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
+                               (GDestroyNotify)account_candidates_free);
+    s.display_threshold = display_threshold;
+    s.date_threshold = date_threshold;
+    s.date_not_threshold = date_not_threshold;
+    s.fuzzy_amount = fuzzy_amount_difference;
+
+    g_hash_table_iter_init (&hash_iter, account_hash);
+    while (g_hash_table_iter_next (&hash_iter, &account, &splits))
+        g_hash_table_insert (s.candidates, account,
+                             account_candidates_new (splits));
+
+    if (n_trans >= MATCH_THREAD_MIN_TRANS && g_get_num_processors () > 1)
+    {
+        /* The number heuristic reads a book option that is cached on first
+         * use; fill the cache before the workers race to. */
+        qof_book_use_split_action_for_num_field (gnc_get_current_book ());
+        pool = g_thread_pool_new (match_trans_info, &s,
+                                  (gint)g_get_num_processors (), TRUE, NULL);
+    }
+    if (pool)
+    {
+        for (GSList *imported_txn = trans_list; imported_txn != NULL;
+             imported_txn = g_slist_next (imported_txn))
+            g_thread_pool_push (pool, imported_txn->data, NULL);
+        g_thread_pool_free (pool, FALSE, TRUE);
+    }
+    else
+        g_slist_foreach (trans_list, match_trans_info, &s);
+
+    g_hash_table_destroy (s.candidates);
+}
+
 /***********************************************************************
  */
 
@@ -87,6 +87,24 @@ void split_find_match (GNCImportTransInfo * trans_info,
                        gint date_not_threshold,
                        double fuzzy_amount_difference);
 
+/** Finds the matches of each imported transaction among the candidate
+ * splits of its account, as split_find_match would with every candidate
+ * in turn but skipping those that can't reach the display threshold. Runs
+ * on worker threads when there are many transactions.
+ *
+ * @param trans_list The GNCImportTransInfo of each imported transaction.
+ *
+ * @param account_hash Maps each account to a GSList of its candidate splits.
+ *
+ * The other parameters are those of split_find_match.
+ */
+void gnc_import_find_matches (GSList *trans_list,
+                              GHashTable *account_hash,
+                              gint display_threshold,
+                              gint date_threshold,
+                              gint date_not_threshold,
+                              double fuzzy_amount_difference);
+
 /** Iterates through all splits of the originating account of
  * trans_info. Sorts the resulting list and sets the selected_match
  * and action fields in the trans_info.
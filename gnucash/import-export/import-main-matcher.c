@@ -52,6 +52,7 @@
 #include "gnc-component-manager.h"
 #include "guid.h"
 #include "gnc-session.h"
+#include "engine-helpers.h"
 #include "Query.h"
 #include "SplitP.h"
 
@@ -1798,25 +1799,6 @@ create_hash_of_potential_matches (GList *candidate_txns,
     return account_hash;
 }
 
-typedef struct _match_struct
-{
-    GNCImportTransInfo* transaction_info;
-    gint display_threshold;
-    gint date_threshold;
-    gint date_not_threshold;
-    double fuzzy_amount;
-} match_struct;
-
-static void
-match_helper (Split* data, match_struct* s)
-{
-    split_find_match (s->transaction_info, data,
-                      s->display_threshold, 
-                      s->date_threshold,
-                      s->date_not_threshold,
-                      s->fuzzy_amount);
-}
-
 /* Iterate through the imported transactions selecting matches from the
  * potential match lists in the account hash and update the matcher with the
  * results.
@@ -1826,14 +1808,13 @@ static void
 perform_matching (GNCImportMainMatcher *gui, GHashTable *account_hash)
 {
     GtkTreeModel* model = gtk_tree_view_get_model (gui->view);
-    gint display_threshold =
-        gnc_import_Settings_get_display_threshold (gui->user_settings);
-    gint date_threshold =
-        gnc_import_Settings_get_date_threshold (gui->user_settings);
-    gint date_not_threshold =
-        gnc_import_Settings_get_date_not_threshold (gui->user_settings);
-    double fuzzy_amount =
-        gnc_import_Settings_get_fuzzy_amount (gui->user_settings);
+    GNCImportSettings* settings = gui->user_settings;
+
+    gnc_import_find_matches (gui->temp_trans_list, account_hash,
+                             gnc_import_Settings_get_display_threshold (settings),
+                             gnc_import_Settings_get_date_threshold (settings),
+                             gnc_import_Settings_get_date_not_threshold (settings),
+                             gnc_import_Settings_get_fuzzy_amount (settings));
 
     for (GSList *imported_txn = gui->temp_trans_list; imported_txn !=NULL;
          imported_txn = g_slist_next (imported_txn))
@@ -1842,11 +1823,6 @@ perform_matching (GNCImportMainMatcher *gui, GHashTable *account_hash)
         GNCImportMatchInfo *selected_match;
         gboolean match_selected_manually;
         GNCImportTransInfo* txn_info = imported_txn->data;
-        Account *importaccount = xaccSplitGetAccount (gnc_import_TransInfo_get_fsplit (txn_info));
-        match_struct s = {txn_info, display_threshold, date_threshold, date_not_threshold, fuzzy_amount};
-
-        g_slist_foreach (g_hash_table_lookup (account_hash, importaccount),
-                         (GFunc) match_helper, &s);
 
         // Sort the matches, select the best match, and set the action.
         gnc_import_TransInfo_init_matches (txn_info, gui->user_settings);
@@ -0,0 +1,238 @@
+/********************************************************************
+ * gtest-import-matching.cpp -- unit tests for finding the matches  *
+ *                              of imported transactions.           *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+ *******************************************************************/
+
+#include <gtest/gtest.h>
+extern "C"
+{
+#include <config.h>
+#include <gtk/gtk.h> /* for references in import-backend.h */
+#include <import-backend.h>
+#include <gnc-session.h>
+#include <gnc-ui-util.h>
+#include <Account.h>
+#include <Transaction.h>
+}
+#include <vector>
+
+/* The imported transactions are matched against candidates around every
+ * edge of the amount and date scores, with amounts within, just at and
+ * just past the fuzzy amount difference and dates just at and past the
+ * date thresholds. */
+static const double fuzzy_amount = 2.0;
+static const int date_threshold = 4;
+static const int date_not_threshold = 14;
+static const int num_days = 10;
+static const int num_imported = 250;
+static const double base_amounts[] = {-12.34, -50.00, 7.50, 100.00, -0.01};
+static const double amount_deltas[] = {0.0, 0.01, -0.01, 1.99, -1.99, 2.0,
+                                       -2.0, 2.01, -2.01};
+static const time64 time_deltas[] = {0, 1, -1,
+                                     date_threshold * 86400,
+                                     (date_threshold + 1) * 86400 - 1,
+                                     -(date_threshold + 1) * 86400,
+                                     date_not_threshold * 86400,
+                                     (date_not_threshold + 1) * 86400};
+
+struct Match
+{
+    Split* split;
+    gint probability;
+    gboolean update_proposed;
+    bool operator==(const Match& other) const
+    {
+        return split == other.split && probability == other.probability &&
+            update_proposed == other.update_proposed;
+    }
+};
+using MatchVec = std::vector<Match>;
+
+class ImportMatchingTest : public ::testing::Test
+{
+protected:
+    ImportMatchingTest() :
+        m_book{gnc_get_current_book()}, m_root{gnc_account_create_root(m_book)},
+        m_usd{gnc_commodity_new(m_book, "US Dollar", "CURRENCY", "USD", "840",
+                                100)}
+    {
+        m_bank = add_account("Bank");
+        m_expense = add_account("Expenses");
+        m_start = gnc_dmy2time64_neutral(1, 3, 2021);
+
+        /* The candidates, in the order the matcher is given them. */
+        GSList* candidates = nullptr;
+        auto n = 0;
+        for (auto day = 0; day < num_days; ++day)
+            for (auto time_delta : time_deltas)
+                for (auto base : base_amounts)
+                    for (auto delta : amount_deltas)
+                    {
+                        auto trans = add_transaction(m_start + day * 86400 +
+                                                     time_delta, base + delta,
+                                                     n % 3, n % 2);
+                        xaccTransCommitEdit(trans);
+                        auto split = xaccTransFindSplitByAccount(trans, m_bank);
+                        candidates = g_slist_prepend(candidates, split);
+                        ++n;
+                    }
+        m_candidates = g_slist_reverse(candidates);
+        m_account_hash = g_hash_table_new(g_direct_hash, g_direct_equal);
+        g_hash_table_insert(m_account_hash, m_bank, m_candidates);
+
+        /* The imported transactions stay open, as the importer leaves
+         * them, and are destroyed with their infos. */
+        GSList* infos = nullptr;
+        for (auto i = 0; i < num_imported; ++i)
+        {
+            auto base = base_amounts[i % G_N_ELEMENTS(base_amounts)];
+            auto trans = add_transaction(m_start + (i % num_days) * 86400,
+                                         base, i % 4, i % 4 == 3);
+            infos = g_slist_prepend(infos, gnc_import_TransInfo_new(trans,
+                                                                    nullptr));
+        }
+        m_infos = g_slist_reverse(infos);
+    }
+    ~ImportMatchingTest()
+    {
+        g_hash_table_destroy(m_account_hash);
+        g_slist_free(m_candidates);
+        g_slist_free_full(m_infos, (GDestroyNotify)gnc_import_TransInfo_delete);
+        xaccAccountBeginEdit(m_root);
+        xaccAccountDestroy(m_root); //It does the commit
+        gnc_clear_current_session();
+    }
+    Account* add_account(const char* name)
+    {
+        auto account = xaccMallocAccount(m_book);
+        xaccAccountBeginEdit(account);
+        xaccAccountSetType(account, ACCT_TYPE_BANK);
+        xaccAccountSetName(account, name);
+        xaccAccountSetCommodity(account, m_usd);
+        gnc_account_append_child(m_root, account);
+        xaccAccountCommitEdit(account);
+        return account;
+    }
+    /* An open transaction moving amount into the bank account. Those with
+     * more details get fewer points from them and are matched against
+     * more candidates. */
+    Transaction* add_transaction(time64 date, double amount, int details,
+                                 bool numbered)
+    {
+        static const char* descriptions[] = {"", "Grocery Store",
+                                             "Grocery Store", "Rent"};
+        static const char* memos[] = {"", "", "Weekly", "Weekly shop"};
+        auto value = double_to_gnc_numeric(amount, 100, GNC_HOW_RND_ROUND);
+        auto trans = xaccMallocTransaction(m_book);
+        xaccTransBeginEdit(trans);
+        xaccTransSetCurrency(trans, m_usd);
+        xaccTransSetDatePostedSecs(trans, date);
+        xaccTransSetDescription(trans, descriptions[details]);
+        if (numbered)
+            xaccTransSetNum(trans, "101");
+        for (auto account : {m_bank, m_expense})
+        {
+            auto split = xaccMallocSplit(m_book);
+            xaccSplitSetParent(split, trans);
+            xaccSplitSetAccount(split, account);
+            xaccSplitSetMemo(split, account == m_bank ? memos[details] : "");
+            xaccSplitSetValue(split, value);
+            xaccSplitSetAmount(split, value);
+            value = gnc_numeric_neg(value);
+        }
+        return trans;
+    }
+    /* Each imported transaction's matches, in the order they were found,
+     * which are then forgotten. */
+    std::vector<MatchVec> take_matches()
+    {
+        std::vector<MatchVec> result;
+        for (auto node = m_infos; node; node = g_slist_next(node))
+        {
+            auto info = static_cast<GNCImportTransInfo*>(node->data);
+            auto match_list = gnc_import_TransInfo_get_match_list(info);
+            MatchVec matches;
+            for (auto match_node = match_list; match_node;
+                 match_node = g_list_next(match_node))
+            {
+                auto match = static_cast<GNCImportMatchInfo*>(match_node->data);
+                matches.push_back({gnc_import_MatchInfo_get_split(match),
+                                   gnc_import_MatchInfo_get_probability(match),
+                                   match->update_proposed});
+            }
+            result.push_back(std::move(matches));
+            g_list_free_full(match_list, g_free);
+            gnc_import_TransInfo_set_match_list(info, nullptr);
+        }
+        return result;
+    }
+    /* Matches every imported transaction with gnc_import_find_matches and
+     * by scoring every candidate with split_find_match in turn, as the
+     * matcher used to, and compares their lists of matches. */
+    void compare_matches(gint display_threshold)
+    {
+        gnc_import_find_matches(m_infos, m_account_hash, display_threshold,
+                                date_threshold, date_not_threshold,
+                                fuzzy_amount);
+        auto found = take_matches();
+
+        for (auto node = m_infos; node; node = g_slist_next(node))
+            for (auto split = m_candidates; split; split = g_slist_next(split))
+                split_find_match(static_cast<GNCImportTransInfo*>(node->data),
+                                 static_cast<Split*>(split->data),
+                                 display_threshold, date_threshold,
+                                 date_not_threshold, fuzzy_amount);
+        auto scanned = take_matches();
+
+        ASSERT_EQ(scanned.size(), found.size());
+        size_t total = 0;
+        for (size_t i = 0; i < scanned.size(); ++i)
+        {
+            EXPECT_EQ(scanned[i], found[i])
+                << "imported transaction " << i << ", display threshold "
+                << display_threshold;
+            total += scanned[i].size();
+        }
+        /* Some of the candidates matched and some didn't. */
+        EXPECT_LT(0u, total);
+        EXPECT_GT(scanned.size() * g_slist_length(m_candidates), total);
+    }
+
+    QofBook* m_book;
+    Account* m_root;
+    gnc_commodity* m_usd;
+    Account* m_bank;
+    Account* m_expense;
+    time64 m_start;
+    GSList* m_candidates;
+    GHashTable* m_account_hash;
+    GSList* m_infos;
+};
+
+/* Enough transactions to be matched on worker threads, with thresholds
+ * that let through only candidates with a close amount, those with a close
+ * date too, and every candidate. */
+TEST_F(ImportMatchingTest, pooled_matches_equal_full_scan)
+{
+    ASSERT_LE(200, num_imported);
+    for (auto display_threshold : {6, 3, 1, -10})
+        compare_matches(display_threshold);
+}
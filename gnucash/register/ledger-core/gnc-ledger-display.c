@@ -63,6 +63,10 @@ struct gnc_ledger_display
 
     SplitRegister* reg;
 
+    /* The shown splits' transactions, referenced so that a backend loading
+     * them on demand doesn't evict them. */
+    GList* held_trans;
+
     gboolean loading;
     gboolean use_double_line_default;
 
@@ -636,6 +640,9 @@ close_handler (gpointer user_data)
     qof_query_destroy (ld->query);
     ld->query = NULL;
 
+    g_list_free_full (ld->held_trans, g_object_unref);
+    ld->held_trans = NULL;
+
     g_free (ld);
 }
 
@@ -796,6 +803,7 @@ gnc_ledger_display_internal (Account* lead_account, Query* q,
 
     ld->leader = *xaccAccountGetGUID (lead_account);
     ld->query = NULL;
+    ld->held_trans = NULL;
     ld->ld_type = ld_type;
     ld->loading = FALSE;
     ld->destroy = NULL;
@@ -863,6 +871,8 @@ gnc_ledger_display_find_by_query (Query* q)
 static void
 gnc_ledger_display_refresh_internal (GNCLedgerDisplay* ld, GList* splits)
 {
+    GList* held = NULL;
+
     if (!ld || ld->loading)
         return;
 
@@ -871,6 +881,12 @@ gnc_ledger_display_refresh_internal (GNCLedgerDisplay* ld, GList* splits)
 
     ld->loading = TRUE;
 
+    for (GList* node = splits; node; node = node->next)
+        held = g_list_prepend (held,
+                               g_object_ref (xaccSplitGetParent (node->data)));
+    g_list_free_full (ld->held_trans, g_object_unref);
+    ld->held_trans = held;
+
     gnc_split_register_load (ld->reg, splits,
                              gnc_ledger_display_leader (ld));
 
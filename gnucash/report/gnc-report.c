@@ -39,6 +39,7 @@
 
 #include "gnc-filepath-utils.h"
 #include "gnc-guile-utils.h"
+#include "gnc-prefs.h"
 #include "gnc-report.h"
 #include "gnc-engine.h"
 
@@ -50,6 +51,10 @@ static QofLogModule log_module = GNC_MOD_GUI;
 static GHashTable *reports = NULL;
 static gint report_next_serial_id = 0;
 
+/* Bumped whenever a preference the reports may read changes. */
+static guint report_prefs_generation = 0;
+static gboolean report_prefs_watched = FALSE;
+
 static gboolean
 try_load_config_array(const gchar *fns[])
 {
@@ -314,6 +319,27 @@ gnc_run_report_id_string_with_error_handling (const char * id_string, char **dat
     return gnc_run_report_with_error_handling (report_id, data, errmsg);
 }
 
+static void
+report_prefs_changed (gpointer prefs, gchar *pref, gpointer user_data)
+{
+    report_prefs_generation++;
+}
+
+guint
+gnc_report_prefs_generation (void)
+{
+    /* The preferences may be set up after the reports. */
+    if (!report_prefs_watched && gnc_prefs_is_set_up ())
+    {
+        gnc_prefs_register_group_cb (GNC_PREFS_GROUP_GENERAL,
+                                     report_prefs_changed, NULL);
+        gnc_prefs_register_group_cb (GNC_PREFS_GROUP_GENERAL_REPORT,
+                                     report_prefs_changed, NULL);
+        report_prefs_watched = TRUE;
+    }
+    return report_prefs_generation;
+}
+
 gchar*
 gnc_get_default_report_font_family(void)
 {
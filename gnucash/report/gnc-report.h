@@ -62,6 +62,11 @@ gint gnc_report_add(SCM report);
 void gnc_reports_flush_global(void);
 GHashTable *gnc_reports_get_global(void);
 
+/** @return A number that changes whenever one of the general or the
+ *  general report preferences changes, so that report output formatted
+ *  by them isn't reused after a change. */
+guint gnc_report_prefs_generation (void);
+
 gchar* gnc_get_default_report_font_family(void);
 
 gboolean gnc_saved_reports_backup (void);
@@ -62,6 +62,7 @@
 (export gnc:html-document-set-style!)
 (export gnc:html-document-tree-collapse)
 (export gnc:html-document-render)
+(export gnc:html-document-render-to-port)
 (export gnc:html-document-push-style)
 (export gnc:html-document-pop-style)
 (export gnc:html-document-add-object!)
@@ -75,6 +76,9 @@
 (export gnc:html-document-set-export-string)
 (export gnc:html-document-export-error)
 (export gnc:html-document-set-export-error)
+(export gnc:html-document-export-writer)
+(export gnc:html-document-set-export-writer)
+(export gnc:html-document-write-export)
 (export <html-object>)
 (export gnc:html-object?)
 (export gnc:make-html-object-internal)
@@ -93,7 +97,7 @@
 (define-record-type <html-document>
   (make-html-document-internal style-sheet style-stack style
                                style-text title headline objects
-                               export-string export-error)
+                               export-string export-error export-writer)
   html-document?
   (style-sheet html-document-style-sheet html-document-set-style-sheet)
   (style-stack html-document-style-stack html-document-set-style-stack)
@@ -103,7 +107,8 @@
   (headline html-document-headline html-document-set-headline)
   (objects html-document-objects html-document-set-objects)
   (export-string html-document-export-string html-document-set-export-string)
-  (export-error html-document-export-error html-document-set-export-error))
+  (export-error html-document-export-error html-document-set-export-error)
+  (export-writer html-document-export-writer html-document-set-export-writer))
 
 (define gnc:html-document-set-title! html-document-set-title)
 (define gnc:html-document-title html-document-title)
@@ -121,10 +126,27 @@
 (define gnc:html-document-objects html-document-objects)
 (define gnc:html-document? html-document?)
 (define gnc:make-html-document-internal make-html-document-internal)
-(define gnc:html-document-export-string html-document-export-string)
 (define gnc:html-document-set-export-string html-document-set-export-string)
 (define gnc:html-document-export-error html-document-export-error)
 (define gnc:html-document-set-export-error html-document-set-export-error)
+(define gnc:html-document-export-writer html-document-export-writer)
+(define gnc:html-document-set-export-writer html-document-set-export-writer)
+
+;; the export writer is a procedure writing the export to the port it's
+;; given, for exports too large to build as a string. callers wanting a
+;; string still get one.
+(define (gnc:html-document-export-string doc)
+  (or (html-document-export-string doc)
+      (let ((writer (html-document-export-writer doc)))
+        (and writer (call-with-output-string writer)))))
+
+;; writes the export-string or export-writer output to port. returns #f
+;; if the document has neither.
+(define (gnc:html-document-write-export doc port)
+  (cond
+   ((html-document-export-writer doc) => (lambda (writer) (writer port) #t))
+   ((html-document-export-string doc) => (lambda (str) (display str port) #t))
+   (else #f)))
 
 (define (gnc:make-html-document)
   (gnc:make-html-document-internal
@@ -137,6 +159,7 @@
    '()                   ;; subobjects
    #f                    ;; export-string -- must be #f by default
    #f                    ;; export-error -- must be #f by default
+   #f                    ;; export-writer -- must be #f by default
    ))
 
 (define (gnc:html-document-set-style! doc tag . rest)
@@ -154,6 +177,15 @@
           ((string? e) (cons e accum))
           (else (cons (object->string e) accum)))))
 
+;; while set, the next document rendered without a style sheet is
+;; written to this port as it's rendered, see
+;; gnc:html-document-render-to-port.
+(define render-port (make-parameter #f))
+
+(define (write-tree tree port)
+  (for-each (lambda (str) (display str port))
+            (gnc:html-document-tree-collapse tree)))
+
 ;; first optional argument is "headers?"
 ;; returns the html document as a string, I think.
 (define (gnc:html-document-render doc . rest)
@@ -166,8 +198,11 @@
         (gnc:html-style-sheet-render stylesheet doc headers?)
 
         ;; otherwise, do the trivial render.
-        (let* ((retval '())
-               (push (lambda (l) (set! retval (cons l retval))))
+        (let* ((port (render-port))
+               (retval '())
+               (push (if port
+                         (lambda (l) (write-tree l port))
+                         (lambda (l) (set! retval (cons l retval)))))
                (objs (gnc:html-document-objects doc))
                (title (gnc:html-document-title doc)))
           ;; compile the doc style
@@ -197,11 +232,21 @@
             ;; attributes like bgcolor get included
             (push ((gnc:html-markup/open-tag-only "body") doc)))
 
-          ;; now render the children
-          (for-each
-           (lambda (child)
-               (push (gnc:html-object-render child doc)))
-           objs)
+          ;; now render the children. documents nested in them, such as
+          ;; embedded reports, are rendered to strings as usual.
+          (parameterize ((render-port #f))
+            (for-each
+             (lambda (child)
+               (if (and port
+                        (gnc:html-object? child)
+                        (eq? (gnc:html-object-renderer child) gnc:html-table-render))
+                   ;; tables are written out a row at a time
+                   (begin
+                     (gnc:pulse-progress-bar)
+                     (gnc:html-table-render-to-port
+                      (gnc:html-object-data child) doc port))
+                   (push (gnc:html-object-render child doc))))
+             objs))
 
           (when headers?
             (push "</body>\n")
@@ -211,7 +256,20 @@
           (gnc:html-document-pop-style doc)
           (gnc:html-style-table-uncompile (gnc:html-document-style doc))
 
-          (string-concatenate (gnc:html-document-tree-collapse retval))))))
+          (if port
+              ""
+              (string-concatenate (gnc:html-document-tree-collapse retval)))))))
+
+;; renders doc like gnc:html-document-render, but writes the html to
+;; port as it goes instead of returning it as a string. the report's
+;; top-level tables are written a row at a time, so the html of a large
+;; report is never held in memory as a whole.
+(define* (gnc:html-document-render-to-port doc port #:optional (headers? #t))
+  ;; a style sheet that doesn't hand the document back to
+  ;; gnc:html-document-render still returns a string.
+  (display (parameterize ((render-port port))
+             (gnc:html-document-render doc headers?))
+           port))
 
 
 (define (gnc:html-document-push-style doc style)
@@ -99,6 +99,7 @@
 (export gnc:html-table-set-cell/tag!)
 (export gnc:html-table-append-column!)
 (export gnc:html-table-render)
+(export gnc:html-table-render-to-port)
 
 ;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;;
 ;; 
@@ -437,8 +438,20 @@ populate html-table row-wise using gnc:html-table-append-row! instead.")
           (1+ numrows))))))
 
 (define (gnc:html-table-render table doc)
+  (render-table table doc #f))
+
+;; writes the table's html to port a cell at a time instead of
+;; returning it, see gnc:html-document-render-to-port.
+(define (gnc:html-table-render-to-port table doc port)
+  (render-table table doc port))
+
+(define (render-table table doc port)
   (let* ((retval '())
-         (push (lambda (l) (set! retval (cons l retval)))))
+         (push (if port
+                   (lambda (l)
+                     (for-each (lambda (str) (display str port))
+                               (gnc:html-document-tree-collapse l)))
+                   (lambda (l) (set! retval (cons l retval))))))
 
     ;; compile the table style to make other compiles faster
     (gnc:html-style-table-compile (gnc:html-table-style table)
@@ -79,6 +79,8 @@
 (export gnc:report-options)
 (export gnc:report-render-html)
 (export gnc:render-report)
+(export gnc:report-render-html-to-port)
+(export gnc:render-report-to-port)
 (export gnc:report-run)
 (export gnc:report-serialize)
 (export gnc:report-set-ctext!)
@@ -735,6 +737,51 @@ not found.")))
           (gnc:custom-report-templates-list))))
 
 
+;; The html of the most recently rendered reports, so that reloading a
+;; report whose book and options haven't changed doesn't render it
+;; again. Keyed by everything the html depends on, see
+;; report-cache-key. That includes the report id, which ends up in the
+;; html's links. The oldest are dropped once they hold more than
+;; report-cache-max-chars characters.
+(define *report-cache* (make-hash-table))
+(define *report-cache-keys* '())        ;most recent first
+(define *report-cache-chars* 0)
+(define report-cache-max-chars (* 16 1024 1024))
+
+;; Returns #f for reports that can't be cached: those embedding other
+;; reports, whose options aren't part of their own.
+(define (report-cache-key report stylesheet headers?)
+  (and (null? (or (gnc:report-embedded-list (gnc:report-options report)) '()))
+       (string-append
+        (gnc:report-type report)
+        (format #f " ~a~a" (gnc:report-id report) (if headers? " headers " " "))
+        (number->string (qof-book-get-generation (gnc-get-current-book)))
+        ;; the preferences that formatting reads
+        (format #f " ~a" (gnc-report-prefs-generation))
+        ;; relative dates resolve differently tomorrow
+        (strftime " %F\n" (localtime (current-time)))
+        (gnc:generate-restore-forms (gnc:report-options report) "options")
+        (if stylesheet
+            (gnc:generate-restore-forms
+             (gnc:html-style-sheet-options stylesheet) "stylesheet")
+            ""))))
+
+(define (report-cache-remove! key)
+  (let ((html (hash-ref *report-cache* key)))
+    (when html
+      (set! *report-cache-chars* (- *report-cache-chars* (string-length html)))
+      (hash-remove! *report-cache* key)
+      (set! *report-cache-keys* (delete key *report-cache-keys*)))))
+
+(define (report-cache-add! key html)
+  (report-cache-remove! key)
+  (when (<= (string-length html) report-cache-max-chars)
+    (hash-set! *report-cache* key html)
+    (set! *report-cache-keys* (cons key *report-cache-keys*))
+    (set! *report-cache-chars* (+ *report-cache-chars* (string-length html)))
+    (while (> *report-cache-chars* report-cache-max-chars)
+      (report-cache-remove! (last *report-cache-keys*)))))
+
 ;; gets the renderer from the report template;
 ;; gets the stylesheet from the report;
 ;; renders the html doc and caches the resulting string;
@@ -747,18 +794,49 @@ not found.")))
       (gnc:report-ctext report)
       (let ((template (hash-ref *gnc:_report-templates_* (gnc:report-type report))))
         (and template
-             (let* ((renderer (gnc:report-template-renderer template))
-                    (stylesheet (gnc:report-stylesheet report))
-                    (doc (renderer report))
-                    (html (cond
-                           ((string? doc) doc)
-                           (else
-                            (gnc:html-document-set-style-sheet! doc stylesheet)
-                            (gnc:html-document-render doc headers?)))))
+             (let* ((stylesheet (gnc:report-stylesheet report))
+                    (key (report-cache-key report stylesheet headers?))
+                    (html (or (and key (hash-ref *report-cache* key))
+                              (let* ((renderer (gnc:report-template-renderer template))
+                                     (doc (renderer report))
+                                     (html (cond
+                                            ((string? doc) doc)
+                                            (else
+                                             (gnc:html-document-set-style-sheet! doc stylesheet)
+                                             (gnc:html-document-render doc headers?)))))
+                                (when (and key (string? html))
+                                  (report-cache-add! key html))
+                                html))))
                (gnc:report-set-ctext! report html) ;; cache the html
                (gnc:report-set-dirty?! report #f)  ;; mark it clean
                html)))))
 
+;; like gnc:report-render-html, but writes the html to port while it's
+;; rendered instead of returning it, see
+;; gnc:html-document-render-to-port. the html isn't kept, it's meant for
+;; reports too large to hold in memory. returns #f if the report has no
+;; template.
+(define (gnc:report-render-html-to-port report port headers?)
+  (let ((template (hash-ref *gnc:_report-templates_* (gnc:report-type report)))
+        (stylesheet (gnc:report-stylesheet report)))
+    (define (cached-html)
+      (if (and (not (gnc:report-dirty? report))
+               (gnc:report-ctext report))
+          (gnc:report-ctext report)
+          (let ((key (report-cache-key report stylesheet headers?)))
+            (and key (hash-ref *report-cache* key)))))
+    (cond
+     ((not template) #f)
+     ((cached-html) => (lambda (html) (display html port) #t))
+     (else
+      (let ((doc ((gnc:report-template-renderer template) report)))
+        (cond
+         ((string? doc) (display doc port))
+         (else
+          (gnc:html-document-set-style-sheet! doc stylesheet)
+          (gnc:html-document-render-to-port doc port headers?)))
+        #t)))))
+
 ;; render report. will return a 2-element list: either (list html #f)
 ;; where html is the report html string, or (list #f captured-error)
 ;; where captured-error is the error string.
@@ -766,6 +844,12 @@ not found.")))
   (define (get-report) (gnc:report-render-html report #t))
   (gnc:apply-with-error-handling get-report '()))
 
+;; render report to port. returns either (list #t #f) or
+;; (list #f captured-error), like gnc:render-report.
+(define (gnc:render-report-to-port report port)
+  (define (write-report) (gnc:report-render-html-to-port report port #t))
+  (gnc:apply-with-error-handling write-report '()))
+
 ;; looks up the report by id and renders it with gnc:report-render-html
 ;; marks the cursor busy during rendering; returns the html
 (define (gnc:report-run id)
@@ -928,3 +1012,86 @@ not found.")))
   (match (reportname->templates report)
     ((template) (gnc:make-report (gnc:report-template-report-guid template)))
     (_ (gnc:error report " does not match unique report") #f)))
+
+;; In: report - string matching reportname or report guid
+;; In: export-type - string matching export type, or #f for html
+;; In: settings - list of (section name . value) where value is a
+;;     string holding the option's value as a scheme datum
+;; In: port - optional port to write the output to as it's produced
+;; Out: 2-element list, either (list output #f) or (list #f error);
+;;     output is #t if it was written to port
+;;
+;; Used by gnucash-cli and the report server, which keeps running after
+;; errors: the report instance is dropped again once it's rendered.
+(define-public (gnc:cmdline-run-report report export-type settings . rest)
+  (define port (and (pair? rest) (car rest)))
+  (define (set-options! options settings)
+    (let lp ((settings settings))
+      (match settings
+        (() #f)
+        (((section name . value) . rest)
+         (let ((option (gnc:lookup-option options section name)))
+           (cond
+            ((not option)
+             (format #f "No option ~s in section ~s" name section))
+            (else
+             (gnc:option-set-value option
+                                   (call-with-input-string value read))
+             (lp rest))))))))
+
+  (define (export report-obj template)
+    (let* ((parent-guid (gnc:report-template-parent-type template))
+           (template (if parent-guid
+                         (hash-ref *gnc:_report-templates_* parent-guid)
+                         template))
+           (export-thunk (gnc:report-template-export-thunk template))
+           (export-types (gnc:report-template-export-types template))
+           (upgrade-msg "This report must be upgraded to return a document \
+object with export-string or export-error."))
+      (cond
+       ((not export-thunk)
+        (list #f (format #f "~s has no export code" report)))
+       ((not (assoc export-type export-types))
+        (list #f (format #f "Export-type disallowed: ~a. Allowed types: ~a"
+                         export-type (string-join (map car export-types) ", "))))
+       (else
+        (match (gnc:apply-with-error-handling
+                export-thunk
+                (list report-obj (assoc-ref export-types export-type)))
+          ((#f (? string? captured-error)) (list #f captured-error))
+          (((? gnc:html-document? doc) _)
+           (cond
+            ((not port)
+             (cond
+              ((gnc:html-document-export-string doc) => (cut list <> #f))
+              ((gnc:html-document-export-error doc) => (cut list #f <>))
+              (else (list #f upgrade-msg))))
+            ((gnc:html-document-export-error doc) => (cut list #f <>))
+            (else
+             (match (gnc:apply-with-error-handling
+                     gnc:html-document-write-export (list doc port))
+               ((#f (? string? captured-error)) (list #f captured-error))
+               ((#f _) (list #f upgrade-msg))
+               (_ (list #t #f))))))
+          (_ (list #f upgrade-msg)))))))
+
+  (match (reportname->templates report)
+    (() (list #f (format #f "Cannot find ~s" report)))
+    ((template)
+     (let* ((id (gnc:make-report (gnc:report-template-report-guid template)))
+            (report-obj (gnc-report-find id)))
+       (dynamic-wind
+         (const #t)
+         (lambda ()
+           (match (gnc:apply-with-error-handling
+                   set-options! (list (gnc:report-options report-obj) settings))
+             ((#f #f)
+              (cond
+               (export-type (export report-obj template))
+               (port (gnc:render-report-to-port report-obj port))
+               (else (gnc:render-report report-obj))))
+             ((#f captured-error) (list #f captured-error))
+             ((error _) (list #f error))))
+         (lambda () (gnc-report-remove-by-id id)))))
+    (_ (list #f (format #f "~s matches multiple reports. Select guid instead"
+                        report)))))
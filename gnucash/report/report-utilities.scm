@@ -48,6 +48,11 @@
 (export gnc:accounts-get-commodities)
 (export gnc:get-current-account-tree-depth)
 (export gnc:accounts-and-all-descendants)
+(export gnc:account-split-iterator)
+(export gnc:account-child-iterator)
+(export gnc:account-descendant-iterator)
+(export gnc:iterator-fold)
+(export gnc:iterator-for-each)
 (export gnc:make-value-collector)
 (export gnc:make-commodity-collector)
 (export gnc:collector+)
@@ -231,10 +236,42 @@
   (let ((root (gnc-get-current-root-account)))
     (gnc-account-get-tree-depth root)))
 
+;; Iterators over an account's splits, children or descendants. Each
+;; call of the iterator returns the next one, or #f once there are no
+;; more, without building the whole list first. If the book is changed
+;; while an iterator is in use, its next call throws a misc-error,
+;; unless it was created with snapshot? true: a snapshot copies the
+;; list upfront and may be used by code that changes the book.
+(define* (gnc:account-split-iterator account #:optional snapshot?)
+  (let ((iter (gnc-account-iter-scm-new account GNC-ACCOUNT-ITER-SPLITS snapshot?)))
+    (lambda () (gnc-account-iter-scm-next iter))))
+
+(define* (gnc:account-child-iterator account #:optional snapshot?)
+  (let ((iter (gnc-account-iter-scm-new account GNC-ACCOUNT-ITER-CHILDREN snapshot?)))
+    (lambda () (gnc-account-iter-scm-next iter))))
+
+(define* (gnc:account-descendant-iterator account #:optional snapshot?)
+  (let ((iter (gnc-account-iter-scm-new account GNC-ACCOUNT-ITER-DESCENDANTS snapshot?)))
+    (lambda () (gnc-account-iter-scm-next iter))))
+
+(define (gnc:iterator-fold proc init iter)
+  (let lp ((result init))
+    (let ((elt (iter)))
+      (if elt (lp (proc elt result)) result))))
+
+(define (gnc:iterator-for-each proc iter)
+  (let lp ()
+    (let ((elt (iter)))
+      (when elt
+        (proc elt)
+        (lp)))))
+
 ;; Return accountslist *and* their descendant accounts
 (define (gnc:accounts-and-all-descendants accountslist)
   (sort-and-delete-duplicates
-   (apply append accountslist (map gnc-account-get-descendants accountslist))
+   (fold (lambda (acc result)
+           (gnc:iterator-fold cons result (gnc:account-descendant-iterator acc)))
+         accountslist accountslist)
    gnc:account-path-less-p equal?))
 
 ;;; Here's a statistics collector...  Collects max, min, total, and makes
@@ -316,73 +353,79 @@
 ;;       <commodity> doesn't exist, the balance will be 0. If
 ;;       signreverse? is true, the result's sign will be reversed.
 ;;   (internal) 'list #f #f: get the list of
-;;       (cons commodity numeric-collector)
+;;       (cons commodity total), most recently added commodity first
+;;   (internal) 'native #f #f: get the native collector holding all
+;;       the totals, or #f if some are kept in scheme.
+;;
+;; The totals are kept by the engine (see gnc-commodity-collector.h);
+;; only amounts that it can't hold exactly, i.e. inexact numbers or
+;; sums that overflow a gnc-numeric, are summed in scheme instead.
 
 (define (gnc:make-commodity-collector)
-  ;; the association list of (commodity . value-collector) pairs.
-  (let ((commoditylist '()))
-    
-    ;; helper function to add a (commodity . value) pair to our list.
-    ;; If no pair with this commodity exists, we will create one.
+  ;; the native collector, and the association list of
+  ;; (commodity . value) pairs it couldn't hold.
+  (let ((coll (gnc-commodity-collector-scm-new))
+        (extras '()))
+
+    ;; helper function to add a value to a commodity's total.
     (define (add-commodity-value commodity value)
-      (let ((pair (assoc commodity commoditylist)))
-	(unless pair
-	  (set! pair (list commodity (gnc:make-value-collector)))
-	  (set! commoditylist (cons pair commoditylist)))
-	((cadr pair) 'add value)))
-    
-    ;; helper function to walk an association list, adding each
-    ;; (commodity . collector) pair to our list at the appropriate
-    ;; place
-    (define (add-commodity-clist clist)
-      (cond ((null? clist) '())
-	    (else (add-commodity-value 
-		   (caar clist) 
-		   ((cadar clist) 'total #f))
-		  (add-commodity-clist (cdr clist)))))
-
-    (define (minus-commodity-clist clist)
-      (cond ((null? clist) '())
-	    (else (add-commodity-value 
-		   (caar clist) 
-		   (- ((cadar clist) 'total #f)))
-		  (minus-commodity-clist (cdr clist)))))
-
-    ;; helper function walk the association list doing a callback on
-    ;; each key-value pair.
-    (define (process-commodity-list fn clist)
-      (map
-       (lambda (pair)
-         (fn (car pair) ((cadr pair) 'total #f)))
-       clist))
+      (unless (gnc-commodity-collector-scm-add coll commodity value)
+        (let ((pair (assoc commodity extras))
+              (value (if (number? value) value 0)))
+          (if pair
+              (set-cdr! pair (+ (cdr pair) value))
+              (set! extras (cons (cons commodity value) extras))))))
+
+    (define (total c)
+      (let ((extra (assoc c extras)))
+        (+ (gnc-commodity-collector-scm-amount coll c)
+           (if extra (cdr extra) 0))))
+
+    ;; the list of (commodity . total) pairs, most recent first.
+    (define (commodity-totals)
+      (if (null? extras)
+          (gnc-commodity-collector-scm-list coll)
+          (map (lambda (pair) (cons (car pair) (total (car pair))))
+               (gnc-commodity-collector-scm-list coll))))
+
+    ;; helper function to add another collector's totals, negated if
+    ;; sign? is true.
+    (define (merge other sign?)
+      (let ((other-coll (other 'native #f #f)))
+        (unless (and other-coll
+                     (gnc-commodity-collector-scm-merge coll other-coll sign?))
+          (for-each
+           (lambda (pair)
+             (add-commodity-value
+              (car pair) (if sign? (- (cdr pair)) (cdr pair))))
+           (other 'list #f #f)))))
 
     ;; helper function which is given a commodity and returns a list
     ;; (list gnc:commodity number).
     (define (getpair c sign?)
-      (let* ((pair (assoc c commoditylist))
-             (total (if pair ((cadr pair) 'total #f) 0)))
+      (let ((total (total c)))
 	(list c (if sign? (- total) total))))
 
     ;; helper function which is given a commodity and returns a
     ;; <gnc:monetary> value, whose amount may be 0.
     (define (getmonetary c sign?)
-      (let* ((pair (assoc c commoditylist))
-             (total (if pair ((cadr pair) 'total #f) 0)))
+      (let ((total (total c)))
 	(gnc:make-gnc-monetary c (if sign? (- total) total))))
-    
+
     ;; Dispatch function
     (lambda (action commodity amount)
       (case action
 	((add) (add-commodity-value commodity amount))
-	((merge) (add-commodity-clist
-                  (commodity 'list #f #f)))
-	((minusmerge) (minus-commodity-clist
-                       (commodity 'list #f #f)))
-	((format) (process-commodity-list commodity commoditylist))
-	((reset) (set! commoditylist '()))
+	((merge) (merge commodity #f))
+	((minusmerge) (merge commodity #t))
+	((format) (map (lambda (pair) (commodity (car pair) (cdr pair)))
+                       (commodity-totals)))
+	((reset) (gnc-commodity-collector-scm-reset coll)
+                 (set! extras '()))
 	((getpair) (getpair commodity amount))
 	((getmonetary) (getmonetary commodity amount))
-	((list) commoditylist) ; this one is only for internal use
+	((list) (commodity-totals)) ; this one is only for internal use
+	((native) (and (null? extras) coll)) ; so is this one
 	(else (gnc:warn "bad commodity-collector action: " action))))))
 
 (define (gnc:commodity-collector-get-negated collector)
@@ -439,6 +482,7 @@
 ;;      dates-list (list of time64) - NOTE: IT WILL BE SORTED
 ;;      split->amount - an unary lambda. calling (split->amount split)
 ;;      returns a number, or #f which effectively skips the split.
+;;      when omitted the split amounts are summed natively.
 ;; out: (list bal0 bal1 ...), each entry is a gnc-monetary object
 ;;
 ;; NOTE a prior incarnation accepted a #:ignore-closing? boolean
@@ -446,16 +490,29 @@
 ;; (and (not (xaccTransGetIsClosingTxn (xaccSplitGetParent s)))
 ;; (xaccSplitGetAmount s)))
 (define* (gnc:account-get-balances-at-dates
-          account dates-list #:key (split->amount xaccSplitGetAmount))
+          account dates-list #:key (split->amount #f))
   (define (amount->monetary bal)
     (gnc:make-gnc-monetary (xaccAccountGetCommodity account) (or bal 0)))
   (define balance 0)
   (map amount->monetary
-       (gnc:account-accumulate-at-dates
-        account dates-list #:split->elt
-        (lambda (s)
-          (if s (set! balance (+ balance (or (split->amount s) 0))))
-          balance))))
+       (if split->amount
+           (gnc:account-accumulate-at-dates
+            account dates-list #:split->elt
+            (lambda (s)
+              (if s (set! balance (+ balance (or (split->amount s) 0))))
+              balance))
+           (xaccAccountGetBalancesAtDates
+            account ACCOUNT-BALANCE-TOTAL (sort dates-list <)))))
+
+;; the split running balances which xaccAccountGetBalancesAtDates can
+;; look up without calling back into scheme for each split.
+(define (split->elt->balance-kind split->elt)
+  (cond
+   ((eq? split->elt xaccSplitGetBalance) ACCOUNT-BALANCE-TOTAL)
+   ((eq? split->elt xaccSplitGetNoclosingBalance) ACCOUNT-BALANCE-NOCLOSING)
+   ((eq? split->elt xaccSplitGetClearedBalance) ACCOUNT-BALANCE-CLEARED)
+   ((eq? split->elt xaccSplitGetReconciledBalance) ACCOUNT-BALANCE-RECONCILED)
+   (else #f)))
 
 
 ;; this function will scan through account splitlist, building a list
@@ -469,7 +526,9 @@
 ;;                  split in the account until the last date. the result
 ;;                  will be accumulated onto the resulting list. the default
 ;;                  xaccSplitGetBalance makes it similar to
-;;                  gnc:account-get-balances-at-dates.
+;;                  gnc:account-get-balances-at-dates. xaccSplitGetBalance
+;;                  and the other split running balance getters are
+;;                  looked up natively in a single pass.
 ;; out: (list elt0 elt1 ...), each entry is the result of split->elt
 ;;      or nosplit->elt
 (define* (gnc:account-accumulate-at-dates
@@ -479,55 +538,63 @@
           (split->elt xaccSplitGetBalance))
   (define to-date (or split->date (compose xaccTransGetDate xaccSplitGetParent)))
   (define (less? a b) (< (to-date a) (to-date b)))
-
-  (let lp ((splits (if split->date
-                       (stable-sort! (xaccAccountGetSplitList acc) less?)
-                       (xaccAccountGetSplitList acc)))
-           (dates (sort dates <))
-           (result '())
-           (last-result nosplit->elt))
-    (match dates
-
-      ;; end of dates. job done!
-      (() (reverse result))
-
-      ((date . rest)
-       (define (before-date? s) (<= (to-date s) date))
-       (define (after-date? s) (< date (to-date s)))
-       (cond
-
-        ;; end of splits, but still has dates. pad with last-result
-        ;; until end of dates.
-        ((null? splits) (lp '() rest (cons last-result result) last-result))
-
-        ;; the next split is still before date.
-        ((and (pair? (cdr splits)) (before-date? (cadr splits)))
-         (lp (cdr splits) dates result (split->elt (car splits))))
-
-        ;; head split after date, accumulate previous result
-        ((after-date? (car splits))
-         (lp splits rest (cons last-result result) last-result))
-
-        ;; head split before date, next split after date, or end.
-        (else
-         (let ((head-result (split->elt (car splits))))
-           (lp (cdr splits) rest (cons head-result result) head-result))))))))
+  (define balance-kind (and (not split->date)
+                            (split->elt->balance-kind split->elt)))
+
+  (if balance-kind
+      (let lp ((balances (xaccAccountGetBalancesAtDates
+                          acc balance-kind (sort dates <))))
+        ;; dates before the first split come back as #f
+        (match balances
+          ((#f . rest) (cons nosplit->elt (lp rest)))
+          (_ balances)))
+
+      (let lp ((splits (if split->date
+                           (stable-sort! (xaccAccountGetSplitList acc) less?)
+                           (xaccAccountGetSplitList acc)))
+               (dates (sort dates <))
+               (result '())
+               (last-result nosplit->elt))
+        (match dates
+
+          ;; end of dates. job done!
+          (() (reverse result))
+
+          ((date . rest)
+           (define (before-date? s) (<= (to-date s) date))
+           (define (after-date? s) (< date (to-date s)))
+           (cond
+
+            ;; end of splits, but still has dates. pad with last-result
+            ;; until end of dates.
+            ((null? splits) (lp '() rest (cons last-result result) last-result))
+
+            ;; the next split is still before date.
+            ((and (pair? (cdr splits)) (before-date? (cadr splits)))
+             (lp (cdr splits) dates result (split->elt (car splits))))
+
+            ;; head split after date, accumulate previous result
+            ((after-date? (car splits))
+             (lp splits rest (cons last-result result) last-result))
+
+            ;; head split before date, next split after date, or end.
+            (else
+             (let ((head-result (split->elt (car splits))))
+               (lp (cdr splits) rest (cons head-result result) head-result)))))))))
 
 ;; This works similar as above but returns a commodity-collector, 
 ;; thus takes care of children accounts with different currencies.
 (define (gnc:account-get-comm-balance-at-date
          account date include-children?)
-  (let ((balance-collector (gnc:make-commodity-collector))
-        (accounts (cons account
-                        (if include-children?
-                            (gnc-account-get-descendants account)
-                            '()))))
-    (for-each
-     (lambda (acct)
-       (balance-collector 'add
-                          (xaccAccountGetCommodity acct)
-                          (xaccAccountGetBalanceAsOfDate acct date)))
-     accounts)
+  (let ((balance-collector (gnc:make-commodity-collector)))
+    (define (add-balance acct)
+      (balance-collector 'add
+                         (xaccAccountGetCommodity acct)
+                         (xaccAccountGetBalanceAsOfDate acct date)))
+    (add-balance account)
+    (if include-children?
+        (gnc:iterator-for-each add-balance
+                               (gnc:account-descendant-iterator account)))
     balance-collector))
 
 ;; Calculate the increase in the balance of the account in terms of
@@ -739,7 +806,7 @@ query instead.")
 
 ;; function to count the total number of splits to be iterated
 (define (gnc:accounts-count-splits accounts)
-  (apply + (map length (map xaccAccountGetSplitList accounts))))
+  (apply + (map (cut xaccAccountCountSplits <> #f) accounts)))
 
 ;; Sums up any splits of a certain type affecting a set of accounts.
 ;; the type is an alist '((str "match me") (cased #f) (regexp #f))
@@ -1257,7 +1324,8 @@ query instead.")
              (gnc-account-get-full-name acc)
              (gnc-commodity-get-mnemonic (xaccAccountGetCommodity acc))
              (xaccAccountGetTypeStr (xaccAccountGetType acc)))
-     (for-each (cut gnc:dump-split <> #f) (xaccAccountGetSplitList acc))
+     (gnc:iterator-for-each (cut gnc:dump-split <> #f)
+                            (gnc:account-split-iterator acc))
      (format #t "         Balance: ~a Cleared: ~a Reconciled: ~a\n"
              (gnc:monetary->string
               (gnc:make-gnc-monetary
@@ -1281,8 +1349,13 @@ query instead.")
                            (gnc-account-get-descendants-sorted
                             (gnc-get-current-root-account))))
          (inv-txns (filter (lambda (t) (eqv? (xaccTransGetTxnType t) TXN-TYPE-INVOICE))
-                           (map xaccSplitGetParent
-                                (append-map xaccAccountGetSplitList acc-APAR))))
+                           (append-map
+                            (lambda (acc)
+                              (reverse
+                               (gnc:iterator-fold
+                                (lambda (split txns) (cons (xaccSplitGetParent split) txns))
+                                '() (gnc:account-split-iterator acc))))
+                            acc-APAR)))
          (invoices (map gncInvoiceGetInvoiceFromTxn inv-txns)))
     (define (maybe-date time64)         ;handle INT-MAX differently
       (if (= 9223372036854775807 time64) "?" (qof-print-date time64)))
@@ -28,7 +28,6 @@
 (define-module (gnucash reports standard new-aging))
 
 (use-modules (srfi srfi-1))
-(use-modules (srfi srfi-11))            ;let-values
 (use-modules (ice-9 match))
 (use-modules (gnucash utilities))
 (use-modules (gnucash engine))
@@ -66,15 +65,6 @@ exist but have no suitable transactions."))
 
 (define num-buckets 6)
 
-(define (setup-query query accounts date)
-  (qof-query-set-book query (gnc-get-current-book))
-  (xaccQueryAddClearedMatch
-   query (logand CLEARED-ALL (lognot CLEARED-VOIDED)) QOF-QUERY-AND)
-  (xaccQueryAddAccountMatch query accounts QOF-GUID-MATCH-ANY QOF-QUERY-AND)
-  (xaccQueryAddDateMatchTT query #f 0 #t date QOF-QUERY-AND)
-  (qof-query-set-sort-order query (list SPLIT-TRANS TRANS-DATE-POSTED) '() '())
-  (qof-query-set-sort-increasing query #t #t #t))
-
 (define (aging-options-generator options)
   (let* ((add-option
           (lambda (new-option)
@@ -152,24 +142,6 @@ exist but have no suitable transactions."))
     (fold-right (lambda (opt elt prev) (if opt (cons elt prev) prev))
                 '() address-list-options result-list)))
 
-(define (split-is-not-business? split)
-  (let ((type (xaccTransGetTxnType (xaccSplitGetParent split))))
-    (not (or (eqv? type TXN-TYPE-INVOICE)
-             (eqv? type TXN-TYPE-PAYMENT)))))
-
-(define (split-has-owner? split owner)
-  (gncOwnerEqual (gnc:split->owner split) owner))
-
-(define (split-owner-is-invalid? split)
-  (not (gncOwnerIsValid (gnc:split->owner split))))
-
-(define (split-from-acct? split acct)
-  (equal? acct (xaccSplitGetAccount split)))
-
-(define (list-split lst fn cmp)
-  (let-values (((list-yes list-no) (partition (lambda (elt) (fn elt cmp)) lst)))
-    (cons list-yes list-no)))
-
 (define (aging-renderer report-obj receivable)
   (define options (gnc:report-options report-obj))
   (define (op-value section name)
@@ -197,7 +169,6 @@ exist but have no suitable transactions."))
          (sort-by (op-value gnc:pagename-general optname-sort-by))
          (show-zeros (op-value gnc:pagename-general optname-show-zeros))
          (date-type (op-value gnc:pagename-general optname-date-driver))
-         (query (qof-query-create-for-splits))
          (document (gnc:make-html-document)))
 
     (define (sort-aging<? a b)
@@ -227,165 +198,136 @@ exist but have no suitable transactions."))
        document (gnc:make-html-text no-APAR-account)))
 
      (else
-      (setup-query query accounts report-date)
-      (let* ((splits (xaccQueryGetSplitsUniqueTrans query)))
-        (qof-query-destroy query)
-
-        ;; split->owner hashtable should be empty at the start of
-        ;; report renderer. clear it anyway.
-        (gnc:split->owner #f)
-
-        ;; loop into each APAR account
-        (let loop ((accounts accounts)
-                   (splits splits)
-                   (accounts-and-owners '())
-                   (invalid-splits '()))
-          (cond
-           ((null? accounts)
+      ;; the engine ages all owners of the accounts at once, from an
+      ;; index of their documents it keeps up to date
+      (match-let* (((accounts-aging . invalid)
+                    (gnc-owner-aging-scm accounts report-date num-buckets
+                                         (eq? date-type 'duedate) receivable))
+                   (accounts-and-owners
+                    (filter-map
+                     (match-lambda
+                       ((account owners-aging)
+                        (let lp ((owners-aging owners-aging)
+                                 (acc-totals (make-list (1+ num-buckets) 0))
+                                 (owners-and-aging '()))
+                          (match owners-aging
+                            (() (and (pair? owners-and-aging)
+                                     (list account owners-and-aging acc-totals)))
+                            (((owner . aging) . rest)
+                             (let ((aging-total (apply + aging)))
+                               (lp rest
+                                   (map + acc-totals (reverse (cons aging-total aging)))
+                                   (if (or show-zeros (any (negate zero?) aging))
+                                       (cons (list owner aging aging-total)
+                                             owners-and-aging)
+                                       owners-and-aging))))))))
+                     accounts-aging))
+                   (invalid-splits
+                    (map
+                     (match-lambda
+                       ((split . 'no-owner)
+                        (list (G_ "Payment has no owner") split))
+                       ((split . _)
+                        (let ((type (xaccTransGetTxnType (xaccSplitGetParent split))))
+                          (list (format #f (G_ "Invalid Txn Type ~a") type) split))))
+                     invalid)))
+
+        (cond
+         ((null? accounts-and-owners)
+          (gnc:html-document-add-object!
+           document (gnc:make-html-text empty-APAR-accounts)))
+
+         (else
+          (let ((table (gnc:make-html-table))
+                (accounts>1? (> (length accounts-and-owners) 1)))
+
+            (gnc:html-table-set-col-headers!
+             table (append (if accounts>1? '(#f) '())
+                           make-heading-list
+                           (options->address options receivable #f)))
+
+            (for-each
+             (lambda (account-and-owners)
+               (let* ((account (car account-and-owners))
+                      (owners-and-aging (cadr account-and-owners))
+                      (acc-totals (caddr account-and-owners))
+                      (comm (xaccAccountGetCommodity account)))
+
+                 (when accounts>1?
+                   (gnc:html-table-append-row!
+                    table (list (gnc:make-html-table-cell/size
+                                 1 (+ 2 num-buckets)
+                                 (gnc:make-html-text
+                                  (gnc:html-markup-anchor
+                                   (gnc:account-anchor-text account)
+                                   (xaccAccountGetName account)))))))
+
+                 (for-each
+                  (lambda (owner-and-aging)
+                    (let ((owner (car owner-and-aging))
+                          (aging (cadr owner-and-aging))
+                          (aging-total (caddr owner-and-aging)))
+
+                      (gnc:html-table-append-row!
+                       table
+                       (append
+                        (if accounts>1? '(#f) '())
+                        (cons
+                         (gnc:make-html-text
+                          (gnc:html-markup-anchor
+                           (gnc:owner-anchor-text owner)
+                           (gncOwnerGetName owner)))
+                         (map
+                          (lambda (amt)
+                            (gnc:make-html-table-cell/markup
+                             "number-cell" (gnc:make-gnc-monetary comm amt)))
+                          (reverse aging)))
+                        (list
+                         (gnc:make-html-table-cell/markup
+                          "number-cell"
+                          (gnc:make-html-text
+                           (gnc:html-markup-anchor
+                            (gnc:owner-report-text owner account report-date)
+                            (gnc:make-gnc-monetary comm aging-total)))))
+                        (options->address options receivable owner)))))
+                  (sort owners-and-aging sort-aging<?))
+
+                 (gnc:html-table-append-row!
+                  table
+                  (append
+                   (if accounts>1? '(#f) '())
+                   (list (gnc:make-html-table-cell/markup
+                          "total-label-cell" (G_ "Total")))
+                   (map
+                    (lambda (amt)
+                      (gnc:make-html-table-cell/markup
+                       "total-number-cell" (gnc:make-gnc-monetary comm amt)))
+                    acc-totals)))))
+             accounts-and-owners)
+
+            (gnc:html-document-add-object! document table)
+
+            (unless (null? invalid-splits)
+              (gnc:html-document-add-object!
+               document (gnc:make-html-text (gnc:html-markup-br)))
 
-            (cond
-             ((null? accounts-and-owners)
               (gnc:html-document-add-object!
-               document (gnc:make-html-text empty-APAR-accounts)))
-
-             (else
-              (let ((table (gnc:make-html-table))
-                    (accounts>1? (> (length accounts-and-owners) 1)))
-
-                (gnc:html-table-set-col-headers!
-                 table (append (if accounts>1? '(#f) '())
-                               make-heading-list
-                               (options->address options receivable #f)))
-
-                (for-each
-                 (lambda (account-and-owners)
-                   (let* ((account (car account-and-owners))
-                          (owners-and-aging (cadr account-and-owners))
-                          (acc-totals (caddr account-and-owners))
-                          (comm (xaccAccountGetCommodity account)))
-
-                     (when accounts>1?
-                       (gnc:html-table-append-row!
-                        table (list (gnc:make-html-table-cell/size
-                                     1 (+ 2 num-buckets)
-                                     (gnc:make-html-text
-                                      (gnc:html-markup-anchor
-                                       (gnc:account-anchor-text account)
-                                       (xaccAccountGetName account)))))))
-
-                     (for-each
-                      (lambda (owner-and-aging)
-                        (let ((owner (car owner-and-aging))
-                              (aging (cadr owner-and-aging))
-                              (aging-total (caddr owner-and-aging)))
-
-                          (gnc:html-table-append-row!
-                           table
-                           (append
-                            (if accounts>1? '(#f) '())
-                            (cons
-                             (gnc:make-html-text
-                              (gnc:html-markup-anchor
-                               (gnc:owner-anchor-text owner)
-                               (gncOwnerGetName owner)))
-                             (map
-                              (lambda (amt)
-                                (gnc:make-html-table-cell/markup
-                                 "number-cell" (gnc:make-gnc-monetary comm amt)))
-                              (reverse aging)))
-                            (list
-                             (gnc:make-html-table-cell/markup
-                              "number-cell"
-                              (gnc:make-html-text
-                               (gnc:html-markup-anchor
-                                (gnc:owner-report-text owner account report-date)
-                                (gnc:make-gnc-monetary comm aging-total)))))
-                            (options->address options receivable owner)))))
-                      (sort owners-and-aging sort-aging<?))
-
-                     (gnc:html-table-append-row!
-                      table
-                      (append
-                       (if accounts>1? '(#f) '())
-                       (list (gnc:make-html-table-cell/markup
-                              "total-label-cell" (G_ "Total")))
-                       (map
-                        (lambda (amt)
-                          (gnc:make-html-table-cell/markup
-                           "total-number-cell" (gnc:make-gnc-monetary comm amt)))
-                        acc-totals)))))
-                 (reverse accounts-and-owners))
-
-                (gnc:split->owner #f)       ;free the gncOwners
-                (gnc:html-document-add-object! document table)
-
-                (unless (null? invalid-splits)
-                  (gnc:html-document-add-object!
-                   document (gnc:make-html-text (gnc:html-markup-br)))
-
-                  (gnc:html-document-add-object!
-                   document
-                   (gnc:make-html-text
-                    (G_ "Please note some transactions were not processed")
-                    (gnc:html-markup-ol
-                     (map
-                      (lambda (invalid-split)
-                        (gnc:html-markup-anchor
-                         (gnc:split-anchor-text (cadr invalid-split))
-                         (car invalid-split)))
-                      invalid-splits)))))))))
-
-           (else
-            (let* ((account (car accounts))
-                   (splits-acc-others (list-split splits split-from-acct? account)))
-
-              (let lp ((acc-splits (car splits-acc-others))
-                       (acc-totals (make-list (1+ num-buckets) 0))
-                       (invalid-splits invalid-splits)
-                       (owners-and-aging '()))
-
-                (match acc-splits
-                  (()
-                   (loop (cdr accounts)
-                         (cdr splits-acc-others)
-                         (if (null? owners-and-aging)
-                             accounts-and-owners
-                             (cons (list account owners-and-aging acc-totals)
-                                   accounts-and-owners))
-                         invalid-splits))
-
-                  ;; txn type != TXN_TYPE_INVOICE or TXN_TYPE_PAYMENT.
-                  (((? split-is-not-business? this) . rest)
-                   (let ((type (xaccTransGetTxnType (xaccSplitGetParent this))))
-                     (lp rest
-                         acc-totals
-                         (cons (list (format #f (G_ "Invalid Txn Type ~a") type) this)
-                               invalid-splits)
-                         owners-and-aging)))
-
-                  ;; some payment splits may have no owner in this
-                  ;; account. skip. see bug 797506.
-                  (((? split-owner-is-invalid? this) . rest)
-                   (gnc:warn "split " this " has no owner")
-                   (lp rest
-                       acc-totals
-                       (cons (list (G_ "Payment has no owner") this) invalid-splits)
-                       owners-and-aging))
-
-                  ((this . _)
-                   (match-let* ((owner (gnc:split->owner this))
-                                ((owner-splits . other-owner-splits)
-                                 (list-split acc-splits split-has-owner? owner))
-                                (aging (gnc:owner-splits->aging-list
-                                        owner-splits num-buckets report-date
-                                        date-type receivable))
-                                (aging-total (apply + aging)))
-                     (lp other-owner-splits
-                         (map + acc-totals (reverse (cons aging-total aging)))
-                         invalid-splits
-                         (if (or show-zeros (any (negate zero?) aging))
-                             (cons (list owner aging aging-total) owners-and-aging)
-                             owners-and-aging)))))))))))))
+               document
+               (gnc:make-html-text
+                (G_ "Please note some transactions were not processed")
+                (gnc:html-markup-ol
+                 (map
+                  (lambda (invalid-split)
+                    (gnc:html-markup-anchor
+                     (gnc:split-anchor-text (cadr invalid-split))
+                     (car invalid-split)))
+                  invalid-splits))))))))
+
+        ;; free the gncOwners
+        (for-each
+         (match-lambda
+           ((account owners-aging) (for-each (compose gncOwnerFree car) owners-aging)))
+         accounts-aging))))
     (gnc:report-finished)
     document))
 
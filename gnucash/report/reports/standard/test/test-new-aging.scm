@@ -0,0 +1,223 @@
+(use-modules (gnucash core-utils))
+(use-modules (gnucash app-utils))
+(use-modules (gnucash engine))
+(use-modules (tests test-engine-extras))
+(use-modules (gnucash reports standard new-aging))
+(use-modules (gnucash report stylesheets plain)) ; For the default stylesheet, required for rendering
+(use-modules (gnucash report))
+(use-modules (gnucash reports))
+(use-modules (tests test-report-extras))
+(use-modules (srfi srfi-1))
+(use-modules (srfi srfi-11))
+(use-modules (srfi srfi-64))
+(use-modules (tests srfi64-extras))
+(use-modules (sxml simple))
+(use-modules (sxml xpath))
+
+(define uuid "9cf76bed17f14401b8e3e22d0079cb98") ;receivable aging
+
+(setlocale LC_ALL "C")
+
+(define (run-test)
+  (test-runner-factory gnc:test-runner)
+  (test-begin "test-new-aging")
+  (aging-tests)
+  (test-end "test-new-aging"))
+
+(define (set-option! options section name value)
+  (let ((option (gnc:lookup-option options section name)))
+    (if option
+        (gnc:option-set-value option value)
+        (test-assert (format #f "wrong-option ~a ~a" section name) #f))))
+
+(define (get-currency sym)
+  (gnc-commodity-table-lookup
+   (gnc-commodity-table-get-table (gnc-get-current-book))
+   (gnc-commodity-get-namespace (gnc-default-report-currency))
+   sym))
+
+(define structure
+  (list "Root" (list (cons 'type ACCT-TYPE-ASSET)
+                     (cons 'commodity (get-currency "USD")))
+        (list "Asset"
+              (list "Bank-USD"))
+        (list "Income" (list (cons 'type ACCT-TYPE-INCOME))
+              (list "Income-USD"))
+        (list "A/Receivable" (list (cons 'type ACCT-TYPE-RECEIVABLE))
+              (list "AR-USD"))))
+
+(define (aging-tests)
+  (let* ((env (create-test-env))
+         (account-alist (env-create-account-structure-alist env structure))
+         (get-acct (lambda (name)
+                     (or (assoc-ref account-alist name)
+                         (error "invalid account name" name))))
+         (AR (get-acct "AR-USD"))
+         (Bank (get-acct "Bank-USD"))
+         (date (gnc-dmy2time64 30 06 1980)))
+
+    (define (make-owner id)
+      (let ((cust (gncCustomerCreate (gnc-get-current-book)))
+            (owner (gncOwnerNew)))
+        (gncCustomerSetID cust (string-append id "-id"))
+        (gncCustomerSetName cust (string-append id "-name"))
+        (gncCustomerSetCurrency cust (get-currency "USD"))
+        (gncOwnerInitCustomer owner cust)
+        owner))
+
+    (define cust-1 (make-owner "cust-1"))
+    (define cust-2 (make-owner "cust-2"))
+
+    (define (add-invoice owner posted due amount)
+      (let ((inv (gncInvoiceCreate (gnc-get-current-book)))
+            (entry (gncEntryCreate (gnc-get-current-book))))
+        (gncInvoiceSetOwner inv owner)
+        (gncInvoiceSetCurrency inv (get-currency "USD"))
+        (gncEntrySetDateGDate entry (time64-to-gdate posted))
+        (gncEntrySetInvAccount entry (get-acct "Income-USD"))
+        (gncEntrySetDocQuantity entry 1 #f)
+        (gncEntrySetInvPrice entry amount)
+        (gncInvoiceAddEntry inv entry)
+        (gncInvoicePostToAccount inv AR posted due "" #t #f)
+        inv))
+
+    (define (create-split-for-lot account amount lot)
+      (let ((split (xaccMallocSplit (gnc-get-current-book))))
+        (xaccSplitSetAccount split account)
+        (xaccSplitSetAmount split amount)
+        (xaccSplitSetValue split amount)
+        (when lot
+          (gnc-lot-add-split lot split))
+        split))
+
+    (define (create-multisplit DD MM YY type splits)
+      (let ((txn (xaccMallocTransaction (gnc-get-current-book))))
+        (xaccTransBeginEdit txn)
+        (xaccTransSetCurrency txn (get-currency "USD"))
+        (xaccTransSetDate txn DD MM YY)
+        (xaccTransSetTxnType txn type)
+        (for-each (lambda (s) (xaccSplitSetParent s txn)) splits)
+        (xaccTransCommitEdit txn)
+        txn))
+
+    ;; The owners' names and buckets as the engine ages them.
+    (define (engine-aging date date-type)
+      (let ((accounts-aging
+             (car (gnc-owner-aging-scm (list AR) date 6
+                                       (eq? date-type 'duedate) #t))))
+        (if (null? accounts-aging)
+            '()
+            (map
+             (lambda (owner-and-aging)
+               (cons (gncOwnerGetName (car owner-and-aging))
+                     (cdr owner-and-aging)))
+             (cadr (car accounts-aging))))))
+
+    ;; The same, from the account's splits as the aging report found
+    ;; them before the engine aged them.
+    (define (scheme-aging date date-type)
+      (let ((query (qof-query-create-for-splits)))
+        (qof-query-set-book query (gnc-get-current-book))
+        (xaccQueryAddClearedMatch
+         query (logand CLEARED-ALL (lognot CLEARED-VOIDED)) QOF-QUERY-AND)
+        (xaccQueryAddAccountMatch query (list AR) QOF-GUID-MATCH-ANY QOF-QUERY-AND)
+        (xaccQueryAddDateMatchTT query #f 0 #t date QOF-QUERY-AND)
+        (qof-query-set-sort-order query (list SPLIT-TRANS TRANS-DATE-POSTED) '() '())
+        (qof-query-set-sort-increasing query #t #t #t)
+        (let lp ((splits (xaccQueryGetSplitsUniqueTrans query))
+                 (result '()))
+          (cond
+           ((null? splits)
+            (qof-query-destroy query)
+            (gnc:split->owner #f)
+            (reverse result))
+           (else
+            (let ((owner (gnc:split->owner (car splits))))
+              (let-values (((owner-splits other-splits)
+                            (partition
+                             (lambda (split)
+                               (gncOwnerEqual (gnc:split->owner split) owner))
+                             splits)))
+                (lp other-splits
+                    (cons (cons (gncOwnerGetName owner)
+                                (gnc:owner-splits->aging-list
+                                 owner-splits 6 date date-type #t))
+                          result)))))))))
+
+    (define (test-aging title)
+      (for-each
+       (lambda (date-type)
+         (for-each
+          (lambda (date)
+            (test-equal (format #f "~a, ~a as of ~a" title date-type
+                                (qof-print-date date))
+              (scheme-aging date date-type)
+              (engine-aging date date-type)))
+          (list date (gnc-dmy2time64 15 04 1980) (gnc-dmy2time64 21 06 1980))))
+       '(postdate duedate)))
+
+    (test-begin "aging")
+
+    (test-equal "no invoices"
+      '()
+      (engine-aging date 'postdate))
+    (test-aging "no invoices")
+
+    (let* ((inv-a (add-invoice cust-1 (gnc-dmy2time64 13 01 1980)
+                               (gnc-dmy2time64 12 02 1980) 23/2))
+           (inv-b (add-invoice cust-2 (gnc-dmy2time64 20 05 1980)
+                               (gnc-dmy2time64 19 06 1980) 27/4))
+           (inv-c (add-invoice cust-1 (gnc-dmy2time64 10 06 1980)
+                               (gnc-dmy2time64 10 07 1980) 28)))
+
+      (test-equal "invoices posted"
+        (list (cons "cust-1-name" (list 23/2 0 0 28 0 0))
+              (cons "cust-2-name" (list 0 0 27/4 0 0 0)))
+        (engine-aging date 'postdate))
+      (test-aging "invoices posted")
+
+      (gncInvoiceApplyPayment inv-a '() Bank 3/2 1
+                              (gnc-dmy2time64 18 03 1980) "" "")
+      (gncInvoiceApplyPayment inv-c '() Bank 8 1
+                              (gnc-dmy2time64 20 06 1980) "" "")
+      (test-equal "invoices paid"
+        (list (cons "cust-1-name" (list 10 0 0 20 0 0))
+              (cons "cust-2-name" (list 0 0 27/4 0 0 0)))
+        (engine-aging date 'postdate))
+      (test-aging "invoices paid")
+
+      ;; a payment with no invoice to pay is a prepayment
+      (let ((lot (gnc-lot-new (gnc-get-current-book))))
+        (gncOwnerAttachToLot cust-2 lot)
+        (create-multisplit
+         25 06 1980 TXN-TYPE-PAYMENT
+         (list (create-split-for-lot AR -10 lot)
+               (create-split-for-lot Bank 10 #f))))
+      (test-equal "prepayment"
+        (list (cons "cust-1-name" (list 10 0 0 20 0 0))
+              (cons "cust-2-name" (list 0 0 27/4 0 0 -10)))
+        (engine-aging date 'postdate))
+      (test-aging "prepayment")
+
+      ;; the payment of an unposted invoice becomes a prepayment
+      (gncInvoiceUnpost inv-c #t)
+      (test-equal "invoice unposted"
+        (list (cons "cust-1-name" (list 10 0 0 0 0 -8))
+              (cons "cust-2-name" (list 0 0 27/4 0 0 -10)))
+        (engine-aging date 'postdate))
+      (test-aging "invoice unposted")
+
+      (gncInvoiceUnpost inv-a #t)
+      (test-aging "both invoices unposted"))
+
+    (test-end "aging")
+
+    (test-begin "report")
+    (let ((options (gnc:make-report-options uuid)))
+      (set-option! options "General" "To" (cons 'absolute date))
+      (set-option! options "General" "Due or Post Date" 'postdate)
+      (let ((sxml (gnc:options->sxml uuid options "test-new-aging" "owners")))
+        (test-assert "owners are listed"
+          (lset<= equal? '("cust-1-name" "cust-2-name")
+                  ((sxpath '(// a *text*)) sxml)))))
+    (test-end "report")))
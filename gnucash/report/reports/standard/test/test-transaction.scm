@@ -809,6 +809,43 @@
 
     (test-end "sorting options")
 
+    (test-begin "subtotal breaks")
+
+    ;; Both keys subtotalled: each primary group closes the secondary
+    ;; group it ends in, so the primary subtotal follows the last
+    ;; secondary one.
+    (let ((options (default-testing-options)))
+      (set-option! options "Accounts" "Accounts" (list bank expense))
+      (set-option! options "General" "Start Date" (cons 'absolute (gnc-dmy2time64 01 01 1969)))
+      (set-option! options "General" "End Date" (cons 'absolute (gnc-dmy2time64 31 12 1970)))
+      (set-option! options "Display" "Totals" #t)
+      (set-option! options "Sorting" "Add indenting columns" #t)
+      (set-option! options "Sorting" "Show subtotals only (hide transactional data)" #t)
+      (set-option! options "Sorting" "Primary Key" 'account-name)
+      (set-option! options "Sorting" "Primary Subtotal" #t)
+      (set-option! options "Sorting" "Secondary Key" 'date)
+      (set-option! options "Sorting" "Secondary Subtotal for Date Key" 'monthly)
+      (let ((sxml (options->sxml options "primary=account-name, secondary=monthly")))
+        (test-equal "account subtotals follow their monthly subtotals"
+          '("$29.00" "-$5.00" "-$23.00" "$1.00"
+            "$16.00" "$15.00" "$31.00"
+            "$32.00")
+          (get-row-col sxml #f -1)))
+
+      (set-option! options "Sorting" "Primary Key" 'date)
+      (set-option! options "Sorting" "Primary Subtotal for Date Key" 'monthly)
+      (set-option! options "Sorting" "Secondary Key" 'account-name)
+      (set-option! options "Sorting" "Secondary Subtotal" #t)
+      (let ((sxml (options->sxml options "primary=monthly, secondary=account-name")))
+        (test-equal "monthly subtotals follow their account subtotals"
+          '("$29.00" "$29.00"
+            "-$5.00" "$16.00" "$11.00"
+            "-$23.00" "$15.00" "-$8.00"
+            "$32.00")
+          (get-row-col sxml #f -1))))
+
+    (test-end "subtotal breaks")
+
     (test-begin "subtotal table")
 
     (let ((options (default-testing-options)))
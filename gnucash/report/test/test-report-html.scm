@@ -786,6 +786,30 @@ HTML Document Title</title></head><body></body>\n\
             (gnc:html-table-render table1 doc))))))
     (test-end "html-table arbitrary row/col modification")
 
+    (test-begin "html-document render to port")
+    (let ((doc (gnc:make-html-document))
+          (table (gnc:make-html-table)))
+      (gnc:html-table-append-row! table '("Row 1" "Col A"))
+      (gnc:html-table-append-row! table '("Row 2" "Col B"))
+      (gnc:html-document-add-object! doc "before")
+      (gnc:html-document-add-object! doc table)
+      (test-equal "render-to-port writes what render returns"
+        (gnc:html-document-render doc)
+        (call-with-output-string
+          (lambda (port) (gnc:html-document-render-to-port doc port))))
+      (test-equal "render-to-port without headers"
+        (gnc:html-document-render doc #f)
+        (call-with-output-string
+          (lambda (port) (gnc:html-document-render-to-port doc port #f))))
+      (test-assert "no export writer"
+        (not (gnc:html-document-write-export doc (%make-void-port "w"))))
+      (gnc:html-document-set-export-writer
+       doc (lambda (port) (display "a,b" port)))
+      (test-equal "export-string runs the export writer"
+        "a,b"
+        (gnc:html-document-export-string doc)))
+    (test-end "html-document render to port")
+
     (test-begin "html-table-cell renderers")
     (let ((doc (gnc:make-html-document))
           (cell (gnc:make-html-table-cell 4)))
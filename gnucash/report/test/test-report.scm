@@ -1,6 +1,7 @@
 (use-modules (gnucash app-utils))
 (use-modules (gnucash report))
 (use-modules (srfi srfi-64))
+(use-modules (ice-9 match))
 (use-modules (tests test-engine-extras))
 (use-modules (tests srfi64-extras))
 
@@ -18,6 +19,7 @@
   (test-report-template-getters)
   (test-make-report)
   (test-report)
+  (test-cmdline-run-report)
   (test-end "Testing/Temporary/test-report"))
 
 (define test4-guid "54c2fc051af64a08ba2334c2e9179e24")
@@ -237,3 +239,59 @@
     (test-assert "gnc:report-serialize = string"
       (string?
        (gnc:report-serialize report)))))
+
+(define (test-cmdline-run-report)
+  (define test-uuid "cmdline-report-guid")
+  (define (options-generator)
+    (let ((options (gnc:new-options)))
+      (gnc:register-option
+       options
+       (gnc:make-string-option "General" "Greeting" "a" "Greeting" "hello"))
+      options))
+  (gnc:define-report
+   'version 1
+   'name "cmdline report"
+   'report-guid test-uuid
+   'options-generator options-generator
+   'renderer (lambda (obj)
+               (string-append
+                "<p>"
+                (gnc:option-value
+                 (gnc:lookup-option (gnc:report-options obj) "General" "Greeting"))
+                "</p>")))
+  (test-begin "gnc:cmdline-run-report")
+  (test-equal "default options"
+    (list "<p>hello</p>" #f)
+    (gnc:cmdline-run-report "cmdline report" #f '()))
+  (test-equal "option settings, by guid"
+    (list "<p>bonjour</p>" #f)
+    (gnc:cmdline-run-report test-uuid #f '(("General" "Greeting" . "\"bonjour\""))))
+  (let* ((result #f)
+         (output (call-with-output-string
+                   (lambda (port)
+                     (set! result (gnc:cmdline-run-report
+                                   "cmdline report" #f
+                                   '(("General" "Greeting" . "\"hi\""))
+                                   port))))))
+    (test-equal "written to port"
+      (list #t #f)
+      result)
+    (test-equal "port output"
+      "<p>hi</p>"
+      output))
+  (test-equal "unknown option"
+    (list #f "No option \"Salutation\" in section \"General\"")
+    (gnc:cmdline-run-report "cmdline report" #f
+                            '(("General" "Salutation" . "\"hi\""))))
+  (test-assert "unreadable option value"
+    (match (gnc:cmdline-run-report "cmdline report" #f
+                                   '(("General" "Greeting" . "(")))
+      ((#f (? string?)) #t)
+      (_ #f)))
+  (test-equal "unknown report"
+    (list #f "Cannot find \"no such report\"")
+    (gnc:cmdline-run-report "no such report" #f '()))
+  (test-equal "export type without export code"
+    (list #f "\"cmdline report\" has no export code")
+    (gnc:cmdline-run-report "cmdline report" "csv" '()))
+  (test-end "gnc:cmdline-run-report"))
@@ -61,6 +61,7 @@
 (export gnc:trep-options-generator)
 (export gnc:trep-renderer)
 (export gnc:lists->csv)
+(export gnc:write-lists-csv)
 
 ;; Define the strings here to avoid typos and make changes easier.
 
@@ -152,7 +153,7 @@ in the Options panel."))
 (define (sortkey-list split-action?)
   ;; Defines the different sorting keys, as an association-list
   ;; together with the subtotal functions. Each entry:
-  ;;  'sortkey             - sort parameter sent via qof-query
+  ;;  'split-key           - the GncSplitSortKey of the native split selection
   ;;  'split-sortvalue     - function retrieves number/string for comparing splits
   ;;  'text                - text displayed in Display tab
   ;;  'renderer-fn         - helper function to select subtotal/subheading renderer
@@ -162,32 +163,32 @@ in the Options panel."))
   ;;       otherwise it converts split->string
   ;;
   (list (list 'account-name
-              (cons 'sortkey (list SPLIT-ACCT-FULLNAME))
+              (cons 'split-key GNC-SPLIT-SORT-ACCOUNT-NAME)
               (cons 'split-sortvalue
                     (compose gnc-account-get-full-name xaccSplitGetAccount))
               (cons 'text (G_ "Account Name"))
               (cons 'renderer-fn xaccSplitGetAccount))
 
         (list 'account-code
-              (cons 'sortkey (list SPLIT-ACCOUNT ACCOUNT-CODE-))
+              (cons 'split-key GNC-SPLIT-SORT-ACCOUNT-CODE)
               (cons 'split-sortvalue (compose xaccAccountGetCode xaccSplitGetAccount))
               (cons 'text (G_ "Account Code"))
               (cons 'renderer-fn xaccSplitGetAccount))
 
         (list 'date
-              (cons 'sortkey (list SPLIT-TRANS TRANS-DATE-POSTED))
+              (cons 'split-key GNC-SPLIT-SORT-DATE)
               (cons 'split-sortvalue (compose xaccTransGetDate xaccSplitGetParent))
               (cons 'text (G_ "Date"))
               (cons 'renderer-fn #f))
 
         (list 'reconciled-date
-              (cons 'sortkey (list SPLIT-DATE-RECONCILED))
+              (cons 'split-key GNC-SPLIT-SORT-RECONCILED-DATE)
               (cons 'split-sortvalue xaccSplitGetDateReconciled)
               (cons 'text (G_ "Reconciled Date"))
               (cons 'renderer-fn #f))
 
         (list 'reconciled-status
-              (cons 'sortkey #f)
+              (cons 'split-key GNC-SPLIT-SORT-RECONCILED-STATUS)
               (cons 'split-sortvalue (lambda (s)
                                        (length (memv (xaccSplitGetReconcile s)
                                                      (map car reconcile-list)))))
@@ -197,31 +198,31 @@ in the Options panel."))
                                              (xaccSplitGetReconcile s)))))
 
         (list 'register-order
-              (cons 'sortkey (list QUERY-DEFAULT-SORT))
+              (cons 'split-key GNC-SPLIT-SORT-REGISTER-ORDER)
               (cons 'split-sortvalue #f)
               (cons 'text (G_ "Register Order"))
               (cons 'renderer-fn #f))
 
         (list 'corresponding-acc-name
-              (cons 'sortkey (list SPLIT-CORR-ACCT-NAME))
+              (cons 'split-key GNC-SPLIT-SORT-CORR-ACCOUNT-NAME)
               (cons 'split-sortvalue xaccSplitGetCorrAccountFullName)
               (cons 'text (G_ "Other Account Name"))
               (cons 'renderer-fn (compose xaccSplitGetAccount xaccSplitGetOtherSplit)))
 
         (list 'corresponding-acc-code
-              (cons 'sortkey (list SPLIT-CORR-ACCT-CODE))
+              (cons 'split-key GNC-SPLIT-SORT-CORR-ACCOUNT-CODE)
               (cons 'split-sortvalue xaccSplitGetCorrAccountCode)
               (cons 'text (G_ "Other Account Code"))
               (cons 'renderer-fn (compose xaccSplitGetAccount xaccSplitGetOtherSplit)))
 
         (list 'amount
-              (cons 'sortkey (list SPLIT-VALUE))
+              (cons 'split-key GNC-SPLIT-SORT-AMOUNT)
               (cons 'split-sortvalue xaccSplitGetValue)
               (cons 'text (G_ "Amount"))
               (cons 'renderer-fn #f))
 
         (list 'description
-              (cons 'sortkey (list SPLIT-TRANS TRANS-DESCRIPTION))
+              (cons 'split-key GNC-SPLIT-SORT-DESCRIPTION)
               (cons 'split-sortvalue (compose xaccTransGetDescription
                                               xaccSplitGetParent))
               (cons 'text (G_ "Description"))
@@ -229,37 +230,37 @@ in the Options panel."))
 
         (if split-action?
             (list 'number
-                  (cons 'sortkey (list SPLIT-ACTION))
+                  (cons 'split-key GNC-SPLIT-SORT-ACTION)
                   (cons 'split-sortvalue xaccSplitGetAction)
                   (cons 'text (G_ "Number/Action"))
                   (cons 'renderer-fn #f))
 
             (list 'number
-                  (cons 'sortkey (list SPLIT-TRANS TRANS-NUM))
+                  (cons 'split-key GNC-SPLIT-SORT-NUMBER)
                   (cons 'split-sortvalue (compose xaccTransGetNum xaccSplitGetParent))
                   (cons 'text (G_ "Number"))
                   (cons 'renderer-fn #f)))
 
         (list 't-number
-              (cons 'sortkey (list SPLIT-TRANS TRANS-NUM))
+              (cons 'split-key GNC-SPLIT-SORT-NUMBER)
               (cons 'split-sortvalue (compose xaccTransGetNum xaccSplitGetParent))
               (cons 'text (G_ "Transaction Number"))
               (cons 'renderer-fn #f))
 
         (list 'memo
-              (cons 'sortkey (list SPLIT-MEMO))
+              (cons 'split-key GNC-SPLIT-SORT-MEMO)
               (cons 'split-sortvalue xaccSplitGetMemo)
               (cons 'text (G_ "Memo"))
               (cons 'renderer-fn xaccSplitGetMemo))
 
         (list 'notes
-              (cons 'sortkey #f)
+              (cons 'split-key GNC-SPLIT-SORT-NOTES)
               (cons 'split-sortvalue (compose xaccTransGetNotes xaccSplitGetParent))
               (cons 'text (G_ "Notes"))
               (cons 'renderer-fn (compose xaccTransGetNotes xaccSplitGetParent)))
 
         (list 'none
-              (cons 'sortkey '())
+              (cons 'split-key GNC-SPLIT-SORT-NONE)
               (cons 'split-sortvalue #f)
               (cons 'text (G_ "None"))
               (cons 'renderer-fn #f))))
@@ -283,6 +284,7 @@ in the Options panel."))
 (define date-subtotal-list
   ;; List for date option.
   ;; Defines the different date sorting keys, as an association-list. Each entry:
+  ;;  'date-group          - the GncSplitDateGroup of the native split selection
   ;;  'split-sortvalue     - func retrieves number/string used for comparing splits
   ;;  'text                - text displayed in Display tab
   ;;  'renderer-fn         - func retrieves string for subtotal/subheading renderer
@@ -290,44 +292,44 @@ in the Options panel."))
   ;;         otherwise it converts split->string
   (list
    (list 'none
+         (cons 'date-group GNC-SPLIT-DATE-GROUP-NONE)
          (cons 'split-sortvalue #f)
-         (cons 'date-sortvalue #f)
          (cons 'text (G_ "None"))
          (cons 'renderer-fn #f))
 
    (list 'daily
+         (cons 'date-group GNC-SPLIT-DATE-GROUP-DAY)
          (cons 'split-sortvalue (lambda (s) (time64-day (split->time64 s))))
-         (cons 'date-sortvalue time64-day)
          (cons 'text (G_ "Daily"))
          (cons 'renderer-fn (lambda (s) (qof-print-date (split->time64 s)))))
 
    (list 'weekly
+         (cons 'date-group GNC-SPLIT-DATE-GROUP-WEEK)
          (cons 'split-sortvalue (lambda (s) (time64-week (split->time64 s))))
-         (cons 'date-sortvalue time64-week)
          (cons 'text (G_ "Weekly"))
          (cons 'renderer-fn (compose gnc:date-get-week-year-string
                                      gnc-localtime
                                      split->time64)))
 
    (list 'monthly
+         (cons 'date-group GNC-SPLIT-DATE-GROUP-MONTH)
          (cons 'split-sortvalue (lambda (s) (time64-month (split->time64 s))))
-         (cons 'date-sortvalue time64-month)
          (cons 'text (G_ "Monthly"))
          (cons 'renderer-fn (compose gnc:date-get-month-year-string
                                      gnc-localtime
                                      split->time64)))
 
    (list 'quarterly
+         (cons 'date-group GNC-SPLIT-DATE-GROUP-QUARTER)
          (cons 'split-sortvalue (lambda (s) (time64-quarter (split->time64 s))))
-         (cons 'date-sortvalue time64-quarter)
          (cons 'text (G_ "Quarterly"))
          (cons 'renderer-fn (compose gnc:date-get-quarter-year-string
                                      gnc-localtime
                                      split->time64)))
 
    (list 'yearly
+         (cons 'date-group GNC-SPLIT-DATE-GROUP-YEAR)
          (cons 'split-sortvalue (lambda (s) (time64-year (split->time64 s))))
-         (cons 'date-sortvalue time64-year)
          (cons 'text (G_ "Yearly"))
          (cons 'renderer-fn (compose gnc:date-get-year-string
                                      gnc-localtime
@@ -435,18 +437,8 @@ in the Options panel."))
   ;; it checks whether a renderer-fn is defined.
   (keylist-get-info (sortkey-list split-action?) sortkey 'renderer-fn))
 
-(define (CUSTOM-SORTING? sortkey split-action?)
-  ;; sortkey -> bool
-  ;;
-  ;; this returns which sortkeys which *must* use the custom sorter.
-  ;; it filters whereby a split-sortvalue is defined (i.e. the splits
-  ;; can be compared according to their 'sortvalue) but the QofQuery
-  ;; sortkey is not defined (i.e. their 'sortkey is #f).
-  (and (keylist-get-info (sortkey-list split-action?) sortkey 'split-sortvalue)
-       (not (keylist-get-info (sortkey-list split-action?) sortkey 'sortkey))))
-
-(define (lists->csv lst)
-  ;; converts a list of lists into CSV
+(define (write-lists-csv lst port)
+  ;; writes a list of lists to port as CSV
   ;; this function aims to follow RFC4180, and will pad lists to
   ;; ensure equal number of items per row.
   ;; e.g. '(("from" "01/01/2010")
@@ -482,9 +474,19 @@ in the Options panel."))
      ((gnc:gnc-monetary? obj) (strify (gnc:gnc-monetary-amount obj)))
      (else (object->string obj))))
 
-  (string-join (map strify lst) "\n"))
+  (let lp ((lst lst) (first? #t))
+    (unless (null? lst)
+      (unless first? (newline port))
+      (display (strify (car lst)) port)
+      (lp (cdr lst) #f))))
+
+(define (lists->csv lst)
+  ;; converts a list of lists into a CSV string, see write-lists-csv
+  (call-with-output-string
+    (lambda (port) (write-lists-csv lst port))))
 
 (define gnc:lists->csv lists->csv)
+(define gnc:write-lists-csv write-lists-csv)
 
 
 ;;
@@ -1021,7 +1023,7 @@ be excluded from periodic reporting.")
 ;; ;;;;;;;;;;;;;;;;;;;;
 ;; Here comes the big function that builds the whole table.
 
-(define (make-split-table splits options custom-calculated-cells
+(define (make-split-table splits selection options custom-calculated-cells
                           begindate enddate c_account_1)
 
   (define (opt-val section name)
@@ -1700,7 +1702,9 @@ be excluded from periodic reporting.")
       (add-subheading (render-summary (car splits) 'secondary #t)
                       def:secondary-subtotal-style (car splits) 'secondary))
 
+    ;; the selection tells where the subtotal groups end
     (let loop ((splits splits)
+               (breaks (gnc-split-selection-scm-breaks selection splits))
                (odd-row? #t)
                (work-done 0))
 
@@ -1723,6 +1727,7 @@ be excluded from periodic reporting.")
           (let* ((current (car splits))
                  (rest (cdr splits))
                  (next (and (pair? rest) (car rest)))
+                 (group-break (car breaks))
                  (split-values (add-split-row
                                 current
                                 calculated-cells
@@ -1753,10 +1758,7 @@ be excluded from periodic reporting.")
              split-values)
 
             (cond
-             ((and primary-subtotal-comparator
-                   (or (not next)
-                       (not (equal? (primary-subtotal-comparator current)
-                                    (primary-subtotal-comparator next)))))
+             ((= group-break GNC-SPLIT-BREAK-PRIMARY)
               (when secondary-subtotal-comparator
                 (add-subtotal-row (total-string
                                    (render-summary current 'secondary #f))
@@ -1792,10 +1794,7 @@ be excluded from periodic reporting.")
                                   'secondary))))
 
              (else
-              (when (and secondary-subtotal-comparator
-                         (or (not next)
-                             (not (equal? (secondary-subtotal-comparator current)
-                                          (secondary-subtotal-comparator next)))))
+              (when (= group-break GNC-SPLIT-BREAK-SECONDARY)
                 (add-subtotal-row (total-string
                                    (render-summary current 'secondary #f))
                                   secondary-subtotal-collectors
@@ -1815,7 +1814,7 @@ be excluded from periodic reporting.")
                   (add-subheading (render-summary next 'secondary #t)
                                   def:secondary-subtotal-style next 'secondary)))))
 
-            (loop rest (not odd-row?) (1+ work-done)))))
+            (loop rest (cdr breaks) (not odd-row?) (1+ work-done)))))
 
     (let ((csvlist (cond
                     ((any (lambda (cell) (vector-ref cell 4)) calculated-cells)
@@ -1946,15 +1945,9 @@ be excluded from periodic reporting.")
     (gnc:option-value (gnc:lookup-option options section name)))
   (define BOOK-SPLIT-ACTION
     (qof-book-use-split-action-for-num-field (gnc-get-current-book)))
-  (define (is-filter-member split account-list)
-    (define (same-split? s) (equal? s split))
-    (define (from-account? s) (member (xaccSplitGetAccount s) account-list))
-    (let lp ((splits (xaccTransGetSplitList (xaccSplitGetParent split))))
-      (match splits
-        (() #f)
-        (((? same-split?) . rest) (lp rest))
-        (((? from-account?) . _) #t)
-        ((_ . rest) (lp rest)))))
+  ;; the native side of the report: it runs the query, filters the
+  ;; splits and sorts them, see gnc-split-selection.h
+  (define selection (gnc-split-selection-scm-new))
 
   (when filename
     (issue-deprecation-warning "trep-renderer filename is obsolete, and not \
@@ -1990,21 +1983,15 @@ warning will be removed in GnuCash 5.0"))
          (enddate (gnc:time64-end-day-time
                    (gnc:date-option-absolute-time
                     (opt-val gnc:pagename-general optname-enddate))))
-         (transaction-matcher (opt-val pagename-filter optname-transaction-matcher))
-         (transaction-filter-case-insensitive?
-          (opt-val pagename-filter optname-transaction-matcher-caseinsensitive))
          (transaction-matcher-regexp
-          (and (opt-val pagename-filter optname-transaction-matcher-regex)
-               (if (defined? 'make-regexp)
-                   (catch 'regular-expression-syntax
-                     (lambda ()
-                       (if transaction-filter-case-insensitive?
-                           (make-regexp transaction-matcher regexp/icase)
-                           (make-regexp transaction-matcher)))
-                     (const 'invalid-transaction-regex))
-                   'no-guile-regex-support)))
-         (transaction-filter-exclude?
-          (opt-val pagename-filter optname-transaction-matcher-exclude))
+          (and (not (gnc-split-selection-scm-set-matcher
+                     selection
+                     (opt-val pagename-filter optname-transaction-matcher)
+                     (opt-val pagename-filter optname-transaction-matcher-regex)
+                     (opt-val pagename-filter
+                              optname-transaction-matcher-caseinsensitive)
+                     (opt-val pagename-filter optname-transaction-matcher-exclude)))
+               'invalid-transaction-regex))
          (void-filter (opt-val pagename-filter optname-void-transactions))
          (reconcile-filter (opt-val pagename-filter optname-reconcile-status))
          (cleared-filter
@@ -2023,12 +2010,6 @@ warning will be removed in GnuCash 5.0"))
                          (opt-val pagename-filter optname-closing-transactions)
                          'closing-match))
          (splits '())
-         (custom-sort? (or (and (memq primary-key DATE-SORTING-TYPES)
-                                (not (eq? primary-date-subtotal 'none)))
-                           (and (memq secondary-key DATE-SORTING-TYPES)
-                                (not (eq? secondary-date-subtotal 'none)))
-                           (or (CUSTOM-SORTING? primary-key BOOK-SPLIT-ACTION)
-                               (CUSTOM-SORTING? secondary-key BOOK-SPLIT-ACTION))))
          (subtotal-table? (and (opt-val gnc:pagename-display optname-grid)
                                (if (memq primary-key DATE-SORTING-TYPES)
                                    (keylist-get-info date-subtotal-list
@@ -2039,57 +2020,13 @@ warning will be removed in GnuCash 5.0"))
          (infobox-display (opt-val gnc:pagename-general optname-infobox-display))
          (query (qof-query-create-for-splits)))
 
-    (define (match? str)
-      (cond
-       (transaction-matcher-regexp
-        (regexp-exec transaction-matcher-regexp str))
-       (transaction-filter-case-insensitive?
-        (string-contains-ci str transaction-matcher))
-       (else
-        (string-contains str transaction-matcher))))
-
-    (define (generic-less? split-X split-Y sortkey date-subtotal-key ascend?)
-      ;; compare splits X and Y, whereby
-      ;; sortkey and date-subtotal-key specify the options used
-      ;; ascend? specifies whether ascending or descending
-      (let* ((comparator-function
-              (if (memq sortkey DATE-SORTING-TYPES)
-                  (let ((date (keylist-get-info
-                               (sortkey-list BOOK-SPLIT-ACTION)
-                               sortkey 'split-sortvalue))
-                        (date-comparator
-                         (keylist-get-info date-subtotal-list
-                                           date-subtotal-key 'date-sortvalue)))
-                    (lambda (s)
-                      (and date-comparator (date-comparator (date s)))))
-                  (or (keylist-get-info (sortkey-list BOOK-SPLIT-ACTION)
-                                        sortkey 'split-sortvalue)
-                      (lambda (s) #f))))
-             (value-of-X (comparator-function split-X))
-             (value-of-Y (comparator-function split-Y))
-             (op (if (string? value-of-X)
-                     (if ascend? gnc:string-locale<? gnc:string-locale>?)
-                     (if ascend? < >))))
-        (and value-of-X (op value-of-X value-of-Y))))
-
-    (define (primary-comparator? X Y)
-      (generic-less? X Y primary-key
-                     primary-date-subtotal
-                     (eq? primary-order 'ascend)))
-
-    (define (secondary-comparator? X Y)
-      (generic-less? X Y secondary-key
-                     secondary-date-subtotal
-                     (eq? secondary-order 'ascend)))
-
-    ;; This will, by default, sort the split list by ascending posted-date.
-    (define (date-comparator? X Y)
-      (generic-less? X Y 'date 'none #t))
-
-    (define (transaction-filter-match split)
-      (or (match? (xaccTransGetDescription (xaccSplitGetParent split)))
-          (match? (xaccTransGetNotes (xaccSplitGetParent split)))
-          (match? (xaccSplitGetMemo split))))
+    (define (set-sort! level sortkey order date-subtotal subtotal?)
+      (gnc-split-selection-scm-set-sort
+       selection level
+       (keylist-get-info (sortkey-list BOOK-SPLIT-ACTION) sortkey 'split-key)
+       (keylist-get-info date-subtotal-list date-subtotal 'date-group)
+       (eq? order 'ascend)
+       subtotal?))
 
     (cond
      ((or (null? c_account_1)
@@ -2136,52 +2073,40 @@ warning will be removed in GnuCash 5.0"))
         (xaccQueryAddDateMatchTT query #t begindate #t enddate QOF-QUERY-AND))
       (when (boolean? closing-match)
         (xaccQueryAddClosingTransMatch query closing-match QOF-QUERY-AND))
-      (unless custom-sort?
-        (qof-query-set-sort-order
-         query
-         (keylist-get-info (sortkey-list BOOK-SPLIT-ACTION) primary-key 'sortkey)
-         (keylist-get-info (sortkey-list BOOK-SPLIT-ACTION) secondary-key 'sortkey)
-         '())
-        (qof-query-set-sort-increasing
-         query (eq? primary-order 'ascend) (eq? secondary-order 'ascend)
-         #t))
-
-      (if (opt-val "__trep" "unique-transactions")
-          (set! splits (xaccQueryGetSplitsUniqueTrans query))
-          (set! splits (qof-query-run query)))
+
+      ;; The selection filters the splits to/from the selected
+      ;; accounts and by the matcher for Transaction Description/Notes/Memo,
+      ;; then sorts them by the sortkeys.
+      (gnc-split-selection-scm-set-other-accounts
+       selection c_account_2
+       (case filter-mode
+         ((include) GNC-SPLIT-OTHER-ACCOUNTS-INCLUDE)
+         ((exclude) GNC-SPLIT-OTHER-ACCOUNTS-EXCLUDE)
+         (else GNC-SPLIT-OTHER-ACCOUNTS-ANY)))
+      (set-sort! 0 primary-key primary-order primary-date-subtotal
+                 (opt-val pagename-sorting optname-prime-subtotal))
+      (set-sort! 1 secondary-key secondary-order secondary-date-subtotal
+                 (opt-val pagename-sorting optname-sec-subtotal))
+      (set! splits (gnc-split-selection-scm-run
+                    selection query (opt-val "__trep" "unique-transactions")))
 
       (qof-query-destroy query)
 
-      ;; Combined Filter:
+      ;; Filters left to scheme, which keep the sort order:
       ;; - include/exclude using split->date according to date options
-      ;; - include/exclude splits to/from selected accounts
-      ;; - substring/regex matcher for Transaction Description/Notes/Memo
       ;; - custom-split-filter, a split->bool function for derived reports
-      (set! splits
-        (filter
-         (lambda (split)
-           (let* ((trans (xaccSplitGetParent split)))
+      (when (or split->date custom-split-filter)
+        (set! splits
+          (filter
+           (lambda (split)
              (and (or (not split->date)
                       (let ((date (split->date split)))
                         (if date
                             (<= begindate date enddate)
                             split->date-include-false?)))
-                  (case filter-mode
-                    ((none) #t)
-                    ((include) (is-filter-member split c_account_2))
-                    ((exclude) (not (is-filter-member split c_account_2))))
-                  (or (string-null? transaction-matcher)
-                      (if transaction-filter-exclude?
-                          (not (transaction-filter-match split))
-                          (transaction-filter-match split)))
                   (or (not custom-split-filter)
-                      (custom-split-filter split)))))
-         splits))
-
-      (when custom-sort?
-        (set! splits (stable-sort! splits date-comparator?))
-        (set! splits (stable-sort! splits secondary-comparator?))
-        (set! splits (stable-sort! splits primary-comparator?)))
+                      (custom-split-filter split))))
+           splits)))
 
       (cond
        ((null? splits)
@@ -2201,7 +2126,8 @@ warning will be removed in GnuCash 5.0"))
 
        (else
         (let-values (((table grid csvlist)
-                      (make-split-table splits options custom-calculated-cells
+                      (make-split-table splits selection options
+                                        custom-calculated-cells
                                         begindate enddate c_account_1)))
 
           (gnc:html-document-set-title! document report-title)
@@ -2245,13 +2171,17 @@ warning will be removed in GnuCash 5.0"))
             (cond
              ((pair? csvlist)
               (let ((iso-date (qof-date-format-get-string QOF-DATE-FORMAT-ISO)))
-                (gnc:html-document-set-export-string
+                ;; written straight to the export file, the csv of a
+                ;; long period is large.
+                (gnc:html-document-set-export-writer
                  document
-                 (lists->csv
-                  (cons*
-                   `("from" ,(gnc-print-time64 begindate iso-date))
-                   `("to" ,(gnc-print-time64 enddate iso-date))
-                   csvlist)))))
+                 (lambda (port)
+                   (write-lists-csv
+                    (cons*
+                     `("from" ,(gnc-print-time64 begindate iso-date))
+                     `("to" ,(gnc-print-time64 enddate iso-date))
+                     csvlist)
+                    port)))))
 
              (else
               (gnc:html-document-set-export-error document csvlist))))))))))
@@ -0,0 +1,217 @@
+/********************************************************************
+ * gtest-report-workers.cpp -- unit tests for answering batches of  *
+ *                             report requests in worker processes. *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+ *******************************************************************/
+
+#include <config.h>
+#include <cerrno>
+#include <unistd.h>
+#include <gtest/gtest.h>
+#include <gnucash-report-workers.hpp>
+extern "C"
+{
+#include <glib.h>
+#include <glib/gstdio.h>
+}
+#include <set>
+#include <string>
+#include <vector>
+
+using StrVec = std::vector<std::string>;
+
+/* The reports are stubbed by a handler answering each request with
+ * itself and the process that answered it. */
+class ReportWorkersTest : public ::testing::Test
+{
+protected:
+    using ReportHandler = Gnucash::ReportHandler;
+    using ReportFork = Gnucash::ReportFork;
+
+    ReportWorkersTest()
+    {
+        for (auto i = 0; i < 30; i++)
+            m_requests.push_back ("report " + std::to_string (i));
+    }
+    ~ReportWorkersTest()
+    {
+        for (const auto& file : m_files)
+            g_remove (file.c_str());
+    }
+
+    static std::string answer (const std::string& request)
+    {
+        return request + " from " + std::to_string (getpid());
+    }
+    /* Some of the reports take longer, so the workers answer out of
+     * order. */
+    static std::string slow_answer (const std::string& request)
+    {
+        if (request.back() == '0' || request.back() == '5')
+            g_usleep (20000);
+        return answer (request);
+    }
+    /* A handler run in this process, which remembers what it was asked. */
+    ReportHandler recording_handler ()
+    {
+        return [this](const std::string& request)
+            {
+                m_handled.push_back (request);
+                return answer (request);
+            };
+    }
+    /* A fork that counts the workers it forks. */
+    ReportFork counting_fork ()
+    {
+        return [this]() { m_forks++; return fork(); };
+    }
+    /* A datafile holding contents, removed again by the destructor. */
+    std::string datafile (const std::string& contents)
+    {
+        gchar* path = nullptr;
+        auto fd = g_file_open_tmp ("test-report-workers-XXXXXX", &path, nullptr);
+        g_close (fd, nullptr);
+        g_file_set_contents (path, contents.data(), contents.size(), nullptr);
+        std::string result{path};
+        g_free (path);
+        m_files.push_back (result);
+        return result;
+    }
+    /* Every response answers its request, and the pids of the processes
+     * that answered them. */
+    std::set<std::string> expect_answers (const StrVec& responses)
+    {
+        std::set<std::string> pids;
+        EXPECT_EQ (m_requests.size(), responses.size());
+        for (size_t i = 0; i < responses.size() && i < m_requests.size(); i++)
+        {
+            auto prefix = m_requests[i] + " from ";
+            EXPECT_EQ (0u, responses[i].find (prefix)) << responses[i];
+            pids.insert (responses[i].substr (prefix.size()));
+        }
+        return pids;
+    }
+
+    StrVec m_requests;
+    StrVec m_handled;
+    StrVec m_files;
+    unsigned m_forks = 0;
+};
+
+/* The responses come back in the order of the requests, whichever worker
+ * answered them first. */
+TEST_F (ReportWorkersTest, responses_in_request_order)
+{
+    auto responses = Gnucash::run_report_workers (m_requests, 3, slow_answer,
+                                                  counting_fork ());
+    EXPECT_EQ (3u, m_forks);
+    auto pids = expect_answers (responses);
+    EXPECT_EQ (3u, pids.size());
+    EXPECT_EQ (0u, pids.count (std::to_string (getpid())));
+}
+
+/* The request a worker was working on when it died fails; the others are
+ * answered by the remaining worker. */
+TEST_F (ReportWorkersTest, worker_dies_mid_request)
+{
+    m_requests[1] = "die";
+    auto responses = Gnucash::run_report_workers (m_requests, 2,
+        [](const std::string& request)
+        {
+            if (request == "die")
+                _exit (1);
+            return slow_answer (request);
+        },
+        counting_fork ());
+    EXPECT_EQ (Gnucash::error_response ("Report worker exited"), responses[1]);
+    responses[1] = "die from nowhere";
+    auto pids = expect_answers (responses);
+    pids.erase ("nowhere");
+    EXPECT_EQ (1u, pids.size());
+    EXPECT_EQ (0u, pids.count (std::to_string (getpid())));
+}
+
+/* Without any worker every request is answered in this process. */
+TEST_F (ReportWorkersTest, fork_fails)
+{
+    auto responses = Gnucash::run_report_workers (m_requests, 3,
+                                                  recording_handler (),
+                                                  [this]()
+                                                  {
+                                                      m_forks++;
+                                                      errno = EAGAIN;
+                                                      return -1;
+                                                  });
+    EXPECT_EQ (1u, m_forks);
+    EXPECT_EQ (m_requests, m_handled);
+    auto pids = expect_answers (responses);
+    EXPECT_EQ (std::set<std::string>{std::to_string (getpid())}, pids);
+}
+
+/* A request to quit is answered with an error rather than stopping the
+ * batch. */
+TEST_F (ReportWorkersTest, quit_in_batch)
+{
+    auto responses = Gnucash::run_report_batch (m_requests, datafile ("<?xml"),
+                                                1,
+                                                [](const std::string&)
+                                                { return std::string{}; },
+                                                counting_fork ());
+    EXPECT_EQ (0u, m_forks);
+    EXPECT_EQ (m_requests.size(), responses.size());
+    for (const auto& response : responses)
+        EXPECT_EQ (Gnucash::error_response ("Can't quit a batch of reports"),
+                   response);
+}
+
+/* XML files are shared with workers, while databases, which the session
+ * keeps a connection to, have their requests answered in this process. */
+TEST_F (ReportWorkersTest, database_runs_in_process)
+{
+    auto xml = datafile ("<?xml version=\"1.0\" encoding=\"utf-8\" ?>\n");
+    auto sqlite = datafile (std::string{"SQLite format 3", 16} + "more");
+    EXPECT_FALSE (Gnucash::datafile_is_database (xml));
+    EXPECT_FALSE (Gnucash::datafile_is_database ("xml://" + xml));
+    EXPECT_TRUE (Gnucash::datafile_is_database (sqlite));
+    EXPECT_TRUE (Gnucash::datafile_is_database ("file://" + sqlite));
+    EXPECT_TRUE (Gnucash::datafile_is_database ("sqlite3://" + xml));
+    EXPECT_TRUE (Gnucash::datafile_is_database ("postgres://localhost/books"));
+
+    auto pids = expect_answers (Gnucash::run_report_batch (m_requests, xml, 4,
+                                                           recording_handler (),
+                                                           counting_fork ()));
+    EXPECT_EQ (4u, m_forks);
+    EXPECT_TRUE (m_handled.empty());
+    EXPECT_EQ (0u, pids.count (std::to_string (getpid())));
+
+    for (const auto& database : {sqlite, "sqlite3://" + xml,
+                                 std::string{"mysql://localhost/books"}})
+    {
+        m_forks = 0;
+        m_handled.clear();
+        pids = expect_answers (Gnucash::run_report_batch (m_requests, database,
+                                                          4,
+                                                          recording_handler (),
+                                                          counting_fork ()));
+        EXPECT_EQ (0u, m_forks) << database;
+        EXPECT_EQ (m_requests, m_handled) << database;
+        EXPECT_EQ (std::set<std::string>{std::to_string (getpid())}, pids);
+    }
+}
@@ -33,11 +33,217 @@
 
 #include "Account.h"
 #include "Split.h"
+#include "gnc-commodity.h"
+#include "gnc-pricedb.h"
 #include "gncOwner.h"
 #include "qof.h"
 
 G_GNUC_UNUSED static QofLogModule log_module = GNC_MOD_GUI;
 
+/********************************************************************
+ * Balance cache
+ *
+ * Each book keeps the balances computed for its accounts, one entry per
+ * balance function and report commodity. An entry holds the account's own
+ * converted balance and its total including all sub-accounts, which is
+ * summed from the children's cached totals rather than by walking every
+ * descendant again. Changing an account or one of its splits invalidates
+ * the account's own balance and the totals of it and its ancestors; any
+ * price or commodity change, or a new day, empties the cache.
+ ********************************************************************/
+
+#define BALANCE_CACHE "gnc-ui-balance-cache"
+
+typedef struct
+{
+    xaccGetBalanceInCurrencyFn fn;
+    const gnc_commodity *commodity;
+    gnc_numeric own;
+    gnc_numeric total;
+    gboolean own_valid;
+    gboolean total_valid;
+} BalanceCacheEntry;
+
+typedef struct
+{
+    GHashTable *accounts;  /* Account* -> GSList* of BalanceCacheEntry* */
+    time64 today_end;
+} BalanceCache;
+
+static gint balance_cache_handler_id = 0;
+
+static void
+balance_cache_free_entries (gpointer data)
+{
+    g_slist_free_full ((GSList*)data, g_free);
+}
+
+static void
+balance_cache_destroy (QofBook *book, gpointer key, gpointer data)
+{
+    BalanceCache *cache = data;
+
+    g_hash_table_destroy (cache->accounts);
+    g_free (cache);
+}
+
+/* Invalidate the account's totals and those of its ancestors and, if own is
+ * set, the account's own balances.
+ */
+static void
+balance_cache_invalidate (BalanceCache *cache, const Account *account,
+                          gboolean own)
+{
+    const Account *acc;
+
+    for (acc = account; acc; acc = gnc_account_get_parent (acc))
+    {
+        GSList *node = g_hash_table_lookup (cache->accounts, acc);
+        for (; node; node = node->next)
+        {
+            BalanceCacheEntry *entry = node->data;
+            if (own && acc == account)
+                entry->own_valid = FALSE;
+            entry->total_valid = FALSE;
+        }
+    }
+}
+
+static void
+balance_cache_event_handler (QofInstance *entity, QofEventId event_type,
+                             gpointer user_data, gpointer event_data)
+{
+    QofBook *book = qof_instance_get_book (entity);
+    BalanceCache *cache;
+
+    if (!book || qof_book_shutting_down (book))
+        return;
+    cache = qof_book_get_data (book, BALANCE_CACHE);
+    if (!cache)
+        return;
+
+    if (GNC_IS_ACCOUNT (entity))
+    {
+        GncEventData *ed = event_data;
+        /* A removed account has already lost its parent. */
+        if (event_type == QOF_EVENT_REMOVE && ed && ed->node)
+            balance_cache_invalidate (cache, GNC_ACCOUNT (ed->node), FALSE);
+        balance_cache_invalidate (cache, GNC_ACCOUNT (entity), TRUE);
+        if (event_type == QOF_EVENT_DESTROY)
+            g_hash_table_remove (cache->accounts, entity);
+    }
+    else if (GNC_IS_SPLIT (entity))
+    {
+        Account *account = xaccSplitGetAccount (GNC_SPLIT (entity));
+        if (account)
+            balance_cache_invalidate (cache, account, TRUE);
+    }
+    else if (GNC_IS_PRICE (entity) || GNC_IS_COMMODITY (entity))
+        g_hash_table_remove_all (cache->accounts);
+}
+
+static BalanceCache *
+balance_cache_get (QofBook *book)
+{
+    BalanceCache *cache = qof_book_get_data (book, BALANCE_CACHE);
+    time64 today_end = gnc_time64_get_today_end ();
+
+    if (!cache)
+    {
+        cache = g_new0 (BalanceCache, 1);
+        cache->accounts = g_hash_table_new_full (g_direct_hash,
+                                                 g_direct_equal, NULL,
+                                                 balance_cache_free_entries);
+        cache->today_end = today_end;
+        qof_book_set_data_fin (book, BALANCE_CACHE, cache,
+                               balance_cache_destroy);
+        if (!balance_cache_handler_id)
+            balance_cache_handler_id =
+                qof_event_register_handler (balance_cache_event_handler, NULL);
+    }
+    /* Present balances and the prices used for them depend on the date. */
+    else if (cache->today_end != today_end)
+    {
+        g_hash_table_remove_all (cache->accounts);
+        cache->today_end = today_end;
+    }
+    return cache;
+}
+
+static BalanceCacheEntry *
+balance_cache_lookup (BalanceCache *cache, const Account *account,
+                      xaccGetBalanceInCurrencyFn fn,
+                      const gnc_commodity *commodity)
+{
+    GSList *entries = g_hash_table_lookup (cache->accounts, account);
+    GSList *node;
+    BalanceCacheEntry *entry;
+
+    for (node = entries; node; node = node->next)
+    {
+        entry = node->data;
+        if (entry->fn == fn && entry->commodity == commodity)
+            return entry;
+    }
+    entry = g_new0 (BalanceCacheEntry, 1);
+    entry->fn = fn;
+    entry->commodity = commodity;
+    g_hash_table_steal (cache->accounts, account);
+    g_hash_table_insert (cache->accounts, (gpointer)account,
+                         g_slist_prepend (entries, entry));
+    return entry;
+}
+
+static gnc_numeric
+balance_cache_get_balance (BalanceCache *cache, xaccGetBalanceInCurrencyFn fn,
+                           const Account *account, gboolean recurse,
+                           const gnc_commodity *commodity)
+{
+    BalanceCacheEntry *entry;
+
+    entry = balance_cache_lookup (cache, account, fn, commodity);
+    if (!entry->own_valid)
+    {
+        entry->own = fn (account, commodity, FALSE);
+        entry->own_valid = TRUE;
+    }
+    if (!recurse)
+        return entry->own;
+
+    if (!entry->total_valid)
+    {
+        GList *children = gnc_account_get_children (account);
+        GList *node;
+        gnc_numeric total = entry->own;
+        int fraction = gnc_commodity_get_fraction (commodity);
+
+        for (node = children; node; node = node->next)
+        {
+            gnc_numeric balance =
+                balance_cache_get_balance (cache, fn, node->data, TRUE,
+                                           commodity);
+            total = gnc_numeric_add (total, balance, fraction,
+                                     GNC_HOW_RND_ROUND_HALF_UP);
+        }
+        g_list_free (children);
+        entry->total = total;
+        entry->total_valid = TRUE;
+    }
+    return entry->total;
+}
+
+void
+gnc_ui_account_balance_cache_invalidate (const Account *account)
+{
+    BalanceCache *cache;
+
+    g_return_if_fail (GNC_IS_ACCOUNT (account));
+
+    cache = qof_book_get_data (gnc_account_get_book (account), BALANCE_CACHE);
+    if (cache)
+        balance_cache_invalidate (cache, account, TRUE);
+}
+
 /********************************************************************
  * Balance calculations related to accounts
  ********************************************************************/
@@ -68,8 +274,15 @@ gnc_ui_account_get_balance_full (xaccGetBalanceInCurrencyFn fn,
                                  const gnc_commodity *commodity)
 {
     gnc_numeric balance;
+    QofBook *book = gnc_account_get_book (account);
 
-    balance = fn(account, commodity, recurse);
+    if (!commodity)
+        commodity = xaccAccountGetCommodity (account);
+    if (book && commodity)
+        balance = balance_cache_get_balance (balance_cache_get (book), fn,
+                                             account, recurse, commodity);
+    else
+        balance = fn(account, commodity, recurse);
 
     /* reverse sign if needed */
     if (gnc_reverse_balance (account))
@@ -38,6 +38,15 @@
  * Balance calculations related to accounts
  ********************************************************************/
 
+/**
+ * Forget the cached balances of an account and the totals of its parents.
+ * The cache follows account, split and price events by itself; this is for
+ * event handlers that may read balances before the cache has seen the event.
+ *
+ * @param account The account that changed.
+ */
+void gnc_ui_account_balance_cache_invalidate (const Account *account);
+
 gnc_numeric
 gnc_ui_account_get_balance_full (xaccGetBalanceInCurrencyFn fn,
                                  const Account *account,
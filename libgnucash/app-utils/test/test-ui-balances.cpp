@@ -0,0 +1,109 @@
+/********************************************************************
+ * test-ui-balances.cpp: test suite for the account balance cache   *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, you can retrieve it from        *
+ * https://www.gnu.org/licenses/old-licenses/gpl-2.0.html            *
+ * or contact:                                                      *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ ********************************************************************/
+#include "config.h"
+#include <glib.h>
+extern "C" {
+#include "../gnc-ui-balances.h"
+}
+#include <memory>
+#include <Split.h>
+#include <gnc-commodity.h>
+#include <gtest/gtest.h>
+
+static const int64_t DENOM = 100;
+
+class BalanceCacheTest : public ::testing::Test {
+protected:
+    std::shared_ptr<QofBook> m_book;
+    gnc_commodity *m_currency; // owned by m_book
+    Account *m_root, *m_parent, *m_child, *m_grandchild, *m_sibling;
+
+    Account *make_account(Account *parent, const char *name) {
+        Account *acct = xaccMallocAccount(m_book.get());
+        xaccAccountBeginEdit(acct);
+        xaccAccountSetName(acct, name);
+        xaccAccountSetType(acct, ACCT_TYPE_BANK);
+        xaccAccountSetCommodity(acct, m_currency);
+        gnc_account_append_child(parent, acct);
+        xaccAccountCommitEdit(acct);
+        return acct;
+    }
+
+    void add_split(Account *acct, gint64 amount) {
+        xaccAccountBeginEdit(acct);
+        Split *split = xaccMallocSplit(m_book.get());
+        xaccSplitSetAmount(split, gnc_numeric_create(amount, DENOM));
+        xaccSplitSetAccount(split, acct);
+        gnc_account_insert_split(acct, split);
+        xaccAccountCommitEdit(acct);
+    }
+
+    gint64 total(Account *acct) {
+        gnc_numeric balance = gnc_ui_account_get_balance(acct, TRUE);
+        return gnc_numeric_convert(balance, DENOM, GNC_HOW_RND_NEVER).num;
+    }
+
+public:
+    BalanceCacheTest() :
+        m_book(qof_book_new(), qof_book_destroy),
+        m_currency(gnc_commodity_new(m_book.get(), "US Dollar",
+                                     GNC_COMMODITY_NS_CURRENCY, "USD",
+                                     NULL, DENOM)),
+        m_root(gnc_book_get_root_account(m_book.get())),
+        m_parent(make_account(m_root, "Parent")),
+        m_child(make_account(m_parent, "Child")),
+        m_grandchild(make_account(m_child, "Grandchild")),
+        m_sibling(make_account(m_parent, "Sibling"))
+    {
+        add_split(m_parent, 100);
+        add_split(m_child, 2000);
+        add_split(m_grandchild, 30000);
+        add_split(m_sibling, 400000);
+    }
+};
+
+TEST_F(BalanceCacheTest, RollsUpChildren) {
+    EXPECT_EQ(total(m_grandchild), 30000);
+    EXPECT_EQ(total(m_child), 32000);
+    EXPECT_EQ(total(m_parent), 432100);
+    EXPECT_EQ(gnc_ui_account_get_balance(m_parent, FALSE).num, 100);
+    // Asking again is answered from the cache.
+    EXPECT_EQ(total(m_parent), 432100);
+}
+
+TEST_F(BalanceCacheTest, FollowsChanges) {
+    EXPECT_EQ(total(m_parent), 432100);
+    add_split(m_grandchild, 5000000);
+    EXPECT_EQ(total(m_child), 5032000);
+    EXPECT_EQ(total(m_parent), 5432100);
+    EXPECT_EQ(total(m_sibling), 400000);
+
+    xaccAccountBeginEdit(m_parent);
+    gnc_account_remove_child(m_parent, m_child);
+    xaccAccountCommitEdit(m_parent);
+    EXPECT_EQ(total(m_parent), 400100);
+
+    gnc_account_append_child(m_sibling, m_child);
+    EXPECT_EQ(total(m_sibling), 5432000);
+    EXPECT_EQ(total(m_parent), 5432100);
+}
@@ -0,0 +1,173 @@
+/********************************************************************
+ * bench-dbi-save.cpp -- time saving and loading a book with SQLite *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+/* Not a test: run by hand (make bench-dbi-save) to measure "Save As",
+ * load and single-split edit throughput against a local SQLite file. The
+ * optional argument is the number of transactions to create.
+ */
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <config.h>
+#include <qof.h>
+#include <cashobjects.h>
+#include <Account.h>
+#include <Transaction.h>
+#include <Split.h>
+#include <gnc-commodity.h>
+#include <TransLog.h>
+#include <kvp-frame.hpp>
+#include "../gnc-backend-dbi.h"
+
+using Clock = std::chrono::steady_clock;
+
+static Account*
+make_account (QofBook* book, Account* parent, const char* name,
+              gnc_commodity* currency)
+{
+    auto acct = xaccMallocAccount (book);
+    xaccAccountBeginEdit (acct);
+    xaccAccountSetType (acct, ACCT_TYPE_BANK);
+    xaccAccountSetName (acct, name);
+    xaccAccountSetCommodity (acct, currency);
+    gnc_account_append_child (parent, acct);
+    xaccAccountCommitEdit (acct);
+    return acct;
+}
+
+static void
+populate_book (QofBook* book, size_t count)
+{
+    auto root = gnc_book_get_root_account (book);
+    auto table = gnc_commodity_table_get_table (book);
+    auto currency = gnc_commodity_table_lookup (table,
+                                                GNC_COMMODITY_NS_CURRENCY,
+                                                "USD");
+    auto from = make_account (book, root, "Checking", currency);
+    auto to = make_account (book, root, "Expenses", currency);
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto tx = xaccMallocTransaction (book);
+        xaccTransBeginEdit (tx);
+        xaccTransSetCurrency (tx, currency);
+        xaccTransSetDatePostedSecsNormalized (tx, 1500000000 + i * 3600);
+        xaccTransSetDescription (tx, "Benchmark transaction");
+        auto amount = gnc_numeric_create (static_cast<int64_t> (i % 10000 + 1),
+                                          100);
+        for (auto acct : {from, to})
+        {
+            auto split = xaccMallocSplit (book);
+            xaccSplitSetParent (split, tx);
+            xaccSplitSetAccount (split, acct);
+            xaccSplitSetValue (split, amount);
+            xaccSplitSetAmount (split, amount);
+            amount = gnc_numeric_neg (amount);
+        }
+        auto frame = qof_instance_get_slots (QOF_INSTANCE (tx));
+        frame->set ({"notes"}, new KvpValue (g_strdup ("Benchmark note")));
+        xaccTransCommitEdit (tx);
+    }
+}
+
+static double
+seconds_since (Clock::time_point start)
+{
+    return std::chrono::duration<double> (Clock::now() - start).count();
+}
+
+int
+main (int argc, char** argv)
+{
+    size_t count = argc > 1 ? std::strtoul (argv[1], nullptr, 10) : 20000;
+    auto filename = std::string{"/tmp/bench-dbi-save-"} +
+        std::to_string (getpid ()) + ".gnucash";
+    auto url = "sqlite3://" + filename;
+
+    g_setenv ("GNC_UNINSTALLED", "1", TRUE);
+    qof_init ();
+    cashobjects_register ();
+    gnc_module_init_backend_dbi ();
+    xaccLogDisable ();
+
+    auto book = qof_book_new ();
+    populate_book (book, count);
+
+    auto session = qof_session_new (book);
+    qof_session_begin (session, url.c_str(), SESSION_NEW_OVERWRITE);
+    auto start = Clock::now();
+    qof_session_save (session, nullptr);
+    auto save_time = seconds_since (start);
+    auto save_err = qof_session_get_error (session);
+    qof_session_end (session);
+    qof_session_destroy (session);
+
+    session = qof_session_new (qof_book_new ());
+    qof_session_begin (session, url.c_str(), SESSION_NORMAL_OPEN);
+    start = Clock::now();
+    qof_session_load (session, nullptr);
+    auto load_time = seconds_since (start);
+    auto load_err = qof_session_get_error (session);
+
+    std::vector<Transaction*> txns;
+    qof_collection_foreach (qof_book_get_collection (qof_session_get_book (session),
+                                                     GNC_ID_TRANS),
+                            [](QofInstance* inst, gpointer data)
+                            {
+                                static_cast<std::vector<Transaction*>*>(data)->
+                                    push_back (GNC_TRANS (inst));
+                            }, &txns);
+    if (txns.size() > 2000)
+        txns.resize (2000);
+    start = Clock::now();
+    for (auto tx : txns)
+    {
+        xaccTransBeginEdit (tx);
+        xaccSplitSetMemo (xaccTransGetSplit (tx, 0), "Edited");
+        xaccTransCommitEdit (tx);
+    }
+    auto edit_time = seconds_since (start);
+    auto edit_err = qof_session_get_error (session);
+    qof_session_end (session);
+    qof_session_destroy (session);
+    g_unlink (filename.c_str());
+
+    std::cout << count << " transactions: save " << save_time << " s ("
+              << count / save_time << " tx/s), load " << load_time << " s ("
+              << count / load_time << " tx/s)\n" << txns.size()
+              << " split edits: " << edit_time << " s ("
+              << txns.size() / edit_time << " edits/s)\n";
+    if (save_err != ERR_BACKEND_NO_ERR || load_err != ERR_BACKEND_NO_ERR ||
+        edit_err != ERR_BACKEND_NO_ERR)
+    {
+        std::cerr << "Backend error: save " << save_err << ", load "
+                  << load_err << ", edit " << edit_err << "\n";
+        return 1;
+    }
+    qof_close ();
+    return 0;
+}
@@ -54,6 +54,9 @@ extern "C"
 /* For test_conn_index_functions */
 #include "../gnc-backend-dbi.hpp"
 #include "../gnc-backend-dbi.h"
+#include <gnc-sql-object-backend.hpp>
+#include <gnc-sql-column-table-entry.hpp>
+#include <gnc-transaction-sql.h>
 extern "C"
 {
 #include <unittest-support.h>
@@ -142,6 +145,16 @@ setup_memory (Fixture* fixture, gconstpointer pData)
     auto guid = qof_instance_get_guid (QOF_INSTANCE (acct1));
     frame->set ({"guid-val"}, new KvpValue (const_cast<GncGUID*> (guid_copy (
             guid))));
+    frame->set_path ({"frame-val", "nested", "int64-val"},
+                     new KvpValue (INT64_C (200)));
+    frame->set_path ({"frame-val", "string-val"},
+                     new KvpValue (g_strdup ("qrstuvwxyz")));
+    auto list = g_list_append (nullptr, new KvpValue (INT64_C (1)));
+    list = g_list_append (list, new KvpValue (g_strdup ("two")));
+    auto list_frame = new KvpFrame;
+    list_frame->set ({"double-val"}, new KvpValue (2.71828));
+    list = g_list_append (list, new KvpValue (list_frame));
+    frame->set ({"list-val"}, new KvpValue (list));
 
     gnc_account_append_child (root, acct1);
 
@@ -504,6 +517,168 @@ cleanup:
     }
     return;
 }
+/* Save a book, reopen it, edit a transaction, one of its splits and an
+ * account's slots, and check that the database ends up holding the edited
+ * objects: committing an edit writes only the columns and top-level slots
+ * that changed.
+ */
+static void
+test_dbi_edit_and_reload (Fixture* fixture, gconstpointer pData)
+{
+    auto url = (gchar*)pData;
+    auto msg = "[GncDbiSqlConnection::unlock_database()] There was no lock entry in the Lock table";
+    auto log_domain = nullptr;
+    auto loglevel = static_cast<GLogLevelFlags> (G_LOG_LEVEL_WARNING |
+                                                 G_LOG_FLAG_FATAL);
+    TestErrorStruct* check = test_error_struct_new (log_domain, loglevel, msg);
+    fixture->hdlrs = test_log_set_fatal_handler (fixture->hdlrs, check,
+                                                 (GLogFunc)test_checked_handler);
+    if (fixture->filename)
+        url = fixture->filename;
+
+    auto session_1 = qof_session_new (qof_book_new ());
+    qof_session_begin (session_1, url, SESSION_NEW_OVERWRITE);
+    g_assert_cmpint (qof_session_get_error (session_1), == , ERR_BACKEND_NO_ERR);
+    qof_session_swap_data (fixture->session, session_1);
+    qof_book_mark_session_dirty (qof_session_get_book (session_1));
+    qof_session_save (session_1, NULL);
+    g_assert_cmpint (qof_session_get_error (session_1), == , ERR_BACKEND_NO_ERR);
+    qof_session_end (session_1);
+    qof_session_destroy (session_1);
+
+    auto session_2 = qof_session_new (qof_book_new ());
+    qof_session_begin (session_2, url, SESSION_NORMAL_OPEN);
+    g_assert_cmpint (qof_session_get_error (session_2), == , ERR_BACKEND_NO_ERR);
+    qof_session_load (session_2, NULL);
+    g_assert_cmpint (qof_session_get_error (session_2), == , ERR_BACKEND_NO_ERR);
+    auto book_2 = qof_session_get_book (session_2);
+
+    auto acct = gnc_account_lookup_by_name (gnc_book_get_root_account (book_2),
+                                            "Bank 1");
+    g_assert (acct != NULL);
+    xaccAccountBeginEdit (acct);
+    auto frame = qof_instance_get_slots (QOF_INSTANCE (acct));
+    delete frame->set ({"string-val"}, new KvpValue (g_strdup ("changed")));
+    delete frame->set ({"double-val"}, nullptr);
+    frame->set ({"new-val"}, new KvpValue (INT64_C (300)));
+    xaccAccountSetDescription (acct, "Edited");
+    xaccAccountCommitEdit (acct);
+
+    Transaction* tx = nullptr;
+    qof_collection_foreach (qof_book_get_collection (book_2, GNC_ID_TRANS),
+                            [](QofInstance* inst, gpointer data)
+                            {
+                                *static_cast<Transaction**>(data) =
+                                    GNC_TRANS (inst);
+                            }, &tx);
+    g_assert (tx != NULL);
+    xaccTransBeginEdit (tx);
+    xaccTransSetDescription (tx, "Edited");
+    xaccTransSetNotes (tx, "Edited notes");
+    xaccSplitSetMemo (xaccTransGetSplit (tx, 0), "Edited memo");
+    xaccTransCommitEdit (tx);
+    g_assert_cmpint (qof_session_get_error (session_2), == , ERR_BACKEND_NO_ERR);
+
+    auto session_3 = qof_session_new (qof_book_new ());
+    qof_session_begin (session_3, url, SESSION_READ_ONLY);
+    g_assert_cmpint (qof_session_get_error (session_3), == , ERR_BACKEND_NO_ERR);
+    qof_session_load (session_3, NULL);
+    g_assert_cmpint (qof_session_get_error (session_3), == , ERR_BACKEND_NO_ERR);
+    compare_books (book_2, qof_session_get_book (session_3));
+
+    qof_session_end (session_2);
+    qof_session_destroy (session_2);
+    qof_session_end (session_3);
+    qof_session_destroy (session_3);
+}
+
+/* Check that each of book_1's accounts has the same balances in book_2. */
+static void
+compare_balances (QofBook* book_1, QofBook* book_2)
+{
+    auto accounts = gnc_account_get_descendants (gnc_book_get_root_account (book_1));
+    for (auto node = accounts; node; node = node->next)
+    {
+        auto acct_1 = GNC_ACCOUNT (node->data);
+        auto acct_2 = xaccAccountLookup (qof_instance_get_guid (acct_1), book_2);
+        g_assert (acct_2 != NULL);
+        g_assert (gnc_numeric_equal (xaccAccountGetBalance (acct_1),
+                                     xaccAccountGetBalance (acct_2)));
+        g_assert (gnc_numeric_equal (xaccAccountGetClearedBalance (acct_1),
+                                     xaccAccountGetClearedBalance (acct_2)));
+        g_assert (gnc_numeric_equal (xaccAccountGetReconciledBalance (acct_1),
+                                     xaccAccountGetReconciledBalance (acct_2)));
+    }
+    g_list_free (accounts);
+}
+
+/* Open a saved book with GNC_SQL_LAZY_LOAD set: no transactions are loaded
+ * but the account balances, summed by the database server, are right, and a
+ * query for all splits loads everything without changing them.
+ */
+static void
+test_dbi_lazy_load (Fixture* fixture, gconstpointer pData)
+{
+    auto url = (gchar*)pData;
+    auto msg = "[GncDbiSqlConnection::unlock_database()] There was no lock entry in the Lock table";
+    auto log_domain = nullptr;
+    auto loglevel = static_cast<GLogLevelFlags> (G_LOG_LEVEL_WARNING |
+                                                 G_LOG_FLAG_FATAL);
+    TestErrorStruct* check = test_error_struct_new (log_domain, loglevel, msg);
+    fixture->hdlrs = test_log_set_fatal_handler (fixture->hdlrs, check,
+                                                 (GLogFunc)test_checked_handler);
+    if (fixture->filename)
+        url = fixture->filename;
+
+    auto session_1 = qof_session_new (qof_book_new ());
+    qof_session_begin (session_1, url, SESSION_NEW_OVERWRITE);
+    g_assert_cmpint (qof_session_get_error (session_1), == , ERR_BACKEND_NO_ERR);
+    qof_session_swap_data (fixture->session, session_1);
+    qof_book_mark_session_dirty (qof_session_get_book (session_1));
+    qof_session_save (session_1, NULL);
+    g_assert_cmpint (qof_session_get_error (session_1), == , ERR_BACKEND_NO_ERR);
+    auto book_1 = qof_session_get_book (session_1);
+
+    g_setenv ("GNC_SQL_LAZY_LOAD", "0", TRUE);
+    auto session_2 = qof_session_new (qof_book_new ());
+    qof_session_begin (session_2, url, SESSION_READ_ONLY);
+    g_assert_cmpint (qof_session_get_error (session_2), == , ERR_BACKEND_NO_ERR);
+    qof_session_load (session_2, NULL);
+    g_unsetenv ("GNC_SQL_LAZY_LOAD");
+    g_assert_cmpint (qof_session_get_error (session_2), == , ERR_BACKEND_NO_ERR);
+    auto book_2 = qof_session_get_book (session_2);
+    compare_balances (book_1, book_2);
+
+    auto sql_be = static_cast<GncSqlBackend*>(qof_book_get_backend (book_2));
+    for (const auto& bal : gnc_sql_get_account_balances (sql_be))
+    {
+        auto acct = xaccAccountLookup (qof_instance_get_guid (bal.acct), book_1);
+        g_assert (gnc_numeric_equal (bal.balance, xaccAccountGetBalance (acct)));
+        g_assert (gnc_numeric_equal (bal.cleared_balance,
+                                     xaccAccountGetClearedBalance (acct)));
+        g_assert (gnc_numeric_equal (bal.reconciled_balance,
+                                     xaccAccountGetReconciledBalance (acct)));
+    }
+    /* Nothing was posted before the epoch. */
+    for (const auto& bal : gnc_sql_get_account_balances (sql_be, 0))
+        g_assert (gnc_numeric_zero_p (bal.balance));
+
+    auto query = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (query, book_2);
+    auto splits = qof_query_run (query);
+    g_assert_cmpint (g_list_length (splits), == ,
+                     qof_collection_count (qof_book_get_collection (book_1,
+                                                                    GNC_ID_SPLIT)));
+    qof_query_destroy (query);
+    compare_balances (book_1, book_2);
+    compare_books (book_1, book_2);
+
+    qof_session_end (session_1);
+    qof_session_destroy (session_1);
+    qof_session_end (session_2);
+    qof_session_destroy (session_2);
+}
+
 /* Test the gnc_dbi_load logic that forces a newer database to be
  * opened read-only and an older one to be safe-saved. Again, it would
  * be better to do this starting from a fresh file, but instead we're
@@ -646,6 +821,10 @@ create_dbi_test_suite (const char* dbm_name, const char* url)
                   test_dbi_store_and_reload, teardown);
     GNC_TEST_ADD (subsuite, "safe_save", Fixture, url, setup_memory,
                   test_dbi_safe_save, teardown);
+    GNC_TEST_ADD (subsuite, "edit_and_reload", Fixture, url, setup_memory,
+                  test_dbi_edit_and_reload, teardown);
+    GNC_TEST_ADD (subsuite, "lazy_load", Fixture, url, setup,
+                  test_dbi_lazy_load, teardown);
     GNC_TEST_ADD (subsuite, "version_control", Fixture, url, setup_memory,
                   test_dbi_version_control, teardown);
     GNC_TEST_ADD (subsuite, "business_store_and_reload", Fixture, url,
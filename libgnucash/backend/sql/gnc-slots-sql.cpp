@@ -42,6 +42,7 @@ extern "C"
 
 #include <string>
 #include <sstream>
+#include <unordered_map>
 
 #include "gnc-sql-connection.hpp"
 #include "gnc-sql-backend.hpp"
@@ -646,6 +647,58 @@ save_slot (const char* key, KvpValue* value, slot_info_t & slot_info)
     }
 }
 
+/* Replace only the rows of the top-level slots that differ from the copy
+ * recorded when the edit began. Returns false without touching the database
+ * if a changed slot holds a frame or a list: their rows hang off generated
+ * guids and are simpler to rewrite wholesale.
+ */
+static bool
+save_changed_slots (slot_info_t& slot_info, KvpFrame& recorded,
+                    KvpFrame& current)
+{
+    auto keys = current.get_keys ();
+    for (const auto& key : recorded.get_keys ())
+        if (current.get_slot ({key}) == nullptr)
+            keys.push_back (key);
+
+    std::vector<std::string> changed;
+    for (const auto& key : keys)
+    {
+        auto old_value = recorded.get_slot ({key});
+        auto new_value = current.get_slot ({key});
+        if (old_value && new_value && compare (old_value, new_value) == 0)
+            continue;
+        for (auto value : {old_value, new_value})
+            if (value && (value->get_type () == KvpValue::Type::FRAME ||
+                          value->get_type () == KvpValue::Type::GLIST))
+                return false;
+        changed.push_back (key);
+    }
+
+    gchar guid_buf[GUID_ENCODING_LENGTH + 1];
+    (void)guid_to_string_buff (slot_info.guid, guid_buf);
+    for (const auto& key : changed)
+    {
+        std::string sql{"DELETE FROM " TABLE_NAME " WHERE obj_guid='"};
+        sql += guid_buf;
+        sql += "' AND name=";
+        sql += slot_info.be->quote_string (key);
+        auto stmt = slot_info.be->create_statement_from_sql (sql);
+        if (stmt == nullptr ||
+            slot_info.be->execute_nonselect_statement (stmt) == -1)
+        {
+            slot_info.is_ok = FALSE;
+            break;
+        }
+        auto value = current.get_slot ({key});
+        if (value != nullptr)
+            save_slot (key.c_str (), value, slot_info);
+        if (!slot_info.is_ok)
+            break;
+    }
+    return true;
+}
+
 gboolean
 gnc_sql_slots_save (GncSqlBackend* sql_be, const GncGUID* guid, gboolean is_infant,
                     QofInstance* inst)
@@ -658,14 +711,17 @@ gnc_sql_slots_save (GncSqlBackend* sql_be, const GncGUID* guid, gboolean is_infa
     g_return_val_if_fail (guid != NULL, FALSE);
     g_return_val_if_fail (pFrame != NULL, FALSE);
 
+    slot_info.be = sql_be;
+    slot_info.guid = guid;
     // If this is not saving into a new db, clear out the old saved slots first
     if (!sql_be->pristine() && !is_infant)
     {
+        auto recorded = sql_be->take_slots (guid);
+        if (recorded && save_changed_slots (slot_info, *recorded, *pFrame))
+            return slot_info.is_ok;
         (void)gnc_sql_slots_delete (sql_be, guid);
     }
 
-    slot_info.be = sql_be;
-    slot_info.guid = guid;
     pFrame->for_each_slot_temp (save_slot, slot_info);
 
     return slot_info.is_ok;
@@ -682,6 +738,7 @@ gnc_sql_slots_delete (GncSqlBackend* sql_be, const GncGUID* guid)
     g_return_val_if_fail (sql_be != NULL, FALSE);
     g_return_val_if_fail (guid != NULL, FALSE);
 
+    (void)sql_be->take_slots (guid);
     (void)guid_to_string_buff (guid, guid_buf);
 
     buf = g_strdup_printf ("SELECT * FROM %s WHERE obj_guid='%s' and slot_type in ('%d', '%d') and not guid_val is null",
@@ -746,20 +803,275 @@ load_slot (slot_info_t* pInfo, GncSqlRow& row)
     delete slot_info;
 }
 
+/* ================================================================= */
+/* Bulk loading
+ *
+ * Loading a row through gnc_sql_load_object calls every column's setter and
+ * each nested frame or list issues a query of its own. The bulk loader
+ * instead reads the rows for a whole set of objects ordered by obj_guid,
+ * decodes only the value column used by each row's slot type and adds the
+ * value straight to its frame. Nested frames and lists are recorded by their
+ * guid_val and filled by one further query per level of nesting.
+ */
+
+struct slot_container_t
+{
+    KvpFrame* frame;    // Frame receiving the rows, nullptr for a list.
+    KvpValue* list;     // List value receiving the rows.
+    GList* items;       // The list's items so far, in reverse order.
+    std::string prefix; // Path of the container, stripped from row names.
+};
+
+using SlotContainerMap = std::unordered_map<std::string, slot_container_t>;
+
+static void
+load_int64_value (gpointer pObject, gint64 value)
+{
+    *static_cast<KvpValue**> (pObject) = new KvpValue {value};
+}
+
+static void
+load_string_value (gpointer pObject, gpointer pValue)
+{
+    if (pValue == NULL) return;
+    *static_cast<KvpValue**> (pObject) =
+        new KvpValue {g_strdup (static_cast<const char*> (pValue))};
+}
+
+static void
+load_double_value (gpointer pObject, gpointer pValue)
+{
+    if (pValue == NULL) return;
+    *static_cast<KvpValue**> (pObject) =
+        new KvpValue {*static_cast<double*> (pValue)};
+}
+
+static void
+load_time_value (gpointer pObject, time64 time)
+{
+    *static_cast<KvpValue**> (pObject) = new KvpValue {Time64{time}};
+}
+
+static void
+load_guid_value (gpointer pObject, gpointer pValue)
+{
+    if (pValue == NULL) return;
+    *static_cast<KvpValue**> (pObject) =
+        new KvpValue {guid_copy (static_cast<GncGUID*> (pValue))};
+}
+
+static void
+load_numeric_value (gpointer pObject, gnc_numeric value)
+{
+    *static_cast<KvpValue**> (pObject) = new KvpValue {value};
+}
+
+static void
+load_gdate_value (gpointer pObject, GDate* value)
+{
+    *static_cast<KvpValue**> (pObject) = new KvpValue {*value};
+}
+
+/* The value columns again, with setters that create a KvpValue. */
+static const EntryVec value_col_table
+{
+    gnc_sql_make_table_entry<CT_INT64>("int64_val", 0, 0, nullptr,
+                                       (QofSetterFunc)load_int64_value),
+    gnc_sql_make_table_entry<CT_STRING>("string_val", SLOT_MAX_PATHNAME_LEN, 0,
+                                        nullptr, load_string_value),
+    gnc_sql_make_table_entry<CT_DOUBLE>("double_val", 0, 0, nullptr,
+                                        load_double_value),
+    gnc_sql_make_table_entry<CT_TIME>("timespec_val", 0, 0, nullptr,
+                                      (QofSetterFunc)load_time_value),
+    gnc_sql_make_table_entry<CT_GUID>("guid_val", 0, 0, nullptr,
+                                      load_guid_value),
+    gnc_sql_make_table_entry<CT_NUMERIC>("numeric_val", 0, 0, nullptr,
+                                         (QofSetterFunc)load_numeric_value),
+    gnc_sql_make_table_entry<CT_GDATE>("gdate_val", 0, 0, nullptr,
+                                       (QofSetterFunc)load_gdate_value),
+};
+
+static KvpValue*
+load_slot_value (const GncSqlBackend* sql_be, GncSqlRow& row,
+                 KvpValue::Type type)
+{
+    int index;
+    switch (type)
+    {
+    case KvpValue::Type::INT64: index = 0; break;
+    case KvpValue::Type::STRING: index = 1; break;
+    case KvpValue::Type::DOUBLE: index = 2; break;
+    case KvpValue::Type::TIME64: index = 3; break;
+    case KvpValue::Type::GUID: index = 4; break;
+    case KvpValue::Type::NUMERIC: index = 5; break;
+    case KvpValue::Type::GDATE: index = 6; break;
+    default: return nullptr;
+    }
+    KvpValue* value = nullptr;
+    value_col_table[index]->load (sql_be, row, TABLE_NAME, &value);
+    return value;
+}
+
+static void
+load_slot_into (const GncSqlBackend* sql_be, GncSqlRow& row,
+                slot_container_t& container, SlotContainerMap& children)
+{
+    KvpValue::Type type;
+    std::string name;
+    try
+    {
+        type = static_cast<KvpValue::Type> (
+            row.get_int_at_col (col_table[slot_type_col]->name()));
+        name = row.get_string_at_col (col_table[name_col]->name());
+    }
+    catch (std::invalid_argument&)
+    {
+        return;
+    }
+
+    KvpValue* value = nullptr;
+    if (type == KvpValue::Type::FRAME || type == KvpValue::Type::GLIST)
+    {
+        std::string guid;
+        try
+        {
+            guid = row.get_string_at_col (col_table[guid_val_col]->name());
+        }
+        catch (std::invalid_argument&)
+        {
+            return;
+        }
+        if (type == KvpValue::Type::FRAME)
+        {
+            auto frame = new KvpFrame;
+            value = new KvpValue {frame};
+            children.emplace (guid, slot_container_t {frame, nullptr, nullptr,
+                                                      name + "/"});
+        }
+        else
+        {
+            value = new KvpValue {static_cast<GList*> (nullptr)};
+            children.emplace (guid, slot_container_t {nullptr, value, nullptr,
+                                                      name + "/"});
+        }
+    }
+    else
+    {
+        value = load_slot_value (sql_be, row, type);
+    }
+    if (value == nullptr)
+        return;
+
+    if (container.frame == nullptr)
+    {
+        container.items = g_list_prepend (container.items, value);
+        return;
+    }
+    if (name.compare (0, container.prefix.size(), container.prefix) == 0)
+        name.erase (0, container.prefix.size());
+    container.frame->set ({name}, value);
+}
+
+/**
+ * Load the slots of the objects whose guids are returned by subquery, or are
+ * the single quoted guid in it. The owning instances are found with
+ * lookup_fn, or are inst if lookup_fn is NULL; rows for instances that
+ * aren't loaded are skipped.
+ */
+static void
+slots_load_bulk (GncSqlBackend* sql_be, std::string subquery,
+                 BookLookupFn lookup_fn, QofInstance* inst)
+{
+    std::string obj_guid_col(obj_guid_col_table[0]->name());
+    std::string nested_types(
+        std::to_string (static_cast<int> (KvpValue::Type::FRAME)) + ", " +
+        std::to_string (static_cast<int> (KvpValue::Type::GLIST)));
+    SlotContainerMap containers;
+    bool top_level = true;
+
+    while (top_level || !containers.empty())
+    {
+        std::string sql("SELECT * FROM " TABLE_NAME " WHERE ");
+        sql += obj_guid_col + " IN (" + subquery + ") ORDER BY " +
+            obj_guid_col + ", " + col_table[id_col]->name();
+        auto stmt = sql_be->create_statement_from_sql(sql);
+        if (stmt == nullptr)
+        {
+            PERR ("stmt == NULL, SQL = '%s'\n", sql.c_str());
+            return;
+        }
+
+        SlotContainerMap children;
+        slot_container_t object_slots {nullptr, nullptr, nullptr, ""};
+        slot_container_t* container = nullptr;
+        std::string current_guid;
+        bool first_row = true;
+        auto result = sql_be->execute_select_statement(stmt);
+        for (auto row : *result)
+        {
+            std::string obj_guid;
+            try
+            {
+                obj_guid = row.get_string_at_col (obj_guid_col.c_str());
+            }
+            catch (std::invalid_argument&)
+            {
+                continue;
+            }
+            /* The rows come grouped by object, so only look up the
+             * container when the object changes. */
+            if (first_row || obj_guid != current_guid)
+            {
+                first_row = false;
+                current_guid = obj_guid;
+                container = nullptr;
+                if (top_level)
+                {
+                    GncGUID guid;
+                    QofInstance* owner = inst;
+                    if (lookup_fn != nullptr)
+                        owner = string_to_guid (obj_guid.c_str(), &guid) ?
+                            lookup_fn (&guid, sql_be->book()) : nullptr;
+                    object_slots.frame = owner ?
+                        qof_instance_get_slots (owner) : nullptr;
+                    if (object_slots.frame != nullptr)
+                        container = &object_slots;
+                }
+                else
+                {
+                    auto iter = containers.find (obj_guid);
+                    if (iter != containers.end())
+                        container = &iter->second;
+                }
+            }
+            if (container == nullptr)
+                continue;
+            load_slot_into (sql_be, row, *container, children);
+        }
+        delete result;
+
+        for (auto& entry : containers)
+        {
+            auto& list = entry.second;
+            if (list.frame == nullptr)
+                list.list->replace_glist_nc (g_list_reverse (list.items));
+        }
+        containers = std::move (children);
+        subquery = "SELECT " + std::string{col_table[guid_val_col]->name()} +
+            " FROM " TABLE_NAME " WHERE " + obj_guid_col + " IN (" +
+            subquery + ") AND slot_type IN (" + nested_types + ")";
+        top_level = false;
+    }
+}
+
 void
 gnc_sql_slots_load (GncSqlBackend* sql_be, QofInstance* inst)
 {
-    slot_info_t info = { NULL, NULL, TRUE, NULL, KvpValue::Type::INVALID,
-                         NULL, FRAME, NULL, "" };
     g_return_if_fail (sql_be != NULL);
     g_return_if_fail (inst != NULL);
 
-    info.be = sql_be;
-    info.guid = qof_instance_get_guid (inst);
-    info.pKvpFrame = qof_instance_get_slots (inst);
-    info.context = NONE;
-
-    slots_load_info (&info);
+    gnc::GUID guid(*qof_instance_get_guid (inst));
+    slots_load_bulk (sql_be, "'" + guid.to_string() + "'", nullptr, inst);
 }
 
 static void
@@ -820,30 +1132,6 @@ load_slot_for_list_item (GncSqlBackend* sql_be, GncSqlRow& row,
 
 }
 
-static void
-load_slot_for_book_object (GncSqlBackend* sql_be, GncSqlRow& row,
-                           BookLookupFn lookup_fn)
-{
-    slot_info_t slot_info = { NULL, NULL, TRUE, NULL, KvpValue::Type::INVALID,
-                              NULL, FRAME, NULL, "" };
-    const GncGUID* guid;
-    QofInstance* inst;
-
-    g_return_if_fail (sql_be != NULL);
-    g_return_if_fail (lookup_fn != NULL);
-
-    guid = load_obj_guid (sql_be, row);
-    g_return_if_fail (guid != NULL);
-    inst = lookup_fn (guid, sql_be->book());
-    if (inst == NULL) return; /* Silently bail if the guid isn't loaded yet. */
-
-    slot_info.be = sql_be;
-    slot_info.pKvpFrame = qof_instance_get_slots (inst);
-    slot_info.path.clear();
-
-    gnc_sql_load_object (sql_be, row, TABLE_NAME, &slot_info, col_table);
-}
-
 /**
  * gnc_sql_slots_load_for_sql_subquery - Loads slots for all objects whose guid is
  * supplied by a subquery.  The subquery should be of the form "SELECT DISTINCT guid FROM ...".
@@ -858,25 +1146,12 @@ void gnc_sql_slots_load_for_sql_subquery (GncSqlBackend* sql_be,
                                           BookLookupFn lookup_fn)
 {
     g_return_if_fail (sql_be != NULL);
+    g_return_if_fail (lookup_fn != NULL);
 
     // Ignore empty subquery
     if (subquery.empty()) return;
 
-    std::string pkey(obj_guid_col_table[0]->name());
-    std::string sql("SELECT * FROM " TABLE_NAME " WHERE ");
-    sql += pkey + " IN (" + subquery + ")";
-
-    // Execute the query and load the slots
-    auto stmt = sql_be->create_statement_from_sql(sql);
-    if (stmt == nullptr)
-    {
-        PERR ("stmt == NULL, SQL = '%s'\n", sql.c_str());
-        return;
-    }
-    auto result = sql_be->execute_select_statement(stmt);
-    for (auto row : *result)
-        load_slot_for_book_object (sql_be, row, lookup_fn);
-    delete result;
+    slots_load_bulk (sql_be, subquery, lookup_fn, nullptr);
 }
 
 /* ================================================================= */
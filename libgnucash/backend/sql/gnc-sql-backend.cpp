@@ -32,10 +32,12 @@ extern "C"
 #include <gncTaxTable.h>
 #include <gncInvoice.h>
 #include <gnc-pricedb.h>
+#include <Transaction.h>
 }
 
 #include <algorithm>
 #include <cassert>
+#include <kvp-frame.hpp>
 
 #include "gnc-sql-connection.hpp"
 #include "gnc-sql-backend.hpp"
@@ -69,6 +71,12 @@ static QofLogModule log_module = G_LOG_DOMAIN;
 #define MAX_TABLE_NAME_LEN 50
 #define TABLE_COL_NAME "table_name"
 #define VERSION_COL_NAME "table_version"
+/* Limits on a multi-row INSERT, comfortably inside the defaults of SQLite
+ * (SQLITE_MAX_COMPOUND_SELECT, SQLITE_MAX_SQL_LENGTH), MySQL
+ * (max_allowed_packet) and PostgreSQL.
+ */
+#define MAX_INSERT_ROWS 250
+#define MAX_INSERT_LENGTH (256 * 1024)
 
 using StrVec = std::vector<std::string>;
 
@@ -117,6 +125,7 @@ GncSqlBackend::create_statement_from_sql(const std::string& str) const noexcept
 GncSqlResultPtr
 GncSqlBackend::execute_select_statement(const GncSqlStatementPtr& stmt) const noexcept
 {
+    flush_inserts();
     auto result = m_conn ? m_conn->execute_select_statement(stmt) : nullptr;
     if (result == nullptr)
     {
@@ -129,6 +138,8 @@ GncSqlBackend::execute_select_statement(const GncSqlStatementPtr& stmt) const no
 int
 GncSqlBackend::execute_nonselect_statement(const GncSqlStatementPtr& stmt) const noexcept
 {
+    if (!flush_inserts())
+        return -1;
     int result = m_conn ? m_conn->execute_nonselect_statement(stmt) : -1;
     if (result == -1)
     {
@@ -252,7 +263,7 @@ GncSqlBackend::ObjectBackendRegistry::load_remaining(GncSqlBackend* sql_be)
 
         num_done++;
         sql_be->update_progress(num_done * 100 / num_types);
-        obe->load_all (sql_be);
+        obe->load_initial (sql_be);
     }
 }
 
@@ -285,6 +296,9 @@ GncSqlBackend::load (QofBook* book, QofBackendLoadType loadType)
     ENTER ("sql_be=%p, book=%p", this, book);
 
     m_loading = TRUE;
+    m_recorded_rows.clear();
+    m_recorded_slots.clear();
+    m_recorded_edits.clear();
 
     if (loadType == LOAD_TYPE_INITIAL_LOAD)
     {
@@ -302,7 +316,7 @@ GncSqlBackend::load (QofBook* book, QofBackendLoadType loadType)
             if (obe)
             {
                 update_progress(num_done * 100 / num_types);
-                obe->load_all(this);
+                obe->load_initial(this);
             }
         }
         for (auto type : business_fixed_load_order)
@@ -312,7 +326,7 @@ GncSqlBackend::load (QofBook* book, QofBackendLoadType loadType)
             if (obe)
             {
                 update_progress(num_done * 100 / num_types);
-                obe->load_all(this);
+                obe->load_initial(this);
             }
         }
 
@@ -470,6 +484,10 @@ GncSqlBackend::sync(QofBook* book)
     ENTER ("book=%p, sql_be->book=%p", book, m_book);
     update_progress(101.0);
 
+    m_recorded_rows.clear();
+    m_recorded_slots.clear();
+    m_recorded_edits.clear();
+
     /* Create new tables */
     m_is_pristine_db = true;
     create_tables();
@@ -477,6 +495,8 @@ GncSqlBackend::sync(QofBook* book)
     /* Save all contents */
     m_book = book;
     auto is_ok = m_conn->begin_transaction();
+    if (is_ok)
+        begin_insert_batch();
 
     // FIXME: should write the set of commodities that are used
     // write_commodities(sql_be, book);
@@ -506,6 +526,10 @@ GncSqlBackend::sync(QofBook* book)
         for (auto entry : m_backend_registry)
             std::get<1>(entry)->write (this);
     }
+    if (is_ok)
+        is_ok = end_insert_batch();
+    else
+        discard_insert_batch();
     if (is_ok)
     {
         is_ok = m_conn->commit_transaction();
@@ -534,19 +558,156 @@ GncSqlBackend::sync(QofBook* book)
 void
 GncSqlBackend::begin(QofInstance* inst)
 {
-    //g_return_if_fail (inst != NULL);
+    g_return_if_fail (inst != NULL);
+
+    if (m_loading || m_is_pristine_db || m_conn == nullptr)
+        return;
+    /* Whatever is done to an account may involve all of its splits. */
+    if (GNC_IS_ACCOUNT (inst) && !m_in_query)
+    {
+        auto obe = std::static_pointer_cast<GncSqlTransBackend>(
+            m_backend_registry.get_object_backend (GNC_ID_TRANS));
+        if (obe && obe->lazy())
+        {
+            m_in_query = true;
+            obe->load_for_account (this, GNC_ACCOUNT (inst));
+            m_in_query = false;
+        }
+    }
+    gchar guid_buf[GUID_ENCODING_LENGTH + 1];
+    (void)guid_to_string_buff (qof_instance_get_guid (inst), guid_buf);
+    m_recording_edit = &m_recorded_edits[guid_buf];
+    record_instance (inst);
+    /* Splits are committed after their transaction without a begin() of
+     * their own, so record them along with it, each as its own edit for
+     * its commit to use.
+     */
+    if (GNC_IS_TRANS (inst))
+    {
+        for (auto node = xaccTransGetSplitList (GNC_TRANS (inst)); node;
+             node = g_list_next (node))
+        {
+            auto split = QOF_INSTANCE (node->data);
+            (void)guid_to_string_buff (qof_instance_get_guid (split), guid_buf);
+            m_recording_edit = &m_recorded_edits[guid_buf];
+            record_instance (split);
+        }
+    }
+    m_recording_edit = nullptr;
+}
+
+/* Drop whatever begin() recorded for inst's edit that its commit didn't use,
+ * such as the rows of splits that didn't change or of an edit rolled back.
+ */
+void
+GncSqlBackend::forget_recorded (QofInstance* inst) noexcept
+{
+    if (m_recorded_edits.empty())
+        return;
+    gchar guid_buf[GUID_ENCODING_LENGTH + 1];
+    (void)guid_to_string_buff (qof_instance_get_guid (inst), guid_buf);
+    auto edit = m_recorded_edits.find (guid_buf);
+    if (edit == m_recorded_edits.end())
+        return;
+    for (const auto& key : edit->second.rows)
+        m_recorded_rows.erase (key);
+    for (const auto& guid : edit->second.slots)
+        m_recorded_slots.erase (guid);
+    m_recorded_edits.erase (edit);
+}
 
-    //ENTER (" ");
-    //LEAVE ("");
+/* A transaction's splits are committed after it, but only the dirty ones, so
+ * forget the others' records along with the transaction's.
+ */
+void
+GncSqlBackend::forget_unchanged_splits (Transaction* trans) noexcept
+{
+    for (auto node = xaccTransGetSplitList (trans); node;
+         node = g_list_next (node))
+    {
+        auto split = QOF_INSTANCE (node->data);
+        if (!qof_instance_get_dirty_flag (split))
+            forget_recorded (split);
+    }
+}
+
+/* An instance that isn't dirty matches its database row (commit() relies on
+ * that too), so its current values are what an UPDATE would overwrite.
+ */
+void
+GncSqlBackend::record_instance (QofInstance* inst) noexcept
+{
+    if (qof_instance_get_infant (inst) || qof_instance_get_dirty_flag (inst) ||
+        qof_instance_get_destroying (inst))
+        return;
+    auto obe = m_backend_registry.get_object_backend (std::string{inst->e_type});
+    if (obe == nullptr)
+        return;
+    obe->record (this, inst);
+    gchar guid_buf[GUID_ENCODING_LENGTH + 1];
+    (void)guid_to_string_buff (qof_instance_get_guid (inst), guid_buf);
+    m_recorded_slots[guid_buf] =
+        std::make_unique<KvpFrame>(*qof_instance_get_slots (inst));
+    if (m_recording_edit)
+        m_recording_edit->slots.emplace_back (guid_buf);
+}
+
+void
+GncSqlBackend::record_row (const char* table_name, QofIdTypeConst obj_name,
+                           gpointer pObject, const EntryVec& table) noexcept
+{
+    auto values = get_object_values (obj_name, pObject, table);
+    if (values.empty())
+        return;
+    auto key = table_name + values[0].second;
+    if (m_recording_edit)
+        m_recording_edit->rows.push_back (key);
+    m_recorded_rows[std::move (key)] = std::move (values);
+}
+
+std::unique_ptr<KvpFrame>
+GncSqlBackend::take_slots (const GncGUID* guid) noexcept
+{
+    if (m_recorded_slots.empty())
+        return nullptr;
+    gchar guid_buf[GUID_ENCODING_LENGTH + 1];
+    (void)guid_to_string_buff (guid, guid_buf);
+    auto slots = m_recorded_slots.find (guid_buf);
+    if (slots == m_recorded_slots.end())
+        return nullptr;
+    auto frame = std::move (slots->second);
+    m_recorded_slots.erase (slots);
+    return frame;
+}
+
+void
+GncSqlBackend::load_for_query(QofQuery* query)
+{
+    g_return_if_fail (query != nullptr);
+
+    if (m_loading || m_in_query || m_conn == nullptr)
+        return;
+    auto obe = std::static_pointer_cast<GncSqlTransBackend>(
+        m_backend_registry.get_object_backend (GNC_ID_TRANS));
+    if (obe == nullptr || !obe->lazy())
+        return;
+    m_in_query = true;
+    obe->load_for_query (this, query);
+    m_in_query = false;
 }
 
 void
 GncSqlBackend::rollback(QofInstance* inst)
 {
-    //g_return_if_fail (inst != NULL);
+    g_return_if_fail (inst != NULL);
 
-    //ENTER (" ");
-    //LEAVE ("");
+    forget_recorded (inst);
+    if (GNC_IS_TRANS (inst))
+    {
+        for (auto node = xaccTransGetSplitList (GNC_TRANS (inst)); node;
+             node = g_list_next (node))
+            forget_recorded (QOF_INSTANCE (node->data));
+    }
 }
 
 void
@@ -567,28 +728,39 @@ GncSqlBackend::get_object_backend(const std::string& type) const noexcept
  */
 void
 GncSqlBackend::commit (QofInstance* inst)
+{
+    g_return_if_fail (inst != NULL);
+
+    commit_instance (inst);
+    forget_recorded (inst);
+    if (GNC_IS_TRANS (inst))
+        forget_unchanged_splits (GNC_TRANS (inst));
+}
+
+void
+GncSqlBackend::commit_instance (QofInstance* inst)
 {
     sql_backend be_data;
     gboolean is_dirty;
     gboolean is_destroying;
     gboolean is_infant;
 
-    g_return_if_fail (inst != NULL);
     g_return_if_fail (m_conn != nullptr);
 
-    if (qof_book_is_readonly(m_book))
-    {
-        set_error (ERR_BACKEND_READONLY);
-        (void)m_conn->rollback_transaction ();
-        return;
-    }
     /* During initial load where objects are being created, don't commit
-    anything, but do mark the object as clean. */
+    anything, but do mark the object as clean. Transactions loaded or evicted
+    later on demand go through here too, even in a read-only book. */
     if (m_loading)
     {
         qof_instance_mark_clean (inst);
         return;
     }
+    if (qof_book_is_readonly(m_book))
+    {
+        set_error (ERR_BACKEND_READONLY);
+        (void)m_conn->rollback_transaction ();
+        return;
+    }
 
     // The engine has a PriceDB object but it isn't in the database
     if (strcmp (inst->e_type, "PriceDB") == 0)
@@ -625,7 +797,14 @@ GncSqlBackend::commit (QofInstance* inst)
 
     auto obe = m_backend_registry.get_object_backend(std::string{inst->e_type});
     if (obe != nullptr)
+    {
+        begin_insert_batch();
         is_ok = obe->commit(this, inst);
+        if (is_ok)
+            is_ok = end_insert_batch();
+        else
+            discard_insert_batch();
+    }
     else
     {
         PERR ("Unknown object type '%s'\n", inst->e_type);
@@ -854,13 +1033,29 @@ GncSqlBackend::do_db_operation (E_DB_OPERATION op, const char* table_name,
     g_return_val_if_fail (obj_name != nullptr, false);
     g_return_val_if_fail (pObject != nullptr, false);
 
+    /* Any other write leaves a recorded row out of date. */
+    if (op != OP_DB_UPDATE && !m_recorded_rows.empty())
+    {
+        auto values = get_object_values (obj_name, pObject, table);
+        if (!values.empty())
+            m_recorded_rows.erase (table_name + values[0].second);
+    }
+
     switch(op)
     {
         case  OP_DB_INSERT:
+        if (m_batch_inserts)
+            return queue_insert (table_name,
+                                 get_object_values (obj_name, pObject, table));
         stmt = build_insert_statement (table_name, obj_name, pObject, table);
         break;
         case OP_DB_UPDATE:
-        stmt = build_update_statement (table_name, obj_name, pObject, table);
+        {
+            auto values = get_object_values (obj_name, pObject, table);
+            if (remove_unchanged (table_name, values) && values.size() == 1)
+                return true;
+            stmt = build_update_statement (table_name, obj_name, values);
+        }
         break;
         case OP_DB_DELETE:
         stmt = build_delete_statement (table_name, obj_name, pObject, table);
@@ -871,6 +1066,38 @@ GncSqlBackend::do_db_operation (E_DB_OPERATION op, const char* table_name,
     return (execute_nonselect_statement(stmt) != -1);
 }
 
+/* If begin() recorded the row, reduce values to the primary key and the
+ * columns whose values differ from it. Returns false, leaving values alone,
+ * if there's nothing to compare with.
+ */
+bool
+GncSqlBackend::remove_unchanged (const char* table_name,
+                                 PairVec& values) const noexcept
+{
+    if (m_recorded_rows.empty() || values.empty())
+        return false;
+    auto row = m_recorded_rows.find (table_name + values[0].second);
+    if (row == m_recorded_rows.end())
+        return false;
+    auto recorded = std::move (row->second);
+    m_recorded_rows.erase (row);
+    /* NULL columns are left out, so a column that became or stopped being
+     * NULL makes the rows line up differently; write them all.
+     */
+    if (recorded.size() != values.size())
+        return false;
+    PairVec changed{values[0]};
+    for (size_t i = 1; i < values.size(); ++i)
+    {
+        if (values[i].first != recorded[i].first)
+            return false;
+        if (values[i].second != recorded[i].second)
+            changed.push_back (std::move (values[i]));
+    }
+    values = std::move (changed);
+    return true;
+}
+
 bool
 GncSqlBackend::save_commodity(gnc_commodity* comm) noexcept
 {
@@ -882,56 +1109,129 @@ GncSqlBackend::save_commodity(gnc_commodity* comm) noexcept
     return true;
 }
 
+static std::string
+insert_head (const char* table_name, const PairVec& values)
+{
+    std::string sql{"INSERT INTO "};
+    sql += table_name;
+    sql += "(";
+    for (auto col_value = values.begin(); col_value != values.end(); ++col_value)
+    {
+        if (col_value != values.begin())
+            sql += ",";
+        sql += col_value->first;
+    }
+    sql += ") VALUES";
+    return sql;
+}
+
+static void
+append_insert_row (std::string& sql, const PairVec& values)
+{
+    sql += "(";
+    for (auto col_value = values.begin(); col_value != values.end(); ++col_value)
+    {
+        if (col_value != values.begin())
+            sql += ",";
+        sql += col_value->second;
+    }
+    sql += ")";
+}
+
 GncSqlStatementPtr
 GncSqlBackend::build_insert_statement (const char* table_name,
                                        QofIdTypeConst obj_name,
                                        gpointer pObject,
                                        const EntryVec& table) const noexcept
 {
-    GncSqlStatementPtr stmt;
-    PairVec col_values;
-    std::ostringstream sql;
-
     g_return_val_if_fail (table_name != nullptr, nullptr);
     g_return_val_if_fail (obj_name != nullptr, nullptr);
     g_return_val_if_fail (pObject != nullptr, nullptr);
     PairVec values{get_object_values(obj_name, pObject, table)};
 
-    sql << "INSERT INTO " << table_name <<"(";
-    for (auto const& col_value : values)
+    auto sql = insert_head (table_name, values);
+    append_insert_row (sql, values);
+    return create_statement_from_sql(sql);
+}
+
+void
+GncSqlBackend::begin_insert_batch() noexcept
+{
+    m_batch_inserts = true;
+    m_batch_failed = false;
+}
+
+/* Write out the queued rows and stop queueing. Returns false if any
+ * multi-row INSERT in the batch failed.
+ */
+bool
+GncSqlBackend::end_insert_batch() noexcept
+{
+    auto is_ok = flush_inserts() && !m_batch_failed;
+    m_batch_inserts = false;
+    m_batch_failed = false;
+    return is_ok;
+}
+
+void
+GncSqlBackend::discard_insert_batch() noexcept
+{
+    m_insert_head.clear();
+    m_insert_rows.clear();
+    m_insert_count = 0;
+    m_batch_inserts = false;
+    m_batch_failed = false;
+}
+
+bool
+GncSqlBackend::queue_insert (const char* table_name,
+                             const PairVec& values) const noexcept
+{
+    auto head = insert_head (table_name, values);
+    if (head != m_insert_head || m_insert_count >= MAX_INSERT_ROWS ||
+        m_insert_rows.size() >= MAX_INSERT_LENGTH)
     {
-        if (col_value != *values.begin())
-            sql << ",";
-        sql << col_value.first;
+        if (!flush_inserts())
+            return false;
+        m_insert_head = std::move (head);
     }
+    if (m_insert_count++ > 0)
+        m_insert_rows += ",";
+    append_insert_row (m_insert_rows, values);
+    return true;
+}
 
-    sql << ") VALUES(";
-    for (auto col_value : values)
+bool
+GncSqlBackend::flush_inserts() const noexcept
+{
+    if (m_insert_count == 0)
+        return true;
+    auto sql = m_insert_head + m_insert_rows;
+    m_insert_rows.clear();
+    m_insert_count = 0;
+    auto stmt = create_statement_from_sql(sql);
+    if (stmt == nullptr || !m_conn ||
+        m_conn->execute_nonselect_statement(stmt) == -1)
     {
-        if (col_value != *values.begin())
-            sql << ",";
-        sql << col_value.second;
+        PERR ("SQL error: %s\n", sql.c_str());
+        qof_backend_set_error ((QofBackend*)this, ERR_BACKEND_SERVER_ERR);
+        m_batch_failed = true;
+        return false;
     }
-    sql << ")";
-
-    stmt = create_statement_from_sql(sql.str());
-    return stmt;
+    return true;
 }
 
 GncSqlStatementPtr
 GncSqlBackend::build_update_statement(const gchar* table_name,
-                                      QofIdTypeConst obj_name, gpointer pObject,
-                                      const EntryVec& table) const noexcept
+                                      QofIdTypeConst obj_name,
+                                      PairVec& values) const noexcept
 {
     GncSqlStatementPtr stmt;
     std::ostringstream sql;
 
     g_return_val_if_fail (table_name != nullptr, nullptr);
     g_return_val_if_fail (obj_name != nullptr, nullptr);
-    g_return_val_if_fail (pObject != nullptr, nullptr);
-
-
-    PairVec values{get_object_values (obj_name, pObject, table)};
+    g_return_val_if_fail (!values.empty(), nullptr);
 
     // Create the SQL statement
     sql <<  "UPDATE " << table_name << " SET ";
@@ -32,12 +32,15 @@ extern "C"
 #include <memory>
 #include <exception>
 #include <sstream>
+#include <string>
+#include <unordered_map>
 #include <vector>
 #include <qof-backend.hpp>
 
 class GncSqlColumnTableEntry;
 using GncSqlColumnTableEntryPtr = std::shared_ptr<GncSqlColumnTableEntry>;
 using EntryVec = std::vector<GncSqlColumnTableEntryPtr>;
+using PairVec = std::vector<std::pair<std::string, std::string>>;
 class GncSqlObjectBackend;
 using GncSqlObjectBackendPtr = std::shared_ptr<GncSqlObjectBackend>;
 using OBEEntry = std::tuple<std::string, GncSqlObjectBackendPtr>;
@@ -80,7 +83,17 @@ public:
      */
     void sync(QofBook*) override;
     /**
-     * An object is about to be edited.
+     * If transactions are being loaded lazily, load the ones a query might
+     * match.
+     *
+     * @param query The query about to be run
+     */
+    void load_for_query(QofQuery*) override;
+    /**
+     * An object is about to be edited. Unless it has uncommitted changes,
+     * record its row, its slots and for a transaction its splits' rows and
+     * slots as they are in the database, so that committing the edit writes
+     * only what changed.
      *
      * @param inst Object being edited
      */
@@ -234,6 +247,25 @@ public:
      * @return true if the commodity needed to be saved.
      */
     bool save_commodity(gnc_commodity* comm) noexcept;
+    /**
+     * Record an object's row as the database holds it, for
+     * do_db_operation(OP_DB_UPDATE) to compare with.
+     *
+     * @param table_name SQL table name
+     * @param obj_name QOF object type name
+     * @param pObject Gnucash object
+     * @param table DB table description
+     */
+    void record_row(const char* table_name, QofIdTypeConst obj_name,
+                    gpointer pObject, const EntryVec& table) noexcept;
+    /**
+     * Take the copy of an object's slots that begin() recorded.
+     *
+     * @param guid The object's GncGUID
+     * @return The slots as the database holds them, or nullptr if they
+     * weren't recorded.
+     */
+    std::unique_ptr<KvpFrame> take_slots(const GncGUID* guid) noexcept;
     QofBook* book() const noexcept { return m_book; }
     void set_loading(bool loading) noexcept { m_loading = loading; }
     bool pristine() const noexcept { return m_is_pristine_db; }
@@ -254,14 +286,23 @@ private:
     bool write_transactions();
     bool write_template_transactions();
     bool write_schedXactions();
+    void begin_insert_batch() noexcept;
+    bool end_insert_batch() noexcept;
+    void discard_insert_batch() noexcept;
+    bool queue_insert(const char* table_name, const PairVec& values) const noexcept;
+    bool flush_inserts() const noexcept;
+    void commit_instance(QofInstance* inst);
+    void record_instance(QofInstance* inst) noexcept;
+    void forget_recorded(QofInstance* inst) noexcept;
+    void forget_unchanged_splits(Transaction* trans) noexcept;
+    bool remove_unchanged(const char* table_name, PairVec& values) const noexcept;
     GncSqlStatementPtr build_insert_statement (const char* table_name,
                                                QofIdTypeConst obj_name,
                                                gpointer pObject,
                                                const EntryVec& table) const noexcept;
     GncSqlStatementPtr build_update_statement (const gchar* table_name,
                                                QofIdTypeConst obj_name,
-                                               gpointer pObject,
-                                               const EntryVec& table) const noexcept;
+                                               PairVec& values) const noexcept;
     GncSqlStatementPtr build_delete_statement (const char* table_name,
                                                QofIdTypeConst obj_name,
                                                gpointer pObject,
@@ -288,6 +329,32 @@ private:
     };
     ObjectBackendRegistry m_backend_registry;
     std::vector<gnc_commodity*> m_postload_commodities;
+    /* While a batch is open do_db_operation queues inserted rows and writes
+     * each run of rows for the same table and columns as one multi-row
+     * INSERT. The queue is written out before any other statement.
+     */
+    bool m_batch_inserts = false;
+    mutable bool m_batch_failed = false;
+    mutable std::string m_insert_head;  /**< INSERT INTO table(columns) VALUES */
+    mutable std::string m_insert_rows;  /**< The queued rows' value lists */
+    mutable unsigned int m_insert_count = 0;
+    /* Rows keyed by table name and primary key, and slots keyed by guid, as
+     * the database holds them; recorded by begin() and used up by the
+     * commit that follows.
+     */
+    mutable std::unordered_map<std::string, PairVec> m_recorded_rows;
+    std::unordered_map<std::string, std::unique_ptr<KvpFrame>> m_recorded_slots;
+    /* The keys of the rows and slots each edit recorded, by the guid of the
+     * instance begin() was called for or of one of its transaction's splits,
+     * so that its commit or rollback can drop the ones that weren't used.
+     */
+    struct RecordedEdit
+    {
+        std::vector<std::string> rows;
+        std::vector<std::string> slots;
+    };
+    std::unordered_map<std::string, RecordedEdit> m_recorded_edits;
+    RecordedEdit* m_recording_edit = nullptr;
 };
 
 #endif //__GNC_SQL_BACKEND_HPP__
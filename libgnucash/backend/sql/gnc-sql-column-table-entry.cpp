@@ -389,8 +389,11 @@ GncSqlColumnTableEntryImpl<CT_TIME>::load (const GncSqlBackend* sql_be,
         try
         {
             auto val = row.get_string_at_col(m_col_name);
-            GncDateTime time(val);
-            t = static_cast<time64>(time);
+            if (!GncDateTime::parse_iso8601(val.c_str(), t))
+            {
+                GncDateTime time(val);
+                t = static_cast<time64>(time);
+            }
         }
         catch (const std::invalid_argument& err)
         {
@@ -447,9 +450,13 @@ GncSqlColumnTableEntryImpl<CT_TIME>::add_to_query(QofIdTypeConst obj_name,
     }
     if (t64 > MINTIME && t64 < MAXTIME)
     {
-        GncDateTime time(t64);
+        char buff[GncDateTime::iso8601_buff_size];
         std::string timestr("'");
-        timestr += time.format_iso8601() + "'";
+        if (GncDateTime::format_iso8601_buff(t64, buff))
+            timestr += buff;
+        else
+            timestr += GncDateTime(t64).format_iso8601();
+        timestr += "'";
         vec.emplace_back (std::make_pair (std::string{m_col_name}, timestr));
     }
     else
@@ -95,3 +95,11 @@ GncSqlObjectBackend::instance_in_db(const GncSqlBackend* sql_be,
     return sql_be->object_in_db(m_table_name.c_str(), m_type_name.c_str(),
                                 inst, m_col_table);
 }
+
+void
+GncSqlObjectBackend::record(GncSqlBackend* sql_be,
+                            QofInstance* inst) const noexcept
+{
+    sql_be->record_row(m_table_name.c_str(), m_type_name.c_str(),
+                       inst, m_col_table);
+}
@@ -60,6 +60,12 @@ public:
      * @param sql_be The GncSqlBackend containing the database connection.
      */
     virtual void load_all (GncSqlBackend* sql_be) = 0;
+    /**
+     * Load the objects of m_type that are needed when a book is opened;
+     * unless overridden, all of them.
+     * @param sql_be The GncSqlBackend containing the database connection.
+     */
+    virtual void load_initial (GncSqlBackend* sql_be) { load_all (sql_be); }
     /**
      * Conditionally create or update a database table from m_col_table. The
      * condition is the version returned by querying the database's version
@@ -105,6 +111,14 @@ public:
      */
     bool instance_in_db(const GncSqlBackend* sql_be,
                         QofInstance* inst) const noexcept;
+    /**
+     * Record an unmodified instance's row so that the UPDATE which commits
+     * its next edit can leave out the columns that didn't change.
+     *
+     * @param sql_be Backend owning the database
+     * @param inst QofInstance about to be edited.
+     */
+    void record(GncSqlBackend* sql_be, QofInstance* inst) const noexcept;
 protected:
     const std::string m_table_name;
     const int m_version;
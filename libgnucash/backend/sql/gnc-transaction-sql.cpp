@@ -43,14 +43,19 @@ extern "C"
 #include "engine-helpers.h"
 #include "gnc-commodity.h"
 #include "gnc-engine.h"
+#include "TransLog.h"
 
 #ifdef S_SPLINT_S
 #include "splint-defs.h"
 #endif
 }
 
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
 #include <string>
 #include <sstream>
+#include <unordered_set>
 
 #include "escape.h"
 
@@ -328,12 +333,13 @@ typedef struct
  * of the splits.
  *
  * @param sql_be SQL backend
- * @param stmt SQL statement
+ * @param selector Subquery or condition selecting the transactions
+ * @return The transactions that weren't already loaded
  */
-static void
+static InstanceVec
 query_transactions (GncSqlBackend* sql_be, std::string selector)
 {
-    g_return_if_fail (sql_be != NULL);
+    g_return_val_if_fail (sql_be != NULL, InstanceVec{});
 
     const std::string tpkey(tx_col_table[0]->name());
     std::string sql("SELECT * FROM " TRANSACTION_TABLE);
@@ -347,7 +353,7 @@ query_transactions (GncSqlBackend* sql_be, std::string selector)
     if (result->begin() == result->end())
     {
         PINFO("Query %s returned no results", sql.c_str());
-        return;
+        return InstanceVec{};
     }
 
     Transaction* tx;
@@ -391,6 +397,7 @@ query_transactions (GncSqlBackend* sql_be, std::string selector)
     for (auto instance : instances)
          xaccTransCommitEdit(GNC_TRANSACTION(instance));
 
+    return instances;
 }
 
 
@@ -702,7 +709,9 @@ void gnc_sql_transaction_load_tx_for_account (GncSqlBackend* sql_be,
     std::string sql("(SELECT DISTINCT ");
     sql += stkey + " FROM " SPLIT_TABLE " WHERE " + sakey + " = '";
     sql += gnc::GUID(*guid).to_string() + "')";
-    query_transactions (sql_be, sql);
+    auto obe = std::static_pointer_cast<GncSqlTransBackend>(
+        sql_be->get_object_backend (GNC_ID_TRANS));
+    obe->load_transactions (sql_be, sql);
 }
 
 /**
@@ -719,9 +728,602 @@ GncSqlTransBackend::load_all (GncSqlBackend* sql_be)
     auto root = gnc_book_get_root_account (sql_be->book());
     gnc_account_foreach_descendant(root, (AccountCb)xaccAccountBeginEdit,
                                    nullptr);
-    query_transactions (sql_be, "");
+    auto instances = query_transactions (sql_be, "");
     gnc_account_foreach_descendant(root, (AccountCb)xaccAccountCommitEdit,
                                    nullptr);
+    if (m_lazy)
+    {
+        /* Everything is in memory now, so stop tracking and evicting. */
+        adjust_start_balances (instances, true);
+        m_windows.clear();
+        m_window_index.clear();
+        m_num_loaded = 0;
+        m_max_loaded = 0;
+        auto& window = use_window ("");
+        window.start = INT64_MIN;
+        window.end = INT64_MAX;
+    }
+}
+
+InstanceVec
+GncSqlTransBackend::load_transactions (GncSqlBackend* sql_be,
+                                       std::string selector)
+{
+    auto instances = query_transactions (sql_be, selector);
+    if (m_lazy)
+        adjust_start_balances (instances, true);
+    return instances;
+}
+
+/* ----------------------------------------------------------------- */
+typedef struct
+{
+    const GncSqlBackend* sql_be;
+    Account* acct;
+    char reconcile_state;
+    gnc_numeric balance;
+} single_acct_balance_t;
+
+static void
+set_acct_bal_account_from_guid (gpointer pObject, gpointer pValue)
+{
+    single_acct_balance_t* bal = (single_acct_balance_t*)pObject;
+    const GncGUID* guid = (const GncGUID*)pValue;
+
+    g_return_if_fail (pObject != NULL);
+    g_return_if_fail (pValue != NULL);
+
+    bal->acct = xaccAccountLookup (guid, bal->sql_be->book());
+}
+
+static void
+set_acct_bal_reconcile_state (gpointer pObject, gpointer pValue)
+{
+    single_acct_balance_t* bal = (single_acct_balance_t*)pObject;
+    const gchar* s = (const gchar*)pValue;
+
+    g_return_if_fail (pObject != NULL);
+    g_return_if_fail (pValue != NULL);
+
+    bal->reconcile_state = s[0];
+}
+
+static void
+set_acct_bal_balance (gpointer pObject, gnc_numeric value)
+{
+    single_acct_balance_t* bal = (single_acct_balance_t*)pObject;
+
+    g_return_if_fail (pObject != NULL);
+
+    bal->balance = value;
+}
+
+static const EntryVec acct_balances_col_table
+{
+    gnc_sql_make_table_entry<CT_GUID>("account_guid", 0, 0, nullptr,
+                                (QofSetterFunc)set_acct_bal_account_from_guid),
+    gnc_sql_make_table_entry<CT_STRING>("reconcile_state", 1, 0, nullptr,
+                                (QofSetterFunc)set_acct_bal_reconcile_state),
+    gnc_sql_make_table_entry<CT_NUMERIC>("quantity", 0, 0, nullptr,
+                                         (QofSetterFunc)set_acct_bal_balance),
+};
+
+/* ================================================================= */
+/* Loading on demand */
+
+#define LAZY_LOAD_ENV "GNC_SQL_LAZY_LOAD"
+#define LAZY_LOAD_DAYS_ENV "GNC_SQL_LAZY_LOAD_DAYS"
+#define LAZY_EVICT_ENV "GNC_SQL_LAZY_EVICT"
+/* Transactions asked for within this many seconds are never evicted. */
+static const time64 min_evict_age = 600;
+
+static std::string window_selector (const std::string& guid, time64 start,
+                                    time64 end);
+
+void
+GncSqlTransBackend::load_initial (GncSqlBackend* sql_be)
+{
+    g_return_if_fail (sql_be != NULL);
+
+    auto env = g_getenv (LAZY_LOAD_ENV);
+    if (env == nullptr)
+    {
+        load_all (sql_be);
+        return;
+    }
+    m_lazy = true;
+    auto evict = g_getenv (LAZY_EVICT_ENV);
+    m_max_loaded = evict ? std::strtoul (evict, nullptr, 10) : 0;
+    m_num_loaded = 0;
+    m_windows.clear();
+    m_window_index.clear();
+
+    auto days = g_getenv (LAZY_LOAD_DAYS_ENV);
+    if (days == nullptr)
+    {
+        set_start_balances (sql_be, INT64_MAX);
+        return;
+    }
+    /* Sum the older transactions' splits and load the recent ones. */
+    auto cutoff = gnc_time64_get_today_start () -
+        static_cast<time64>(std::strtoul (days, nullptr, 10)) * 86400;
+    set_start_balances (sql_be, cutoff);
+    auto& window = use_window ("");
+    window.start = cutoff;
+    window.end = INT64_MAX;
+    auto instances = query_transactions (sql_be, window_selector ("", cutoff,
+                                                                  INT64_MAX));
+    for (auto inst : instances)
+        window.transactions.push_back (*qof_instance_get_guid (inst));
+    m_num_loaded += instances.size();
+}
+
+static void
+add_to_balances (acct_balances_t& bal, char reconcile_state,
+                 gnc_numeric amount)
+{
+    auto scu = xaccAccountGetCommoditySCU (bal.acct);
+    auto add = [scu, amount](gnc_numeric& total) {
+        total = gnc_numeric_add (total, amount, scu, GNC_HOW_RND_ROUND_HALF_UP);
+    };
+    add (bal.balance);
+    if (reconcile_state != NREC)
+        add (bal.cleared_balance);
+    if (reconcile_state == YREC || reconcile_state == FREC)
+        add (bal.reconciled_balance);
+}
+
+static void
+apply_start_balances (const acct_balances_t& bal)
+{
+    gnc_account_set_start_balance (bal.acct, bal.balance);
+    gnc_account_set_start_cleared_balance (bal.acct, bal.cleared_balance);
+    gnc_account_set_start_reconciled_balance (bal.acct,
+                                              bal.reconciled_balance);
+    xaccAccountRecomputeBalance (bal.acct);
+}
+
+AcctBalancesVec
+gnc_sql_get_account_balances (GncSqlBackend* sql_be, time64 cutoff)
+{
+    g_return_val_if_fail (sql_be != NULL, AcctBalancesVec{});
+
+    const std::string tpkey(tx_col_table[0]->name());         //guid
+    const std::string stkey(split_col_table[1]->name());      //tx_guid
+    const std::string sakey(split_col_table[2]->name());      //account_guid
+    const std::string pdkey(post_date_col_table[0]->name());  //post_date
+    std::string sql("SELECT " SPLIT_TABLE "." + sakey + " AS " + sakey +
+                    ", " SPLIT_TABLE ".reconcile_state AS reconcile_state, "
+                    "sum(" SPLIT_TABLE ".quantity_num) AS quantity_num, "
+                    SPLIT_TABLE ".quantity_denom AS quantity_denom FROM "
+                    SPLIT_TABLE);
+    if (cutoff != INT64_MAX)
+        sql += " INNER JOIN " TRANSACTION_TABLE " ON " SPLIT_TABLE "." + stkey +
+            " = " TRANSACTION_TABLE "." + tpkey + " WHERE " TRANSACTION_TABLE
+            "." + pdkey + " < '" + GncDateTime(cutoff).format_iso8601() +
+            "' OR " TRANSACTION_TABLE "." + pdkey + " IS NULL";
+    sql += " GROUP BY " SPLIT_TABLE "." + sakey + ", " SPLIT_TABLE
+        ".reconcile_state, " SPLIT_TABLE ".quantity_denom";
+    auto stmt = sql_be->create_statement_from_sql (sql);
+    auto result = sql_be->execute_select_statement (stmt);
+
+    /* A row per account, reconcile state and denominator. */
+    AcctBalancesVec balances;
+    std::unordered_map<const Account*, size_t> index;
+    for (auto row : *result)
+    {
+        single_acct_balance_t bal{sql_be, nullptr, NREC, gnc_numeric_zero ()};
+        gnc_sql_load_object (sql_be, row, NULL, &bal, acct_balances_col_table);
+        if (bal.acct == nullptr) // Template accounts aren't loaded yet.
+            continue;
+        auto iter = index.find (bal.acct);
+        if (iter == index.end())
+        {
+            iter = index.emplace (bal.acct, balances.size()).first;
+            balances.push_back (acct_balances_t{bal.acct, gnc_numeric_zero (),
+                        gnc_numeric_zero (), gnc_numeric_zero ()});
+        }
+        add_to_balances (balances[iter->second], bal.reconcile_state,
+                         bal.balance);
+    }
+    return balances;
+}
+
+/**
+ * Sets each account's starting balances to the sum of its splits in the
+ * database that aren't in memory, computed by the database server.
+ *
+ * @param sql_be SQL backend
+ * @param cutoff Only transactions posted before this are counted.
+ */
+void
+GncSqlTransBackend::set_start_balances (GncSqlBackend* sql_be, time64 cutoff)
+{
+    m_start_balances.clear();
+    for (const auto& bal : gnc_sql_get_account_balances (sql_be, cutoff))
+    {
+        m_start_balances.emplace (bal.acct, bal);
+        apply_start_balances (bal);
+    }
+}
+
+/**
+ * Moves the amounts of transactions' splits out of their accounts' starting
+ * balances after they're loaded, or back into them before they're evicted,
+ * so that the accounts' ending balances don't change.
+ *
+ * @param transactions The transactions
+ * @param loaded true if they were just loaded, false if they're about to go.
+ */
+void
+GncSqlTransBackend::adjust_start_balances (const InstanceVec& transactions,
+                                           bool loaded)
+{
+    std::unordered_set<Account*> accounts;
+    for (auto inst : transactions)
+    {
+        auto tx = GNC_TRANSACTION (inst);
+        for (auto node = xaccTransGetSplitList (tx); node; node = node->next)
+        {
+            auto split = GNC_SPLIT (node->data);
+            auto acct = xaccSplitGetAccount (split);
+            if (acct == nullptr)
+                continue;
+            auto iter = m_start_balances.find (acct);
+            /* Accounts whose splits weren't summed, like the template ones,
+             * have nothing to take out.
+             */
+            if (iter == m_start_balances.end())
+            {
+                if (loaded)
+                    continue;
+                iter = m_start_balances.emplace (acct, acct_balances_t{
+                        acct, gnc_numeric_zero (), gnc_numeric_zero (),
+                        gnc_numeric_zero ()}).first;
+            }
+            auto amount = xaccSplitGetAmount (split);
+            add_to_balances (iter->second, xaccSplitGetReconcile (split),
+                             loaded ? gnc_numeric_neg (amount) : amount);
+            accounts.insert (acct);
+        }
+    }
+    for (auto acct : accounts)
+        apply_start_balances (m_start_balances[acct]);
+}
+
+static bool
+is_account_guid_path (QofQueryParamList* path)
+{
+    if (path == nullptr)
+        return false;
+    auto last = g_slist_last (path);
+    if (g_strcmp0 ((const char*)last->data, SPLIT_ACCOUNT_GUID) == 0)
+        return true;
+    auto length = g_slist_length (path);
+    return length > 1 &&
+        g_strcmp0 ((const char*)last->data, QOF_PARAM_GUID) == 0 &&
+        g_strcmp0 ((const char*)g_slist_nth_data (path, length - 2),
+                   SPLIT_ACCOUNT) == 0;
+}
+
+void
+GncSqlTransBackend::load_for_query (GncSqlBackend* sql_be, QofQuery* query)
+{
+    g_return_if_fail (sql_be != nullptr);
+    g_return_if_fail (query != nullptr);
+
+    if (!m_lazy)
+        return;
+    auto search_for = qof_query_get_search_for (query);
+    auto for_splits = g_strcmp0 (search_for, GNC_ID_SPLIT) == 0;
+    if (!for_splits && g_strcmp0 (search_for, GNC_ID_TRANS) != 0)
+        return;
+
+    auto or_terms = qof_query_get_terms (query);
+    if (or_terms == nullptr)
+        load_window (sql_be, "", INT64_MIN, INT64_MAX);
+    /* Each OR'd group of terms can only match transactions posted in the
+     * group's date range to the accounts it names, if it names any.
+     * Anything else only narrows the match further.
+     */
+    for (auto or_node = or_terms; or_node; or_node = or_node->next)
+    {
+        std::vector<std::string> accounts;
+        time64 start = INT64_MIN, end = INT64_MAX;
+        for (auto and_node = static_cast<GList*>(or_node->data); and_node;
+             and_node = and_node->next)
+        {
+            auto term = static_cast<QofQueryTerm*>(and_node->data);
+            if (qof_query_term_is_inverted (term))
+                continue;
+            auto path = qof_query_term_get_param_path (term);
+            if (for_splits && path &&
+                g_strcmp0 ((const char*)path->data, SPLIT_TRANS) == 0)
+                path = path->next;
+            auto pred_data = qof_query_term_get_pred_data (term);
+            if (g_strcmp0 (pred_data->type_name, QOF_TYPE_GUID) == 0 &&
+                is_account_guid_path (path))
+            {
+                auto guid_data = (query_guid_t)pred_data;
+                if (guid_data->options != QOF_GUID_MATCH_ANY &&
+                    guid_data->options != QOF_GUID_MATCH_ALL)
+                    continue;
+                for (auto node = guid_data->guids; node; node = node->next)
+                {
+                    auto guid = static_cast<GncGUID*>(node->data);
+                    accounts.push_back (gnc::GUID{*guid}.to_string());
+                }
+            }
+            else if (g_strcmp0 (pred_data->type_name, QOF_TYPE_DATE) == 0 &&
+                     path && path->next == nullptr &&
+                     g_strcmp0 ((const char*)path->data,
+                                TRANS_DATE_POSTED) == 0)
+            {
+                auto date_data = (query_date_t)pred_data;
+                auto first = date_data->date, last = date_data->date;
+                if (date_data->options == QOF_DATE_MATCH_DAY)
+                {
+                    first = gnc_time64_get_day_start (date_data->date);
+                    last = gnc_time64_get_day_end (date_data->date);
+                }
+                if (pred_data->how == QOF_COMPARE_LT ||
+                    pred_data->how == QOF_COMPARE_LTE ||
+                    pred_data->how == QOF_COMPARE_EQUAL)
+                    end = std::min (end, last);
+                if (pred_data->how == QOF_COMPARE_GT ||
+                    pred_data->how == QOF_COMPARE_GTE ||
+                    pred_data->how == QOF_COMPARE_EQUAL)
+                    start = std::max (start, first);
+            }
+        }
+        if (start <= MINTIME)
+            start = INT64_MIN;
+        if (end >= MAXTIME)
+            end = INT64_MAX;
+        if (accounts.empty())
+            load_window (sql_be, "", start, end);
+        for (const auto& guid : accounts)
+            load_window (sql_be, guid, start, end);
+    }
+    evict_stale (sql_be);
+}
+
+void
+GncSqlTransBackend::load_for_account (GncSqlBackend* sql_be,
+                                      const Account* account)
+{
+    g_return_if_fail (sql_be != nullptr);
+    g_return_if_fail (account != nullptr);
+
+    if (!m_lazy)
+        return;
+    auto guid = qof_instance_get_guid (QOF_INSTANCE (account));
+    load_window (sql_be, gnc::GUID{*guid}.to_string(), INT64_MIN, INT64_MAX);
+    evict_stale (sql_be);
+}
+
+/**
+ * Makes an account's window, or the book's if guid is empty, the most
+ * recently used one, creating an empty one if necessary.
+ */
+GncSqlTransBackend::LoadedWindow&
+GncSqlTransBackend::use_window (const std::string& guid)
+{
+    auto iter = m_window_index.find (guid);
+    if (iter == m_window_index.end())
+    {
+        m_windows.push_front (LoadedWindow{guid, INT64_MAX, INT64_MIN, 0, {}});
+        iter = m_window_index.emplace (guid, m_windows.begin()).first;
+    }
+    else
+        m_windows.splice (m_windows.begin(), m_windows, iter->second);
+    iter->second->last_used = gnc_time (nullptr);
+    return *iter->second;
+}
+
+static inline bool
+window_covers (time64 w_start, time64 w_end, time64 start, time64 end)
+{
+    return w_start <= start && end <= w_end;
+}
+
+/**
+ * Builds the selector for the transactions with splits in an account, or in
+ * any account if guid is empty, posted between start and end inclusive.
+ */
+static std::string
+window_selector (const std::string& guid, time64 start, time64 end)
+{
+    const std::string tpkey(tx_col_table[0]->name());         //guid
+    const std::string stkey(split_col_table[1]->name());      //tx_guid
+    const std::string sakey(split_col_table[2]->name());      //account_guid
+    const std::string pdkey(post_date_col_table[0]->name());  //post_date
+    std::string conditions;
+    auto add_condition = [&conditions](const std::string& condition) {
+        conditions += (conditions.empty() ? " WHERE " : " AND ") + condition;
+    };
+    if (!guid.empty())
+        add_condition (SPLIT_TABLE "." + sakey + " = '" + guid + "'");
+    if (start != INT64_MIN)
+        add_condition (TRANSACTION_TABLE "." + pdkey + " >= '" +
+                       GncDateTime(start).format_iso8601() + "'");
+    if (end != INT64_MAX)
+        add_condition (TRANSACTION_TABLE "." + pdkey + " <= '" +
+                       GncDateTime(end).format_iso8601() + "'");
+    if (guid.empty())
+        return conditions.empty() ? "" :
+            "(SELECT " + tpkey + " FROM " TRANSACTION_TABLE + conditions + ")";
+    return "(SELECT DISTINCT " SPLIT_TABLE "." + stkey + " FROM " SPLIT_TABLE
+        " INNER JOIN " TRANSACTION_TABLE " ON " SPLIT_TABLE "." + stkey +
+        " = " TRANSACTION_TABLE "." + tpkey + conditions + ")";
+}
+
+/**
+ * Loads the transactions in an account's window, or the book's if guid is
+ * empty, that aren't in memory already and extends the window to cover
+ * start to end.
+ */
+void
+GncSqlTransBackend::load_window (GncSqlBackend* sql_be, const std::string& guid,
+                                 time64 start, time64 end)
+{
+    auto& window = use_window (guid);
+    if (window_covers (window.start, window.end, start, end))
+        return;
+    if (!guid.empty())
+    {
+        auto book_window = m_window_index.find ("");
+        if (book_window != m_window_index.end() &&
+            window_covers (book_window->second->start,
+                           book_window->second->end, start, end))
+            return;
+    }
+
+    std::vector<std::pair<time64, time64>> ranges;
+    if (window.start > window.end || end < window.start || start > window.end)
+    {
+        ranges.emplace_back (start, end);
+        window.start = start;
+        window.end = end;
+    }
+    else
+    {
+        if (start < window.start)
+            ranges.emplace_back (start, window.start - 1);
+        if (end > window.end)
+            ranges.emplace_back (window.end + 1, end);
+        window.start = std::min (window.start, start);
+        window.end = std::max (window.end, end);
+    }
+
+    auto book = sql_be->book();
+    auto was_dirty = qof_book_session_not_saved (book);
+    xaccLogDisable ();
+    sql_be->set_loading (true);
+    for (const auto& range : ranges)
+    {
+        auto selector = window_selector (guid, range.first, range.second);
+        auto instances = load_transactions (sql_be, selector);
+        for (auto inst : instances)
+            window.transactions.push_back (*qof_instance_get_guid (inst));
+        m_num_loaded += instances.size();
+    }
+    sql_be->set_loading (false);
+    xaccLogEnable ();
+    if (!was_dirty)
+        qof_book_mark_session_saved (book);
+}
+
+/* Whoever holds a reference to a transaction, such as a register showing
+ * it, may still use it.
+ */
+static bool
+can_evict (Transaction* tx)
+{
+    if (G_OBJECT (tx)->ref_count > 1 ||
+        qof_instance_get_editlevel (tx) > 0 ||
+        qof_instance_is_dirty (QOF_INSTANCE (tx)) ||
+        xaccTransGetReadOnly (tx) != nullptr)
+        return false;
+    for (auto node = xaccTransGetSplitList (tx); node; node = node->next)
+    {
+        auto split = GNC_SPLIT (node->data);
+        if (qof_instance_is_dirty (QOF_INSTANCE (split)) ||
+            xaccSplitGetLot (split) != nullptr)
+            return false;
+    }
+    return true;
+}
+
+/**
+ * Evicts the least recently used windows until no more than m_max_loaded
+ * transactions are loaded, keeping those asked for in the last min_evict_age
+ * seconds.
+ */
+void
+GncSqlTransBackend::evict_stale (GncSqlBackend* sql_be)
+{
+    if (m_max_loaded == 0)
+        return;
+    auto cutoff = gnc_time (nullptr) - min_evict_age;
+    /* Windows that keep transactions go to the front, so try each once. */
+    auto tries = m_windows.size();
+    while (tries-- > 0 && m_num_loaded > m_max_loaded &&
+           !m_windows.empty() && m_windows.back().last_used < cutoff)
+        evict (sql_be, m_windows.back());
+}
+
+/**
+ * Destroys a window's transactions, except for any that are referenced,
+ * being edited or belong to a lot, putting their amounts back into the
+ * starting balances. Since other windows may have shared them, the windows
+ * of every account they touched are emptied too. A window that keeps some
+ * of its transactions moves to the front of the list with just those.
+ */
+void
+GncSqlTransBackend::evict (GncSqlBackend* sql_be, LoadedWindow& window)
+{
+    auto book = sql_be->book();
+    InstanceVec victims;
+    std::vector<GncGUID> kept;
+    for (const auto& guid : window.transactions)
+    {
+        auto tx = xaccTransLookup (&guid, book);
+        if (tx == nullptr)
+            continue;
+        if (can_evict (tx))
+            victims.push_back (QOF_INSTANCE (tx));
+        else
+            kept.push_back (guid);
+    }
+
+    std::unordered_set<std::string> touched;
+    for (auto inst : victims)
+        for (auto node = xaccTransGetSplitList (GNC_TRANSACTION (inst)); node;
+             node = node->next)
+        {
+            auto acct = xaccSplitGetAccount (GNC_SPLIT (node->data));
+            if (acct != nullptr)
+            {
+                auto guid = qof_instance_get_guid (acct);
+                touched.insert (gnc::GUID{*guid}.to_string());
+            }
+        }
+    adjust_start_balances (victims, false);
+
+    auto was_dirty = qof_book_session_not_saved (book);
+    xaccLogDisable ();
+    sql_be->set_loading (true);
+    for (auto inst : victims)
+        xaccTransDestroy (GNC_TRANSACTION (inst));
+    sql_be->set_loading (false);
+    xaccLogEnable ();
+    if (!was_dirty)
+        qof_book_mark_session_saved (book);
+
+    touched.insert ("");
+    for (const auto& guid : touched)
+    {
+        auto iter = m_window_index.find (guid);
+        if (iter == m_window_index.end())
+            continue;
+        iter->second->start = INT64_MAX;
+        iter->second->end = INT64_MIN;
+    }
+    /* Those no longer found were destroyed since they were loaded. */
+    auto gone = window.transactions.size() - kept.size();
+    m_num_loaded -= std::min (m_num_loaded, gone);
+    auto iter = m_window_index[window.guid];
+    if (kept.empty())
+    {
+        m_window_index.erase (iter->guid);
+        m_windows.erase (iter);
+        return;
+    }
+    iter->start = INT64_MAX;
+    iter->end = INT64_MIN;
+    iter->transactions = std::move (kept);
+    m_windows.splice (m_windows.begin(), m_windows, iter);
 }
 
 static void
@@ -892,59 +1494,6 @@ typedef struct
     gboolean has_been_run;
 } split_query_info_t;
 
-/* ----------------------------------------------------------------- */
-typedef struct
-{
-    const GncSqlBackend* sql_be;
-    Account* acct;
-    char reconcile_state;
-    gnc_numeric balance;
-} single_acct_balance_t;
-
-static void
-set_acct_bal_account_from_guid (gpointer pObject, gpointer pValue)
-{
-    single_acct_balance_t* bal = (single_acct_balance_t*)pObject;
-    const GncGUID* guid = (const GncGUID*)pValue;
-
-    g_return_if_fail (pObject != NULL);
-    g_return_if_fail (pValue != NULL);
-
-    bal->acct = xaccAccountLookup (guid, bal->sql_be->book());
-}
-
-static void
-set_acct_bal_reconcile_state (gpointer pObject, gpointer pValue)
-{
-    single_acct_balance_t* bal = (single_acct_balance_t*)pObject;
-    const gchar* s = (const gchar*)pValue;
-
-    g_return_if_fail (pObject != NULL);
-    g_return_if_fail (pValue != NULL);
-
-    bal->reconcile_state = s[0];
-}
-
-static void
-set_acct_bal_balance (gpointer pObject, gnc_numeric value)
-{
-    single_acct_balance_t* bal = (single_acct_balance_t*)pObject;
-
-    g_return_if_fail (pObject != NULL);
-
-    bal->balance = value;
-}
-
-static const EntryVec acct_balances_col_table
-{
-    gnc_sql_make_table_entry<CT_GUID>("account_guid", 0, 0, nullptr,
-                                (QofSetterFunc)set_acct_bal_account_from_guid),
-    gnc_sql_make_table_entry<CT_STRING>("reconcile_state", 1, 0, nullptr,
-                                (QofSetterFunc)set_acct_bal_reconcile_state),
-    gnc_sql_make_table_entry<CT_NUMERIC>("quantity", 0, 0, nullptr,
-                                         (QofSetterFunc)set_acct_bal_balance),
-};
-
 /* ----------------------------------------------------------------- */
 template<> void
 GncSqlColumnTableEntryImpl<CT_TXREF>::load (const GncSqlBackend* sql_be,
@@ -970,7 +1519,9 @@ GncSqlColumnTableEntryImpl<CT_TXREF>::load (const GncSqlBackend* sql_be,
         if (tx == nullptr)
         {
 	    std::string sql = tpkey + " = '" + val + "'";
-            query_transactions ((GncSqlBackend*)sql_be, sql);
+            auto obe = std::static_pointer_cast<GncSqlTransBackend>(
+                sql_be->get_object_backend (GNC_ID_TRANS));
+            obe->load_transactions ((GncSqlBackend*)sql_be, sql);
             tx = xaccTransLookup (&guid, sql_be->book());
         }
 
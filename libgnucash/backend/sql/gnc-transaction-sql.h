@@ -35,13 +35,105 @@ extern "C"
 #include "qof.h"
 #include "Account.h"
 }
+
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+typedef struct
+{
+    Account* acct;
+    gnc_numeric balance;
+    gnc_numeric cleared_balance;
+    gnc_numeric reconciled_balance;
+} acct_balances_t;
+using AcctBalancesVec = std::vector<acct_balances_t>;
+
+/**
+ * Loads and saves transactions and their splits.
+ *
+ * If the environment variable GNC_SQL_LAZY_LOAD is set when a book is opened
+ * its transactions aren't loaded up front. Instead each account's starting
+ * balances are set to the sum of its splits in the database, and
+ * load_for_query() fetches the transactions that a split or transaction
+ * query could match. Transactions loaded that way stay in memory. If
+ * GNC_SQL_LAZY_LOAD_DAYS is set too, transactions posted within that many
+ * days are loaded when the book is opened and only the older ones are summed.
+ *
+ * Setting GNC_SQL_LAZY_EVICT to a number limits how many transactions
+ * loaded on demand stay in memory; the ones least recently asked for are
+ * destroyed first. Eviction is off unless it's set, because it is only safe
+ * when everything that keeps transactions a query found beyond the next
+ * query holds a reference to them (g_object_ref), and only the registers
+ * do. Reports, the import matcher, scheduled transactions and the Scheme
+ * and Python bindings keep plain pointers.
+ */
 class GncSqlTransBackend : public GncSqlObjectBackend
 {
 public:
     GncSqlTransBackend();
+    void load_initial(GncSqlBackend*) override;
     void load_all(GncSqlBackend*) override;
     void create_tables(GncSqlBackend*) override;
     bool commit (GncSqlBackend* sql_be, QofInstance* inst) override;
+    /**
+     * Load the transactions selected by an SQL subquery or condition,
+     * keeping the accounts' balances unchanged when loading lazily.
+     *
+     * @param sql_be SQL backend
+     * @param selector "(SELECT guid ...)", a WHERE condition on the
+     * transactions table or "" for all transactions.
+     * @return The transactions that weren't already in memory.
+     */
+    InstanceVec load_transactions (GncSqlBackend* sql_be,
+                                   std::string selector);
+    /**
+     * When loading lazily, load the transactions that a query for splits or
+     * transactions could match and evict the least recently used ones if
+     * there are too many.
+     *
+     * @param sql_be SQL backend
+     * @param query The query about to be run.
+     */
+    void load_for_query (GncSqlBackend* sql_be, QofQuery* query);
+    /**
+     * When loading lazily, load all of an account's transactions.
+     *
+     * @param sql_be SQL backend
+     * @param account The account
+     */
+    void load_for_account (GncSqlBackend* sql_be, const Account* account);
+    bool lazy() const noexcept { return m_lazy; }
+private:
+    /* Transactions loaded for one account, or for every account if guid is
+     * empty. All of the account's transactions posted between start and end
+     * are in memory.
+     */
+    struct LoadedWindow
+    {
+        std::string guid;
+        time64 start;
+        time64 end;
+        time64 last_used;
+        std::vector<GncGUID> transactions;
+    };
+    using WindowList = std::list<LoadedWindow>;
+    LoadedWindow& use_window (const std::string& guid);
+    void load_window (GncSqlBackend* sql_be, const std::string& guid,
+                      time64 start, time64 end);
+    void set_start_balances (GncSqlBackend* sql_be, time64 cutoff);
+    void adjust_start_balances (const InstanceVec& transactions, bool loaded);
+    void evict_stale (GncSqlBackend* sql_be);
+    void evict (GncSqlBackend* sql_be, LoadedWindow& window);
+    bool m_lazy = false;
+    size_t m_max_loaded = 0;     /**< 0 for no limit */
+    size_t m_num_loaded = 0;
+    WindowList m_windows;        /**< Most recently used first */
+    std::unordered_map<std::string, WindowList::iterator> m_window_index;
+    /* The sum of each account's splits that aren't in memory. */
+    std::unordered_map<const Account*, acct_balances_t> m_start_balances;
 };
 
 class GncSqlSplitBackend : public GncSqlObjectBackend
@@ -61,13 +153,17 @@ public:
  */
 void gnc_sql_transaction_load_tx_for_account (GncSqlBackend* sql_be,
                                               Account* account);
-typedef struct
-{
-    Account* acct;
-    gnc_numeric balance;
-    gnc_numeric cleared_balance;
-    gnc_numeric reconciled_balance;
-} acct_balances_t;
-
+/**
+ * Sums the splits in the database of each loaded account, computing its
+ * balance, cleared balance and reconciled balance on the server with GROUP
+ * BY. Nothing needs to be loaded into memory first.
+ *
+ * @param sql_be SQL backend
+ * @param cutoff Only count the splits of transactions posted before this
+ * time, or with no posted date. INT64_MAX counts them all.
+ * @return The balances, one for each account that has splits.
+ */
+AcctBalancesVec gnc_sql_get_account_balances (GncSqlBackend* sql_be,
+                                              time64 cutoff = INT64_MAX);
 
 #endif /* GNC_TRANSACTION_SQL_H */
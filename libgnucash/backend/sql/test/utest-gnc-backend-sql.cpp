@@ -27,7 +27,11 @@ extern "C"
 #include <config.h>
 #include <string.h>
 #include <unittest-support.h>
+#include <Transaction.h>
+#include <cashobjects.h>
 }
+#include <string>
+#include <vector>
 /* Add specific headers for this class */
 #include "../gnc-sql-connection.hpp"
 #include "../gnc-sql-backend.hpp"
@@ -126,6 +130,42 @@ private:
     GncMockSqlResult m_result;
 };
 
+/* Keeps the SQL of each statement, and the connection keeps each one it
+ * executes that isn't a SELECT.
+ */
+class GncRecordingSqlStatement : public GncSqlStatement
+{
+public:
+    GncRecordingSqlStatement(const std::string& sql) : m_sql{sql} {}
+    const char* to_sql() const { return m_sql.c_str(); }
+    void add_where_cond (QofIdTypeConst, const PairVec& col_values)
+    {
+        m_sql += " WHERE ";
+        for (auto colpair : col_values)
+        {
+            if (colpair != *col_values.begin())
+                m_sql += " AND ";
+            m_sql += colpair.first + " = " + colpair.second;
+        }
+    }
+private:
+    std::string m_sql;
+};
+
+class GncRecordingSqlConnection : public GncMockSqlConnection
+{
+public:
+    int execute_nonselect_statement (const GncSqlStatementPtr& stmt)
+        noexcept override {
+        m_statements.push_back (stmt->to_sql ());
+        return 1; }
+    GncSqlStatementPtr create_statement_from_sql (const std::string& sql)
+        const noexcept override {
+        return std::unique_ptr<GncRecordingSqlStatement>(
+            new GncRecordingSqlStatement{sql}); }
+    std::vector<std::string> m_statements;
+};
+
 /* gnc_sql_init
 void
 gnc_sql_init (GncSqlBackend* sql_be)// C: 1 */
@@ -337,6 +377,101 @@ test_gnc_sql_commit_edit (void)
     g_object_unref (book);
     delete sql_be;
 }
+
+/* The names of the columns an UPDATE statement sets. */
+static std::vector<std::string>
+updated_columns (const std::string& sql)
+{
+    std::vector<std::string> columns;
+    auto start = sql.find (" SET ");
+    auto end = sql.find (" WHERE ");
+    g_assert (start != std::string::npos && end != std::string::npos);
+    for (auto pos = start + 5; pos < end;)
+    {
+        auto equals = sql.find ('=', pos);
+        auto comma = sql.find (',', equals);
+        columns.push_back (sql.substr (pos, equals - pos));
+        pos = comma < end ? comma + 1 : end;
+    }
+    return columns;
+}
+
+/* Splits are committed after their transaction; editing one column or slot
+ * of one of them must write only that column or slot.
+ */
+static void
+test_gnc_sql_commit_split_edit (void)
+{
+    auto conn = new GncRecordingSqlConnection;
+    auto& statements = conn->m_statements;
+
+    cashobjects_register ();
+    auto book = qof_book_new ();
+    auto sql_be = new GncMockSqlBackend{conn, book};
+    qof_book_set_backend (book, sql_be);
+
+    auto usd = gnc_commodity_new (book, "US Dollar", "CURRENCY", "USD",
+                                  "840", 100);
+    auto root = gnc_account_create_root (book);
+    Split* splits[2];
+    auto trans = xaccMallocTransaction (book);
+    xaccTransBeginEdit (trans);
+    xaccTransSetCurrency (trans, usd);
+    xaccTransSetDatePostedSecsNormalized (trans, gnc_time (nullptr));
+    for (auto i = 0; i < 2; ++i)
+    {
+        auto acc = xaccMallocAccount (book);
+        xaccAccountBeginEdit (acc);
+        xaccAccountSetName (acc, i ? "Expenses" : "Bank");
+        xaccAccountSetCommodity (acc, usd);
+        xaccAccountCommitEdit (acc);
+        gnc_account_append_child (root, acc);
+        auto amount = gnc_numeric_create (i ? 1000 : -1000, 100);
+        splits[i] = xaccMallocSplit (book);
+        xaccSplitSetParent (splits[i], trans);
+        xaccSplitSetAccount (splits[i], acc);
+        xaccSplitSetValue (splits[i], amount);
+        xaccSplitSetAmount (splits[i], amount);
+    }
+    xaccTransCommitEdit (trans);
+    g_assert (!qof_instance_get_infant (QOF_INSTANCE (splits[0])));
+
+    statements.clear ();
+    xaccTransBeginEdit (trans);
+    xaccSplitSetMemo (splits[0], "Memo");
+    xaccTransCommitEdit (trans);
+    g_assert_cmpuint (statements.size (), ==, 1);
+    g_assert_cmpstr (statements[0].substr (0, 18).c_str (), ==,
+                     "UPDATE splits SET ");
+    auto columns = updated_columns (statements[0]);
+    g_assert_cmpuint (columns.size (), ==, 2);
+    g_assert_cmpstr (columns[0].c_str (), ==, "guid");
+    g_assert_cmpstr (columns[1].c_str (), ==, "memo");
+
+    statements.clear ();
+    xaccTransBeginEdit (trans);
+    xaccSplitSetMemo (splits[0], "Memo");
+    xaccTransCommitEdit (trans);
+    g_assert_cmpuint (statements.size (), ==, 0);
+
+    statements.clear ();
+    xaccTransBeginEdit (trans);
+    qof_instance_set (QOF_INSTANCE (splits[1]), "online-id", "1234", NULL);
+    qof_instance_set_dirty (QOF_INSTANCE (splits[1]));
+    xaccTransCommitEdit (trans);
+    gchar guid_buf[GUID_ENCODING_LENGTH + 1];
+    (void)guid_to_string_buff (qof_instance_get_guid (splits[1]), guid_buf);
+    auto delete_sql = std::string{"DELETE FROM slots WHERE obj_guid='"} +
+        guid_buf + "' AND name=online_id";
+    g_assert_cmpuint (statements.size (), ==, 2);
+    g_assert_cmpstr (statements[0].c_str (), ==, delete_sql.c_str ());
+    g_assert_cmpstr (statements[1].substr (0, 18).c_str (), ==,
+                     "INSERT INTO slots(");
+
+    qof_book_set_backend (book, nullptr);
+    qof_book_destroy (book);
+    delete sql_be;
+}
 /* handle_and_term
 static void
 handle_and_term (QofQueryTerm* pTerm, GString* sql)// 2
@@ -857,6 +992,7 @@ test_suite_gnc_backend_sql (void)
 // GNC_TEST_ADD (suitename, "gnc sql rollback edit", Fixture, nullptr, test_gnc_sql_rollback_edit,  teardown);
 // GNC_TEST_ADD (suitename, "commit cb", Fixture, nullptr, test_commit_cb,  teardown);
     GNC_TEST_ADD_FUNC (suitename, "gnc sql commit edit", test_gnc_sql_commit_edit);
+    GNC_TEST_ADD_FUNC (suitename, "gnc sql commit split edit", test_gnc_sql_commit_split_edit);
 // GNC_TEST_ADD (suitename, "handle and term", Fixture, nullptr, test_handle_and_term,  teardown);
 // GNC_TEST_ADD (suitename, "compile query cb", Fixture, nullptr, test_compile_query_cb,  teardown);
 // GNC_TEST_ADD (suitename, "gnc sql compile query", Fixture, nullptr, test_gnc_sql_compile_query,  teardown);
@@ -138,13 +138,19 @@ time64_to_dom_tree (const char* tag, const time64 time)
 {
     xmlNodePtr ret;
     g_return_val_if_fail (time != INT64_MAX, NULL);
-    auto date_str = GncDateTime(time).format_iso8601();
-    if (date_str.empty())
-        return NULL;
-    date_str += " +0000"; //Tack on a UTC offset to mollify GnuCash for Android
+    char buff[GncDateTime::iso8601_buff_size + 6];
+    auto end = GncDateTime::format_iso8601_buff (time, buff);
+    if (!end)
+    {
+        auto date_str = GncDateTime(time).format_iso8601();
+        if (date_str.empty() || date_str.size() >= GncDateTime::iso8601_buff_size)
+            return NULL;
+        strcpy (buff, date_str.c_str());
+        end = buff + date_str.size();
+    }
+    strcpy (end, " +0000"); //Tack on a UTC offset to mollify GnuCash for Android
     ret = xmlNewNode (NULL, BAD_CAST tag);
-    xmlNewTextChild (ret, NULL, BAD_CAST "ts:date",
-                     checked_char_cast (const_cast<char*>(date_str.c_str())));
+    xmlNewTextChild (ret, NULL, BAD_CAST "ts:date", checked_char_cast (buff));
     return ret;
 }
 
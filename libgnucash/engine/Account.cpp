@@ -47,8 +47,12 @@ extern "C" {
 #include "gnc-features.h"
 #include "guid.hpp"
 
+#include <atomic>
 #include <numeric>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 static QofLogModule log_module = GNC_MOD_ACCOUNT;
 
@@ -72,6 +76,7 @@ static const std::string AB_BANK_CODE("bank-code");
 static const std::string AB_TRANS_RETRIEVAL("trans-retrieval");
 
 static gnc_numeric GetBalanceAsOfDate (Account *acc, time64 date, gboolean ignclosing);
+static void free_bayes_index (AccountPrivate *priv);
 
 using FinalProbabilityVec=std::vector<std::pair<std::string, int32_t>>;
 using ProbabilityVec=std::vector<std::pair<std::string, struct AccountProbability>>;
@@ -1402,6 +1407,8 @@ xaccFreeAccount (Account *acc)
     priv->balance_dirty = FALSE;
     priv->sort_dirty = FALSE;
 
+    free_bayes_index (priv);
+
     /* qof_instance_release (&acc->inst); */
     g_object_unref(acc);
 }
@@ -3228,6 +3235,111 @@ gnc_account_foreach_descendant_until (const Account *acc,
     return NULL;
 }
 
+struct GncAccountIter
+{
+    GncAccountIterKind kind;
+    gboolean snapshot;
+    gboolean stale;
+    QofBook *book;
+    guint64 generation;
+    /* The copied list of a snapshot iterator, freed with it. */
+    GList *copy;
+    /* The next node of each list being walked. A live descendants
+     * iterator pushes each account's children as it returns it, so that
+     * they come right after it as in gnc_account_get_descendants(). */
+    std::vector<GList*> nodes;
+};
+
+GncAccountIter *
+gnc_account_iter_new (const Account *acc, GncAccountIterKind kind,
+                      gboolean snapshot)
+{
+    GList *list = NULL;
+
+    g_return_val_if_fail(GNC_IS_ACCOUNT(acc), NULL);
+
+    switch (kind)
+    {
+    case GNC_ACCOUNT_ITER_SPLITS:
+        list = xaccAccountGetSplitList(acc);
+        break;
+    case GNC_ACCOUNT_ITER_CHILDREN:
+        list = GET_PRIVATE(acc)->children;
+        break;
+    case GNC_ACCOUNT_ITER_DESCENDANTS:
+        list = snapshot ? gnc_account_get_descendants(acc) : GET_PRIVATE(acc)->children;
+        break;
+    }
+
+    auto iter = new GncAccountIter;
+    iter->kind = kind;
+    iter->snapshot = snapshot;
+    iter->stale = FALSE;
+    iter->book = gnc_account_get_book(acc);
+    iter->generation = qof_book_get_generation(iter->book);
+    iter->copy = NULL;
+    if (snapshot)
+    {
+        /* gnc_account_get_descendants() already returned a copy. */
+        if (kind != GNC_ACCOUNT_ITER_DESCENDANTS)
+            list = g_list_copy(list);
+        iter->copy = list;
+    }
+    iter->nodes.push_back(list);
+    return iter;
+}
+
+GncAccountIterKind
+gnc_account_iter_get_kind (const GncAccountIter *iter)
+{
+    g_return_val_if_fail(iter, GNC_ACCOUNT_ITER_SPLITS);
+    return iter->kind;
+}
+
+gpointer
+gnc_account_iter_next (GncAccountIter *iter)
+{
+    g_return_val_if_fail(iter, NULL);
+
+    /* Check before touching any node, the one we hold may be gone. */
+    if (!iter->snapshot &&
+        qof_book_get_generation(iter->book) != iter->generation)
+        iter->stale = TRUE;
+    if (iter->stale)
+        return NULL;
+
+    while (!iter->nodes.empty())
+    {
+        GList *node = iter->nodes.back();
+        if (!node)
+        {
+            iter->nodes.pop_back();
+            continue;
+        }
+        iter->nodes.back() = node->next;
+        if (iter->kind == GNC_ACCOUNT_ITER_DESCENDANTS && !iter->snapshot)
+            iter->nodes.push_back(GET_PRIVATE(static_cast<Account*>(node->data))->children);
+        return node->data;
+    }
+    return NULL;
+}
+
+gboolean
+gnc_account_iter_is_stale (const GncAccountIter *iter)
+{
+    g_return_val_if_fail(iter, FALSE);
+    return iter->stale;
+}
+
+void
+gnc_account_iter_free (GncAccountIter *iter)
+{
+    if (!iter)
+        return;
+    g_list_free(iter->copy);
+    delete iter;
+}
+
 
 GNCAccountType
 xaccAccountGetType (const Account *acc)
@@ -3576,6 +3688,60 @@ xaccAccountGetReconciledBalanceAsOfDate (Account *acc, time64 date)
     return balance;
 }
 
+static gnc_numeric
+split_balance_of_kind (const Split *split, GNCAccountBalanceKind kind)
+{
+    switch (kind)
+    {
+    case ACCOUNT_BALANCE_NOCLOSING:
+        return xaccSplitGetNoclosingBalance (split);
+    case ACCOUNT_BALANCE_CLEARED:
+        return xaccSplitGetClearedBalance (split);
+    case ACCOUNT_BALANCE_RECONCILED:
+        return xaccSplitGetReconciledBalance (split);
+    default:
+        return xaccSplitGetBalance (split);
+    }
+}
+
+guint
+xaccAccountGetBalancesAtDates (Account *acc, GNCAccountBalanceKind kind,
+                               const time64 *dates, guint n_dates,
+                               gnc_numeric *balances)
+{
+    g_return_val_if_fail (GNC_IS_ACCOUNT(acc), 0);
+    g_return_val_if_fail (n_dates == 0 || (dates && balances), 0);
+
+    xaccAccountSortSplits (acc, TRUE); /* just in case, normally a noop */
+    xaccAccountRecomputeBalance (acc); /* just in case, normally a noop */
+
+    /* Both the splits and the dates are sorted, so each split is only
+     * looked at once however many dates there are. */
+    auto node = GET_PRIVATE(acc)->splits;
+    Split *latest = nullptr;
+    guint no_split_dates = 0;
+    for (guint i = 0; i < n_dates; i++)
+    {
+        for (; node; node = node->next)
+        {
+            auto split = static_cast<Split*>(node->data);
+            if (xaccTransGetDate (xaccSplitGetParent (split)) > dates[i])
+                break;
+            latest = split;
+        }
+
+        if (latest)
+            balances[i] = split_balance_of_kind (latest, kind);
+        else
+        {
+            balances[i] = gnc_numeric_zero ();
+            no_split_dates++;
+        }
+    }
+
+    return no_split_dates;
+}
+
 /*
  * Originally gsr_account_present_balance in gnc-split-reg.c
  */
@@ -5235,19 +5401,41 @@ gnc_account_merge_children (Account *parent)
 /* ================================================================ */
 /* Transaction Traversal functions                                  */
 
+/* A transaction's marker only counts while its marker_epoch matches this, so
+ * beginning a new set of staged traversals is a matter of moving on to the
+ * next epoch rather than visiting every transaction to reset it. Atomic so
+ * that the traversals can run on any thread.
+ */
+static std::atomic<guint64> staged_traversal_epoch{1};
+
+static inline unsigned int
+trans_get_stage (const Transaction *trans)
+{
+    auto epoch = staged_traversal_epoch.load (std::memory_order_relaxed);
+    return trans->marker_epoch == epoch ? trans->marker : 0;
+}
+
+static inline gboolean
+trans_advance_stage (Transaction *trans, unsigned int stage)
+{
+    if (trans_get_stage (trans) >= stage)
+        return FALSE;
+    trans->marker = stage;
+    trans->marker_epoch = staged_traversal_epoch.load (std::memory_order_relaxed);
+    return TRUE;
+}
 
 void
 xaccSplitsBeginStagedTransactionTraversals (GList *splits)
 {
-    GList *lp;
-
-    for (lp = splits; lp; lp = lp->next)
+    auto epoch = staged_traversal_epoch.load (std::memory_order_relaxed);
+    for (auto node = splits; node; node = node->next)
     {
-        Split *s = static_cast <Split*> (lp->data);
-        Transaction *trans = s->parent;
-
-        if (trans)
-            trans->marker = 0;
+        auto trans = xaccSplitGetParent (GNC_SPLIT (node->data));
+        if (!trans)
+            continue;
+        trans->marker = 0;
+        trans->marker_epoch = epoch;
     }
 }
 
@@ -5255,49 +5443,22 @@ xaccSplitsBeginStagedTransactionTraversals (GList *splits)
 void
 xaccAccountBeginStagedTransactionTraversals (const Account *account)
 {
-    AccountPrivate *priv;
-
-    if (!account)
-        return;
-    priv = GET_PRIVATE(account);
-    xaccSplitsBeginStagedTransactionTraversals(priv->splits);
+    ++staged_traversal_epoch;
 }
 
 gboolean
 xaccTransactionTraverse (Transaction *trans, int stage)
 {
-    if (trans == NULL) return FALSE;
-
-    if (trans->marker < stage)
-    {
-        trans->marker = stage;
-        return TRUE;
-    }
-
-    return FALSE;
-}
-
-static void do_one_split (Split *s, gpointer data)
-{
-    Transaction *trans = s->parent;
-    trans->marker = 0;
-}
+    if (trans == NULL || stage <= 0) return FALSE;
 
-static void do_one_account (Account *account, gpointer data)
-{
-    AccountPrivate *priv = GET_PRIVATE(account);
-    g_list_foreach(priv->splits, (GFunc)do_one_split, NULL);
+    return trans_advance_stage (trans, stage);
 }
 
 /* Replacement for xaccGroupBeginStagedTransactionTraversals */
 void
 gnc_account_tree_begin_staged_transaction_traversals (Account *account)
 {
-    GList *descendants;
-
-    descendants = gnc_account_get_descendants(account);
-    g_list_foreach(descendants, (GFunc)do_one_account, NULL);
-    g_list_free(descendants);
+    ++staged_traversal_epoch;
 }
 
 int
@@ -5326,9 +5487,8 @@ xaccAccountStagedTransactionTraversal (const Account *acc,
 
         s = static_cast <Split*> (split_p->data);
         trans = s->parent;
-        if (trans && (trans->marker < stage))
+        if (trans && trans_advance_stage (trans, stage))
         {
-            trans->marker = stage;
             if (thunk)
             {
                 retval = thunk(trans, cb_data);
@@ -5368,9 +5528,8 @@ gnc_account_tree_staged_transaction_traversal (const Account *acc,
     {
         s = static_cast <Split*> (split_p->data);
         trans = s->parent;
-        if (trans && (trans->marker < stage))
+        if (trans && trans_advance_stage (trans, stage))
         {
-            trans->marker = stage;
             if (thunk)
             {
                 retval = thunk(trans, cb_data);
@@ -5385,6 +5544,79 @@ gnc_account_tree_staged_transaction_traversal (const Account *acc,
 /********************************************************************\
 \********************************************************************/
 
+/* Each ForEachTransaction traversal stamps the transactions it visits with
+ * an epoch of its own. Only one traversal can own the stamps at a time; one
+ * started meanwhile, from a callback or another thread, remembers the
+ * transactions it has visited in a set instead.
+ */
+static std::atomic<bool> visit_stamps_busy{false};
+static guint64 visit_epoch = 0;
+
+class TransactionVisitor
+{
+public:
+    TransactionVisitor() :
+        m_stamping{!visit_stamps_busy.exchange(true, std::memory_order_acquire)}
+    {
+        if (m_stamping)
+            m_epoch = ++visit_epoch;
+    }
+    ~TransactionVisitor()
+    {
+        if (m_stamping)
+            visit_stamps_busy.store(false, std::memory_order_release);
+    }
+    TransactionVisitor(const TransactionVisitor&) = delete;
+    TransactionVisitor& operator=(const TransactionVisitor&) = delete;
+    /* True the first time the traversal reaches trans. */
+    bool first_visit(Transaction *trans)
+    {
+        if (!m_stamping)
+            return m_visited.insert(trans).second;
+        if (trans->visit_epoch == m_epoch)
+            return false;
+        trans->visit_epoch = m_epoch;
+        return true;
+    }
+private:
+    bool m_stamping;
+    guint64 m_epoch = 0;
+    std::unordered_set<const Transaction*> m_visited;
+};
+
+static int
+account_foreach_transaction (const Account *acc, bool recurse,
+                             TransactionVisitor& visitor,
+                             TransactionCallback proc, void *data)
+{
+    auto priv = GET_PRIVATE(acc);
+    if (recurse)
+    {
+        /* depth first traversal */
+        for (auto acc_p = priv->children; acc_p; acc_p = g_list_next(acc_p))
+        {
+            auto retval = account_foreach_transaction (static_cast<Account*>(acc_p->data),
+                                                       recurse, visitor, proc, data);
+            if (retval) return retval;
+        }
+    }
+
+    GList *next;
+    for (auto split_p = priv->splits; split_p; split_p = next)
+    {
+        /* As in xaccAccountStagedTransactionTraversal, in case proc
+         * destroys the split. */
+        next = g_list_next(split_p);
+        auto trans = static_cast<Split*>(split_p->data)->parent;
+        if (trans && visitor.first_visit (trans))
+        {
+            auto retval = proc (trans, data);
+            if (retval) return retval;
+        }
+    }
+    return 0;
+}
+
 int
 xaccAccountTreeForEachTransaction (Account *acc,
                                    int (*proc)(Transaction *t, void *data),
@@ -5392,8 +5624,8 @@ xaccAccountTreeForEachTransaction (Account *acc,
 {
     if (!acc || !proc) return 0;
 
-    gnc_account_tree_begin_staged_transaction_traversals (acc);
-    return gnc_account_tree_staged_transaction_traversal (acc, 42, proc, data);
+    TransactionVisitor visitor;
+    return account_foreach_transaction (acc, true, visitor, proc, data);
 }
 
 
@@ -5402,8 +5634,9 @@ xaccAccountForEachTransaction(const Account *acc, TransactionCallback proc,
                               void *data)
 {
     if (!acc || !proc) return 0;
-    xaccAccountBeginStagedTransactionTraversals (acc);
-    return xaccAccountStagedTransactionTraversal(acc, 42, proc, data);
+
+    TransactionVisitor visitor;
+    return account_foreach_transaction (acc, false, visitor, proc, data);
 }
 
 /* ================================================================ */
@@ -5540,15 +5773,82 @@ struct AccountInfo
     int32_t probability;
 };
 
+using TokenIndex = std::unordered_map<std::string, TokenAccountsInfo>;
+
+/** The tokens of an account's import map with the accounts they were seen
+ * with, so that matching a token is a hash lookup instead of a search of
+ * the account's slots. It is valid as long as the account's slots have
+ * the frame and serial it was built from.
+ */
+struct BayesIndex
+{
+    KvpFrame const * frame;
+    uint64_t serial;
+    TokenIndex tokens;
+};
+
 static void
-build_token_info(char const * suffix, KvpValue * value, TokenAccountsInfo & tokenInfo)
+build_token_index(char const * suffix, KvpValue * value, TokenIndex & tokens)
 {
-    if (strlen(suffix) == GUID_ENCODING_LENGTH)
-    {
-        tokenInfo.total_count += value->get<int64_t>();
-        /*By convention, the key ends with the account GUID.*/
-        tokenInfo.accounts.emplace_back(AccountTokenCount{std::string{suffix}, value->get<int64_t>()});
-    }
+    /*By convention, the key ends with the account GUID.*/
+    auto len = strlen(suffix);
+    if (len <= GUID_ENCODING_LENGTH || suffix[len - GUID_ENCODING_LENGTH - 1] != '/')
+        return;
+    auto & tokenInfo = tokens[std::string{suffix, len - GUID_ENCODING_LENGTH - 1}];
+    tokenInfo.total_count += value->get<int64_t>();
+    /* The slots are sorted, so the accounts are kept in GUID order. */
+    tokenInfo.accounts.emplace_back(AccountTokenCount{std::string{suffix + len - GUID_ENCODING_LENGTH},
+                                                      value->get<int64_t>()});
+}
+
+static void
+free_bayes_index (AccountPrivate *priv)
+{
+    delete priv->bayes_index;
+    priv->bayes_index = nullptr;
+}
+
+static bool
+bayes_index_is_current (BayesIndex const * index, KvpFrame const * frame)
+{
+    return index && index->frame == frame && index->serial == frame->serial();
+}
+
+static BayesIndex const &
+get_bayes_index (Account * acc)
+{
+    auto priv = GET_PRIVATE(acc);
+    auto frame = qof_instance_get_slots (QOF_INSTANCE (acc));
+    if (bayes_index_is_current (priv->bayes_index, frame))
+        return *priv->bayes_index;
+    if (!priv->bayes_index)
+        priv->bayes_index = new BayesIndex;
+    auto index = priv->bayes_index;
+    index->tokens.clear();
+    qof_instance_foreach_slot_prefix (QOF_INSTANCE (acc), IMAP_FRAME_BAYES "/",
+                                      &build_token_index, index->tokens);
+    index->frame = frame;
+    index->serial = frame->serial();
+    return *index;
+}
+
+/** Add token_count occurrences of a token for account_guid to an index that
+ * was current before the matching slot was changed. */
+static void
+update_bayes_index (BayesIndex & index, std::string const & token,
+                    std::string const & account_guid, int64_t token_count)
+{
+    auto & tokenInfo = index.tokens[token];
+    tokenInfo.total_count += token_count;
+    auto & accounts = tokenInfo.accounts;
+    auto spot = std::lower_bound (accounts.begin(), accounts.end(), account_guid,
+                                  [](AccountTokenCount const & a, std::string const & guid) {
+                                      return a.account_guid < guid;
+                                  });
+    if (spot != accounts.end() && spot->account_guid == account_guid)
+        spot->token_count += token_count;
+    else
+        accounts.insert (spot, AccountTokenCount{account_guid, token_count});
 }
 
 /** We scale the probability values by probability_factor.
@@ -5588,21 +5888,25 @@ static ProbabilityVec
 get_first_pass_probabilities(GncImportMatchMap * imap, GList * tokens)
 {
     ProbabilityVec ret;
+    /* Where each account is in ret */
+    std::unordered_map<std::string, size_t> positions;
+    auto const & index = get_bayes_index (imap->acc);
     /* find the probability for each account that contains any of the tokens
      * in the input tokens list. */
     for (auto current_token = tokens; current_token; current_token = current_token->next)
     {
-        TokenAccountsInfo tokenInfo{};
-        auto path = std::string{IMAP_FRAME_BAYES "/"} + static_cast <char const *> (current_token->data) + "/";
-        qof_instance_foreach_slot_prefix (QOF_INSTANCE (imap->acc), path, &build_token_info, tokenInfo);
+        if (!current_token->data)
+            continue;
+        auto token_entry = index.tokens.find (static_cast <char const *> (current_token->data));
+        if (token_entry == index.tokens.end())
+            continue;
+        auto const & tokenInfo = token_entry->second;
         for (auto const & current_account_token : tokenInfo.accounts)
         {
-            auto item = std::find_if(ret.begin(), ret.end(), [&current_account_token]
-                (std::pair<std::string, AccountProbability> const & a) {
-                    return current_account_token.account_guid == a.first;
-                });
-            if (item != ret.end())
+            auto position = positions.find (current_account_token.account_guid);
+            if (position != positions.end())
             {/* This account is already in the map */
+                auto item = ret.begin() + position->second;
                 item->second.product = ((double)current_account_token.token_count /
                                       (double)tokenInfo.total_count) * item->second.product;
                 item->second.product_difference = ((double)1 - ((double)current_account_token.token_count /
@@ -5615,6 +5919,7 @@ get_first_pass_probabilities(GncImportMatchMap * imap, GList * tokens)
                 new_probability.product = ((double)current_account_token.token_count /
                                       (double)tokenInfo.total_count);
                 new_probability.product_difference = 1 - (new_probability.product);
+                positions.emplace (current_account_token.account_guid, ret.size());
                 ret.push_back({current_account_token.account_guid, std::move(new_probability)});
             }
         } /* for all accounts in tokenInfo */
@@ -5871,6 +6176,13 @@ gnc_account_imap_add_account_bayes (GncImportMatchMap *imap,
     account_fullname = gnc_account_get_full_name(acc);
     xaccAccountBeginEdit (imap->acc);
 
+    /* Keep the index in step with the slots rather than rebuilding it on
+     * the next search, but only if nothing else has changed them. */
+    auto frame = qof_instance_get_slots (QOF_INSTANCE (imap->acc));
+    auto index = GET_PRIVATE (imap->acc)->bayes_index;
+    if (!bayes_index_is_current (index, frame))
+        index = nullptr;
+
     PINFO("account name: '%s'", account_fullname);
 
     guid_string = guid_to_string (xaccAccountGetGUID (acc));
@@ -5891,7 +6203,12 @@ gnc_account_imap_add_account_bayes (GncImportMatchMap *imap,
         auto path = std::string {IMAP_FRAME_BAYES} + '/' + static_cast<char*>(current_token->data) + '/' + guid_string;
         /* change the imap entry for the account */
         change_imap_entry (imap, path, token_count);
+        if (index)
+            update_bayes_index (*index, static_cast<char*>(current_token->data),
+                                guid_string, token_count);
     }
+    if (index)
+        index->serial = frame->serial();
     /* free up the account fullname and guid string */
     qof_instance_set_dirty (QOF_INSTANCE (imap->acc));
     xaccAccountCommitEdit (imap->acc);
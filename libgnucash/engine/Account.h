@@ -568,6 +568,35 @@ gnc_numeric xaccAccountGetBalanceAsOfDate (Account *account,
 /** Get the reconciled balance of the account as of the date specified */
 gnc_numeric xaccAccountGetReconciledBalanceAsOfDate (Account *account, time64 date);
 
+/** The running balances kept in each split, see xaccSplitGetBalance()
+ *  and its siblings. */
+typedef enum
+{
+    ACCOUNT_BALANCE_TOTAL,      /**< xaccSplitGetBalance() */
+    ACCOUNT_BALANCE_NOCLOSING,  /**< xaccSplitGetNoclosingBalance() */
+    ACCOUNT_BALANCE_CLEARED,    /**< xaccSplitGetClearedBalance() */
+    ACCOUNT_BALANCE_RECONCILED, /**< xaccSplitGetReconciledBalance() */
+} GNCAccountBalanceKind;
+
+/** Get the balances of the account at several dates in a single pass
+ *  over its splits.
+ *
+ *  @param account The account.
+ *  @param kind Which of the split running balances to report.
+ *  @param dates The dates, sorted in ascending order.
+ *  @param n_dates The number of dates.
+ *  @param balances Receives n_dates balances. balances[i] is the running
+ *  balance of the last split posted on or before dates[i], or zero if
+ *  there is no such split.
+ *
+ *  @return The number of leading dates which have no split posted on
+ *  or before them.
+ */
+guint xaccAccountGetBalancesAtDates (Account *account,
+                                     GNCAccountBalanceKind kind,
+                                     const time64 *dates, guint n_dates,
+                                     gnc_numeric *balances);
+
 /* These two functions convert a given balance from one commodity to
    another.  The account argument is only used to get the Book, and
    may have nothing to do with the supplied balance.  Likewise, the
@@ -865,6 +894,55 @@ gpointer gnc_account_foreach_descendant_until (const Account *account,
         AccountCb2 func, /*@ null @*/ gpointer user_data);
 
 
+/** @} */
+
+/** @name Iterators
+ *
+ *  An iterator hands out an account's splits, children or descendants
+ *  one at a time, in the order of xaccAccountGetSplitList(),
+ *  gnc_account_get_children() and gnc_account_get_descendants(). They
+ *  exist mostly for the language bindings, which would otherwise have
+ *  to convert the whole list before looking at its first element.
+ *
+ *  A live iterator walks the account's own lists without copying
+ *  them. It becomes stale as soon as anything in the book is
+ *  committed, because that may have changed or freed the list it is
+ *  walking, and then returns nothing more. A snapshot iterator copies
+ *  the list when it is created and returns all of it whatever happens
+ *  to the book; like the lists returned by the functions above, it
+ *  can't tell when an element has been destroyed in the meantime. Use
+ *  a snapshot when the loop changes the book.
+ @{
+*/
+
+typedef enum
+{
+    GNC_ACCOUNT_ITER_SPLITS,
+    GNC_ACCOUNT_ITER_CHILDREN,
+    GNC_ACCOUNT_ITER_DESCENDANTS,
+} GncAccountIterKind;
+
+typedef struct GncAccountIter GncAccountIter;
+
+/** Create an iterator over the splits, children or descendants of
+ *  account. Free it with gnc_account_iter_free(). */
+GncAccountIter *gnc_account_iter_new (const Account *account,
+                                      GncAccountIterKind kind,
+                                      gboolean snapshot);
+
+/** @return What the iterator was created to return. */
+GncAccountIterKind gnc_account_iter_get_kind (const GncAccountIter *iter);
+
+/** @return The next Split or Account, or NULL when there are no more or
+ *  the iterator has become stale. */
+gpointer gnc_account_iter_next (GncAccountIter *iter);
+
+/** @return TRUE if the book was changed while a live iterator was in
+ *  use. Always FALSE for snapshot iterators. */
+gboolean gnc_account_iter_is_stale (const GncAccountIter *iter);
+
+void gnc_account_iter_free (GncAccountIter *iter);
+
 /** @} */
 
 /** @name Concatenation, Merging
@@ -1076,7 +1154,8 @@ void xaccAccountMoveAllSplits (Account *accfrom, Account *accto);
  * in child accounts.
  *
  * @a proc will be called exactly once for each transaction that is
- * pointed to by at least one split in the given account.
+ * pointed to by at least one split in the given account. Like
+ * xaccAccountTreeForEachTransaction() it may be nested.
  *
  * The result of this function will be 0 <em>if and only if</em>
  * every relevant transaction was traversed exactly once.
@@ -1398,18 +1477,26 @@ void xaccClearMarkDown (Account *account, short val);
  *  account in the account tree originating with the specified node.
  *  This is done so that a new sequence of staged traversals can
  *  begin.
+ *
+ *  The markers are reset by starting a new traversal epoch, which takes
+ *  constant time and resets the marker of every transaction in the
+ *  book, not only those in the tree. The sequence may run on any
+ *  thread, but since it resets every marker only one sequence may be
+ *  in progress at a time.
  */
 void gnc_account_tree_begin_staged_transaction_traversals(Account *acc);
 
 /** xaccSplitsBeginStagedTransactionTraversals() resets the traversal
  *    marker for each transaction which is a parent of one of the
- *    splits in the list.
+ *    splits in the list, and only for those.
  */
 void xaccSplitsBeginStagedTransactionTraversals(SplitList *splits);
 
 /** xaccAccountBeginStagedTransactionTraversals() resets the traversal
  *    marker for each transaction which is a parent of one of the
- *    splits in the account.
+ *    splits in the account. Like
+ *    gnc_account_tree_begin_staged_transaction_traversals() it does so
+ *    in constant time by resetting every transaction's marker.
  */
 void xaccAccountBeginStagedTransactionTraversals(const Account *account);
 
@@ -1481,10 +1568,10 @@ int gnc_account_tree_staged_transaction_traversal(const Account *account,
  * it will not traverse transactions present only in the remote
  * database.
  *
- * Note that this routine is just a trivial wrapper for
- *
- * gnc_account_tree_begin_staged_transaction_traversals(g);
- * gnc_account_tree_staged_transaction_traversal(g, 42, proc, data);
+ * Unlike the staged traversals this routine doesn't use the
+ * transactions' traversal markers, so it may be called from within
+ * @a proc or from another thread without disturbing the traversal
+ * already in progress.
  */
 
 int xaccAccountTreeForEachTransaction(Account *acc,
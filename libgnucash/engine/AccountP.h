@@ -127,6 +127,10 @@ typedef struct AccountPrivate
      * account tree. */
     short mark;
     gboolean defer_bal_computation;
+
+    /* Token to account counts from the "import-map-bayes" slots, built
+     * the first time the Bayesian import map is searched. */
+    struct BayesIndex *bayes_index;
 } AccountPrivate;
 
 struct account_s
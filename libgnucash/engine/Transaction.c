@@ -270,6 +270,8 @@ gnc_transaction_init(Transaction* trans)
     trans->date_entered  = 0;
     trans->date_posted  = 0;
     trans->marker = 0;
+    trans->marker_epoch = 0;
+    trans->visit_epoch = 0;
     trans->orig = NULL;
     trans->readonly_reason = NULL;
     trans->reason_cache_valid = FALSE;
@@ -1036,18 +1038,30 @@ xaccTransLookup (const GncGUID *guid, QofBook *book)
 /********************************************************************\
 \********************************************************************/
 
+#define IMBALANCE_STACK_SPLITS 16
+
 gnc_numeric
 xaccTransGetImbalanceValue (const Transaction * trans)
 {
     gnc_numeric imbal = gnc_numeric_zero();
+    /* Nearly every transaction fits on the stack. */
+    gnc_numeric stack_values[IMBALANCE_STACK_SPLITS];
+    gnc_numeric *values = stack_values;
+    guint num_splits;
+    size_t count = 0;
     if (!trans) return imbal;
 
     ENTER("(trans=%p)", trans);
     /* Could use xaccSplitsComputeValue, except that we want to use
        GNC_HOW_DENOM_EXACT */
-    FOR_EACH_SPLIT(trans, imbal =
-                       gnc_numeric_add(imbal, xaccSplitGetValue(s),
-                                       GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT));
+    num_splits = g_list_length (trans->splits);
+    if (num_splits > IMBALANCE_STACK_SPLITS)
+        values = g_new (gnc_numeric, num_splits);
+    FOR_EACH_SPLIT(trans, values[count++] = xaccSplitGetValue(s));
+    imbal = gnc_numeric_sum (values, count,
+                             GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
+    if (values != stack_values)
+        g_free (values);
     LEAVE("(trans=%p) imbal=%s", trans, gnc_num_dbg_to_string(imbal));
     return imbal;
 }
@@ -102,8 +102,14 @@ struct transaction_s
      * a new transaction in the middle of a traversal. All each new
      * traversal cares about is whether or not the marker stored in
      * a transaction is the same as or different than the one
-     * corresponding to the current traversal. */
+     * corresponding to the current traversal. It only counts while
+     * marker_epoch matches the current staged traversal epoch, so starting
+     * a new set of staged traversals needn't reset every marker. */
     unsigned char  marker;
+    guint64 marker_epoch;
+    /* The epoch of the last xaccAccount(Tree)ForEachTransaction traversal
+     * that visited this transaction. */
+    guint64 visit_epoch;
 
     /* The orig pointer points at a copy of the original transaction,
      * before editing was started.  This orig copy is used to rollback
@@ -0,0 +1,174 @@
+/********************************************************************\
+ * gnc-commodity-collector.cpp -- sums amounts per commodity        *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+#include <glib.h>
+
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "gnc-commodity-collector.h"
+#include "gnc-rational.hpp"
+
+struct CollectorEntry
+{
+    gnc_commodity *commodity;
+    GncRational total;
+};
+
+struct GncCommodityCollector
+{
+    /* In the order the commodities were first added */
+    std::vector<CollectorEntry> entries;
+    std::unordered_map<const gnc_commodity*, size_t> index;
+
+    CollectorEntry& entry (gnc_commodity *commodity)
+    {
+        auto result = index.emplace (commodity, entries.size());
+        if (result.second)
+            entries.push_back ({commodity, GncRational{}});
+        return entries[result.first->second];
+    }
+};
+
+/* The sum of total and amount, reduced so that it stays comparable with
+ * what gnc_numeric arithmetic gives. Returns false if it wouldn't fit in
+ * a gnc_numeric. */
+static bool
+sum_amounts (const GncRational& total, const GncRational& amount,
+             GncRational& sum)
+{
+    try
+    {
+        sum = (total + amount).reduce();
+        return !sum.is_big();
+    }
+    catch (const std::exception&)
+    {
+        return false;
+    }
+}
+
+GncCommodityCollector *
+gnc_commodity_collector_new (void)
+{
+    return new GncCommodityCollector;
+}
+
+void
+gnc_commodity_collector_destroy (GncCommodityCollector *coll)
+{
+    delete coll;
+}
+
+gboolean
+gnc_commodity_collector_add (GncCommodityCollector *coll,
+                             gnc_commodity *commodity, gnc_numeric amount)
+{
+    g_return_val_if_fail (coll, FALSE);
+
+    auto& entry = coll->entry (commodity);
+    if (gnc_numeric_check (amount))
+        return FALSE;
+
+    GncRational sum;
+    if (!sum_amounts (entry.total, GncRational (amount), sum))
+        return FALSE;
+    entry.total = sum;
+    return TRUE;
+}
+
+gboolean
+gnc_commodity_collector_merge (GncCommodityCollector *coll,
+                               const GncCommodityCollector *other,
+                               gboolean negate)
+{
+    g_return_val_if_fail (coll && other, FALSE);
+
+    /* Work out all the new totals first so that nothing changes if one
+     * of them doesn't fit. Other's commodities are taken most recent
+     * first, just like the scheme collectors always did. */
+    std::vector<std::pair<gnc_commodity*, GncRational>> sums;
+    sums.reserve (other->entries.size());
+    for (auto it = other->entries.rbegin(); it != other->entries.rend(); ++it)
+    {
+        auto found = coll->index.find (it->commodity);
+        auto total = found == coll->index.end() ? GncRational{} :
+            coll->entries[found->second].total;
+        GncRational sum;
+        if (!sum_amounts (total, negate ? -it->total : it->total, sum))
+            return FALSE;
+        sums.emplace_back (it->commodity, sum);
+    }
+
+    for (const auto& sum : sums)
+        coll->entry (sum.first).total = sum.second;
+    return TRUE;
+}
+
+void
+gnc_commodity_collector_reset (GncCommodityCollector *coll)
+{
+    g_return_if_fail (coll);
+    coll->entries.clear();
+    coll->index.clear();
+}
+
+gnc_numeric
+gnc_commodity_collector_get_amount (const GncCommodityCollector *coll,
+                                    const gnc_commodity *commodity)
+{
+    g_return_val_if_fail (coll, gnc_numeric_zero());
+
+    auto found = coll->index.find (commodity);
+    if (found == coll->index.end())
+        return gnc_numeric_zero();
+    return coll->entries[found->second].total;
+}
+
+guint
+gnc_commodity_collector_get_length (const GncCommodityCollector *coll)
+{
+    g_return_val_if_fail (coll, 0);
+    return coll->entries.size();
+}
+
+gnc_commodity *
+gnc_commodity_collector_nth_commodity (const GncCommodityCollector *coll,
+                                       guint n)
+{
+    g_return_val_if_fail (coll, nullptr);
+    if (n >= coll->entries.size())
+        return nullptr;
+    return coll->entries[coll->entries.size() - 1 - n].commodity;
+}
+
+gnc_numeric
+gnc_commodity_collector_nth_amount (const GncCommodityCollector *coll,
+                                    guint n)
+{
+    g_return_val_if_fail (coll, gnc_numeric_zero());
+    if (n >= coll->entries.size())
+        return gnc_numeric_zero();
+    return coll->entries[coll->entries.size() - 1 - n].total;
+}
@@ -0,0 +1,99 @@
+/********************************************************************\
+ * gnc-commodity-collector.h -- sums amounts per commodity          *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+/** @addtogroup Engine
+ *  @{ */
+/** @file gnc-commodity-collector.h
+ *  @brief Exact per-commodity totals, the native side of the reports'
+ *  gnc:make-commodity-collector.
+ *
+ *  A collector keeps one running total for each commodity added to
+ *  it. The totals are exact: an amount whose sum can't be represented
+ *  as a gnc_numeric isn't added, and the add reports the failure so
+ *  that the caller can keep it elsewhere.
+ *
+ *  Commodities are listed most recently added first, the order in
+ *  which the scheme collectors have always reported them.
+ */
+
+#ifndef GNC_COMMODITY_COLLECTOR_H
+#define GNC_COMMODITY_COLLECTOR_H
+
+#include "gnc-commodity.h"
+#include "gnc-numeric.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef struct GncCommodityCollector GncCommodityCollector;
+
+/** Create an empty collector. Free it with
+ *  gnc_commodity_collector_destroy(). */
+GncCommodityCollector *gnc_commodity_collector_new (void);
+
+void gnc_commodity_collector_destroy (GncCommodityCollector *coll);
+
+/** Add amount to the total of commodity. The commodity is listed even
+ *  when the amount can't be added.
+ *
+ *  @return FALSE if amount is an error value or the new total wouldn't
+ *  fit in a gnc_numeric, in which case the total is unchanged. */
+gboolean gnc_commodity_collector_add (GncCommodityCollector *coll,
+                                      gnc_commodity *commodity,
+                                      gnc_numeric amount);
+
+/** Add all of other's totals, negated if negate is TRUE, to coll.
+ *
+ *  @return FALSE if any of the new totals wouldn't fit in a
+ *  gnc_numeric, in which case coll is unchanged. */
+gboolean gnc_commodity_collector_merge (GncCommodityCollector *coll,
+                                        const GncCommodityCollector *other,
+                                        gboolean negate);
+
+/** Forget all commodities and their totals. */
+void gnc_commodity_collector_reset (GncCommodityCollector *coll);
+
+/** @return The total of commodity, zero if it was never added. */
+gnc_numeric gnc_commodity_collector_get_amount (const GncCommodityCollector *coll,
+                                                const gnc_commodity *commodity);
+
+/** @return The number of commodities in the collector. */
+guint gnc_commodity_collector_get_length (const GncCommodityCollector *coll);
+
+/** @return The nth commodity, counting from the most recently added
+ *  one, or NULL if there are fewer commodities. */
+gnc_commodity *gnc_commodity_collector_nth_commodity (const GncCommodityCollector *coll,
+                                                      guint n);
+
+/** @return The total of the nth commodity, see
+ *  gnc_commodity_collector_nth_commodity(). */
+gnc_numeric gnc_commodity_collector_nth_amount (const GncCommodityCollector *coll,
+                                                guint n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GNC_COMMODITY_COLLECTOR_H */
+/** @} */
@@ -116,6 +116,8 @@ gnc_localtime (const time64 *secs)
 struct tm*
 gnc_localtime_r (const time64 *secs, struct tm* time)
 {
+    if (GncDateTime::local_tm(*secs, *time))
+        return time;
     try
     {
         *time = static_cast<struct tm>(GncDateTime(*secs));
@@ -1118,6 +1120,8 @@ gnc_iso8601_to_time64_gmt(const char *cstr)
 {
     time64 time;
     if (!cstr) return INT64_MAX;
+    if (GncDateTime::parse_iso8601(cstr, time))
+        return time;
     try
     {
         GncDateTime gncdt(cstr);
@@ -1144,6 +1148,8 @@ gnc_time64_to_iso8601_buff (time64 time, char * buff)
     constexpr size_t max_iso_date_length = 32;
 
     if (! buff) return NULL;
+    if (auto end = GncDateTime::format_iso8601_buff(time, buff))
+        return end;
     try
     {
         GncDateTime gncdt(time);
@@ -1301,6 +1307,8 @@ gnc_time64_get_day_start (time64 time_val)
     struct tm tm;
     time64 new_time;
 
+    if (GncDateTime::day_part(time_val, DayPart::start, new_time))
+        return new_time;
     gnc_tm_get_day_start(&tm, time_val);
     new_time = gnc_mktime(&tm);
     return new_time;
@@ -1310,6 +1318,10 @@ time64
 gnc_time64_get_day_neutral (time64 time_val)
 {
     struct tm tm;
+    time64 new_time;
+
+    if (GncDateTime::day_part(time_val, DayPart::neutral, new_time))
+        return new_time;
     gnc_localtime_r(&time_val, &tm);
     return gnc_dmy2time64_internal(tm.tm_mday, tm.tm_mon + 1, tm.tm_year + 1900,
                                    DayPart::neutral);
@@ -1321,6 +1333,8 @@ gnc_time64_get_day_end (time64 time_val)
     struct tm tm;
     time64 new_time;
 
+    if (GncDateTime::day_part(time_val, DayPart::end, new_time))
+        return new_time;
     gnc_tm_get_day_end(&tm, time_val);
     new_time = gnc_mktime(&tm);
     return new_time;
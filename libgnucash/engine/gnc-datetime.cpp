@@ -545,9 +545,214 @@ GncDateTimeImpl::format_zulu(const char* format) const
 #endif
 }
 
+/* Allocation-free conversions for the fixed layouts written by the backends.
+ * The civil-calendar arithmetic is Howard Hinnant's days_from_civil and
+ * civil_from_days, http://howardhinnant.github.io/date_algorithms.html.
+ */
+static constexpr int64_t seconds_per_day = INT64_C(86400);
+
+static inline int64_t
+days_from_civil(int year, int month, int day) noexcept
+{
+    year -= month <= 2;
+    const int era = (year >= 0 ? year : year - 399) / 400;
+    const int yoe = year - era * 400;
+    const int doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return static_cast<int64_t>(era) * 146097 + doe - 719468;
+}
+
+static inline ymd
+civil_from_days(int64_t days) noexcept
+{
+    days += 719468;
+    const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const int doe = static_cast<int>(days - era * 146097);
+    const int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const int mp = (5 * doy + 2) / 153;
+    const int day = doy - (153 * mp + 2) / 5 + 1;
+    const int month = mp < 10 ? mp + 3 : mp - 9;
+    return {static_cast<int>(era * 400 + yoe) + (month <= 2), month, day};
+}
+
+static inline int
+days_in_month(int year, int month) noexcept
+{
+    static const int mdays[] {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (month == 2 && year % 4 == 0 && (year % 100 != 0 || year % 400 == 0))
+        return 29;
+    return mdays[month - 1];
+}
+
+static inline bool
+parse_digits(const char* str, int count, int& value) noexcept
+{
+    value = 0;
+    for (int i = 0; i < count; ++i)
+    {
+        if (str[i] < '0' || str[i] > '9')
+            return false;
+        value = value * 10 + (str[i] - '0');
+    }
+    return true;
+}
+
+static inline char*
+write_digits(char* buff, int count, int value) noexcept
+{
+    for (int i = count - 1; i >= 0; --i, value /= 10)
+        buff[i] = '0' + value % 10;
+    return buff + count;
+}
+
+static bool
+parse_iso8601_fast(const char* str, time64& time) noexcept
+{
+    int year, month, day, hour, minute, second;
+    const char* tail;
+    if (!str)
+        return false;
+    if (parse_digits(str, 4, year) && str[4] == '-' &&
+        parse_digits(str + 5, 2, month) && str[7] == '-' &&
+        parse_digits(str + 8, 2, day) && str[10] == ' ' &&
+        parse_digits(str + 11, 2, hour) && str[13] == ':' &&
+        parse_digits(str + 14, 2, minute) && str[16] == ':' &&
+        parse_digits(str + 17, 2, second))
+        tail = str + 19;
+    else if (parse_digits(str, 4, year) && parse_digits(str + 4, 2, month) &&
+             parse_digits(str + 6, 2, day) && parse_digits(str + 8, 2, hour) &&
+             parse_digits(str + 10, 2, minute) &&
+             parse_digits(str + 12, 2, second))
+        tail = str + 14;
+    else
+        return false;
+
+    int offset{0};
+    if (*tail)
+    {
+        int off_hours, off_minutes;
+        if (tail[0] != ' ' || (tail[1] != '+' && tail[1] != '-') ||
+            !parse_digits(tail + 2, 2, off_hours) ||
+            !parse_digits(tail + 4, 2, off_minutes) || tail[6] ||
+            off_hours > 23 || off_minutes > 59)
+            return false;
+        offset = (off_hours * 3600 + off_minutes * 60) * (tail[1] == '-' ? -1 : 1);
+    }
+    if (year < 1400 || month < 1 || month > 12 || day < 1 ||
+        day > days_in_month(year, month) || hour > 23 || minute > 59 ||
+        second > 59)
+        return false;
+
+    auto result = days_from_civil(year, month, day) * seconds_per_day +
+        hour * 3600 + minute * 60 + second - offset;
+    if (result < MINTIME || result > MAXTIME)
+        return false;
+    time = result;
+    return true;
+}
+
+static char*
+format_iso8601_fast(time64 time, char* buff) noexcept
+{
+    if (!buff || time < MINTIME || time > MAXTIME)
+        return nullptr;
+    auto days = time / seconds_per_day;
+    auto secs = static_cast<int>(time % seconds_per_day);
+    if (secs < 0)
+    {
+        secs += seconds_per_day;
+        --days;
+    }
+    auto date = civil_from_days(days);
+    auto p = write_digits(buff, 4, date.year);
+    *p++ = '-';
+    p = write_digits(p, 2, date.month);
+    *p++ = '-';
+    p = write_digits(p, 2, date.day);
+    *p++ = ' ';
+    p = write_digits(p, 2, secs / 3600);
+    *p++ = ':';
+    p = write_digits(p, 2, secs / 60 % 60);
+    *p++ = ':';
+    p = write_digits(p, 2, secs % 60);
+    *p = '\0';
+    return p;
+}
+
+static inline int64_t
+floor_div(int64_t num, int64_t den) noexcept
+{
+    auto quot = num / den;
+    return (num % den < 0) ? quot - 1 : quot;
+}
+
+static bool
+local_tm_fast(time64 time, struct tm& tm) noexcept
+{
+    int32_t offset;
+    bool is_dst;
+    if (!tzp->utc_offset(time, offset, is_dst))
+        return false;
+    auto local = time + offset;
+    auto days = floor_div(local, seconds_per_day);
+    auto secs = static_cast<int>(local - days * seconds_per_day);
+    auto date = civil_from_days(days);
+    memset(&tm, 0, sizeof(tm));
+    tm.tm_year = date.year - 1900;
+    tm.tm_mon = date.month - 1;
+    tm.tm_mday = date.day;
+    tm.tm_hour = secs / 3600;
+    tm.tm_min = secs / 60 % 60;
+    tm.tm_sec = secs % 60;
+    tm.tm_wday = static_cast<int>((days % 7 + 11) % 7); // 1970-01-01 was a Thursday.
+    tm.tm_yday = static_cast<int>(days - days_from_civil(date.year, 1, 1));
+    tm.tm_isdst = is_dst ? 1 : 0;
+#if HAVE_STRUCT_TM_GMTOFF
+    tm.tm_gmtoff = offset;
+#endif
+    return true;
+}
+
+static bool
+day_part_fast(time64 time, DayPart part, time64& result) noexcept
+{
+    static constexpr int64_t neutral_secs{10 * 3600 + 59 * 60};
+    int32_t offset;
+    bool is_dst;
+    if (!tzp->utc_offset(time, offset, is_dst))
+        return false;
+    auto days = floor_div(time + offset, seconds_per_day);
+    auto date = civil_from_days(days);
+/* The slow path picks the zone by the local year, the offset table by the
+ * UTC one. They can differ only around New Year.
+ */
+    if ((date.month == 1 && date.day == 1) || (date.month == 12 && date.day == 31))
+        return false;
+    switch (part)
+    {
+    case DayPart::start:
+        result = days * seconds_per_day - offset;
+        break;
+    case DayPart::end:
+        result = days * seconds_per_day + seconds_per_day - 1 - offset;
+        break;
+    case DayPart::neutral:
+        result = days * seconds_per_day + neutral_secs;
+        if (!tzp->utc_offset(result, offset, is_dst) ||
+            offset < -10 * 3600 || offset > 13 * 3600)
+            return false;
+        return true;
+    }
+    return !tzp->near_transition(result, seconds_per_day);
+}
+
 std::string
 GncDateTimeImpl::format_iso8601() const
 {
+    char buff[GncDateTime::iso8601_buff_size];
+    if (format_iso8601_fast(static_cast<time64>(*this), buff))
+        return buff;
     auto str = boost::posix_time::to_iso_extended_string(m_time.utc_time());
     str[10] = ' ';
     return str.substr(0, 19);
@@ -704,6 +909,30 @@ GncDateTime::timestamp()
     return GncDateTimeImpl::timestamp();
 }
 
+bool
+GncDateTime::parse_iso8601(const char* str, time64& time) noexcept
+{
+    return parse_iso8601_fast(str, time);
+}
+
+char*
+GncDateTime::format_iso8601_buff(time64 time, char* buff) noexcept
+{
+    return format_iso8601_fast(time, buff);
+}
+
+bool
+GncDateTime::local_tm(time64 time, struct tm& tm) noexcept
+{
+    return local_tm_fast(time, tm);
+}
+
+bool
+GncDateTime::day_part(time64 time, DayPart part, time64& result) noexcept
+{
+    return day_part_fast(time, part, result);
+}
+
 /* GncDate */
 GncDate::GncDate() : m_impl{new GncDateImpl} {}
 GncDate::GncDate(int year, int month, int day) :
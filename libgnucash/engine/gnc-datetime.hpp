@@ -156,7 +156,45 @@ public:
  *  @return a std::string in the format YYYYMMDDHHMMSS.
  */
     static std::string timestamp();
-    
+/** Parse the fixed layouts written by the file and SQL backends,
+ *  "YYYY-MM-DD HH:MM:SS" optionally followed by " +HHMM" or " -HHMM", and
+ *  the undelimited "YYYYMMDDHHMMSS", without allocating or constructing a
+ *  GncDateTime.
+ *  @param str The string to parse.
+ *  @param time Set to the parsed time as seconds from the POSIX epoch.
+ *  @return false if str isn't exactly one of those layouts or is out of
+ *  range, in which case the caller should use GncDateTime(std::string).
+ */
+    static bool parse_iso8601(const char* str, time64& time) noexcept;
+/** Format a time64 as a gnucash-style iso8601 string in UTC, YYYY-MM-DD
+ *  HH:MM:SS, without allocating or constructing a GncDateTime.
+ *  @param time Seconds from the POSIX epoch.
+ *  @param buff A buffer of at least iso8601_buff_size chars.
+ *  @return A pointer to the terminating NUL in buff, or nullptr if time is
+ *  outside of MINTIME to MAXTIME.
+ */
+    static char* format_iso8601_buff(time64 time, char* buff) noexcept;
+    static constexpr size_t iso8601_buff_size = 20;
+/** Fill a struct tm with the local time, as
+ *  static_cast<struct tm>(GncDateTime(time)) does, but from the time zone's
+ *  table of UTC offsets instead of constructing a GncDateTime.
+ *  @param time Seconds from the POSIX epoch.
+ *  @param tm The struct tm to fill.
+ *  @return false if the table doesn't cover time; use GncDateTime then.
+ */
+    static bool local_tm(time64 time, struct tm& tm) noexcept;
+/** Compute the start, neutral time or end of the local day containing a
+ *  time, as GncDateTime(GncDateTime(time).date(), part) does, from the
+ *  time zone's table of UTC offsets.
+ *  @param time Seconds from the POSIX epoch.
+ *  @param part Which time of the day to compute.
+ *  @param result Set to the requested time.
+ *  @return false within a day of an offset change or of the end of a year,
+ *  or if the table doesn't cover time; use GncDateTime then.
+ */
+    static bool day_part(time64 time, DayPart part, time64& result) noexcept;
+
+
 private:
     std::unique_ptr<GncDateTimeImpl> m_impl;
 };
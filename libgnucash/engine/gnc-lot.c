@@ -492,7 +492,6 @@ gnc_numeric
 gnc_lot_get_balance (GNCLot *lot)
 {
     GNCLotPrivate* priv;
-    GList *node;
     gnc_numeric zero = gnc_numeric_zero();
     gnc_numeric baln = zero;
     if (!lot) return zero;
@@ -507,13 +506,11 @@ gnc_lot_get_balance (GNCLot *lot)
     /* Sum over splits; because they all belong to same account
      * they will have same denominator.
      */
-    for (node = priv->splits; node; node = node->next)
-    {
-        Split *s = node->data;
-        gnc_numeric amt = xaccSplitGetAmount (s);
-        baln = gnc_numeric_add_fixed (baln, amt);
-        g_assert (gnc_numeric_check (baln) == GNC_ERROR_OK);
-    }
+    baln = gnc_numeric_sum_list (priv->splits,
+                                 (GncNumericGetter)xaccSplitGetAmount,
+                                 GNC_DENOM_AUTO,
+                                 GNC_HOW_DENOM_FIXED | GNC_HOW_RND_NEVER);
+    g_assert (gnc_numeric_check (baln) == GNC_ERROR_OK);
 
     /* cache a zero balance as a closed lot */
     if (gnc_numeric_equal (baln, zero))
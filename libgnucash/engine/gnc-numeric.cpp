@@ -30,6 +30,7 @@
 #include <cstring>
 #include <cstdint>
 #include <sstream>
+#include <vector>
 #include <boost/regex.hpp>
 #include <boost/locale/encoding_utf.hpp>
 
@@ -744,6 +745,51 @@ denom_lcd(gnc_numeric a, gnc_numeric b, int64_t denom, int how)
     return denom;
 }
 
+/* True if a sum of operands all having denominator common_denom can be
+ * returned as-is in that denominator for the given denom and how, i.e. the
+ * conversion the general path performs would be a no-op.
+ */
+static inline bool
+same_denom_result_ok(gint64 common_denom, gint64 denom, gint how)
+{
+    if (common_denom <= 0)
+        return false;
+    if (denom != GNC_DENOM_AUTO && denom != common_denom)
+        return false;
+    switch (how & GNC_NUMERIC_DENOM_MASK)
+    {
+    case GNC_HOW_DENOM_EXACT:
+    case GNC_HOW_DENOM_REDUCE:
+    case GNC_HOW_DENOM_SIGFIG:
+        return false;
+    default:
+        return true;
+    }
+}
+
+/* The overwhelmingly common case for addition and subtraction is two
+ * operands with the same positive denominator and a result requested in
+ * that denominator (or GNC_DENOM_AUTO). No conversion or rounding is needed
+ * then, so unless the int64_t numerator overflows the result is computed
+ * here directly. Returns false if the general path must be taken; that
+ * includes overflow, which the general path handles by rounding the 128-bit
+ * intermediate.
+ */
+static inline bool
+same_denom_fast_path(gnc_numeric a, gnc_numeric b, gint64 denom, gint how,
+                     bool subtract, gnc_numeric& result)
+{
+    if (a.denom != b.denom || !same_denom_result_ok(a.denom, denom, how))
+        return false;
+    int64_t num;
+    if (subtract ? __builtin_sub_overflow(a.num, b.num, &num) :
+        __builtin_add_overflow(a.num, b.num, &num))
+        return false;
+    result.num = num;
+    result.denom = a.denom;
+    return true;
+}
+
 /* *******************************************************************
  *  gnc_numeric_add
  ********************************************************************/
@@ -752,6 +798,9 @@ gnc_numeric
 gnc_numeric_add(gnc_numeric a, gnc_numeric b,
                 gint64 denom, gint how)
 {
+    gnc_numeric result;
+    if (same_denom_fast_path(a, b, denom, how, false, result))
+        return result;
     if (gnc_numeric_check(a) || gnc_numeric_check(b))
     {
         return gnc_numeric_error(GNC_ERROR_ARG);
@@ -805,7 +854,9 @@ gnc_numeric
 gnc_numeric_sub(gnc_numeric a, gnc_numeric b,
                 gint64 denom, gint how)
 {
-    gnc_numeric nb;
+    gnc_numeric result;
+    if (same_denom_fast_path(a, b, denom, how, true, result))
+        return result;
     if (gnc_numeric_check(a) || gnc_numeric_check(b))
     {
         return gnc_numeric_error(GNC_ERROR_ARG);
@@ -851,6 +902,83 @@ gnc_numeric_sub(gnc_numeric a, gnc_numeric b,
     }
 }
 
+/* *******************************************************************
+ *  gnc_numeric_sum
+ ********************************************************************/
+
+/* Sum a uniform-denominator array in one pass. The loop has no branches or
+ * cross-iteration dependencies other than the three reductions so that the
+ * compiler can vectorize it. Rather than detecting overflow element by
+ * element we bound it: if count * max|num| fits in an int64_t then no
+ * partial sum can overflow, so the wrapping sum is exact and is the same
+ * value the scalar fold of gnc_numeric_add produces. Returns false if the
+ * denominators aren't all common_denom or the bound doesn't hold.
+ */
+static bool
+sum_uniform(const gnc_numeric *values, size_t count, int64_t common_denom,
+            int64_t& result)
+{
+    uint64_t sum{0}, max_abs{0};
+    bool mismatch{false};
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto num = static_cast<uint64_t>(values[i].num);
+        auto abs = values[i].num < 0 ? 0 - num : num;
+        sum += num;
+        max_abs = abs > max_abs ? abs : max_abs;
+        mismatch |= values[i].denom != common_denom;
+    }
+    if (mismatch)
+        return false;
+    uint64_t bound;
+    if (__builtin_mul_overflow(static_cast<uint64_t>(count), max_abs, &bound) ||
+        bound > static_cast<uint64_t>(INT64_MAX))
+        return false;
+    result = static_cast<int64_t>(sum);
+    return true;
+}
+
+gnc_numeric
+gnc_numeric_sum(const gnc_numeric *values, size_t count,
+                gint64 denom, gint how)
+{
+    gnc_numeric sum = gnc_numeric_zero();
+    if (!values || !count)
+        return sum;
+
+    auto common_denom = values[0].denom;
+    auto dtype = how & GNC_NUMERIC_DENOM_MASK;
+    /* The exact path returns 0/1 for a zero sum and x/common_denom
+     * otherwise, provided it is allowed to "round" the result.
+     */
+    bool exact_ok = dtype == GNC_HOW_DENOM_EXACT && common_denom > 0 &&
+        denom == GNC_DENOM_AUTO &&
+        (how & GNC_NUMERIC_RND_MASK) != GNC_HOW_RND_NEVER;
+    int64_t num;
+    if ((exact_ok || same_denom_result_ok(common_denom, denom, how)) &&
+        sum_uniform(values, count, common_denom, num))
+    {
+        if (exact_ok && num == 0)
+            return sum;
+        return gnc_numeric_create(num, common_denom);
+    }
+
+    for (size_t i = 0; i < count; ++i)
+        sum = gnc_numeric_add(sum, values[i], denom, how);
+    return sum;
+}
+
+gnc_numeric
+gnc_numeric_sum_list(GList *list, GncNumericGetter getter,
+                     gint64 denom, gint how)
+{
+    std::vector<gnc_numeric> values;
+    values.reserve(g_list_length(list));
+    for (auto node = list; node; node = g_list_next(node))
+        values.push_back(getter(node->data));
+    return gnc_numeric_sum(values.data(), values.size(), denom, how);
+}
+
 /* *******************************************************************
  *  gnc_numeric_mul
  ********************************************************************/
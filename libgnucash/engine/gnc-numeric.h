@@ -444,6 +444,27 @@ gnc_numeric gnc_numeric_sub_fixed(gnc_numeric a, gnc_numeric b)
     return gnc_numeric_sub(a, b, GNC_DENOM_AUTO,
                            GNC_HOW_DENOM_FIXED | GNC_HOW_RND_NEVER);
 }
+
+/**
+ * Return the sum of @a count values, the same result (including overflow
+ * and error reporting) as folding gnc_numeric_add(sum, value, denom, how)
+ * over the array starting from zero. When all of the values have the same
+ * denominator the sum is computed in a single vectorizable pass without
+ * conversions.
+ */
+gnc_numeric gnc_numeric_sum(const gnc_numeric *values, size_t count,
+                            gint64 denom, gint how);
+
+/** Accessor used by gnc_numeric_sum_list to get a value from a list
+ * element, e.g. xaccSplitGetAmount. */
+typedef gnc_numeric (*GncNumericGetter)(gconstpointer item);
+
+/**
+ * Return the sum of getter(item) for each item in @a list. See
+ * gnc_numeric_sum().
+ */
+gnc_numeric gnc_numeric_sum_list(GList *list, GncNumericGetter getter,
+                                 gint64 denom, gint how);
 /** @} */
 
 
@@ -0,0 +1,553 @@
+/********************************************************************\
+ * gnc-owner-aging.cpp -- aging of the owners' open documents       *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+#include <glib.h>
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "gnc-owner-aging.h"
+#include "Transaction.h"
+#include "gnc-date.h"
+#include "gnc-event.h"
+#include "gnc-lot.h"
+#include "gncInvoice.h"
+
+#define AGING_INDEX "gnc-owner-aging-index"
+
+struct GuidHash
+{
+    size_t operator() (const GncGUID& guid) const
+    {
+        return guid_hash_to_guint (&guid);
+    }
+};
+
+struct GuidEqual
+{
+    bool operator() (const GncGUID& a, const GncGUID& b) const
+    {
+        return guid_equal (&a, &b);
+    }
+};
+
+template <typename T>
+using GuidMap = std::unordered_map<GncGUID, T, GuidHash, GuidEqual>;
+
+/* An A/R or A/P split of an indexed transaction. */
+struct DocSplit
+{
+    Split *split;
+    Account *account;
+    GncGUID lot;                /* The null guid if the split has no lot */
+    bool voided;
+};
+
+/* A transaction with a split in one of the aged accounts. */
+struct AgingDoc
+{
+    time64 posted;
+    time64 entered;
+    char type;
+    std::vector<DocSplit> splits;
+};
+
+/* What aging a document needs to know about a lot. */
+struct LotInfo
+{
+    GncOwner owner {};
+    bool invoice = false;
+    time64 date_posted = 0;     /* Of the invoice */
+    time64 date_due = 0;
+    /* The lot's balance at the end of each of its transactions' posted
+     * dates, oldest first. */
+    std::vector<std::pair<time64, gnc_numeric>> balances;
+};
+
+/* The index is keyed by guid rather than by pointer: the events only
+ * say what to look at again, and a transaction or lot destroyed since
+ * is simply no longer found. */
+struct AgingIndex
+{
+    GuidMap<AgingDoc> docs;
+    /* The transactions to index again before the next aging */
+    std::unordered_set<GncGUID, GuidHash, GuidEqual> dirty;
+    /* Filled on demand, and dropped when the lot changes */
+    GuidMap<LotInfo> lots;
+    /* The accounts aged so far and how many splits they have */
+    std::unordered_map<const Account*, guint> accounts;
+
+    void mark_trans (const Transaction *trans)
+    {
+        if (trans)
+            dirty.insert (*qof_entity_get_guid (trans));
+    }
+
+    void mark_lot (GNCLot *lot)
+    {
+        if (lot)
+            lots.erase (*qof_entity_get_guid (lot));
+    }
+};
+
+struct AgingRow
+{
+    Account *account;
+    GncOwner owner;
+    std::vector<gnc_numeric> buckets;
+};
+
+struct GncOwnerAging
+{
+    guint num_buckets;
+    std::vector<AgingRow> rows;
+    std::vector<std::pair<Split*, GncOwnerAgingInvalid>> invalid;
+};
+
+static gint aging_index_handler_id = 0;
+
+static void
+aging_index_event_handler (QofInstance *entity, QofEventId event_type,
+                           gpointer user_data, gpointer event_data)
+{
+    auto book = qof_instance_get_book (entity);
+    if (!book || qof_book_shutting_down (book))
+        return;
+    auto index = static_cast<AgingIndex*>(qof_book_get_data (book, AGING_INDEX));
+    if (!index)
+        return;
+
+    if (GNC_IS_SPLIT (entity))
+    {
+        auto split = GNC_SPLIT (entity);
+        auto ed = static_cast<GncEventData*>(event_data);
+        /* A split leaving its transaction names the one it left. */
+        if (event_type == QOF_EVENT_REMOVE && ed)
+            index->mark_trans (static_cast<Transaction*>(ed->node));
+        index->mark_trans (xaccSplitGetParent (split));
+        index->mark_lot (xaccSplitGetLot (split));
+    }
+    else if (GNC_IS_TRANS (entity))
+    {
+        auto trans = GNC_TRANS (entity);
+        index->mark_trans (trans);
+        /* The lots' balance history follows the posted date. */
+        for (auto node = xaccTransGetSplitList (trans); node; node = node->next)
+            index->mark_lot (xaccSplitGetLot (GNC_SPLIT (node->data)));
+    }
+    else if (GNC_IS_LOT (entity))
+        index->mark_lot (GNC_LOT (entity));
+    else if (GNC_IS_INVOICE (entity))
+        index->mark_lot (gncInvoiceGetPostedLot (GNC_INVOICE (entity)));
+    else if (GNC_IS_ACCOUNT (entity))
+    {
+        auto count = index->accounts.find (GNC_ACCOUNT (entity));
+        if (count == index->accounts.end())
+            return;
+        if (event_type == GNC_EVENT_ITEM_ADDED)
+            count->second++;
+        else if (event_type == GNC_EVENT_ITEM_REMOVED)
+            count->second--;
+        else if (event_type == QOF_EVENT_DESTROY)
+        {
+            index->accounts.erase (count);
+            return;
+        }
+        else
+            return;
+        index->mark_trans (xaccSplitGetParent (static_cast<Split*>(event_data)));
+    }
+}
+
+static void
+aging_index_destroy (QofBook *book, gpointer key, gpointer data)
+{
+    delete static_cast<AgingIndex*>(data);
+}
+
+static AgingIndex&
+aging_index_get (QofBook *book)
+{
+    auto index = static_cast<AgingIndex*>(qof_book_get_data (book, AGING_INDEX));
+    if (!index)
+    {
+        index = new AgingIndex;
+        qof_book_set_data_fin (book, AGING_INDEX, index, aging_index_destroy);
+        if (!aging_index_handler_id)
+            aging_index_handler_id =
+                qof_event_register_handler (aging_index_event_handler, nullptr);
+    }
+    return *index;
+}
+
+/* Start indexing account's transactions. The split count catches the
+ * splits added or removed while events were suspended, e.g. by a
+ * backend loading them, in which case all of them are looked at
+ * again. */
+static void
+aging_index_track (AgingIndex& index, Account *account)
+{
+    auto splits = xaccAccountGetSplitList (account);
+    auto count = g_list_length (splits);
+    auto tracked = index.accounts.find (account);
+    if (tracked != index.accounts.end() && tracked->second == count)
+        return;
+
+    index.accounts[account] = count;
+    for (auto node = splits; node; node = node->next)
+        index.mark_trans (xaccSplitGetParent (GNC_SPLIT (node->data)));
+}
+
+/* Fill doc from trans. Returns false if trans has no split in an aged
+ * account and doesn't belong in the index. */
+static bool
+make_doc (const AgingIndex& index, Transaction *trans, AgingDoc& doc)
+{
+    bool aged = false;
+    for (auto node = xaccTransGetSplitList (trans); node; node = node->next)
+    {
+        auto split = GNC_SPLIT (node->data);
+        auto account = xaccSplitGetAccount (split);
+        if (!xaccTransStillHasSplit (trans, split) || !account ||
+            !xaccAccountIsAPARType (xaccAccountGetType (account)))
+            continue;
+
+        auto lot = xaccSplitGetLot (split);
+        doc.splits.push_back ({split, account,
+                               lot ? *qof_entity_get_guid (lot) : *guid_null (),
+                               xaccSplitGetReconcile (split) == VREC});
+        aged = aged || index.accounts.count (account);
+    }
+    doc.posted = xaccTransGetDate (trans);
+    doc.entered = xaccTransGetDateEntered (trans);
+    doc.type = xaccTransGetTxnType (trans);
+    return aged;
+}
+
+static void
+aging_index_refresh (AgingIndex& index, QofBook *book)
+{
+    for (const auto& guid : index.dirty)
+    {
+        auto trans = xaccTransLookup (&guid, book);
+        AgingDoc doc;
+        if (trans && make_doc (index, trans, doc))
+            index.docs[guid] = std::move (doc);
+        else
+            index.docs.erase (guid);
+    }
+    index.dirty.clear();
+}
+
+/* The owner is found the way gnc:split->owner does: from the lot, or
+ * else from its invoice. */
+static const LotInfo&
+lot_info (AgingIndex& index, const GncGUID& guid, QofBook *book)
+{
+    auto found = index.lots.find (guid);
+    if (found != index.lots.end())
+        return found->second;
+
+    auto& info = index.lots[guid];
+    auto lot = gnc_lot_lookup (&guid, book);
+    if (!lot)
+        return info;
+
+    auto invoice = gncInvoiceGetInvoiceFromLot (lot);
+    if (!gncOwnerGetOwnerFromLot (lot, &info.owner))
+    {
+        info.owner = GncOwner {};
+        gncOwnerCopy (gncOwnerGetEndOwner (gncInvoiceGetOwner (invoice)),
+                      &info.owner);
+    }
+    if (invoice)
+    {
+        info.invoice = true;
+        info.date_posted = gncInvoiceGetDatePosted (invoice);
+        info.date_due = gncInvoiceGetDateDue (invoice);
+    }
+
+    std::vector<std::pair<time64, gnc_numeric>> amounts;
+    for (auto node = gnc_lot_get_split_list (lot); node; node = node->next)
+    {
+        auto split = GNC_SPLIT (node->data);
+        amounts.emplace_back (xaccTransGetDate (xaccSplitGetParent (split)),
+                              xaccSplitGetAmount (split));
+    }
+    std::stable_sort (amounts.begin(), amounts.end(),
+                      [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    auto balance = gnc_numeric_zero ();
+    for (const auto& amount : amounts)
+    {
+        balance = gnc_numeric_add (balance, amount.second, GNC_DENOM_AUTO,
+                                   GNC_HOW_DENOM_LCD);
+        if (!info.balances.empty() && info.balances.back().first == amount.first)
+            info.balances.back().second = balance;
+        else
+            info.balances.emplace_back (amount.first, balance);
+    }
+    return info;
+}
+
+/* The lot's balance counting only the transactions posted on or before
+ * date. */
+static gnc_numeric
+balance_at (const LotInfo& info, time64 date)
+{
+    auto after = std::upper_bound (info.balances.begin(), info.balances.end(), date,
+                                   [](time64 date, const auto& balance)
+                                   { return date < balance.first; });
+    return after == info.balances.begin() ? gnc_numeric_zero () :
+        std::prev (after)->second;
+}
+
+static gnc_numeric
+balance (const LotInfo& info)
+{
+    return info.balances.empty() ? gnc_numeric_zero () : info.balances.back().second;
+}
+
+/* date moved by days in local time, as decdate and incdate do it. */
+static time64
+add_days (time64 date, int days)
+{
+    struct tm tm;
+    if (!gnc_localtime_r (&date, &tm))
+        return date;
+    tm.tm_mday += days;
+    tm.tm_isdst = -1;
+    return gnc_mktime (&tm);
+}
+
+/* The dates before which the documents go in each bucket but the
+ * current and prepayment ones, as make-extended-interval-list in
+ * report-utilities.scm steps them. */
+static std::vector<time64>
+bucket_ends (time64 date, guint num_buckets)
+{
+    auto start = date;
+    for (guint i = 0; i < num_buckets - 3; i++)
+        start = add_days (start, -30);
+
+    std::vector<time64> ends;
+    for (auto end = start; end < date && ends.size() < num_buckets - 3;
+         end = add_days (end, 30))
+        ends.push_back (end);
+    ends.push_back (date);
+    return ends;
+}
+
+static void
+add_to_bucket (gnc_numeric& bucket, gnc_numeric amount, gboolean receivable)
+{
+    bucket = gnc_numeric_add (bucket, receivable ? amount : gnc_numeric_neg (amount),
+                              GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
+}
+
+using DocRef = std::pair<const AgingDoc*, const DocSplit*>;
+
+static void
+age_account (GncOwnerAging& aging, AgingIndex& index, QofBook *book,
+             Account *account, std::vector<DocRef>& refs,
+             const std::vector<time64>& ends, time64 date,
+             gboolean due_date, gboolean receivable)
+{
+    /* In the order of the report's query, which sorts by posted date. */
+    std::sort (refs.begin(), refs.end(),
+               [](const DocRef& a, const DocRef& b)
+               {
+                   if (a.first->posted != b.first->posted)
+                       return a.first->posted < b.first->posted;
+                   return a.first->entered < b.first->entered;
+               });
+
+    std::map<std::pair<GncOwnerType, gpointer>, size_t> rows;
+    for (const auto& ref : refs)
+    {
+        const auto& doc = *ref.first;
+        if (doc.type != TXN_TYPE_INVOICE && doc.type != TXN_TYPE_PAYMENT)
+        {
+            aging.invalid.emplace_back (ref.second->split,
+                                        GNC_OWNER_AGING_INVALID_TXN_TYPE);
+            continue;
+        }
+
+        const auto& lot = lot_info (index, ref.second->lot, book);
+        if (!gncOwnerIsValid (&lot.owner))
+        {
+            aging.invalid.emplace_back (ref.second->split,
+                                        GNC_OWNER_AGING_INVALID_NO_OWNER);
+            continue;
+        }
+
+        auto row = rows.emplace (std::make_pair (gncOwnerGetType (&lot.owner),
+                                                 gncOwnerGetUndefined (&lot.owner)),
+                                 aging.rows.size());
+        if (row.second)
+            aging.rows.push_back ({account, lot.owner,
+                                   std::vector<gnc_numeric> (aging.num_buckets,
+                                                             gnc_numeric_zero ())});
+        auto& buckets = aging.rows[row.first->second].buckets;
+
+        if (doc.type == TXN_TYPE_INVOICE)
+        {
+            if (!lot.invoice)
+                continue;
+            auto doc_date = due_date ? lot.date_due : lot.date_posted;
+            auto bucket = std::upper_bound (ends.begin(), ends.end(), doc_date) -
+                ends.begin();
+            add_to_bucket (buckets[bucket], balance_at (lot, date), receivable);
+        }
+        else
+        {
+            /* What's left in the payment's lots without an invoice is a
+             * prepayment. */
+            for (const auto& split : doc.splits)
+            {
+                const auto& other = lot_info (index, split.lot, book);
+                if (!other.invoice)
+                    add_to_bucket (buckets.back(), balance (other), receivable);
+            }
+        }
+    }
+}
+
+GncOwnerAging *
+gnc_owner_aging_new (GList *accounts, time64 date, guint num_buckets,
+                     gboolean due_date, gboolean receivable)
+{
+    g_return_val_if_fail (num_buckets >= 3, nullptr);
+
+    auto aging = new GncOwnerAging;
+    aging->num_buckets = num_buckets;
+    if (!accounts)
+        return aging;
+
+    auto book = gnc_account_get_book (GNC_ACCOUNT (accounts->data));
+    auto& index = aging_index_get (book);
+    std::vector<Account*> order;
+    std::unordered_map<const Account*, size_t> positions;
+    for (auto node = accounts; node; node = node->next)
+    {
+        auto account = GNC_ACCOUNT (node->data);
+        if (!positions.emplace (account, order.size()).second)
+            continue;
+        order.push_back (account);
+        aging_index_track (index, account);
+    }
+    aging_index_refresh (index, book);
+
+    /* Each transaction is aged once, with its first split that the
+     * report's query would find: one in the accounts that isn't
+     * voided. */
+    std::vector<std::vector<DocRef>> refs (order.size());
+    for (const auto& entry : index.docs)
+    {
+        const auto& doc = entry.second;
+        if (doc.posted > date)
+            continue;
+        auto split = std::find_if (doc.splits.begin(), doc.splits.end(),
+                                   [&positions](const DocSplit& split)
+                                   {
+                                       return !split.voided &&
+                                           positions.count (split.account);
+                                   });
+        if (split != doc.splits.end())
+            refs[positions[split->account]].emplace_back (&doc, &*split);
+    }
+
+    auto ends = bucket_ends (date, num_buckets);
+    for (size_t i = 0; i < order.size(); i++)
+        age_account (*aging, index, book, order[i], refs[i], ends, date,
+                     due_date, receivable);
+    return aging;
+}
+
+void
+gnc_owner_aging_destroy (GncOwnerAging *aging)
+{
+    delete aging;
+}
+
+guint
+gnc_owner_aging_get_num_buckets (const GncOwnerAging *aging)
+{
+    g_return_val_if_fail (aging, 0);
+    return aging->num_buckets;
+}
+
+guint
+gnc_owner_aging_get_num_rows (const GncOwnerAging *aging)
+{
+    g_return_val_if_fail (aging, 0);
+    return aging->rows.size();
+}
+
+Account *
+gnc_owner_aging_get_account (const GncOwnerAging *aging, guint row)
+{
+    g_return_val_if_fail (aging && row < aging->rows.size(), nullptr);
+    return aging->rows[row].account;
+}
+
+const GncOwner *
+gnc_owner_aging_get_owner (const GncOwnerAging *aging, guint row)
+{
+    g_return_val_if_fail (aging && row < aging->rows.size(), nullptr);
+    return &aging->rows[row].owner;
+}
+
+gnc_numeric
+gnc_owner_aging_get_bucket (const GncOwnerAging *aging, guint row, guint bucket)
+{
+    g_return_val_if_fail (aging && row < aging->rows.size() &&
+                          bucket < aging->num_buckets, gnc_numeric_zero ());
+    return aging->rows[row].buckets[bucket];
+}
+
+guint
+gnc_owner_aging_get_num_invalid (const GncOwnerAging *aging)
+{
+    g_return_val_if_fail (aging, 0);
+    return aging->invalid.size();
+}
+
+Split *
+gnc_owner_aging_get_invalid_split (const GncOwnerAging *aging, guint n)
+{
+    g_return_val_if_fail (aging && n < aging->invalid.size(), nullptr);
+    return aging->invalid[n].first;
+}
+
+GncOwnerAgingInvalid
+gnc_owner_aging_get_invalid_reason (const GncOwnerAging *aging, guint n)
+{
+    g_return_val_if_fail (aging && n < aging->invalid.size(),
+                          GNC_OWNER_AGING_INVALID_TXN_TYPE);
+    return aging->invalid[n].second;
+}
@@ -0,0 +1,120 @@
+/********************************************************************\
+ * gnc-owner-aging.h -- aging of the owners' open documents         *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+/** @addtogroup Engine
+ *  @{ */
+/** @file gnc-owner-aging.h
+ *  @brief The aging of all the owners of A/Receivable or A/Payable
+ *  accounts in one call, as the aging reports show it.
+ *
+ *  Each book keeps an index of the invoice and payment transactions of
+ *  the A/R and A/P accounts that have been aged, along with the owner,
+ *  invoice dates and balance history of their lots. The index is kept
+ *  up to date from the engine's events as invoices are posted and
+ *  unposted and payments applied, so aging the accounts again only
+ *  looks at what changed since, and never scans the splits of every
+ *  owner.
+ *
+ *  Documents are bucketed exactly as gnc:owner-splits->aging-list
+ *  always did: by their posted or due date into 30 day periods before
+ *  the aging date, with a current bucket for those not yet due and a
+ *  last bucket for prepayments.
+ */
+
+#ifndef GNC_OWNER_AGING_H
+#define GNC_OWNER_AGING_H
+
+#include "qof.h"
+#include "Account.h"
+#include "gncOwner.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef struct GncOwnerAging GncOwnerAging;
+
+/** Why a split couldn't be aged. */
+typedef enum
+{
+    GNC_OWNER_AGING_INVALID_TXN_TYPE,   /**< Neither an invoice nor a payment */
+    GNC_OWNER_AGING_INVALID_NO_OWNER,   /**< The split's lot has no owner */
+} GncOwnerAgingInvalid;
+
+/** Age the owners of accounts as of date.
+ *
+ *  The result has a row for each account and owner with invoices or
+ *  payments posted on or before date, in the order of the accounts and
+ *  then of the owners' first transactions. Each row has num_buckets
+ *  amounts, oldest first: the invoice balances due more than
+ *  (num_buckets - 3) * 30 days before date, those due in each 30 day
+ *  period after that, those not yet due on date, and last the
+ *  prepayments.
+ *
+ *  @param accounts The A/R or A/P accounts to age, all from one book.
+ *
+ *  @param num_buckets At least 3.
+ *
+ *  @param due_date Bucket the invoices by their due date rather than
+ *  their posted date.
+ *
+ *  @param receivable Whether the accounts are receivable, and the
+ *  amounts owed to the book positive, or payable, and the amounts owed
+ *  by it positive.
+ *
+ *  @return A new aging, free it with gnc_owner_aging_destroy(). */
+GncOwnerAging *gnc_owner_aging_new (GList *accounts, time64 date,
+                                    guint num_buckets, gboolean due_date,
+                                    gboolean receivable);
+
+void gnc_owner_aging_destroy (GncOwnerAging *aging);
+
+guint gnc_owner_aging_get_num_buckets (const GncOwnerAging *aging);
+
+guint gnc_owner_aging_get_num_rows (const GncOwnerAging *aging);
+
+Account *gnc_owner_aging_get_account (const GncOwnerAging *aging, guint row);
+
+/** @return The row's owner, which belongs to the aging. */
+const GncOwner *gnc_owner_aging_get_owner (const GncOwnerAging *aging,
+                                           guint row);
+
+gnc_numeric gnc_owner_aging_get_bucket (const GncOwnerAging *aging,
+                                        guint row, guint bucket);
+
+/** The splits posted on or before the date that couldn't be aged, one
+ *  per transaction, in the order of the accounts and their dates. */
+guint gnc_owner_aging_get_num_invalid (const GncOwnerAging *aging);
+
+Split *gnc_owner_aging_get_invalid_split (const GncOwnerAging *aging,
+                                          guint n);
+
+GncOwnerAgingInvalid gnc_owner_aging_get_invalid_reason (const GncOwnerAging *aging,
+                                                         guint n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GNC_OWNER_AGING_H */
+/** @} */
@@ -0,0 +1,127 @@
+/********************************************************************\
+ * gnc-split-columns.cpp -- columnar snapshots of an account tree's *
+ *                          splits                                  *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+#include <glib.h>
+
+#include <cstring>
+#include <string_view>
+#include <unordered_map>
+
+#include "gnc-split-columns.h"
+#include "Split.h"
+#include "Transaction.h"
+
+/* Hands out one index per distinct string */
+class StringIndex
+{
+public:
+    StringIndex (GPtrArray *strings) : m_strings{strings} {}
+    guint32 operator() (const char *str)
+    {
+        if (!str)
+            str = "";
+        auto result = m_index.emplace (str, m_index.size());
+        if (result.second && m_strings)
+            g_ptr_array_add (m_strings, const_cast<char*>(str));
+        return result.first->second;
+    }
+private:
+    std::unordered_map<std::string_view, guint32> m_index;
+    GPtrArray *m_strings;
+};
+
+guint
+gnc_split_columns_count (const Account *root)
+{
+    g_return_val_if_fail (root, 0);
+
+    guint count = g_list_length (xaccAccountGetSplitList (root));
+    auto descendants = gnc_account_get_descendants (root);
+    for (auto node = descendants; node; node = g_list_next (node))
+        count += g_list_length (xaccAccountGetSplitList (static_cast<Account*>(node->data)));
+    g_list_free (descendants);
+    return count;
+}
+
+guint
+gnc_split_columns_fill (const Account *root, const GncSplitColumns *columns,
+                        GPtrArray *accounts, GPtrArray *strings)
+{
+    g_return_val_if_fail (root && columns, 0);
+
+    auto descendants = g_list_prepend (gnc_account_get_descendants (root),
+                                       const_cast<Account*>(root));
+    StringIndex string_index{strings};
+    guint n = 0;
+    guint32 account_index = 0;
+
+    for (auto anode = descendants; anode; anode = g_list_next (anode), account_index++)
+    {
+        auto account = static_cast<Account*>(anode->data);
+        if (accounts)
+            g_ptr_array_add (accounts, account);
+
+        for (auto snode = xaccAccountGetSplitList (account); snode;
+             snode = g_list_next (snode), n++)
+        {
+            auto split = static_cast<Split*>(snode->data);
+            auto trans = xaccSplitGetParent (split);
+
+            if (columns->split_guid)
+                memcpy (columns->split_guid + n * GUID_DATA_SIZE,
+                        xaccSplitGetGUID (split), GUID_DATA_SIZE);
+            if (columns->trans_guid)
+                memcpy (columns->trans_guid + n * GUID_DATA_SIZE,
+                        xaccTransGetGUID (trans), GUID_DATA_SIZE);
+            if (columns->account)
+                columns->account[n] = account_index;
+            if (columns->posted)
+                columns->posted[n] = xaccTransRetDatePosted (trans);
+            if (columns->amount_num || columns->amount_denom)
+            {
+                auto amount = xaccSplitGetAmount (split);
+                if (columns->amount_num)
+                    columns->amount_num[n] = amount.num;
+                if (columns->amount_denom)
+                    columns->amount_denom[n] = amount.denom;
+            }
+            if (columns->value_num || columns->value_denom)
+            {
+                auto value = xaccSplitGetValue (split);
+                if (columns->value_num)
+                    columns->value_num[n] = value.num;
+                if (columns->value_denom)
+                    columns->value_denom[n] = value.denom;
+            }
+            if (columns->reconcile)
+                columns->reconcile[n] = xaccSplitGetReconcile (split);
+            if (columns->memo)
+                columns->memo[n] = string_index (xaccSplitGetMemo (split));
+            if (columns->description)
+                columns->description[n] = string_index (xaccTransGetDescription (trans));
+        }
+    }
+
+    g_list_free (descendants);
+    return n;
+}
@@ -0,0 +1,88 @@
+/********************************************************************\
+ * gnc-split-columns.h -- columnar snapshots of an account tree's   *
+ *                        splits                                    *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+/** @addtogroup Engine
+ *  @{ */
+/** @file gnc-split-columns.h
+ *  @brief Copies the fields of many splits into flat arrays at once.
+ *
+ *  Meant for bindings handing splits to array based analysis tools:
+ *  one call fills an array per field instead of one call per field and
+ *  split. The caller allocates the arrays, which lets them live in
+ *  memory owned by the binding.
+ */
+
+#ifndef GNC_SPLIT_COLUMNS_H
+#define GNC_SPLIT_COLUMNS_H
+
+#include "Account.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/** The arrays to fill, each with room for one entry per split, or
+ *  NULL if that field isn't wanted. */
+typedef struct
+{
+    guint8 *split_guid;     /**< GUID_DATA_SIZE bytes per split */
+    guint8 *trans_guid;     /**< GUID_DATA_SIZE bytes per split */
+    guint32 *account;       /**< Index into the accounts array */
+    time64 *posted;
+    gint64 *amount_num;
+    gint64 *amount_denom;
+    gint64 *value_num;
+    gint64 *value_denom;
+    char *reconcile;
+    guint32 *memo;          /**< Index into the strings array */
+    guint32 *description;   /**< Index into the strings array */
+} GncSplitColumns;
+
+/** @return The number of splits in root and all its descendants. */
+guint gnc_split_columns_count (const Account *root);
+
+/** Fill columns with the splits of root and its descendants, account
+ *  by account in the order of gnc_account_get_descendants() and in
+ *  each account's split order.
+ *
+ *  @param accounts If not NULL, receives root and its descendants, in
+ *  the order the account column refers to them.
+ *
+ *  @param strings If not NULL, receives each distinct memo and
+ *  description once, in the order the memo and description columns
+ *  refer to them. The strings belong to the engine and remain valid
+ *  while the splits and transactions are unchanged.
+ *
+ *  @return The number of splits filled in, which is
+ *  gnc_split_columns_count (root). */
+guint gnc_split_columns_fill (const Account *root,
+                              const GncSplitColumns *columns,
+                              GPtrArray *accounts, GPtrArray *strings);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GNC_SPLIT_COLUMNS_H */
+/** @} */
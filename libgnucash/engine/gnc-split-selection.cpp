@@ -0,0 +1,480 @@
+/********************************************************************\
+ * gnc-split-selection.cpp -- filters, sorts and groups report      *
+ *                            splits                                *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+#include <glib.h>
+
+#include <boost/regex.hpp>
+#include <algorithm>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <variant>
+#include <vector>
+
+#include "gnc-split-selection.h"
+#include "Account.h"
+#include "Query.h"
+#include "Transaction.h"
+#include "gnc-date.h"
+
+struct SortLevel
+{
+    GncSplitSortKey key = GNC_SPLIT_SORT_NONE;
+    GncSplitDateGroup date_group = GNC_SPLIT_DATE_GROUP_NONE;
+    bool ascending = true;
+    bool subtotal = false;
+};
+
+struct GncSplitSelection
+{
+    std::string pattern;
+    std::optional<boost::regex> regex;
+    bool case_insensitive = false;
+    bool exclude = false;
+
+    std::unordered_set<const Account*> other_accounts;
+    GncSplitOtherAccounts other_accounts_mode = GNC_SPLIT_OTHER_ACCOUNTS_ANY;
+
+    SortLevel levels[2];
+};
+
+/* What a split is sorted by: nothing, a number, an amount or the
+ * collation key of a string. */
+using SortValue = std::variant<std::monostate, gint64, gnc_numeric, std::string>;
+/* What a split is grouped by, strings are compared as they are. */
+using GroupValue = std::variant<gint64, std::string>;
+
+static const char*
+str_or_empty (const char *str)
+{
+    return str ? str : "";
+}
+
+static bool
+is_date_key (GncSplitSortKey key)
+{
+    return key == GNC_SPLIT_SORT_DATE || key == GNC_SPLIT_SORT_RECONCILED_DATE;
+}
+
+static gint64
+date_group_value (time64 date, GncSplitDateGroup group)
+{
+    struct tm tm;
+    if (!gnc_localtime_r (&date, &tm))
+        return 0;
+    gint64 year = tm.tm_year + 1900;
+
+    switch (group)
+    {
+    case GNC_SPLIT_DATE_GROUP_DAY:
+        return year * 500 + tm.tm_yday + 1;
+    case GNC_SPLIT_DATE_GROUP_WEEK:
+    {
+        /* Weeks since the epoch, starting on the locale's first day of
+         * the week, 1 being Sunday. */
+        auto weekstart = gnc_start_of_week ();
+        auto secs = gnc_time64_get_day_start (date) -
+            (1 + (weekstart ? weekstart : 1)) * 86400;
+        auto week = secs / (7 * 86400);
+        return secs % (7 * 86400) < 0 ? week - 1 : week;
+    }
+    case GNC_SPLIT_DATE_GROUP_MONTH:
+        return year * 100 + tm.tm_mon + 1;
+    case GNC_SPLIT_DATE_GROUP_QUARTER:
+        return year * 10 + tm.tm_mon / 3 + 1;
+    case GNC_SPLIT_DATE_GROUP_YEAR:
+        return year;
+    default:
+        return 0;
+    }
+}
+
+/* The order of the reconcile flags, of which the last sorts first. */
+static gint64
+reconcile_value (char reconcile)
+{
+    static const char flags[] = {NREC, CREC, YREC, FREC, VREC};
+    auto flag = std::find (std::begin (flags), std::end (flags), reconcile);
+    return std::end (flags) - flag;
+}
+
+static std::string
+string_value (const Split *split, GncSplitSortKey key)
+{
+    auto trans = xaccSplitGetParent (split);
+    switch (key)
+    {
+    case GNC_SPLIT_SORT_ACCOUNT_NAME:
+    case GNC_SPLIT_SORT_CORR_ACCOUNT_NAME:
+    {
+        auto name = key == GNC_SPLIT_SORT_ACCOUNT_NAME ?
+            gnc_account_get_full_name (xaccSplitGetAccount (split)) :
+            xaccSplitGetCorrAccountFullName (split);
+        std::string result{str_or_empty (name)};
+        g_free (name);
+        return result;
+    }
+    case GNC_SPLIT_SORT_ACCOUNT_CODE:
+        return str_or_empty (xaccAccountGetCode (xaccSplitGetAccount (split)));
+    case GNC_SPLIT_SORT_CORR_ACCOUNT_CODE:
+        return str_or_empty (xaccSplitGetCorrAccountCode (split));
+    case GNC_SPLIT_SORT_DESCRIPTION:
+        return str_or_empty (xaccTransGetDescription (trans));
+    case GNC_SPLIT_SORT_NUMBER:
+        return str_or_empty (xaccTransGetNum (trans));
+    case GNC_SPLIT_SORT_ACTION:
+        return str_or_empty (xaccSplitGetAction (split));
+    case GNC_SPLIT_SORT_MEMO:
+        return str_or_empty (xaccSplitGetMemo (split));
+    case GNC_SPLIT_SORT_NOTES:
+        return str_or_empty (xaccTransGetNotes (trans));
+    default:
+        return std::string{};
+    }
+}
+
+static SortValue
+sort_value (const Split *split, const SortLevel& level)
+{
+    switch (level.key)
+    {
+    case GNC_SPLIT_SORT_NONE:
+    case GNC_SPLIT_SORT_REGISTER_ORDER:
+        return std::monostate{};
+    /* Ungrouped dates are left in query order */
+    case GNC_SPLIT_SORT_DATE:
+        if (level.date_group == GNC_SPLIT_DATE_GROUP_NONE)
+            return std::monostate{};
+        return date_group_value (xaccTransGetDate (xaccSplitGetParent (split)),
+                                 level.date_group);
+    case GNC_SPLIT_SORT_RECONCILED_DATE:
+        if (level.date_group == GNC_SPLIT_DATE_GROUP_NONE)
+            return std::monostate{};
+        return date_group_value (xaccSplitGetDateReconciled (split),
+                                 level.date_group);
+    case GNC_SPLIT_SORT_RECONCILED_STATUS:
+        return reconcile_value (xaccSplitGetReconcile (split));
+    case GNC_SPLIT_SORT_AMOUNT:
+        return xaccSplitGetValue (split);
+    default:
+    {
+        auto key = g_utf8_collate_key (string_value (split, level.key).c_str(), -1);
+        std::string result{key};
+        g_free (key);
+        return result;
+    }
+    }
+}
+
+/* The value whose change ends a subtotal group of a level that
+ * groups(). The date keys are grouped by the posted date, as the report
+ * always did. */
+static GroupValue
+group_value (const Split *split, const SortLevel& level)
+{
+    switch (level.key)
+    {
+    case GNC_SPLIT_SORT_DATE:
+    case GNC_SPLIT_SORT_RECONCILED_DATE:
+        return date_group_value (xaccTransGetDate (xaccSplitGetParent (split)),
+                                 level.date_group);
+    case GNC_SPLIT_SORT_RECONCILED_STATUS:
+        return reconcile_value (xaccSplitGetReconcile (split));
+    default:
+        return string_value (split, level.key);
+    }
+}
+
+static bool
+groups (const SortLevel& level)
+{
+    switch (level.key)
+    {
+    case GNC_SPLIT_SORT_DATE:
+    case GNC_SPLIT_SORT_RECONCILED_DATE:
+        return level.date_group != GNC_SPLIT_DATE_GROUP_NONE;
+    case GNC_SPLIT_SORT_RECONCILED_STATUS:
+    case GNC_SPLIT_SORT_ACCOUNT_NAME:
+    case GNC_SPLIT_SORT_ACCOUNT_CODE:
+    case GNC_SPLIT_SORT_CORR_ACCOUNT_NAME:
+    case GNC_SPLIT_SORT_CORR_ACCOUNT_CODE:
+    case GNC_SPLIT_SORT_DESCRIPTION:
+    case GNC_SPLIT_SORT_MEMO:
+    case GNC_SPLIT_SORT_NOTES:
+        return level.subtotal;
+    default:
+        return false;
+    }
+}
+
+static int
+compare (const SortValue& a, const SortValue& b)
+{
+    if (auto num = std::get_if<gint64>(&a))
+    {
+        auto other = std::get<gint64>(b);
+        return (*num > other) - (*num < other);
+    }
+    if (auto amount = std::get_if<gnc_numeric>(&a))
+        return gnc_numeric_compare (*amount, std::get<gnc_numeric>(b));
+    if (auto str = std::get_if<std::string>(&a))
+        return str->compare (std::get<std::string>(b));
+    return 0;
+}
+
+/* The query parameters for the keys the query can sort by itself. */
+static QofQueryParamList*
+query_sort_params (GncSplitSortKey key)
+{
+    switch (key)
+    {
+    case GNC_SPLIT_SORT_ACCOUNT_NAME:
+        return qof_query_build_param_list (SPLIT_ACCT_FULLNAME, nullptr);
+    case GNC_SPLIT_SORT_ACCOUNT_CODE:
+        return qof_query_build_param_list (SPLIT_ACCOUNT, ACCOUNT_CODE_, nullptr);
+    case GNC_SPLIT_SORT_DATE:
+        return qof_query_build_param_list (SPLIT_TRANS, TRANS_DATE_POSTED, nullptr);
+    case GNC_SPLIT_SORT_RECONCILED_DATE:
+        return qof_query_build_param_list (SPLIT_DATE_RECONCILED, nullptr);
+    case GNC_SPLIT_SORT_REGISTER_ORDER:
+        return qof_query_build_param_list (QUERY_DEFAULT_SORT, nullptr);
+    case GNC_SPLIT_SORT_CORR_ACCOUNT_NAME:
+        return qof_query_build_param_list (SPLIT_CORR_ACCT_NAME, nullptr);
+    case GNC_SPLIT_SORT_CORR_ACCOUNT_CODE:
+        return qof_query_build_param_list (SPLIT_CORR_ACCT_CODE, nullptr);
+    case GNC_SPLIT_SORT_AMOUNT:
+        return qof_query_build_param_list (SPLIT_VALUE, nullptr);
+    case GNC_SPLIT_SORT_DESCRIPTION:
+        return qof_query_build_param_list (SPLIT_TRANS, TRANS_DESCRIPTION, nullptr);
+    case GNC_SPLIT_SORT_NUMBER:
+        return qof_query_build_param_list (SPLIT_TRANS, TRANS_NUM, nullptr);
+    case GNC_SPLIT_SORT_ACTION:
+        return qof_query_build_param_list (SPLIT_ACTION, nullptr);
+    case GNC_SPLIT_SORT_MEMO:
+        return qof_query_build_param_list (SPLIT_MEMO, nullptr);
+    default:
+        return nullptr;
+    }
+}
+
+/* Whether the splits have to be sorted after the query has run. */
+static bool
+custom_sort (const SortLevel& level)
+{
+    if (is_date_key (level.key))
+        return level.date_group != GNC_SPLIT_DATE_GROUP_NONE;
+    return level.key == GNC_SPLIT_SORT_RECONCILED_STATUS ||
+        level.key == GNC_SPLIT_SORT_NOTES;
+}
+
+static bool
+matches (const GncSplitSelection *sel, const char *str)
+{
+    str = str_or_empty (str);
+    if (sel->regex)
+        return boost::regex_search (str, *sel->regex);
+    if (!sel->case_insensitive)
+        return strstr (str, sel->pattern.c_str());
+
+    auto folded = g_utf8_casefold (str, -1);
+    auto found = strstr (folded, sel->pattern.c_str()) != nullptr;
+    g_free (folded);
+    return found;
+}
+
+static bool
+passes_matcher (const GncSplitSelection *sel, const Split *split)
+{
+    if (sel->pattern.empty())
+        return true;
+    auto trans = xaccSplitGetParent (split);
+    auto found = matches (sel, xaccTransGetDescription (trans)) ||
+        matches (sel, xaccTransGetNotes (trans)) ||
+        matches (sel, xaccSplitGetMemo (split));
+    return found != sel->exclude;
+}
+
+static bool
+passes_other_accounts (const GncSplitSelection *sel, const Split *split)
+{
+    if (sel->other_accounts_mode == GNC_SPLIT_OTHER_ACCOUNTS_ANY)
+        return true;
+
+    auto found = false;
+    for (auto node = xaccTransGetSplitList (xaccSplitGetParent (split));
+         node && !found; node = g_list_next (node))
+    {
+        auto other = static_cast<const Split*>(node->data);
+        found = other != split &&
+            sel->other_accounts.count (xaccSplitGetAccount (other));
+    }
+    return found == (sel->other_accounts_mode == GNC_SPLIT_OTHER_ACCOUNTS_INCLUDE);
+}
+
+GncSplitSelection *
+gnc_split_selection_new (void)
+{
+    return new GncSplitSelection;
+}
+
+void
+gnc_split_selection_destroy (GncSplitSelection *sel)
+{
+    delete sel;
+}
+
+gboolean
+gnc_split_selection_set_matcher (GncSplitSelection *sel, const char *pattern,
+                                 gboolean regex, gboolean case_insensitive,
+                                 gboolean exclude)
+{
+    g_return_val_if_fail (sel, FALSE);
+
+    pattern = str_or_empty (pattern);
+    std::optional<boost::regex> re;
+    if (regex)
+    {
+        auto flags = boost::regex::extended | boost::regex::nosubs;
+        if (case_insensitive)
+            flags |= boost::regex::icase;
+        try
+        {
+            re.emplace (pattern, flags);
+        }
+        catch (const boost::regex_error&)
+        {
+            return FALSE;
+        }
+    }
+
+    if (!regex && case_insensitive)
+    {
+        auto folded = g_utf8_casefold (pattern, -1);
+        sel->pattern = folded;
+        g_free (folded);
+    }
+    else
+        sel->pattern = pattern;
+    sel->regex = std::move (re);
+    sel->case_insensitive = case_insensitive;
+    sel->exclude = exclude;
+    return TRUE;
+}
+
+void
+gnc_split_selection_set_other_accounts (GncSplitSelection *sel,
+                                        GList *accounts,
+                                        GncSplitOtherAccounts mode)
+{
+    g_return_if_fail (sel);
+
+    sel->other_accounts.clear();
+    for (auto node = accounts; node; node = g_list_next (node))
+        sel->other_accounts.insert (static_cast<const Account*>(node->data));
+    sel->other_accounts_mode = mode;
+}
+
+void
+gnc_split_selection_set_sort (GncSplitSelection *sel, guint level,
+                              GncSplitSortKey key, GncSplitDateGroup date_group,
+                              gboolean ascending, gboolean subtotal)
+{
+    g_return_if_fail (sel && level < 2);
+    sel->levels[level] = {key, date_group, static_cast<bool>(ascending),
+                          static_cast<bool>(subtotal)};
+}
+
+SplitList *
+gnc_split_selection_run (const GncSplitSelection *sel, QofQuery *query,
+                         gboolean unique_trans)
+{
+    g_return_val_if_fail (sel && query, nullptr);
+
+    const auto& levels = sel->levels;
+    auto sort_after = custom_sort (levels[0]) || custom_sort (levels[1]);
+    if (!sort_after)
+    {
+        qof_query_set_sort_order (query, query_sort_params (levels[0].key),
+                                  query_sort_params (levels[1].key), nullptr);
+        qof_query_set_sort_increasing (query, levels[0].ascending,
+                                       levels[1].ascending, TRUE);
+    }
+
+    auto splits = unique_trans ? xaccQueryGetSplitsUniqueTrans (query) :
+        g_list_copy (qof_query_run (query));
+
+    struct Row
+    {
+        Split *split;
+        SortValue values[2];
+    };
+    std::vector<Row> rows;
+    for (auto node = splits; node; node = g_list_next (node))
+    {
+        auto split = static_cast<Split*>(node->data);
+        if (passes_other_accounts (sel, split) && passes_matcher (sel, split))
+            rows.push_back ({split, {}});
+    }
+    g_list_free (splits);
+
+    if (sort_after)
+    {
+        for (auto& row : rows)
+            for (auto i = 0; i < 2; i++)
+                row.values[i] = sort_value (row.split, levels[i]);
+
+        std::stable_sort (rows.begin(), rows.end(),
+                          [&levels](const Row& a, const Row& b)
+                          {
+                              for (auto i = 0; i < 2; i++)
+                              {
+                                  auto result = compare (a.values[i], b.values[i]);
+                                  if (result)
+                                      return levels[i].ascending ? result < 0 : result > 0;
+                              }
+                              return false;
+                          });
+    }
+
+    GList *result = nullptr;
+    for (auto it = rows.rbegin(); it != rows.rend(); ++it)
+        result = g_list_prepend (result, it->split);
+    return result;
+}
+
+GncSplitBreak
+gnc_split_selection_get_break (const GncSplitSelection *sel,
+                               const Split *split, const Split *next)
+{
+    g_return_val_if_fail (sel && split, GNC_SPLIT_BREAK_NONE);
+
+    const auto& levels = sel->levels;
+    if (groups (levels[0]) &&
+        (!next || group_value (split, levels[0]) != group_value (next, levels[0])))
+        return GNC_SPLIT_BREAK_PRIMARY;
+    if (groups (levels[1]) &&
+        (!next || group_value (split, levels[1]) != group_value (next, levels[1])))
+        return GNC_SPLIT_BREAK_SECONDARY;
+    return GNC_SPLIT_BREAK_NONE;
+}
@@ -0,0 +1,164 @@
+/********************************************************************\
+ * gnc-split-selection.h -- filters, sorts and groups report splits *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+/** @addtogroup Engine
+ *  @{ */
+/** @file gnc-split-selection.h
+ *  @brief The data shaping stages of the transaction report: the native
+ *  side of trep-engine.scm.
+ *
+ *  A selection runs a split query, keeps the splits matching its text
+ *  and account filters, and orders them by a primary and a secondary
+ *  sort key. The report then walks the result, asking where each
+ *  subtotal group ends.
+ *
+ *  The keys, filters and groups behave exactly as the scheme report
+ *  always did: strings sort in the locale's collation order, and the
+ *  date keys can be grouped by day, week, month, quarter or year.
+ */
+
+#ifndef GNC_SPLIT_SELECTION_H
+#define GNC_SPLIT_SELECTION_H
+
+#include "qof.h"
+#include "Split.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+typedef struct GncSplitSelection GncSplitSelection;
+
+/** The values the splits can be sorted and grouped by. */
+typedef enum
+{
+    GNC_SPLIT_SORT_NONE,
+    GNC_SPLIT_SORT_ACCOUNT_NAME,        /**< Full name of the split's account */
+    GNC_SPLIT_SORT_ACCOUNT_CODE,
+    GNC_SPLIT_SORT_DATE,                /**< Transaction posted date */
+    GNC_SPLIT_SORT_RECONCILED_DATE,
+    GNC_SPLIT_SORT_RECONCILED_STATUS,
+    GNC_SPLIT_SORT_REGISTER_ORDER,
+    GNC_SPLIT_SORT_CORR_ACCOUNT_NAME,   /**< Full name of the other account */
+    GNC_SPLIT_SORT_CORR_ACCOUNT_CODE,
+    GNC_SPLIT_SORT_AMOUNT,              /**< Split value */
+    GNC_SPLIT_SORT_DESCRIPTION,
+    GNC_SPLIT_SORT_NUMBER,              /**< Transaction number */
+    GNC_SPLIT_SORT_ACTION,              /**< Split action, used as the number */
+    GNC_SPLIT_SORT_MEMO,
+    GNC_SPLIT_SORT_NOTES,
+} GncSplitSortKey;
+
+/** The periods by which the date keys group splits. */
+typedef enum
+{
+    GNC_SPLIT_DATE_GROUP_NONE,
+    GNC_SPLIT_DATE_GROUP_DAY,
+    GNC_SPLIT_DATE_GROUP_WEEK,
+    GNC_SPLIT_DATE_GROUP_MONTH,
+    GNC_SPLIT_DATE_GROUP_QUARTER,
+    GNC_SPLIT_DATE_GROUP_YEAR,
+} GncSplitDateGroup;
+
+/** How the other accounts of the splits' transactions filter them. */
+typedef enum
+{
+    GNC_SPLIT_OTHER_ACCOUNTS_ANY,
+    GNC_SPLIT_OTHER_ACCOUNTS_INCLUDE,   /**< Keep splits with another split
+                                         *   in one of the accounts */
+    GNC_SPLIT_OTHER_ACCOUNTS_EXCLUDE,   /**< Drop them */
+} GncSplitOtherAccounts;
+
+/** Where the subtotal groups end, see gnc_split_selection_get_break(). */
+typedef enum
+{
+    GNC_SPLIT_BREAK_NONE,
+    GNC_SPLIT_BREAK_SECONDARY,          /**< A secondary group ends */
+    GNC_SPLIT_BREAK_PRIMARY,            /**< A primary group ends, and with
+                                         *   it any secondary group */
+} GncSplitBreak;
+
+/** Create a selection that keeps all splits in query order. Free it
+ *  with gnc_split_selection_destroy(). */
+GncSplitSelection *gnc_split_selection_new (void);
+
+void gnc_split_selection_destroy (GncSplitSelection *sel);
+
+/** Keep only the splits whose transaction description or notes, or
+ *  whose memo, contain pattern, or only those that don't if exclude is
+ *  TRUE. An empty pattern keeps all splits.
+ *
+ *  @param regex If TRUE pattern is a POSIX extended regular expression,
+ *  otherwise a plain string.
+ *
+ *  @return FALSE if pattern isn't a valid regular expression, in which
+ *  case the selection is unchanged. */
+gboolean gnc_split_selection_set_matcher (GncSplitSelection *sel,
+                                          const char *pattern, gboolean regex,
+                                          gboolean case_insensitive,
+                                          gboolean exclude);
+
+/** Filter the splits by the accounts of the other splits in their
+ *  transactions. The list is copied. */
+void gnc_split_selection_set_other_accounts (GncSplitSelection *sel,
+                                             GList *accounts,
+                                             GncSplitOtherAccounts mode);
+
+/** Set the primary (level 0) or secondary (level 1) sort key.
+ *
+ *  @param date_group For the two date keys, the period to sort and
+ *  group the dates by. A date key without one isn't grouped.
+ *
+ *  @param subtotal Whether the other keys end a subtotal group when
+ *  their value changes. Only the account names and codes, the
+ *  reconciled status, the description, the memo and the notes can be
+ *  subtotaled. */
+void gnc_split_selection_set_sort (GncSplitSelection *sel, guint level,
+                                   GncSplitSortKey key,
+                                   GncSplitDateGroup date_group,
+                                   gboolean ascending, gboolean subtotal);
+
+/** Run query and return the splits it finds that pass the filters,
+ *  sorted by the sort keys. Sorts the query can do itself are set on
+ *  it; the others are done afterwards, keeping the query's order for
+ *  splits that sort equal.
+ *
+ *  @param unique_trans Return at most one split per transaction.
+ *
+ *  @return A new list, free it with g_list_free(). */
+SplitList *gnc_split_selection_run (const GncSplitSelection *sel,
+                                    QofQuery *query, gboolean unique_trans);
+
+/** @return The subtotal groups that end between split and next, the
+ *  split that follows it in the report. All groups end after the last
+ *  split, for which next is NULL. */
+GncSplitBreak gnc_split_selection_get_break (const GncSplitSelection *sel,
+                                             const Split *split,
+                                             const Split *next);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GNC_SPLIT_SELECTION_H */
+/** @} */
@@ -47,6 +47,8 @@ using PTZ = boost::local_time::posix_time_zone;
 
 const unsigned int TimeZoneProvider::min_year = 1400;
 const unsigned int TimeZoneProvider::max_year = 9999;
+const unsigned int TimeZoneProvider::table_first_year = 1900;
+const unsigned int TimeZoneProvider::table_last_year = 2200;
 
 template<typename T>
 T*
@@ -767,6 +769,142 @@ TimeZoneProvider::get(int year) const noexcept
     return iter->second;
 }
 
+static inline int64_t
+ptime_to_time64(const boost::posix_time::ptime& time)
+{
+    static const boost::posix_time::ptime epoch(boost::gregorian::date(1970, 1, 1));
+    return (time - epoch).total_seconds();
+}
+
+static inline boost::posix_time::ptime
+time64_to_ptime(int64_t time)
+{
+    static const boost::posix_time::ptime epoch(boost::gregorian::date(1970, 1, 1));
+    return epoch + boost::posix_time::hours(time / 3600) +
+        boost::posix_time::seconds(time % 3600);
+}
+
+/* The offset can only change where the zone does, at the start of a UTC
+ * year since that's what GncDateTime passes to get(); where the DST rules
+ * used by local_date_time::is_dst change, at the start of a year in
+ * standard local time; and near the DST transitions themselves. is_dst's
+ * handling of the skipped and repeated local times means the exact second
+ * isn't always the rule's time in standard or daylight time, so candidates
+ * bracket each transition and wherever local_date_time evaluates two
+ * neighbouring candidates differently the change is found by bisection.
+ */
+void
+TimeZoneProvider::build_transitions() const noexcept
+{
+    using boost::gregorian::date;
+    using boost::posix_time::ptime;
+    using LDT = boost::local_time::local_date_time;
+    std::vector<int64_t> candidates;
+    try
+    {
+        for (auto year = table_first_year; year <= table_last_year; ++year)
+        {
+            ptime new_year(date(year, 1, 1));
+            candidates.push_back(ptime_to_time64(new_year));
+            for (auto tz : {get(year - 1), get(year)})
+            {
+                auto base = tz->base_utc_offset();
+                candidates.push_back(ptime_to_time64(new_year - base));
+                if (!tz->has_dst())
+                    continue;
+                auto dst = tz->dst_offset();
+                for (auto rule_year : {year - 1, year})
+                {
+                    for (auto change : {tz->dst_local_start_time(rule_year),
+                                tz->dst_local_end_time(rule_year)})
+                    {
+                        candidates.push_back(ptime_to_time64(change - base - dst));
+                        candidates.push_back(ptime_to_time64(change - base));
+                    }
+                }
+            }
+        }
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()),
+                         candidates.end());
+
+        auto evaluate = [this](int64_t time) -> TZ_Transition {
+            auto utc = time64_to_ptime(time);
+            LDT ldt(utc, get(utc.date().year()));
+            auto offset = (ldt.local_time() - utc).total_seconds();
+            return {time, static_cast<int32_t>(offset), ldt.is_dst()};
+        };
+        auto differ = [](const TZ_Transition& a, const TZ_Transition& b) {
+            return a.offset != b.offset || a.is_dst != b.is_dst;
+        };
+        TZ_Transition last{};
+        for (auto candidate : candidates)
+        {
+            auto trans = evaluate(candidate);
+            if (m_transitions.empty())
+            {
+                m_transitions.push_back(trans);
+            }
+            else if (differ(trans, last))
+            {
+                /* The change is somewhere in (last.time, candidate]. */
+                auto lo = last.time, hi = candidate;
+                while (hi - lo > 1)
+                {
+                    auto mid = lo + (hi - lo) / 2;
+                    if (differ(evaluate(mid), last))
+                        hi = mid;
+                    else
+                        lo = mid;
+                }
+                trans.time = hi;
+                if (differ(trans, m_transitions.back()))
+                    m_transitions.push_back(trans);
+            }
+            last = evaluate(candidate);
+        }
+        m_table_begin = ptime_to_time64(ptime(date(table_first_year, 1, 1)));
+        m_table_end = ptime_to_time64(ptime(date(table_last_year, 1, 1)));
+    }
+    catch (const std::exception& err)
+    {
+        PWARN("Unable to build the UTC offset table, using the zone rules directly: %s",
+              err.what());
+        m_transitions.clear();
+        m_table_begin = m_table_end = 0;
+    }
+}
+
+bool
+TimeZoneProvider::utc_offset(int64_t time, int32_t& offset, bool& is_dst) const noexcept
+{
+    std::call_once(m_transitions_built, [this]() { build_transitions(); });
+    if (time < m_table_begin || time >= m_table_end)
+        return false;
+    auto iter = std::upper_bound(m_transitions.begin(), m_transitions.end(), time,
+                                 [](int64_t t, const TZ_Transition& trans)
+                                 { return t < trans.time; });
+    if (iter == m_transitions.begin())
+        return false;
+    --iter;
+    offset = iter->offset;
+    is_dst = iter->is_dst;
+    return true;
+}
+
+bool
+TimeZoneProvider::near_transition(int64_t time, int64_t window) const noexcept
+{
+    std::call_once(m_transitions_built, [this]() { build_transitions(); });
+    if (time - window < m_table_begin || time + window >= m_table_end)
+        return true;
+    auto iter = std::lower_bound(m_transitions.begin(), m_transitions.end(),
+                                 time - window,
+                                 [](const TZ_Transition& trans, int64_t t)
+                                 { return trans.time < t; });
+    return iter != m_transitions.end() && iter->time <= time + window;
+}
+
 void
 TimeZoneProvider::dump() const noexcept
 {
@@ -30,6 +30,9 @@ extern "C"
 #endif
 }
 
+#include <cstdint>
+#include <mutex>
+#include <vector>
 #define BOOST_ERROR_CODE_HEADER_ONLY
 #include <boost/date_time/local_time/local_time.hpp>
 
@@ -44,6 +47,18 @@ using TZ_Entry = std::pair<int, TZ_Ptr>;
 using TZ_Vector = std::vector<TZ_Entry>;
 using time_zone_names = boost::local_time::time_zone_names;
 
+/** A change of UTC offset: From the UTC time (seconds from the POSIX
+ * epoch) the offset is offset seconds east of UTC and DST is in effect if
+ * is_dst.
+ */
+struct TZ_Transition
+{
+    int64_t time;
+    int32_t offset;
+    bool is_dst;
+};
+using TZ_Transitions = std::vector<TZ_Transition>;
+
 class TimeZoneProvider
 {
 public:
@@ -55,13 +70,36 @@ public:
     TimeZoneProvider operator=(const TimeZoneProvider&) = delete;
     TimeZoneProvider operator=(const TimeZoneProvider&&) = delete;
     TZ_Ptr get (int year) const noexcept;
+    /** Look up the UTC offset in effect at a UTC time in a table of
+     * transitions built from the zone rules on first use. The result is the
+     * same as constructing a local_date_time from the time with get() for
+     * its UTC year, but costs a binary search.
+     * @param time Seconds from the POSIX epoch.
+     * @param offset Set to the offset in seconds east of UTC.
+     * @param is_dst Set to whether DST is in effect.
+     * @return false if time is outside of the years covered by the table,
+     * table_first_year to table_last_year.
+     */
+    bool utc_offset (int64_t time, int32_t& offset, bool& is_dst) const noexcept;
+    /** Whether the offset changes within window seconds either side of
+     * time, or time is outside the table. Used to avoid the fast path
+     * when converting local times that might be skipped or repeated.
+     */
+    bool near_transition (int64_t time, int64_t window) const noexcept;
     void dump() const noexcept;
     static const unsigned int min_year; //1400
     static const unsigned int max_year; //9999
+    static const unsigned int table_first_year; //1900
+    static const unsigned int table_last_year; //2200
 private:
     void parse_file(const std::string& tzname);
     bool construct(const std::string& tzname);
+    void build_transitions() const noexcept;
     TZ_Vector m_zone_vector;
+    mutable std::once_flag m_transitions_built;
+    mutable TZ_Transitions m_transitions;
+    mutable int64_t m_table_begin = 0;
+    mutable int64_t m_table_end = 0;
 #if PLATFORM(WINDOWS)
     void load_windows_dynamic_tz(HKEY, time_zone_names);
     void load_windows_classic_tz(HKEY, time_zone_names);
@@ -34,6 +34,7 @@ extern "C"
 
 #include "kvp-value.hpp"
 #include "kvp-frame.hpp"
+#include <atomic>
 #include <typeinfo>
 #include <sstream>
 #include <algorithm>
@@ -45,7 +46,21 @@ static QofLogModule log_module = "qof.kvp";
 
 static const char delim = '/';
 
-KvpFrameImpl::KvpFrameImpl(const KvpFrameImpl & rhs) noexcept
+/* Shared by all frames so that a serial number never identifies two
+ * different sets of contents, even in two frames allocated at the same
+ * address one after the other. */
+static std::atomic<uint64_t> last_serial {0};
+
+static inline uint64_t
+next_serial () noexcept
+{
+    return ++last_serial;
+}
+
+KvpFrameImpl::KvpFrameImpl() noexcept : m_serial {next_serial ()} {}
+
+KvpFrameImpl::KvpFrameImpl(const KvpFrameImpl & rhs) noexcept :
+    m_serial {next_serial ()}
 {
     std::for_each(rhs.m_valuemap.begin(), rhs.m_valuemap.end(),
         [this](const map_type::value_type & a)
@@ -115,6 +130,8 @@ KvpFrame::set_impl (std::string const & key, KvpValue * value) noexcept
         auto cachedkey = static_cast <char const *> (qof_string_cache_insert (key.c_str ()));
         m_valuemap.emplace (cachedkey, value);
     }
+    if (ret || value)
+        m_serial = next_serial ();
     return ret;
 }
 
@@ -89,6 +89,7 @@
 #include <string>
 #include <vector>
 #include <cstring>
+#include <cstdint>
 #include <algorithm>
 #include <iostream>
 using Path = std::vector<std::string>;
@@ -121,7 +122,7 @@ struct KvpFrameImpl
     using map_type = std::map<const char *, KvpValue*, cstring_comparer>;
 
     public:
-    KvpFrameImpl() noexcept {};
+    KvpFrameImpl() noexcept;
 
     /**
      * Performs a deep copy.
@@ -224,10 +225,20 @@ struct KvpFrameImpl
      * @return true if the frame contains nothing.
      */
     bool empty() const noexcept { return m_valuemap.empty(); }
+
+    /** A number identifying the current contents of the immediate frame.
+     * It changes whenever a value is added to, replaced in or removed from
+     * the frame and no two frames ever share one, so it can tell whether
+     * something derived from the frame's contents is stale. Changes made
+     * in place to a value or to a child frame don't change it.
+     * @return The frame's serial number.
+     */
+    uint64_t serial() const noexcept { return m_serial; }
     friend int compare(const KvpFrameImpl&, const KvpFrameImpl&) noexcept;
 
     private:
     map_type m_valuemap;
+    uint64_t m_serial;
 
     KvpFrame * get_child_frame_or_nullptr (Path const &) noexcept;
     KvpFrame * get_child_frame_or_create (Path const &) noexcept;
@@ -239,14 +250,13 @@ template<typename func_type, typename data_type>
 void KvpFrame::for_each_slot_prefix(std::string const & prefix,
         func_type const & func, data_type & data) const noexcept
 {
-    std::for_each (m_valuemap.begin(), m_valuemap.end(),
-        [&prefix,&func,&data](const KvpFrameImpl::map_type::value_type & a)
-        {
-            /* Testing for prefix matching */
-            if (strncmp(a.first, prefix.c_str(), prefix.size()) == 0)
-                func (&a.first[prefix.size()], a.second, data);
-        }
-    );
+    /* The keys are sorted, so the matches are contiguous starting at the
+     * first key not less than the prefix. */
+    for (auto spot = m_valuemap.lower_bound (prefix.c_str ());
+         spot != m_valuemap.end () &&
+             strncmp (spot->first, prefix.c_str (), prefix.size ()) == 0;
+         ++spot)
+        func (&spot->first[prefix.size()], spot->second, data);
 }
 
 template <typename func_type>
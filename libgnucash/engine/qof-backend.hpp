@@ -212,6 +212,13 @@ public:
  *    better to wait for the query).
  */
     virtual void load (QofBook*, QofBackendLoadType) = 0;
+/**
+ *    Called by qof_query_run() before it searches the objects in memory so
+ *    that a backend which didn't load everything at startup can load the
+ *    objects that the query might match. Backends that load all of their
+ *    data in load() needn't implement it.
+ */
+    virtual void load_for_query (QofQuery*) {}
 /**
  *    Called when the engine is about to make a change to a data structure. It
  *    could provide an advisory lock on data, but no backend does this.
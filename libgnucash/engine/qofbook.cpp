@@ -481,6 +481,7 @@ qof_book_mark_session_saved (QofBook *book)
 void qof_book_mark_session_dirty (QofBook *book)
 {
     if (!book) return;
+    book->generation++;
     if (!book->session_dirty)
     {
         /* Set the session dirty upfront, because the callback will check. */
@@ -506,6 +507,20 @@ qof_book_get_session_dirty_time (const QofBook *book)
     return book->dirty_time;
 }
 
+guint64
+qof_book_get_generation (const QofBook *book)
+{
+    g_return_val_if_fail (book, 0);
+    return book->generation;
+}
+
+void
+qof_book_bump_generation (QofBook *book)
+{
+    g_return_if_fail (book);
+    book->generation++;
+}
+
 void
 qof_book_set_dirty_cb(QofBook *book, QofBookDirtyCB cb, gpointer user_data)
 {
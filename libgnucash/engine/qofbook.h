@@ -107,6 +107,10 @@ struct _QofBook
      * callback function.*/
     gpointer dirty_data;
 
+    /* Incremented every time a change to the book or one of its objects
+     * is committed, see qof_book_get_generation(). */
+    guint64 generation;
+
     /* The entity table associates the GUIDs of all the objects
      * belonging to this book, with their pointers to the respective
      * objects.  This allows a lookup of objects based on their guid.
@@ -342,6 +346,16 @@ void qof_book_mark_session_dirty(QofBook *book);
 /** Retrieve the earliest modification time on the book. */
 time64 qof_book_get_session_dirty_time(const QofBook *book);
 
+/** Retrieve the book's generation. It increases every time a change to
+ *  the book or one of its objects is committed, whether or not the
+ *  change has been saved, so an unchanged generation means that
+ *  nothing in the book has changed. Useful for caching results derived
+ *  from the book's contents. */
+guint64 qof_book_get_generation (const QofBook *book);
+
+/** Increment the book's generation, see qof_book_get_generation(). */
+void qof_book_bump_generation (QofBook *book);
+
 /** Set the function to call when a book transitions from clean to
  *    dirty, or vice versa.
  */
@@ -1003,6 +1003,10 @@ qof_commit_edit_part2(QofInstance *inst,
       qof_collection_mark_dirty(priv->collection);
       qof_book_mark_session_dirty(priv->book);
     }
+    /* Freeing an unsaved instance leaves nothing to save but still
+     * changes the book's contents. */
+    else if (priv->do_free)
+        qof_book_bump_generation(priv->book);
 
     /* See if there's a backend.  If there is, invoke it. */
     auto be = qof_book_get_backend(priv->book);
@@ -824,10 +824,11 @@ static void qof_query_run_cb(QofQueryCB* qcb, gpointer cb_arg)
     for (node = qcb->query->books; node; node = node->next)
     {
         QofBook* book = static_cast<QofBook*>(node->data);
-#ifdef QOF_BACKEND_QUERY
         QofBackend* be = book->backend;
 
-
+        if (be)
+            be->load_for_query (qcb->query);
+#ifdef QOF_BACKEND_QUERY
         if (be)
         {
             gpointer compiled_query = g_hash_table_lookup (qcb->query->be_compiled,
@@ -0,0 +1,139 @@
+/********************************************************************
+ * bench-gnc-numeric.cpp -- micro-benchmarks for gnc_numeric         *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+/* Not a test: run by hand (make bench-gnc-numeric) to compare the cost of
+ * the gnc_numeric C API operations across the denominators that turn up
+ * in real books.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "../gnc-numeric.hpp"
+
+using Clock = std::chrono::steady_clock;
+using OpFunc = gnc_numeric (*)(gnc_numeric, gnc_numeric);
+
+static gnc_numeric
+add_fixed(gnc_numeric a, gnc_numeric b)
+{
+    return gnc_numeric_add_fixed(a, b);
+}
+
+static gnc_numeric
+sub_fixed(gnc_numeric a, gnc_numeric b)
+{
+    return gnc_numeric_sub_fixed(a, b);
+}
+
+static gnc_numeric
+add_lcd(gnc_numeric a, gnc_numeric b)
+{
+    return gnc_numeric_add(a, b, GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
+}
+
+static gnc_numeric
+mul_round(gnc_numeric a, gnc_numeric b)
+{
+    return gnc_numeric_mul(a, b, a.denom, GNC_HOW_RND_ROUND_HALF_UP);
+}
+
+static gnc_numeric
+div_round(gnc_numeric a, gnc_numeric b)
+{
+    return gnc_numeric_div(a, b, a.denom, GNC_HOW_RND_ROUND_HALF_UP);
+}
+
+static gnc_numeric
+convert_round(gnc_numeric a, gnc_numeric)
+{
+    return gnc_numeric_convert(a, 100, GNC_HOW_RND_ROUND_HALF_UP);
+}
+
+static void
+run_one(const char* name, OpFunc op, const std::vector<gnc_numeric>& lhs,
+        const std::vector<gnc_numeric>& rhs)
+{
+    int64_t sink{0};
+    auto start = Clock::now();
+    for (size_t i = 0; i < lhs.size(); ++i)
+        sink += op(lhs[i], rhs[i]).num;
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        Clock::now() - start).count();
+    std::cout << std::setw(14) << name << std::setw(12)
+              << elapsed / static_cast<double>(lhs.size()) << " ns/op"
+              << "  (" << (sink & 1) << ")\n";
+}
+
+static void
+run_sum(const std::vector<gnc_numeric>& values)
+{
+    auto start = Clock::now();
+    auto sum = gnc_numeric_zero();
+    for (auto value : values)
+        sum = gnc_numeric_add_fixed(sum, value);
+    auto scalar = std::chrono::duration_cast<std::chrono::microseconds>(
+        Clock::now() - start).count();
+    start = Clock::now();
+    auto batch = gnc_numeric_sum(values.data(), values.size(), GNC_DENOM_AUTO,
+                                 GNC_HOW_DENOM_FIXED | GNC_HOW_RND_NEVER);
+    auto batched = std::chrono::duration_cast<std::chrono::microseconds>(
+        Clock::now() - start).count();
+    std::cout << std::setw(14) << "sum" << std::setw(12) << scalar
+              << " us scalar, " << batched << " us batch"
+              << (gnc_numeric_eq(sum, batch) ? "" : "  MISMATCH") << "\n";
+}
+
+int
+main(int argc, char** argv)
+{
+    size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    std::mt19937_64 gen(42);
+    std::uniform_int_distribution<int64_t> dist(-100000000, 100000000);
+    for (int64_t denom : {INT64_C(1), INT64_C(100), INT64_C(1000),
+                INT64_C(1000000), INT64_C(100000000)})
+    {
+        std::vector<gnc_numeric> lhs, rhs, mixed;
+        lhs.reserve(count);
+        rhs.reserve(count);
+        mixed.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            lhs.push_back(gnc_numeric_create(dist(gen), denom));
+            auto num = dist(gen);
+            rhs.push_back(gnc_numeric_create(num ? num : 1, denom));
+            mixed.push_back(gnc_numeric_create(num, denom == 1 ? 100 : 1));
+        }
+        std::cout << "denominator " << denom << ":\n";
+        run_one("add_fixed", add_fixed, lhs, rhs);
+        run_one("sub_fixed", sub_fixed, lhs, rhs);
+        run_one("add_lcd", add_lcd, lhs, rhs);
+        run_one("add_mixed", add_lcd, lhs, mixed);
+        run_one("mul", mul_round, lhs, rhs);
+        run_one("div", div_round, lhs, rhs);
+        run_one("convert", convert_round, lhs, rhs);
+        run_sum(lhs);
+    }
+    return 0;
+}
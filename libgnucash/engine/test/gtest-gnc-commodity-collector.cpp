@@ -0,0 +1,114 @@
+/********************************************************************
+ * gtest-gnc-commodity-collector.cpp: Test commodity collectors.    *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+extern "C"
+{
+#include <config.h>
+#include "../gnc-commodity-collector.h"
+#include <qof.h>
+}
+
+#include <gtest/gtest.h>
+
+class CollectorTest : public testing::Test
+{
+protected:
+    void SetUp() {
+        m_book = qof_book_new();
+        m_usd = gnc_commodity_new(m_book, "US Dollar", "CURRENCY", "USD",
+                                  "840", 100);
+        m_eur = gnc_commodity_new(m_book, "Euro", "CURRENCY", "EUR",
+                                  "978", 100);
+        m_coll = gnc_commodity_collector_new();
+    }
+    void TearDown() {
+        gnc_commodity_collector_destroy(m_coll);
+        gnc_commodity_destroy(m_usd);
+        gnc_commodity_destroy(m_eur);
+        qof_book_destroy(m_book);
+    }
+    QofBook *m_book;
+    gnc_commodity *m_usd;
+    gnc_commodity *m_eur;
+    GncCommodityCollector *m_coll;
+};
+
+TEST_F(CollectorTest, add)
+{
+    EXPECT_TRUE(gnc_commodity_collector_add(m_coll, m_usd,
+                                            gnc_numeric_create(150, 100)));
+    EXPECT_TRUE(gnc_commodity_collector_add(m_coll, m_eur,
+                                            gnc_numeric_create(2, 1)));
+    EXPECT_TRUE(gnc_commodity_collector_add(m_coll, m_usd,
+                                            gnc_numeric_create(1, 3)));
+    EXPECT_EQ(2u, gnc_commodity_collector_get_length(m_coll));
+    EXPECT_TRUE(gnc_numeric_equal(gnc_numeric_create(11, 6),
+                                  gnc_commodity_collector_get_amount(m_coll, m_usd)));
+    EXPECT_TRUE(gnc_numeric_equal(gnc_numeric_create(2, 1),
+                                  gnc_commodity_collector_get_amount(m_coll, m_eur)));
+    /* Most recently added first */
+    EXPECT_EQ(m_eur, gnc_commodity_collector_nth_commodity(m_coll, 0));
+    EXPECT_EQ(m_usd, gnc_commodity_collector_nth_commodity(m_coll, 1));
+    EXPECT_EQ(nullptr, gnc_commodity_collector_nth_commodity(m_coll, 2));
+    EXPECT_TRUE(gnc_numeric_equal(gnc_numeric_create(11, 6),
+                                  gnc_commodity_collector_nth_amount(m_coll, 1)));
+
+    gnc_commodity_collector_reset(m_coll);
+    EXPECT_EQ(0u, gnc_commodity_collector_get_length(m_coll));
+    EXPECT_TRUE(gnc_numeric_zero_p(gnc_commodity_collector_get_amount(m_coll, m_usd)));
+}
+
+TEST_F(CollectorTest, add_overflow)
+{
+    auto big = gnc_numeric_create(INT64_MAX, 1);
+    EXPECT_TRUE(gnc_commodity_collector_add(m_coll, m_usd, big));
+    EXPECT_FALSE(gnc_commodity_collector_add(m_coll, m_usd, big));
+    EXPECT_FALSE(gnc_commodity_collector_add(m_coll, m_eur,
+                                             gnc_numeric_error(GNC_ERROR_ARG)));
+    /* The totals are unchanged but the commodity is listed. */
+    EXPECT_TRUE(gnc_numeric_equal(big, gnc_commodity_collector_get_amount(m_coll, m_usd)));
+    EXPECT_EQ(2u, gnc_commodity_collector_get_length(m_coll));
+    EXPECT_TRUE(gnc_numeric_zero_p(gnc_commodity_collector_get_amount(m_coll, m_eur)));
+}
+
+TEST_F(CollectorTest, merge)
+{
+    auto other = gnc_commodity_collector_new();
+    gnc_commodity_collector_add(m_coll, m_usd, gnc_numeric_create(5, 1));
+    gnc_commodity_collector_add(other, m_usd, gnc_numeric_create(2, 1));
+    gnc_commodity_collector_add(other, m_eur, gnc_numeric_create(3, 1));
+
+    EXPECT_TRUE(gnc_commodity_collector_merge(m_coll, other, TRUE));
+    EXPECT_TRUE(gnc_numeric_equal(gnc_numeric_create(3, 1),
+                                  gnc_commodity_collector_get_amount(m_coll, m_usd)));
+    EXPECT_TRUE(gnc_numeric_equal(gnc_numeric_create(-3, 1),
+                                  gnc_commodity_collector_get_amount(m_coll, m_eur)));
+    EXPECT_EQ(m_eur, gnc_commodity_collector_nth_commodity(m_coll, 0));
+
+    /* A merge that overflows leaves the collector alone. */
+    gnc_commodity_collector_add(m_coll, m_usd, gnc_numeric_create(INT64_MAX - 3, 1));
+    EXPECT_FALSE(gnc_commodity_collector_merge(m_coll, other, FALSE));
+    EXPECT_TRUE(gnc_numeric_equal(gnc_numeric_create(INT64_MAX, 1),
+                                  gnc_commodity_collector_get_amount(m_coll, m_usd)));
+    EXPECT_TRUE(gnc_numeric_equal(gnc_numeric_create(-3, 1),
+                                  gnc_commodity_collector_get_amount(m_coll, m_eur)));
+    gnc_commodity_collector_destroy(other);
+}
@@ -569,6 +569,82 @@ TEST(gnc_datetime_functions, test_date)
     EXPECT_EQ(ymd.month, 11);
     EXPECT_EQ(ymd.day - (12 + atime.offset() / 3600) / 24, 13);
 }
+
+TEST(gnc_datetime_functions, test_format_iso8601_buff)
+{
+    char buff[GncDateTime::iso8601_buff_size];
+    for (time64 time : {MINTIME + 86400, INT64_C(-1), INT64_C(0), INT64_C(951782400),
+                INT64_C(2394187200), INT64_C(4107542399), MAXTIME - 86400})
+    {
+        auto end = GncDateTime::format_iso8601_buff(time, buff);
+        ASSERT_NE(nullptr, end);
+        EXPECT_EQ(19, end - buff);
+        EXPECT_EQ(GncDateTime(time).format_zulu("%Y-%m-%d %H:%M:%S"), buff);
+    }
+    EXPECT_EQ(nullptr, GncDateTime::format_iso8601_buff(MINTIME - 1, buff));
+    EXPECT_EQ(nullptr, GncDateTime::format_iso8601_buff(MAXTIME + 1, buff));
+}
+
+TEST(gnc_datetime_functions, test_parse_iso8601)
+{
+    time64 time;
+    for (auto str : {"2015-12-05 11:57:03", "1993-07-22 15:21:19 +0300",
+                "1993-07-22 15:21:19 -0530", "1993-07-22 15:21:19 +0013",
+                "20151205115703", "1400-01-01 00:00:00", "2000-02-29 23:59:59"})
+    {
+        EXPECT_TRUE(GncDateTime::parse_iso8601(str, time)) << str;
+        EXPECT_EQ(static_cast<time64>(GncDateTime(std::string(str))), time) << str;
+    }
+    /* Anything else is left to GncDateTime(std::string). */
+    for (auto str : {"", "2012-07-04 19:27:44.0+08:40", "2020-11-07 06:21:19 -05",
+                "2061-01-25 23:21:19.0 -05:00", "2015-12-05T11:57:03",
+                "2015-12-05 11:57:03 +0300 ", "1999-02-29 10:00:00",
+                "2015-13-05 11:57:03", "1399-12-31 23:59:59"})
+        EXPECT_FALSE(GncDateTime::parse_iso8601(str, time)) << str;
+    EXPECT_FALSE(GncDateTime::parse_iso8601(nullptr, time));
+}
+
+TEST(gnc_datetime_functions, test_local_tm_and_day_part)
+{
+#ifdef __MINGW32__
+    TimeZoneProvider tzp_la{"Pacific Standard Time"};
+#else
+    TimeZoneProvider tzp_la("America/Los_Angeles");
+#endif
+    _set_tzp(tzp_la);
+    /* Hourly across the 2020 spring-forward and 2021 New Year. */
+    for (time64 time : {INT64_C(1583478000), INT64_C(1609268400)})
+    {
+        for (auto end = time + 4 * 86400; time < end; time += 3599)
+        {
+            struct tm fast;
+            if (GncDateTime::local_tm(time, fast))
+            {
+                auto slow = static_cast<struct tm>(GncDateTime(time));
+                EXPECT_EQ(fast.tm_year, slow.tm_year) << time;
+                EXPECT_EQ(fast.tm_yday, slow.tm_yday) << time;
+                EXPECT_EQ(fast.tm_wday, slow.tm_wday) << time;
+                EXPECT_EQ(fast.tm_hour, slow.tm_hour) << time;
+                EXPECT_EQ(fast.tm_min, slow.tm_min) << time;
+                EXPECT_EQ(fast.tm_sec, slow.tm_sec) << time;
+                EXPECT_EQ(fast.tm_isdst, slow.tm_isdst) << time;
+            }
+            for (auto part : {DayPart::start, DayPart::neutral, DayPart::end})
+            {
+                time64 result;
+                if (GncDateTime::day_part(time, part, result))
+                    EXPECT_EQ(result, static_cast<time64>(
+                                  GncDateTime(GncDateTime(time).date(), part)))
+                        << time;
+            }
+        }
+    }
+    time64 result;
+    EXPECT_TRUE(GncDateTime::day_part(1583478000, DayPart::start, result));
+    EXPECT_EQ(result, 1583395200);
+    EXPECT_FALSE(GncDateTime::day_part(1583665140, DayPart::start, result));
+    _reset_tzp();
+}
 /* This test works only in the America/LosAngeles time zone and
  * there's no straightforward way to make it more flexible. It ensures
  * that DST in that timezone transitions correctly for each day of the
@@ -21,6 +21,7 @@
 \********************************************************************/
 
 #include <gtest/gtest.h>
+#include <vector>
 #include "../gnc-numeric.hpp"
 #include "../gnc-rational.hpp"
 
@@ -561,3 +562,123 @@ TEST(gnc_numeric_functions, test_conversion_to_decimal)
     EXPECT_EQ(100, r.num());
     EXPECT_EQ(1, r.denom());
 }
+
+TEST(gnc_numeric_functions, test_same_denom_add_sub)
+{
+    auto a = gnc_numeric_create(12345, 100), b = gnc_numeric_create(-678, 100);
+    auto r = gnc_numeric_add_fixed(a, b);
+    EXPECT_EQ(11667, r.num);
+    EXPECT_EQ(100, r.denom);
+    r = gnc_numeric_sub_fixed(a, b);
+    EXPECT_EQ(13023, r.num);
+    EXPECT_EQ(100, r.denom);
+    r = gnc_numeric_add(a, b, 100, GNC_HOW_DENOM_FIXED | GNC_HOW_RND_NEVER);
+    EXPECT_EQ(11667, r.num);
+    EXPECT_EQ(100, r.denom);
+    r = gnc_numeric_add(a, b, GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
+    EXPECT_EQ(11667, r.num);
+    EXPECT_EQ(100, r.denom);
+/* Results requiring reduction or conversion must match the general path. */
+    r = gnc_numeric_add(a, b, GNC_DENOM_AUTO, GNC_HOW_DENOM_REDUCE);
+    EXPECT_EQ(11667, r.num);
+    EXPECT_EQ(100, r.denom);
+    r = gnc_numeric_add(gnc_numeric_create(25, 100), gnc_numeric_create(25, 100),
+                        GNC_DENOM_AUTO, GNC_HOW_DENOM_REDUCE);
+    EXPECT_EQ(1, r.num);
+    EXPECT_EQ(2, r.denom);
+    r = gnc_numeric_add(a, b, 10, GNC_HOW_DENOM_FIXED | GNC_HOW_RND_ROUND);
+    EXPECT_EQ(1167, r.num);
+    EXPECT_EQ(10, r.denom);
+/* Overflowing the int64 numerator falls back to the 128-bit path. */
+    auto big = gnc_numeric_create(INT64_MAX - 1, 100);
+    r = gnc_numeric_add_fixed(big, big);
+    auto check = GncNumeric(GncRational(big) + GncRational(big));
+    EXPECT_EQ(check.num(), r.num);
+    EXPECT_EQ(check.denom(), r.denom);
+    auto neg_big = gnc_numeric_neg(big);
+    r = gnc_numeric_sub_fixed(neg_big, big);
+    check = GncNumeric(GncRational(neg_big) - GncRational(big));
+    EXPECT_EQ(check.num(), r.num);
+    EXPECT_EQ(check.denom(), r.denom);
+/* Errors still propagate. */
+    r = gnc_numeric_add_fixed(gnc_numeric_error(GNC_ERROR_OVERFLOW),
+                              gnc_numeric_error(GNC_ERROR_OVERFLOW));
+    EXPECT_EQ(GNC_ERROR_ARG, gnc_numeric_check(r));
+}
+
+static gnc_numeric
+fold_add(const std::vector<gnc_numeric>& values, gint64 denom, gint how)
+{
+    auto sum = gnc_numeric_zero();
+    for (auto value : values)
+        sum = gnc_numeric_add(sum, value, denom, how);
+    return sum;
+}
+
+static void
+expect_sum_matches_fold(const std::vector<gnc_numeric>& values,
+                        gint64 denom, gint how)
+{
+    auto expected = fold_add(values, denom, how);
+    auto actual = gnc_numeric_sum(values.data(), values.size(), denom, how);
+    EXPECT_EQ(expected.num, actual.num);
+    EXPECT_EQ(expected.denom, actual.denom);
+}
+
+TEST(gnc_numeric_functions, test_sum)
+{
+    const gint fixed = GNC_HOW_DENOM_FIXED | GNC_HOW_RND_NEVER;
+    std::vector<gnc_numeric> uniform;
+    for (int i = 0; i < 1000; ++i)
+        uniform.push_back(gnc_numeric_create((i % 7 - 3) * 12345 + i, 100));
+    expect_sum_matches_fold(uniform, GNC_DENOM_AUTO, fixed);
+    expect_sum_matches_fold(uniform, GNC_DENOM_AUTO, GNC_HOW_DENOM_LCD);
+    expect_sum_matches_fold(uniform, GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
+    expect_sum_matches_fold(uniform, GNC_DENOM_AUTO, GNC_HOW_DENOM_REDUCE);
+    expect_sum_matches_fold(uniform, 10, GNC_HOW_RND_ROUND_HALF_UP);
+
+    std::vector<gnc_numeric> balanced{gnc_numeric_create(500, 100),
+            gnc_numeric_create(-200, 100), gnc_numeric_create(-300, 100)};
+    expect_sum_matches_fold(balanced, GNC_DENOM_AUTO, fixed);
+    expect_sum_matches_fold(balanced, GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
+    expect_sum_matches_fold(balanced, GNC_DENOM_AUTO,
+                            GNC_HOW_DENOM_EXACT | GNC_HOW_RND_NEVER);
+
+    auto mixed = balanced;
+    mixed.push_back(gnc_numeric_create(0, 1));
+    mixed.push_back(gnc_numeric_create(1, 3));
+    expect_sum_matches_fold(mixed, GNC_DENOM_AUTO, fixed);
+    expect_sum_matches_fold(mixed, GNC_DENOM_AUTO, GNC_HOW_DENOM_EXACT);
+
+    std::vector<gnc_numeric> large(4, gnc_numeric_create(INT64_MAX / 3, 100));
+    expect_sum_matches_fold(large, GNC_DENOM_AUTO, fixed);
+
+    auto with_error = uniform;
+    with_error.push_back(gnc_numeric_error(GNC_ERROR_OVERFLOW));
+    auto r = gnc_numeric_sum(with_error.data(), with_error.size(),
+                             GNC_DENOM_AUTO, fixed);
+    EXPECT_NE(GNC_ERROR_OK, gnc_numeric_check(r));
+
+    r = gnc_numeric_sum(nullptr, 0, GNC_DENOM_AUTO, fixed);
+    EXPECT_TRUE(gnc_numeric_zero_p(r));
+}
+
+static gnc_numeric
+get_numeric(gconstpointer item)
+{
+    return *static_cast<const gnc_numeric*>(item);
+}
+
+TEST(gnc_numeric_functions, test_sum_list)
+{
+    std::vector<gnc_numeric> values{gnc_numeric_create(125, 100),
+            gnc_numeric_create(250, 100), gnc_numeric_create(-75, 100)};
+    GList *list = nullptr;
+    for (auto& value : values)
+        list = g_list_prepend(list, &value);
+    auto r = gnc_numeric_sum_list(list, get_numeric, GNC_DENOM_AUTO,
+                                  GNC_HOW_DENOM_FIXED | GNC_HOW_RND_NEVER);
+    EXPECT_EQ(300, r.num);
+    EXPECT_EQ(100, r.denom);
+    g_list_free(list);
+}
@@ -0,0 +1,161 @@
+/********************************************************************
+ * gtest-gnc-owner-aging.cpp: Test the aging of A/R and A/P owners. *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+extern "C"
+{
+#include <config.h>
+#include "../gnc-owner-aging.h"
+#include "../Account.h"
+#include "../Transaction.h"
+#include "../TransLog.h"
+#include "../cashobjects.h"
+#include "../gncCustomer.h"
+#include "../gncEntry.h"
+#include "../gncInvoice.h"
+#include "../gncOwner.h"
+#include <qof.h>
+}
+
+#include <gtest/gtest.h>
+#include <vector>
+
+/* The buckets of a six bucket aging: over 90, 61-90, 31-60 and 0-30 days
+ * old, not yet due, and prepayments. */
+using Buckets = std::vector<gint64>;
+
+class OwnerAgingTest : public testing::Test
+{
+protected:
+    void SetUp() {
+        qof_init();
+        cashobjects_register();
+        xaccLogDisable();
+        m_book = qof_book_new();
+        m_usd = gnc_commodity_new(m_book, "US Dollar", "CURRENCY", "USD",
+                                  "840", 100);
+        m_root = gnc_account_create_root(m_book);
+        m_receivable = add_account("Receivable", ACCT_TYPE_RECEIVABLE);
+        m_income = add_account("Income", ACCT_TYPE_INCOME);
+        m_bank = add_account("Bank", ACCT_TYPE_BANK);
+
+        m_customer = gncCustomerCreate(m_book);
+        gncCustomerBeginEdit(m_customer);
+        gncCustomerSetID(m_customer, "000001");
+        gncCustomerSetName(m_customer, "Customer");
+        gncCustomerSetCurrency(m_customer, m_usd);
+        gncCustomerCommitEdit(m_customer);
+        gncOwnerInitCustomer(&m_owner, m_customer);
+
+        m_invoice = gncInvoiceCreate(m_book);
+        gncInvoiceBeginEdit(m_invoice);
+        gncInvoiceSetID(m_invoice, "000001");
+        gncInvoiceSetOwner(m_invoice, &m_owner);
+        gncInvoiceSetCurrency(m_invoice, m_usd);
+        auto entry = gncEntryCreate(m_book);
+        gncEntryBeginEdit(entry);
+        gncEntrySetDate(entry, m_date);
+        gncEntrySetQuantity(entry, gnc_numeric_create(1, 1));
+        gncEntrySetInvPrice(entry, gnc_numeric_create(100, 1));
+        gncEntrySetInvAccount(entry, m_income);
+        gncEntrySetInvTaxable(entry, FALSE);
+        gncEntryCommitEdit(entry);
+        gncInvoiceAddEntry(m_invoice, entry);
+        gncInvoiceCommitEdit(m_invoice);
+    }
+    void TearDown() {
+        qof_book_destroy(m_book);
+        qof_close();
+    }
+    Account *add_account(const char *name, GNCAccountType type) {
+        auto account = xaccMallocAccount(m_book);
+        xaccAccountBeginEdit(account);
+        xaccAccountSetName(account, name);
+        xaccAccountSetType(account, type);
+        xaccAccountSetCommodity(account, m_usd);
+        xaccAccountCommitEdit(account);
+        gnc_account_append_child(m_root, account);
+        return account;
+    }
+    time64 days_before(int days) {
+        return m_date - static_cast<time64>(days) * 86400;
+    }
+    /* The rows of the receivable account's aging as of m_date. */
+    std::vector<Buckets> age(bool due_date = false) {
+        auto accounts = g_list_prepend(nullptr, m_receivable);
+        auto aging = gnc_owner_aging_new(accounts, m_date, 6, due_date, TRUE);
+        g_list_free(accounts);
+
+        std::vector<Buckets> rows;
+        for (guint row = 0; row < gnc_owner_aging_get_num_rows(aging); row++)
+        {
+            EXPECT_EQ(m_receivable, gnc_owner_aging_get_account(aging, row));
+            EXPECT_EQ(m_customer,
+                      gncOwnerGetCustomer(gnc_owner_aging_get_owner(aging, row)));
+            Buckets buckets;
+            for (guint i = 0; i < gnc_owner_aging_get_num_buckets(aging); i++)
+            {
+                auto amount = gnc_owner_aging_get_bucket(aging, row, i);
+                buckets.push_back(gnc_numeric_convert(amount, 1,
+                                                      GNC_HOW_RND_ROUND).num);
+            }
+            rows.push_back(buckets);
+        }
+        EXPECT_EQ(0u, gnc_owner_aging_get_num_invalid(aging));
+        gnc_owner_aging_destroy(aging);
+        return rows;
+    }
+    QofBook *m_book;
+    gnc_commodity *m_usd;
+    Account *m_root;
+    Account *m_receivable;
+    Account *m_income;
+    Account *m_bank;
+    GncCustomer *m_customer;
+    GncOwner m_owner;
+    GncInvoice *m_invoice;
+    time64 m_date = gnc_dmy2time64_neutral(15, 6, 2020);
+};
+
+/* Each aging after the first only looks at what the events say changed,
+ * and has to come out as gnc:owner-splits->aging-list would age all of
+ * the account's splits. */
+TEST_F(OwnerAgingTest, post_pay_unpost)
+{
+    EXPECT_EQ(std::vector<Buckets>{}, age());
+
+    gncInvoicePostToAccount(m_invoice, m_receivable, days_before(45),
+                            days_before(-10), "", TRUE, FALSE);
+    EXPECT_EQ((std::vector<Buckets>{{0, 0, 100, 0, 0, 0}}), age());
+    EXPECT_EQ((std::vector<Buckets>{{0, 0, 0, 0, 100, 0}}), age(true));
+
+    auto lots = g_list_prepend(nullptr, gncInvoiceGetPostedLot(m_invoice));
+    gncOwnerApplyPaymentSecs(&m_owner, nullptr, lots, m_receivable, m_bank,
+                             gnc_numeric_create(40, 1),
+                             gnc_numeric_create(1, 1), days_before(10),
+                             "", "", FALSE);
+    g_list_free(lots);
+    EXPECT_EQ((std::vector<Buckets>{{0, 0, 60, 0, 0, 0}}), age());
+
+    /* The payment stays in the invoice's lot, which becomes a
+     * prepayment. */
+    gncInvoiceUnpost(m_invoice, TRUE);
+    EXPECT_EQ((std::vector<Buckets>{{0, 0, 0, 0, 0, -40}}), age());
+}
@@ -0,0 +1,314 @@
+/********************************************************************
+ * gtest-gnc-split-selection.cpp: Test report split selections.     *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+extern "C"
+{
+#include <config.h>
+#include "../gnc-split-selection.h"
+#include "../Account.h"
+#include "../Query.h"
+#include "../Transaction.h"
+#include "../cashobjects.h"
+#include <qof.h>
+}
+
+#include <gtest/gtest.h>
+#include <vector>
+
+using SplitVec = std::vector<Split*>;
+
+class SplitSelectionTest : public testing::Test
+{
+protected:
+    void SetUp() {
+        qof_init();
+        cashobjects_register();
+        m_book = qof_book_new();
+        m_usd = gnc_commodity_new(m_book, "US Dollar", "CURRENCY", "USD",
+                                  "840", 100);
+        m_root = gnc_account_create_root(m_book);
+
+        m_bank = xaccMallocAccount(m_book);
+        xaccAccountSetName(m_bank, "Bank");
+        gnc_account_append_child(m_root, m_bank);
+
+        m_food = xaccMallocAccount(m_book);
+        xaccAccountSetName(m_food, "Food");
+        gnc_account_append_child(m_root, m_food);
+
+        m_jan = add_split(m_bank, gnc_dmy2time64_neutral(15, 1, 2020));
+        m_feb1 = add_split(m_bank, gnc_dmy2time64_neutral(3, 2, 2020));
+        m_feb2 = add_split(m_bank, gnc_dmy2time64_neutral(20, 2, 2020));
+        m_food_feb = add_split(m_food, gnc_dmy2time64_neutral(20, 2, 2020));
+
+        m_sel = gnc_split_selection_new();
+    }
+    void TearDown() {
+        gnc_split_selection_destroy(m_sel);
+        xaccAccountBeginEdit(m_root);
+        xaccAccountDestroy(m_root);
+        gnc_commodity_destroy(m_usd);
+        qof_book_destroy(m_book);
+        qof_close();
+    }
+    Split *add_split(Account *acc, time64 date) {
+        auto trans = xaccMallocTransaction(m_book);
+        xaccTransBeginEdit(trans);
+        xaccTransSetCurrency(trans, m_usd);
+        xaccTransSetDatePostedSecsNormalized(trans, date);
+        auto split = xaccMallocSplit(m_book);
+        xaccSplitSetParent(split, trans);
+        xaccSplitSetAccount(split, acc);
+        xaccTransCommitEdit(trans);
+        return split;
+    }
+    /* Adds a split in acc to split's transaction. */
+    Split *add_other_split(Split *split, Account *acc) {
+        auto trans = xaccSplitGetParent(split);
+        xaccTransBeginEdit(trans);
+        auto other = xaccMallocSplit(m_book);
+        xaccSplitSetParent(other, trans);
+        xaccSplitSetAccount(other, acc);
+        xaccTransCommitEdit(trans);
+        return other;
+    }
+    void set_text(Split *split, const char *description, const char *notes,
+                  const char *memo) {
+        auto trans = xaccSplitGetParent(split);
+        xaccTransBeginEdit(trans);
+        xaccTransSetDescription(trans, description);
+        xaccTransSetNotes(trans, notes);
+        xaccSplitSetMemo(split, memo);
+        xaccTransCommitEdit(trans);
+    }
+    void set_reconcile(Split *split, char reconcile) {
+        auto trans = xaccSplitGetParent(split);
+        xaccTransBeginEdit(trans);
+        xaccSplitSetReconcile(split, reconcile);
+        xaccTransCommitEdit(trans);
+    }
+    /* Runs m_sel on the splits in acc, or on all of them without one. */
+    SplitVec run(Account *acc, gboolean unique_trans = FALSE) {
+        auto query = qof_query_create_for(GNC_ID_SPLIT);
+        qof_query_set_book(query, m_book);
+        if (acc)
+            xaccQueryAddSingleAccountMatch(query, acc, QOF_QUERY_AND);
+        auto splits = gnc_split_selection_run(m_sel, query, unique_trans);
+        SplitVec result;
+        for (auto node = splits; node; node = g_list_next(node))
+            result.push_back(static_cast<Split*>(node->data));
+        g_list_free(splits);
+        qof_query_destroy(query);
+        return result;
+    }
+    void sort_by_date() {
+        gnc_split_selection_set_sort(m_sel, 0, GNC_SPLIT_SORT_DATE,
+                                     GNC_SPLIT_DATE_GROUP_NONE, TRUE, FALSE);
+    }
+    QofBook *m_book;
+    gnc_commodity *m_usd;
+    Account *m_root;
+    Account *m_bank;
+    Account *m_food;
+    Split *m_jan;
+    Split *m_feb1;
+    Split *m_feb2;
+    Split *m_food_feb;
+    GncSplitSelection *m_sel;
+};
+
+TEST_F(SplitSelectionTest, set_matcher)
+{
+    EXPECT_TRUE(gnc_split_selection_set_matcher(m_sel, "gro.*ies", TRUE,
+                                                TRUE, FALSE));
+    EXPECT_TRUE(gnc_split_selection_set_matcher(m_sel, "(", FALSE,
+                                                FALSE, FALSE));
+    EXPECT_FALSE(gnc_split_selection_set_matcher(m_sel, "(", TRUE,
+                                                 FALSE, FALSE));
+    EXPECT_TRUE(gnc_split_selection_set_matcher(m_sel, nullptr, FALSE,
+                                                FALSE, TRUE));
+}
+
+TEST_F(SplitSelectionTest, no_groups)
+{
+    EXPECT_EQ(GNC_SPLIT_BREAK_NONE,
+              gnc_split_selection_get_break(m_sel, m_feb2, m_food_feb));
+    EXPECT_EQ(GNC_SPLIT_BREAK_NONE,
+              gnc_split_selection_get_break(m_sel, m_food_feb, nullptr));
+
+    /* Sorted but not subtotaled */
+    gnc_split_selection_set_sort(m_sel, 0, GNC_SPLIT_SORT_ACCOUNT_NAME,
+                                 GNC_SPLIT_DATE_GROUP_NONE, TRUE, FALSE);
+    gnc_split_selection_set_sort(m_sel, 1, GNC_SPLIT_SORT_DATE,
+                                 GNC_SPLIT_DATE_GROUP_NONE, TRUE, TRUE);
+    EXPECT_EQ(GNC_SPLIT_BREAK_NONE,
+              gnc_split_selection_get_break(m_sel, m_feb2, m_food_feb));
+    EXPECT_EQ(GNC_SPLIT_BREAK_NONE,
+              gnc_split_selection_get_break(m_sel, m_jan, m_feb1));
+}
+
+TEST_F(SplitSelectionTest, get_break)
+{
+    gnc_split_selection_set_sort(m_sel, 0, GNC_SPLIT_SORT_ACCOUNT_NAME,
+                                 GNC_SPLIT_DATE_GROUP_NONE, TRUE, TRUE);
+    gnc_split_selection_set_sort(m_sel, 1, GNC_SPLIT_SORT_DATE,
+                                 GNC_SPLIT_DATE_GROUP_MONTH, TRUE, FALSE);
+    EXPECT_EQ(GNC_SPLIT_BREAK_SECONDARY,
+              gnc_split_selection_get_break(m_sel, m_jan, m_feb1));
+    EXPECT_EQ(GNC_SPLIT_BREAK_NONE,
+              gnc_split_selection_get_break(m_sel, m_feb1, m_feb2));
+    /* Same month, but the account changes */
+    EXPECT_EQ(GNC_SPLIT_BREAK_PRIMARY,
+              gnc_split_selection_get_break(m_sel, m_feb2, m_food_feb));
+    EXPECT_EQ(GNC_SPLIT_BREAK_PRIMARY,
+              gnc_split_selection_get_break(m_sel, m_food_feb, nullptr));
+
+    gnc_split_selection_set_sort(m_sel, 0, GNC_SPLIT_SORT_DATE,
+                                 GNC_SPLIT_DATE_GROUP_YEAR, TRUE, FALSE);
+    EXPECT_EQ(GNC_SPLIT_BREAK_SECONDARY,
+              gnc_split_selection_get_break(m_sel, m_jan, m_feb1));
+    EXPECT_EQ(GNC_SPLIT_BREAK_PRIMARY,
+              gnc_split_selection_get_break(m_sel, m_feb2, nullptr));
+}
+
+TEST_F(SplitSelectionTest, run_other_accounts)
+{
+    add_other_split(m_feb1, m_food);
+    sort_by_date();
+    EXPECT_EQ((SplitVec{m_jan, m_feb1, m_feb2}), run(m_bank));
+
+    auto accounts = g_list_prepend(nullptr, m_food);
+    gnc_split_selection_set_other_accounts(m_sel, accounts,
+                                           GNC_SPLIT_OTHER_ACCOUNTS_INCLUDE);
+    EXPECT_EQ((SplitVec{m_feb1}), run(m_bank));
+    gnc_split_selection_set_other_accounts(m_sel, accounts,
+                                           GNC_SPLIT_OTHER_ACCOUNTS_EXCLUDE);
+    EXPECT_EQ((SplitVec{m_jan, m_feb2}), run(m_bank));
+    g_list_free(accounts);
+
+    /* A split's own account isn't one of the other accounts */
+    accounts = g_list_prepend(nullptr, m_bank);
+    gnc_split_selection_set_other_accounts(m_sel, accounts,
+                                           GNC_SPLIT_OTHER_ACCOUNTS_INCLUDE);
+    EXPECT_EQ(SplitVec{}, run(m_bank));
+    gnc_split_selection_set_other_accounts(m_sel, accounts,
+                                           GNC_SPLIT_OTHER_ACCOUNTS_ANY);
+    EXPECT_EQ((SplitVec{m_jan, m_feb1, m_feb2}), run(m_bank));
+    g_list_free(accounts);
+}
+
+TEST_F(SplitSelectionTest, run_matcher)
+{
+    set_text(m_jan, "Groceries", nullptr, nullptr);
+    set_text(m_feb1, nullptr, nullptr, "weekly GROCERIES");
+    set_text(m_feb2, nullptr, "Rent, Hauptstra\xc3\x9f" "e 1", nullptr);
+    sort_by_date();
+
+    EXPECT_TRUE(gnc_split_selection_set_matcher(m_sel, "Groceries", FALSE,
+                                                FALSE, FALSE));
+    EXPECT_EQ((SplitVec{m_jan}), run(m_bank));
+    EXPECT_TRUE(gnc_split_selection_set_matcher(m_sel, "Groceries", FALSE,
+                                                TRUE, FALSE));
+    EXPECT_EQ((SplitVec{m_jan, m_feb1}), run(m_bank));
+    EXPECT_TRUE(gnc_split_selection_set_matcher(m_sel, "Groceries", FALSE,
+                                                TRUE, TRUE));
+    EXPECT_EQ((SplitVec{m_feb2}), run(m_bank));
+
+    /* Case folding maps the sharp s to ss */
+    EXPECT_TRUE(gnc_split_selection_set_matcher(m_sel, "HAUPTSTRASSE", FALSE,
+                                                TRUE, FALSE));
+    EXPECT_EQ((SplitVec{m_feb2}), run(m_bank));
+    EXPECT_TRUE(gnc_split_selection_set_matcher(m_sel, "HAUPTSTRASSE", FALSE,
+                                                FALSE, FALSE));
+    EXPECT_EQ(SplitVec{}, run(m_bank));
+
+    EXPECT_TRUE(gnc_split_selection_set_matcher(m_sel, "^gro", TRUE,
+                                                TRUE, FALSE));
+    EXPECT_EQ((SplitVec{m_jan}), run(m_bank));
+    EXPECT_TRUE(gnc_split_selection_set_matcher(m_sel, "rent|weekly", TRUE,
+                                                TRUE, TRUE));
+    EXPECT_EQ((SplitVec{m_jan}), run(m_bank));
+}
+
+/* The keys the query can't sort by are sorted afterwards, keeping the
+ * query's order, by posted date, for splits that sort equal. */
+TEST_F(SplitSelectionTest, run_sort_reconciled_status)
+{
+    set_reconcile(m_feb1, YREC);
+    gnc_split_selection_set_sort(m_sel, 0, GNC_SPLIT_SORT_RECONCILED_STATUS,
+                                 GNC_SPLIT_DATE_GROUP_NONE, TRUE, TRUE);
+    EXPECT_EQ((SplitVec{m_feb1, m_jan, m_feb2}), run(m_bank));
+    gnc_split_selection_set_sort(m_sel, 0, GNC_SPLIT_SORT_RECONCILED_STATUS,
+                                 GNC_SPLIT_DATE_GROUP_NONE, FALSE, TRUE);
+    EXPECT_EQ((SplitVec{m_jan, m_feb2, m_feb1}), run(m_bank));
+}
+
+TEST_F(SplitSelectionTest, run_sort_notes)
+{
+    set_text(m_jan, nullptr, "b", nullptr);
+    set_text(m_feb1, nullptr, "a", nullptr);
+    set_text(m_feb2, nullptr, "b", nullptr);
+    gnc_split_selection_set_sort(m_sel, 0, GNC_SPLIT_SORT_NOTES,
+                                 GNC_SPLIT_DATE_GROUP_NONE, TRUE, FALSE);
+    EXPECT_EQ((SplitVec{m_feb1, m_jan, m_feb2}), run(m_bank));
+    gnc_split_selection_set_sort(m_sel, 0, GNC_SPLIT_SORT_NOTES,
+                                 GNC_SPLIT_DATE_GROUP_NONE, FALSE, FALSE);
+    EXPECT_EQ((SplitVec{m_jan, m_feb2, m_feb1}), run(m_bank));
+}
+
+TEST_F(SplitSelectionTest, run_sort_date_groups)
+{
+    gnc_split_selection_set_sort(m_sel, 0, GNC_SPLIT_SORT_DATE,
+                                 GNC_SPLIT_DATE_GROUP_MONTH, FALSE, FALSE);
+    EXPECT_EQ((SplitVec{m_feb1, m_feb2, m_jan}), run(m_bank));
+    gnc_split_selection_set_sort(m_sel, 0, GNC_SPLIT_SORT_DATE,
+                                 GNC_SPLIT_DATE_GROUP_YEAR, FALSE, FALSE);
+    EXPECT_EQ((SplitVec{m_jan, m_feb1, m_feb2}), run(m_bank));
+
+    /* Within each month by notes, descending */
+    set_text(m_jan, nullptr, "b", nullptr);
+    set_text(m_feb1, nullptr, "a", nullptr);
+    set_text(m_feb2, nullptr, "b", nullptr);
+    gnc_split_selection_set_sort(m_sel, 0, GNC_SPLIT_SORT_DATE,
+                                 GNC_SPLIT_DATE_GROUP_MONTH, TRUE, FALSE);
+    gnc_split_selection_set_sort(m_sel, 1, GNC_SPLIT_SORT_NOTES,
+                                 GNC_SPLIT_DATE_GROUP_NONE, FALSE, FALSE);
+    EXPECT_EQ((SplitVec{m_jan, m_feb2, m_feb1}), run(m_bank));
+}
+
+TEST_F(SplitSelectionTest, run_unique_trans)
+{
+    auto food_feb1 = add_other_split(m_feb1, m_food);
+    sort_by_date();
+
+    auto splits = run(nullptr);
+    EXPECT_EQ(5u, splits.size());
+
+    splits = run(nullptr, TRUE);
+    ASSERT_EQ(4u, splits.size());
+    EXPECT_EQ(m_jan, splits[0]);
+    EXPECT_TRUE(splits[1] == m_feb1 || splits[1] == food_feb1);
+    /* The two on the 20th are in either order */
+    EXPECT_TRUE((splits[2] == m_feb2 && splits[3] == m_food_feb) ||
+                (splits[2] == m_food_feb && splits[3] == m_feb2));
+
+    EXPECT_EQ((SplitVec{food_feb1, m_food_feb}), run(m_food, TRUE));
+}
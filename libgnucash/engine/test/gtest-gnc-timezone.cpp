@@ -296,6 +296,46 @@ TEST(gnc_timezone_constructors, test_IANA_Minsk_tz)
         }
      }
 }
+
+TEST(gnc_timezone_offsets, test_utc_offset_matches_zone)
+{
+    using namespace boost::posix_time;
+    static const ptime epoch{boost::gregorian::date(1970, 1, 1)};
+    for (auto name : {"America/Los_Angeles", "Australia/Lord_Howe",
+                      "America/Sao_Paulo", "Europe/Minsk"})
+    {
+        TimeZoneProvider tzp(name);
+        int32_t offset;
+        bool is_dst;
+        for (int64_t time = -1577923200; time < 1893456000; time += 10799)
+        {
+            ptime utc{epoch + seconds(time)};
+            boost::local_time::local_date_time ldt{utc, tzp.get(utc.date().year())};
+            ASSERT_TRUE(tzp.utc_offset(time, offset, is_dst));
+            EXPECT_EQ(offset, (ldt.local_time() - utc).total_seconds())
+                << name << " " << time;
+            EXPECT_EQ(is_dst, ldt.is_dst()) << name << " " << time;
+        }
+    }
+}
+
+TEST(gnc_timezone_offsets, test_near_transition)
+{
+    TimeZoneProvider tzp("America/Los_Angeles");
+    int32_t offset;
+    bool is_dst;
+    EXPECT_TRUE(tzp.utc_offset(1143971999, offset, is_dst));
+    EXPECT_EQ(offset, -28800);
+    EXPECT_FALSE(is_dst);
+    EXPECT_TRUE(tzp.utc_offset(1143972000, offset, is_dst));
+    EXPECT_EQ(offset, -25200);
+    EXPECT_TRUE(is_dst);
+    EXPECT_TRUE(tzp.near_transition(1143972000 - 3600, 86400));
+    EXPECT_TRUE(tzp.near_transition(1162112400 + 86400, 86400));
+    EXPECT_FALSE(tzp.near_transition(1150000000, 86400));
+    EXPECT_TRUE(tzp.near_transition(INT64_C(8000000000), 86400));
+    EXPECT_FALSE(tzp.utc_offset(INT64_C(8000000000), offset, is_dst));
+}
 #endif
 
 TEST(gnc_timezone_constructors, test_bogus_time_constructor)
@@ -326,6 +326,25 @@ TEST_F(ImapBayesTest, AddAccountBayes)
     EXPECT_EQ(2, value->get<int64_t>());
 }
 
+TEST_F(ImapBayesTest, FindAccountBayesFollowsChanges)
+{
+    gnc_account_imap_add_account_bayes(t_imap, t_list1, t_expense_account1);
+    EXPECT_EQ(t_expense_account1, gnc_account_imap_find_account_bayes(t_imap, t_list1));
+    // foo and bar now each point to account2 four times out of five.
+    for (int i = 0; i < 4; ++i)
+        gnc_account_imap_add_account_bayes(t_imap, t_list1, t_expense_account2);
+    EXPECT_EQ(t_expense_account2, gnc_account_imap_find_account_bayes(t_imap, t_list1));
+    EXPECT_EQ(nullptr, gnc_account_imap_find_account_bayes(t_imap, t_list2));
+
+    // Changes made directly to the slots must be seen too.
+    auto root = qof_instance_get_slots(QOF_INSTANCE(t_bank_account));
+    auto acct1_guid = guid_to_string (xaccAccountGetGUID(t_expense_account1));
+    delete root->set_path({std::string{IMAP_FRAME_BAYES} + "/" + foo + "/" + acct1_guid}, new KvpValue{INT64_C(100)});
+    delete root->set_path({std::string{IMAP_FRAME_BAYES} + "/" + bar + "/" + acct1_guid}, new KvpValue{INT64_C(100)});
+    EXPECT_EQ(t_expense_account1, gnc_account_imap_find_account_bayes(t_imap, t_list1));
+    g_free(acct1_guid);
+}
+
 TEST_F(ImapBayesTest, ConvertBayesData)
 {
     auto root = qof_instance_get_slots(QOF_INSTANCE(t_bank_account));
@@ -683,6 +683,33 @@ test_book_get_session_dirty_time( Fixture *fixture, gconstpointer pData )
 
 }
 
+static void
+test_book_get_generation( Fixture *fixture, gconstpointer pData )
+{
+    guint64 generation = qof_book_get_generation( fixture->book );
+    Account *root;
+
+    g_test_message( "Testing that marking the book dirty bumps the generation" );
+    qof_book_mark_session_dirty( fixture->book );
+    g_assert_cmpuint( qof_book_get_generation( fixture->book ), >, generation );
+    generation = qof_book_get_generation( fixture->book );
+    qof_book_mark_session_dirty( fixture->book );
+    g_assert_cmpuint( qof_book_get_generation( fixture->book ), >, generation );
+
+    g_test_message( "Testing that saving doesn't change the generation" );
+    generation = qof_book_get_generation( fixture->book );
+    qof_book_mark_session_saved( fixture->book );
+    g_assert_cmpuint( qof_book_get_generation( fixture->book ), ==, generation );
+
+    g_test_message( "Testing that committing a change bumps the generation" );
+    root = gnc_account_create_root( fixture->book );
+    generation = qof_book_get_generation( fixture->book );
+    xaccAccountBeginEdit( root );
+    xaccAccountSetDescription( root, "changed" );
+    xaccAccountCommitEdit( root );
+    g_assert_cmpuint( qof_book_get_generation( fixture->book ), >, generation );
+}
+
 static void
 test_book_set_dirty_cb( Fixture *fixture, gconstpointer pData )
 {
@@ -936,6 +963,7 @@ test_suite_qofbook ( void )
     GNC_TEST_ADD( suitename, "use split action for num field", Fixture, NULL, setup, test_book_use_split_action_for_num_field, teardown );
     GNC_TEST_ADD( suitename, "mark session dirty", Fixture, NULL, setup, test_book_mark_session_dirty, teardown );
     GNC_TEST_ADD( suitename, "session dirty time", Fixture, NULL, setup, test_book_get_session_dirty_time, teardown );
+    GNC_TEST_ADD( suitename, "get generation", Fixture, NULL, setup, test_book_get_generation, teardown );
     GNC_TEST_ADD( suitename, "set dirty callback", Fixture, NULL, setup, test_book_set_dirty_cb, teardown );
     GNC_TEST_ADD( suitename, "shutting down", Fixture, NULL, setup, test_book_shutting_down, teardown );
     GNC_TEST_ADD( suitename, "set get data", Fixture, NULL, setup, test_book_set_get_data, teardown );
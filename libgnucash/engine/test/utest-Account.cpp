@@ -1834,6 +1834,62 @@ test_gnc_account_foreach_descendant_until (Fixture *fixture, gconstpointer pData
     g_assert (result == expected);
     g_assert_cmpint (counter, == , 6);
 }
+/* gnc_account_iter_new
+GncAccountIter *
+gnc_account_iter_new (const Account *acc, GncAccountIterKind kind,// C: 0 */
+static void
+check_account_iter (const Account *acc, GncAccountIterKind kind,
+                    gboolean snapshot, GList *expected)
+{
+    auto iter = gnc_account_iter_new (acc, kind, snapshot);
+    g_assert (gnc_account_iter_get_kind (iter) == kind);
+    for (GList *node = expected; node; node = node->next)
+        g_assert (gnc_account_iter_next (iter) == node->data);
+    g_assert (gnc_account_iter_next (iter) == NULL);
+    g_assert (!gnc_account_iter_is_stale (iter));
+    gnc_account_iter_free (iter);
+}
+
+static void
+test_gnc_account_iter (Fixture *fixture, gconstpointer pData)
+{
+    Account *root = gnc_account_get_root (fixture->acct);
+    QofBook *book = gnc_account_get_book (root);
+    GList *descendants = gnc_account_get_descendants (root);
+    GList *children = gnc_account_get_children (root);
+    guint n_splits = 0;
+
+    for (GList *node = descendants; node; node = node->next)
+    {
+        auto acc = static_cast<Account*>(node->data);
+        GList *splits = xaccAccountGetSplitList (acc);
+        n_splits += g_list_length (splits);
+        check_account_iter (acc, GNC_ACCOUNT_ITER_SPLITS, FALSE, splits);
+        check_account_iter (acc, GNC_ACCOUNT_ITER_SPLITS, TRUE, splits);
+    }
+    g_assert_cmpuint (n_splits, >, 0);
+    check_account_iter (root, GNC_ACCOUNT_ITER_CHILDREN, FALSE, children);
+    check_account_iter (root, GNC_ACCOUNT_ITER_CHILDREN, TRUE, children);
+    check_account_iter (root, GNC_ACCOUNT_ITER_DESCENDANTS, FALSE, descendants);
+    check_account_iter (root, GNC_ACCOUNT_ITER_DESCENDANTS, TRUE, descendants);
+    check_account_iter (fixture->acct, GNC_ACCOUNT_ITER_DESCENDANTS, FALSE, NULL);
+
+    /* A change to the book stops a live iterator but not a snapshot. */
+    auto live = gnc_account_iter_new (root, GNC_ACCOUNT_ITER_DESCENDANTS, FALSE);
+    auto snapshot = gnc_account_iter_new (root, GNC_ACCOUNT_ITER_DESCENDANTS, TRUE);
+    g_assert (gnc_account_iter_next (live) == descendants->data);
+    g_assert (gnc_account_iter_next (snapshot) == descendants->data);
+    qof_book_bump_generation (book);
+    g_assert (gnc_account_iter_next (live) == NULL);
+    g_assert (gnc_account_iter_is_stale (live));
+    g_assert (gnc_account_iter_next (snapshot) == descendants->next->data);
+    g_assert (!gnc_account_iter_is_stale (snapshot));
+    gnc_account_iter_free (live);
+    gnc_account_iter_free (snapshot);
+
+    g_list_free (children);
+    g_list_free (descendants);
+}
 /* More getter/setters:
  * xaccAccountGetType
  * qofAccountGetTypeString
@@ -1935,6 +1991,40 @@ test_xaccAccountGetBalanceAsOfDate (Fixture *fixture, gconstpointer pData)
     dval = gnc_numeric_to_double (val);
     g_assert_cmpfloat (dval, == , dbal);
 }
+/* xaccAccountGetBalancesAtDates
+guint
+xaccAccountGetBalancesAtDates (Account *acc, GNCAccountBalanceKind kind,
+                               const time64 *dates, guint n_dates,
+                               gnc_numeric *balances)
+*/
+static void
+test_xaccAccountGetBalancesAtDates (Fixture *fixture, gconstpointer pData)
+{
+    time64 now = gnc_time (NULL);
+    gint offset = 24 * 3600 * 3; /* 3 days in seconds */
+    time64 dates[] = {0, now - offset, now, now + 365 * 24 * 3600};
+    guint n_dates = G_N_ELEMENTS (dates);
+    gnc_numeric balances[G_N_ELEMENTS (dates)];
+    guint no_split_dates;
+
+    no_split_dates = xaccAccountGetBalancesAtDates (fixture->acct,
+                                                    ACCOUNT_BALANCE_TOTAL,
+                                                    dates, n_dates, balances);
+    g_assert_cmpuint (no_split_dates, ==, 1);
+    for (guint i = 0; i < n_dates; i++)
+    {
+        /* xaccAccountGetBalanceAsOfDate excludes splits on the date itself */
+        gnc_numeric bal = xaccAccountGetBalanceAsOfDate (fixture->acct,
+                                                         dates[i] + 1);
+        g_assert (gnc_numeric_equal (balances[i], bal));
+    }
+    g_assert (gnc_numeric_equal (balances[n_dates - 1],
+                                 xaccAccountGetBalance (fixture->acct)));
+
+    g_assert_cmpuint (xaccAccountGetBalancesAtDates (fixture->acct,
+                                                     ACCOUNT_BALANCE_TOTAL,
+                                                     NULL, 0, NULL), ==, 0);
+}
 /* xaccAccountGetPresentBalance
 gnc_numeric
 xaccAccountGetPresentBalance (const Account *acc)// C: 4 in 2 */
@@ -2514,6 +2604,39 @@ test_xaccAccountTreeForEachTransaction (Fixture *fixture, gconstpointer pData )
     g_assert_cmpint (result, < , 9);
     g_free(td.name);
 }
+
+typedef struct
+{
+    Account *root;
+    guint outer;
+    guint inner;
+} NestedThunkdata;
+
+static gint
+thunk_nested (Transaction *txn, gpointer data)
+{
+    NestedThunkdata *nd = (NestedThunkdata*)data;
+    Thunkdata td = {0, NULL};
+    ++(nd->outer);
+    xaccAccountTreeForEachTransaction (nd->root, thunk3, &td);
+    nd->inner += td.count;
+    return 0;
+}
+
+static void
+test_xaccAccountTreeForEachTransaction_nested (Fixture *fixture, gconstpointer pData )
+{
+    Account *root = gnc_account_get_root (fixture->acct);
+    NestedThunkdata nd = {root, 0, 0};
+    Thunkdata td = {0, NULL};
+    gint result = xaccAccountTreeForEachTransaction (root, thunk_nested, &nd);
+    g_assert_cmpint (result, == , 0);
+    g_assert_cmpint (nd.outer, == , 9);
+    g_assert_cmpint (nd.inner, == , 81);
+    /* The stamps are free again once the outer traversal is done. */
+    xaccAccountTreeForEachTransaction (root, thunk3, &td);
+    g_assert_cmpint (td.count, == , 9);
+}
 /* xaccAccountForEachTransaction
 gint
 xaccAccountForEachTransaction (const Account *acc, TransactionCallback proc,// C: 8 in 4 */
@@ -2577,9 +2700,11 @@ test_suite_account (void)
     GNC_TEST_ADD (suitename, "gnc account foreach child", Fixture, &complex, setup, test_gnc_account_foreach_child,  teardown );
     GNC_TEST_ADD (suitename, "gnc account foreach descendant", Fixture, &complex, setup, test_gnc_account_foreach_descendant,  teardown );
     GNC_TEST_ADD (suitename, "gnc account foreach descendant until", Fixture, &complex, setup, test_gnc_account_foreach_descendant_until,  teardown );
+    GNC_TEST_ADD (suitename, "gnc account iter", Fixture, &complex_data, setup, test_gnc_account_iter,  teardown );
     GNC_TEST_ADD (suitename, "gnc account get full name", Fixture, &good_data, setup, test_gnc_account_get_full_name,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountGetProjectedMinimumBalance", Fixture, &some_data, setup, test_xaccAccountGetProjectedMinimumBalance,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountGetBalanceAsOfDate", Fixture, &some_data, setup, test_xaccAccountGetBalanceAsOfDate,  teardown );
+    GNC_TEST_ADD (suitename, "xaccAccountGetBalancesAtDates", Fixture, &some_data, setup, test_xaccAccountGetBalancesAtDates,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountGetPresentBalance", Fixture, &some_data, setup, test_xaccAccountGetPresentBalance,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountFindOpenLots", Fixture, &complex_data, setup, test_xaccAccountFindOpenLots,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountForEachLot", Fixture, &complex_data, setup, test_xaccAccountForEachLot,  teardown );
@@ -2593,6 +2718,7 @@ test_suite_account (void)
     GNC_TEST_ADD (suitename, "gnc account merge children", Fixture, &complex_data, setup, test_gnc_account_merge_children,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountForEachTransaction", Fixture, &complex_data, setup, test_xaccAccountForEachTransaction,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountTreeForEachTransaction", Fixture, &complex_data, setup, test_xaccAccountTreeForEachTransaction,  teardown );
+    GNC_TEST_ADD (suitename, "xaccAccountTreeForEachTransaction nested", Fixture, &complex_data, setup, test_xaccAccountTreeForEachTransaction_nested,  teardown );
 
 
 }